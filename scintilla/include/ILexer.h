@@ -12,6 +12,7 @@ namespace Scintilla {
 
 enum {
 	dvRelease4 = 2,
+	dvRangePointer = 3,
 };
 
 class IDocument {
@@ -42,6 +43,13 @@ public:
 	virtual int SCI_METHOD GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const noexcept = 0;
 };
 
+// Available when Version() >= dvRangePointer.
+class IDocumentRangePointer : public IDocument {
+public:
+	virtual const char * SCI_METHOD RangePointer(Sci_Position position, Sci_Position rangeLength) noexcept = 0;
+	virtual Sci_Position SCI_METHOD GapPosition() const noexcept = 0;
+};
+
 enum {
 	lvRelease4 = 2,
 	lvRelease5 = 3,
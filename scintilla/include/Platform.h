@@ -444,6 +444,8 @@ public:
 	virtual void SetUnicodeMode(bool unicodeMode_) noexcept = 0;
 	virtual void SetDBCSMode(int codePage) noexcept = 0;
 	virtual void SetBidiR2L(bool bidiR2L_) noexcept = 0;
+	// Whether MeasureWidths() on separate surfaces can be called from multiple threads at the same time.
+	virtual bool SupportsThreadSafeMeasureWidths() const noexcept = 0;
 };
 
 /**
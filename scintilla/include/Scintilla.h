@@ -519,6 +519,8 @@ typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam,
 #define SCI_FOLDCHILDREN 2238
 #define SCI_EXPANDCHILDREN 2239
 #define SCI_FOLDALL 2662
+#define SCI_BEGINFOLDBATCH 2739
+#define SCI_ENDFOLDBATCH 2740
 #define SCI_ENSUREVISIBLE 2232
 #define SC_AUTOMATICFOLD_SHOW 0x0001
 #define SC_AUTOMATICFOLD_CLICK 0x0002
@@ -581,6 +583,8 @@ typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam,
 #define SC_CACHE_DOCUMENT 3
 #define SCI_SETLAYOUTCACHE 2272
 #define SCI_GETLAYOUTCACHE 2273
+#define SCI_SETLAYOUTCACHEMEMORY 2734
+#define SCI_GETLAYOUTCACHEMEMORY 2735
 #define SCI_SETSCROLLWIDTH 2274
 #define SCI_GETSCROLLWIDTH 2275
 #define SCI_SETSCROLLWIDTHTRACKING 2516
@@ -870,6 +874,14 @@ typedef sptr_t (*SciFnDirect)(sptr_t ptr, unsigned int iMessage, uptr_t wParam,
 #define SCI_INDICATOREND 2509
 #define SCI_SETPOSITIONCACHE 2514
 #define SCI_GETPOSITIONCACHE 2515
+#define SC_POSITIONCACHESTATISTIC_HITS 0
+#define SC_POSITIONCACHESTATISTIC_MISSES 1
+#define SC_POSITIONCACHESTATISTIC_EVICTIONS 2
+#define SCI_GETPOSITIONCACHESTATISTIC 2732
+#define SCI_RESETPOSITIONCACHESTATISTICS 2733
+#define SCI_SETPAINTTIMING 2736
+#define SCI_GETPAINTTIMING 2737
+#define SCI_GETPAINTTIMINGS 2738
 #define SCI_COPYALLOWLINE 2519
 #define SCI_GETCHARACTERPOINTER 2520
 #define SCI_GETRANGEPOINTER 2643
@@ -1206,6 +1218,21 @@ struct Sci_RangeToFormat {
 	struct Sci_CharacterRange chrg;
 };
 
+/* Durations in seconds of the phases of painting one frame, retrieved by SCI_GETPAINTTIMINGS. */
+struct Sci_PaintFrameTiming {
+	double total;
+	double styling;
+	double layout;
+	double background;
+	double text;
+	double indicators;
+	double margin;
+	double caret;
+	int linesPainted;
+	int linesLaidOut;
+	int layoutCacheHits;
+};
+
 #ifndef __cplusplus
 /* For the GTK platform, g-ir-scanner needs to have these typedefs. This
  * is not required in C++ code and actually seems to break ScintillaEditPy */
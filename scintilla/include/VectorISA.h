@@ -24,22 +24,48 @@
 
 	// Clang & GCC use -mavx2 -mpopcnt -mbmi (to enable tzcnt).
 	// MSVC use /arch:AVX2
-	#if defined(_WIN64) && !defined(NP2_USE_AVX2)
-		#if defined(__AVX2__)
+	// other targets may define NP2_USE_AVX2, e.g. tests built with -DNP2_USE_AVX2=1 -mavx2.
+	#if !defined(NP2_USE_AVX2)
+		#if defined(_WIN64) && defined(__AVX2__)
 			#define NP2_USE_AVX2	1
 		#else
 			#define NP2_USE_AVX2	0
 		#endif
-	#else
-		#define NP2_USE_AVX2	0
 	#endif // NP2_USE_AVX2
 
-	#include <intrin.h>
-	// TODO: use __isa_enabled/__isa_available in MSVC build to dynamic enable AVX2 code.
-	//#if defined(_MSC_VER) || (defined(__has_include) && __has_include(<isa_availability.h>))
-	//	#include <isa_availability.h>
-	//#else
-	//#endif
+	#if defined(_WIN32)
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+	// AVX2 code in other builds is compiled with NP2_TARGET_AVX2 on the function (and on inline
+	// functions it calls), and is only called when np2_cpu_has_avx2() is non-zero.
+	#if NP2_USE_AVX2
+		#define NP2_TARGET_AVX2
+		#define np2_cpu_has_avx2()	1
+	#elif defined(_MSC_VER)
+		#include <isa_availability.h>
+		// set by the C runtime on startup, after checking the OS saves AVX registers.
+		#if defined(__cplusplus)
+		extern "C" int __isa_available;
+		#else
+		extern int __isa_available;
+		#endif
+		#if defined(__clang__)
+			#define NP2_TARGET_AVX2		__attribute__((target("avx2")))
+		#else
+			#define NP2_TARGET_AVX2
+		#endif
+		#define np2_cpu_has_avx2()	(__isa_available >= __ISA_AVAILABLE_AVX2)
+	#else
+		#define NP2_TARGET_AVX2		__attribute__((target("avx2")))
+		#define np2_cpu_has_avx2()	__builtin_cpu_supports("avx2")
+	#endif
 
-	// TODO: Function Multiversioning https://gcc.gnu.org/wiki/FunctionMultiVersioning
+	// count trailing zero bits of non-zero 32-bit mask returned by _mm_movemask_epi8() or _mm256_movemask_epi8().
+	#if defined(__clang__) || defined(__GNUC__)
+		#define np2_ctz(x)		__builtin_ctz(x)
+	#else
+		#define np2_ctz(x)		_tzcnt_u32(x)
+	#endif
 #endif
@@ -455,6 +455,8 @@ static void ColouriseCppDoc(Sci_PositionU startPos, Sci_Position length, int ini
 			if (sc.Match('*', '/')) {
 				sc.Forward();
 				sc.ForwardSetState(SCE_C_DEFAULT);
+			} else {
+				sc.ForwardBefore("*");
 			}
 			break;
 		case SCE_C_COMMENTLINE:
@@ -464,6 +466,8 @@ static void ColouriseCppDoc(Sci_PositionU startPos, Sci_Position length, int ini
 				sc.SetState(SCE_C_XML_TAG);
 				sc.Forward();
 				sc.ForwardSetState(SCE_C_XML_DEFAULT);
+			} else {
+				sc.ForwardBefore((lexType == LEX_PHP) ? "?" : "");
 			}
 			break;
 		case SCE_C_COMMENTDOC:
@@ -523,6 +527,8 @@ static void ColouriseCppDoc(Sci_PositionU startPos, Sci_Position length, int ini
 				if (!ignore) {
 					sc.SetState(outerStyle);
 				}
+			} else {
+				sc.ForwardBefore("*{}@\\</>?");
 			}
 			break;
 		case SCE_C_COMMENTDOC_TAG:
@@ -614,6 +620,9 @@ static void ColouriseCppDoc(Sci_PositionU startPos, Sci_Position length, int ini
 					sc.Forward();
 				outerStyle = SCE_C_DEFAULT;
 				sc.ForwardSetState(SCE_C_DEFAULT);
+			} else {
+				const Sci_PositionU pos = sc.ForwardBefore((lexType == LEX_PHP) ? "\\\"${" : (isIncludePreprocessor ? "\\\">" : "\\\""));
+				visibleChars += sc.CountNonSpace(pos, chPrevNonWhite);
 			}
 			break;
 		case SCE_C_STRINGRAW:
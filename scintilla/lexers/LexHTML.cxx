@@ -643,6 +643,8 @@ void ColouriseHyperTextDoc(Sci_PositionU startPos, Sci_Position length, int init
 	// property lexer.html.django
 	//	Set to 1 to enable the django template language.
 	const bool isDjango = styler.GetPropertyInt("lexer.html.django", 0) != 0;
+	// plain text can be skipped in bulk when no template language and no DBCS trail byte.
+	const bool bulkSkip = !isMako && !isDjango && styler.Encoding() != encDBCS;
 
 	const CharacterSet setHTMLWord(CharacterSet::setAlphaNum, ".-_:!#", 0x80, true);
 	const CharacterSet setTagContinue(CharacterSet::setAlphaNum, ".-_:!#[]", 0x80, true);
@@ -1183,6 +1185,7 @@ void ColouriseHyperTextDoc(Sci_PositionU startPos, Sci_Position length, int init
 		}
 		/////////////////////////////////////
 
+		const char *plainTextStops = nullptr;
 		switch (state) {
 		case SCE_H_DEFAULT:
 			if (ch == '<') {
@@ -1201,6 +1204,8 @@ void ColouriseHyperTextDoc(Sci_PositionU startPos, Sci_Position length, int init
 			} else if (ch == '&') {
 				styler.ColourTo(i - 1, SCE_H_DEFAULT);
 				state = SCE_H_ENTITY;
+			} else {
+				plainTextStops = "<&\r\n";
 			}
 			break;
 		case SCE_H_SGML_DEFAULT:
@@ -1329,6 +1334,8 @@ void ColouriseHyperTextDoc(Sci_PositionU startPos, Sci_Position length, int init
 				styler.ColourTo(i, StateToPrint);
 				state = SCE_H_DEFAULT;
 				levelCurrent--;
+			} else {
+				plainTextStops = "<>\r\n";
 			}
 			break;
 		case SCE_H_SGML_1ST_PARAM_COMMENT:
@@ -2089,6 +2096,34 @@ void ColouriseHyperTextDoc(Sci_PositionU startPos, Sci_Position length, int init
 			///////////// end - PHP state handling
 		}
 
+		if (plainTextStops && bulkSkip && inScriptType == eHtml && scriptLanguage == eScriptNone) {
+			// move to the character before next stop character or line end.
+			const Sci_Position pos = styler.FindAnyOf(i + 1, lengthDoc, plainTextStops);
+			if (pos > i + 1) {
+				// same bookkeeping as done at loop start for the skipped characters.
+				int visible = 0;
+				for (Sci_Position j = i; j < pos; j++) {
+					const int chSkip = static_cast<unsigned char>(styler[j]);
+					if (!IsASpace(chSkip)) {
+						if (j != i) {
+							visible++;
+						}
+						if (j != pos - 1) {
+							chPrevNonWhite = chSkip;
+						}
+					}
+				}
+				lineStartVisibleChars += visible;
+				if (fold) {
+					visibleChars += foldCompact ? visible : static_cast<int>(pos - i - 1);
+				}
+				i = pos - 1;
+				chPrev = static_cast<unsigned char>(styler[i - 1]);
+				ch = static_cast<unsigned char>(styler[i]);
+				continue;
+			}
+		}
+
 		// Some of the above terminated their lexeme but since the same character starts
 		// the same class again, only reenter if non empty segment.
 
@@ -162,12 +162,22 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 				}
 				state = SCE_C_DEFAULT;
 				continue;
+			} else if (styler.Encoding() != encDBCS) {
+				// skip to the character before next escape, quote or line end
+				const Sci_PositionU pos = styler.FindAnyOf(i + 1, lineEndPos, (state == SCE_C_STRING) ? "\\\"" : "\\'");
+				if (pos > i + 1) {
+					i = pos - 1;
+					chNext = styler.SafeGetCharAt(pos);
+				}
 			}
 			break;
 		case SCE_C_COMMENTLINE:
 			if (atLineStart) {
 				styler.ColourTo(i - 1, state);
 				state = SCE_C_DEFAULT;
+			} else if (i + 1 < lineEndPos && styler.Encoding() != encDBCS) {
+				i = lineEndPos - 1;
+				chNext = styler.SafeGetCharAt(lineEndPos);
 			}
 			break;
 		case SCE_C_COMMENT:
@@ -178,6 +188,12 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 				state = SCE_C_DEFAULT;
 				levelNext--;
 				continue;
+			} else if (styler.Encoding() != encDBCS) {
+				const Sci_PositionU pos = styler.FindAnyOf(i + 1, lineEndPos, "*");
+				if (pos > i + 1) {
+					i = pos - 1;
+					chNext = styler.SafeGetCharAt(pos);
+				}
 			}
 			break;
 		}
@@ -185,33 +201,93 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 		if (state == SCE_C_DEFAULT) {
 			const int charClass = kJsonCharClass[ch] & 0x0F;
 			switch (charClass) {
-			case JsonChar_Operator:
-				styler.ColourTo(i - 1, state);
-				state = SCE_C_OPERATOR;
+			case JsonChar_None:
+				if (ch == ' ' || ch == '\t') {
+					// skip indentation and spaces between tokens, default style is colored on next token
+					const Sci_PositionU pos = styler.SkipSpaceTab(i + 1, lineEndPos);
+					if (pos > i + 1) {
+						i = pos - 1;
+						chNext = styler.SafeGetCharAt(pos);
+					}
+				}
 				break;
+			case JsonChar_Operator:
 			case JsonChar_OperatorOpen:
-				styler.ColourTo(i - 1, state);
-				state = SCE_C_OPERATOR;
-				levelNext++;
-				break;
 			case JsonChar_OperatorClose:
+				// structural character is styled and folded in place, then jump over spaces to next token
 				styler.ColourTo(i - 1, state);
-				state = SCE_C_OPERATOR;
-				levelNext--;
+				styler.ColourTo(i, SCE_C_OPERATOR);
+				if (charClass == JsonChar_OperatorOpen) {
+					levelNext++;
+				} else if (charClass == JsonChar_OperatorClose) {
+					levelNext--;
+				}
+				if (chNext == ' ' || chNext == '\t') {
+					const Sci_PositionU pos = styler.SkipSpaceTab(i + 1, lineEndPos);
+					i = pos - 1;
+					chNext = styler.SafeGetCharAt(pos);
+				}
 				break;
 			case JsonChar_String:
 				styler.ColourTo(i - 1, state);
 				state = SCE_C_STRING;
+				if (styler.Encoding() != encDBCS) {
+					// string without escape sequence is styled as a whole, otherwise skip to the escape
+					const Sci_PositionU pos = styler.FindAnyOf(i + 1, lineEndPos, "\\\"");
+					if (pos < lineEndPos && styler[pos] == '\"') {
+						i = pos;
+						chNext = styler.SafeGetCharAt(i + 1);
+						if (chNext == ':' || LexGetNextChar(i + 1, styler) == ':') {
+							styler.ColourTo(i, SCE_C_LABEL);
+						} else {
+							styler.ColourTo(i, SCE_C_STRING);
+						}
+						state = SCE_C_DEFAULT;
+					} else if (pos > i + 1) {
+						i = pos - 1;
+						chNext = styler.SafeGetCharAt(pos);
+					}
+				}
 				break;
 			case JsonChar_Digit:
-				styler.ColourTo(i - 1, state);
-				state = SCE_C_NUMBER;
-				break;
 			case JsonChar_WordStart:
+			case JsonChar_IDStart:
 				styler.ColourTo(i - 1, state);
-				state = SCE_C_WORD2;
-				buf[0] = static_cast<char>(ch);
-				wordLen = 1;
+				if (charClass != JsonChar_Digit && styler.Encoding() == encDBCS) {
+					// trail byte in DBCS character may look like a structural character
+					state = (charClass == JsonChar_WordStart) ? SCE_C_WORD2 : SCE_C_IDENTIFIER;
+					buf[0] = static_cast<char>(ch);
+					wordLen = 1;
+				} else {
+					// style whole number or literal at once, then jump over spaces to next structural character
+					const int mask = (charClass == JsonChar_Digit) ? JsonChar_Number : JsonChar_ID;
+					Sci_PositionU pos = i + 1;
+					while (pos <= lineEndPos && (kJsonCharClass[static_cast<unsigned char>(styler[pos])] & mask)) {
+						++pos;
+					}
+					int style = SCE_C_NUMBER;
+					if (charClass != JsonChar_Digit) {
+						style = SCE_C_DEFAULT;
+						if (charClass == JsonChar_WordStart && pos - i <= MaxJsonWordLength) {
+							styler.GetRange(i, pos, buf, sizeof(buf));
+							if (keywordLists[0]->InList(buf)) {
+								style = SCE_C_WORD;
+							}
+						}
+						if (style == SCE_C_DEFAULT && (styler[pos] == ':' || styler.SafeGetCharAt(pos + 1) == ':'
+							|| LexGetNextChar(pos + 1, styler) == ':')) {
+							style = SCE_C_LABEL;
+						}
+					}
+					if (style != SCE_C_DEFAULT) {
+						styler.ColourTo(pos - 1, style);
+					}
+					if (pos < lineEndPos && IsSpaceOrTab(styler[pos])) {
+						pos = styler.SkipSpaceTab(pos + 1, lineEndPos);
+					}
+					i = pos - 1;
+					chNext = styler.SafeGetCharAt(pos);
+				}
 				break;
 			case JsonChar_Dot:
 				styler.ColourTo(i - 1, state);
@@ -233,10 +309,6 @@ void ColouriseJSONDoc(Sci_PositionU startPos, Sci_Position lengthDoc, int initSt
 				styler.ColourTo(i - 1, state);
 				state = SCE_C_CHARACTER;
 				break;
-			case JsonChar_IDStart:
-				styler.ColourTo(i - 1, state);
-				state = SCE_C_IDENTIFIER;
-				break;
 			}
 		}
 
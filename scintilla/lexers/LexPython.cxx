@@ -187,6 +187,8 @@ static void ColourisePyDoc(Sci_PositionU startPos, Sci_Position length, int init
 		case SCE_PY_COMMENTLINE:
 			if (sc.atLineStart) {
 				sc.SetState(SCE_PY_DEFAULT);
+			} else {
+				sc.ForwardBefore("");
 			}
 			break;
 
@@ -201,6 +203,9 @@ static void ColourisePyDoc(Sci_PositionU startPos, Sci_Position length, int init
 				sc.Forward();
 			} else if (sc.ch == '\'') {
 				sc.ForwardSetState(SCE_PY_DEFAULT);
+			} else {
+				const Sci_PositionU pos = sc.ForwardBefore("\\'");
+				visibleChars += sc.CountNonSpace(pos);
 			}
 			break;
 		case SCE_PY_STRING2:
@@ -214,6 +219,9 @@ static void ColourisePyDoc(Sci_PositionU startPos, Sci_Position length, int init
 				sc.Forward();
 			} else if (sc.ch == '\"') {
 				sc.ForwardSetState(SCE_PY_DEFAULT);
+			} else {
+				const Sci_PositionU pos = sc.ForwardBefore("\\\"");
+				visibleChars += sc.CountNonSpace(pos);
 			}
 			break;
 		case SCE_PY_TRIPLE_STRING1:
@@ -224,6 +232,9 @@ static void ColourisePyDoc(Sci_PositionU startPos, Sci_Position length, int init
 			} else if (sc.Match(R"(''')")) {
 				sc.Forward(2);
 				sc.ForwardSetState(SCE_PY_DEFAULT);
+			} else {
+				const Sci_PositionU pos = sc.ForwardBefore("\\'");
+				visibleChars += sc.CountNonSpace(pos);
 			}
 			break;
 		case SCE_PY_TRIPLE_STRING2:
@@ -234,6 +245,9 @@ static void ColourisePyDoc(Sci_PositionU startPos, Sci_Position length, int init
 			} else if (sc.Match(R"(""")")) {
 				sc.Forward(2);
 				sc.ForwardSetState(SCE_PY_DEFAULT);
+			} else {
+				const Sci_PositionU pos = sc.ForwardBefore("\\\"");
+				visibleChars += sc.CountNonSpace(pos);
 			}
 			break;
 		}
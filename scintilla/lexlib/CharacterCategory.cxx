@@ -4826,9 +4826,12 @@ constexpr int maskCategory = 0x1F;
 // For speed, it may be useful to make a linear table for the common values,
 // possibly for 0..0xff for most Western European text or 0..0xfff for most
 // alphabetic languages.
+// Without CHARACTERCATEGORY_USE_BINARY_SEARCH, the category is looked up with
+// a three-stage table covering all code points (about 18 KB), each call takes
+// three dependent loads regardless of the character.
 
 CharacterCategory CategoriseCharacter(int character) noexcept {
-	if (character < 0 || character > maxUnicode) {
+	if (static_cast<unsigned int>(character) > maxUnicode) {
 		return ccCn;
 	}
 #if CHARACTERCATEGORY_OPTIMIZE_LATIN1
@@ -4885,6 +4888,12 @@ bool IsIdPattern(int character) noexcept {
 	return character == 0x2E2F;
 }
 
+// [[:L:][:Nl:]] and [[:L:][:Nl:][:Mn:][:Mc:][:Nd:][:Pc:]] as bit set of CharacterCategory.
+constexpr unsigned int idStartCategoryMask = (1U << ccLu) | (1U << ccLl) | (1U << ccLt) | (1U << ccLm) | (1U << ccLo)
+	| (1U << ccNl);
+constexpr unsigned int idContinueCategoryMask = idStartCategoryMask
+	| (1U << ccMn) | (1U << ccMc) | (1U << ccNd) | (1U << ccPc);
+
 bool OmitXidStart(int character) noexcept {
 	switch (character) {
 	case 0x037A:	// GREEK YPOGEGRAMMENI
@@ -4947,48 +4956,30 @@ bool OmitXidContinue(int character) noexcept {
 
 // UAX #31 defines ID_Start as
 // [[:L:][:Nl:][:Other_ID_Start:]--[:Pattern_Syntax:]--[:Pattern_White_Space:]]
+// category and exception lists are combined without branches, text mixes categories randomly
+// so a branch on the category is often mispredicted.
 bool IsIdStart(int character) noexcept {
-	if (IsIdPattern(character)) {
-		return false;
-	}
-	const OtherID oid = OtherIDOfCharacter(character);
-	if (oid == OtherID::oidStart) {
-		return true;
-	}
 	const CharacterCategory c = CategoriseCharacter(character);
-	return (c == ccLl || c == ccLu || c == ccLt || c == ccLm || c == ccLo
-		|| c == ccNl);
+	const bool category = ((idStartCategoryMask >> c) & 1) & !IsIdPattern(character);
+	return category | (OtherIDOfCharacter(character) == OtherID::oidStart);
 }
 
 // UAX #31 defines ID_Continue as
 // [[:ID_Start:][:Mn:][:Mc:][:Nd:][:Pc:][:Other_ID_Continue:]--[:Pattern_Syntax:]--[:Pattern_White_Space:]]
 bool IsIdContinue(int character) noexcept {
-	if (IsIdPattern(character)) {
-		return false;
-	}
-	const OtherID oid = OtherIDOfCharacter(character);
-	if (oid != OtherID::oidNone) {
-		return true;
-	}
 	const CharacterCategory c = CategoriseCharacter(character);
-	return (c == ccLl || c == ccLu || c == ccLt || c == ccLm || c == ccLo
-		|| c == ccNl || c == ccMn || c == ccMc || c == ccNd || c == ccPc);
+	const bool category = ((idContinueCategoryMask >> c) & 1) & !IsIdPattern(character);
+	return category | (OtherIDOfCharacter(character) != OtherID::oidNone);
 }
 
 // XID_Start is ID_Start modified for Normalization Form KC in UAX #31
 bool IsXidStart(int character) noexcept {
-	if (OmitXidStart(character)) {
-		return false;
-	}
-	return IsIdStart(character);
+	return IsIdStart(character) & !OmitXidStart(character);
 }
 
 // XID_Continue is ID_Continue modified for Normalization Form KC in UAX #31
 bool IsXidContinue(int character) noexcept {
-	if (OmitXidContinue(character)) {
-		return false;
-	}
-	return IsIdContinue(character);
+	return IsIdContinue(character) & !OmitXidContinue(character);
 }
 
 CharacterCategoryMap::CharacterCategoryMap() {
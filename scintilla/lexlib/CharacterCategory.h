@@ -20,7 +20,9 @@ enum CharacterCategory {
 
 // `character` argument must be UTF-32 code point, otherwise the result is undefined.
 // see https://sourceforge.net/p/scintilla/feature-requests/1259/ for these changes.
+#ifndef CHARACTERCATEGORY_USE_BINARY_SEARCH
 #define CHARACTERCATEGORY_USE_BINARY_SEARCH		0
+#endif
 // most calls already checked for ASCII, optimization for Latin-1 may not benefit a lot.
 #define CHARACTERCATEGORY_OPTIMIZE_LATIN1		0
 
@@ -41,7 +43,7 @@ public:
 		if (static_cast<size_t>(character) < dense.size()) {
 			return static_cast<CharacterCategory>(dense[character]);
 		}
-		// binary search through ranges
+		// multi-stage table lookup, or binary search through ranges
 		return CategoriseCharacter(character);
 	}
 	int Size() const noexcept;
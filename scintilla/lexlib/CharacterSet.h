@@ -205,9 +205,13 @@ constexpr T MakeLowerCase(T ch) noexcept {
 #if 0
 int CompareCaseInsensitive(const char *a, const char *b) noexcept;
 int CompareNCaseInsensitive(const char *a, const char *b, size_t len) noexcept;
-#else
+#elif defined(_WIN32)
 #define CompareCaseInsensitive		_stricmp
 #define CompareNCaseInsensitive		_strnicmp
+#else
+// used by tests built on other platforms, string.h or strings.h must be included first.
+#define CompareCaseInsensitive		strcasecmp
+#define CompareNCaseInsensitive		strncasecmp
 #endif
 
 }
@@ -6,18 +6,138 @@
 // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cassert>
+#include <cstdint>
 #include <cctype>
+#include <cstring>
 
 #include <algorithm>
 
 #include "ILexer.h"
 #include "LexAccessor.h"
 #include "CharacterSet.h"
+#include "VectorISA.h"
 
 using namespace Scintilla;
 
+namespace {
+
+const char *FindAnyOf(const char *ptr, const char *end, const char *chars) noexcept {
+	const size_t count = strlen(chars);
+	assert(count <= 16);
+#if NP2_USE_AVX2
+	__m256i needles[16];
+	for (size_t i = 0; i < count; i++) {
+		needles[i] = _mm256_set1_epi8(chars[i]);
+	}
+	while (ptr + sizeof(__m256i) <= end) {
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+		__m256i result = _mm256_setzero_si256();
+		for (size_t i = 0; i < count; i++) {
+			result = _mm256_or_si256(result, _mm256_cmpeq_epi8(chunk, needles[i]));
+		}
+		const uint32_t mask = _mm256_movemask_epi8(result);
+		if (mask) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m256i);
+	}
+	// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+	__m128i needles[16];
+	for (size_t i = 0; i < count; i++) {
+		needles[i] = _mm_set1_epi8(chars[i]);
+	}
+	while (ptr + sizeof(__m128i) <= end) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+		__m128i result = _mm_setzero_si128();
+		for (size_t i = 0; i < count; i++) {
+			result = _mm_or_si128(result, _mm_cmpeq_epi8(chunk, needles[i]));
+		}
+		const uint32_t mask = _mm_movemask_epi8(result);
+		if (mask) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m128i);
+	}
+	// end NP2_USE_SSE2
+#endif
+
+	for (; ptr < end; ptr++) {
+		if (*ptr && memchr(chars, *ptr, count)) {
+			break;
+		}
+	}
+	return ptr;
+}
+
+const char *SkipSpaceTab(const char *ptr, const char *end) noexcept {
+#if NP2_USE_AVX2
+	const __m256i vectSpace = _mm256_set1_epi8(' ');
+	const __m256i vectTab = _mm256_set1_epi8('\t');
+	while (ptr + sizeof(__m256i) <= end) {
+		const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+		const __m256i result = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, vectSpace), _mm256_cmpeq_epi8(chunk, vectTab));
+		const uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(result));
+		if (mask) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m256i);
+	}
+	// end NP2_USE_AVX2
+#elif NP2_USE_SSE2
+	const __m128i vectSpace = _mm_set1_epi8(' ');
+	const __m128i vectTab = _mm_set1_epi8('\t');
+	while (ptr + sizeof(__m128i) <= end) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+		const __m128i result = _mm_or_si128(_mm_cmpeq_epi8(chunk, vectSpace), _mm_cmpeq_epi8(chunk, vectTab));
+		const uint32_t mask = _mm_movemask_epi8(result) ^ 0xffff;
+		if (mask) {
+			return ptr + np2_ctz(mask);
+		}
+		ptr += sizeof(__m128i);
+	}
+	// end NP2_USE_SSE2
+#endif
+
+	while (ptr < end && IsSpaceOrTab(*ptr)) {
+		++ptr;
+	}
+	return ptr;
+}
+
+}
+
 namespace Scintilla {
 
+template <typename Scanner>
+Sci_Position LexAccessor::Scan(Sci_Position startPos_, Sci_Position endPos_, Scanner scanner) noexcept {
+	assert(startPos_ >= 0);
+	endPos_ = std::min(endPos_, lenDoc);
+	while (startPos_ < endPos_) {
+		if (startPos_ < startPos || startPos_ >= endPos) {
+			Fill(startPos_);
+		}
+		const char * const ptr = data + (startPos_ - startPos);
+		const char * const end = data + (std::min(endPos_, endPos) - startPos);
+		const char * const found = scanner(ptr, end);
+		startPos_ += found - ptr;
+		if (found != end) {
+			return startPos_;
+		}
+	}
+	return startPos_;
+}
+
+Sci_Position LexAccessor::FindAnyOf(Sci_Position startPos_, Sci_Position endPos_, const char *chars) noexcept {
+	return Scan(startPos_, endPos_, [chars](const char *ptr, const char *end) noexcept {
+		return ::FindAnyOf(ptr, end, chars);
+	});
+}
+
+Sci_Position LexAccessor::SkipSpaceTab(Sci_Position startPos_, Sci_Position endPos_) noexcept {
+	return Scan(startPos_, endPos_, ::SkipSpaceTab);
+}
+
 bool LexAccessor::MatchIgnoreCase(Sci_Position pos, const char *s) noexcept {
 	for (; *s; s++, pos++) {
 		if (*s != MakeLowerCase(SafeGetCharAt(pos))) {
@@ -30,8 +150,8 @@ bool LexAccessor::MatchIgnoreCase(Sci_Position pos, const char *s) noexcept {
 void LexAccessor::GetRange(Sci_PositionU startPos_, Sci_PositionU endPos_, char *s, Sci_PositionU len) noexcept {
 	endPos_ = std::min(endPos_, startPos_ + len - 1);
 	if (startPos_ >= static_cast<Sci_PositionU>(startPos) && endPos_ <= static_cast<Sci_PositionU>(endPos)) {
-		const char *p = buf + (startPos_ - startPos);
-		const char * const t = buf + (endPos_ - startPos);
+		const char *p = data + (startPos_ - startPos);
+		const char * const t = data + (endPos_ - startPos);
 		while (p < t) {
 			*s++ = *p++;
 		}
@@ -46,8 +166,8 @@ void LexAccessor::GetRange(Sci_PositionU startPos_, Sci_PositionU endPos_, char
 void LexAccessor::GetRangeLowered(Sci_PositionU startPos_, Sci_PositionU endPos_, char *s, Sci_PositionU len) noexcept {
 	endPos_ = std::min(endPos_, startPos_ + len - 1);
 	if (startPos_ >= static_cast<Sci_PositionU>(startPos) && endPos_ <= static_cast<Sci_PositionU>(endPos)) {
-		const char *p = buf + (startPos_ - startPos);
-		const char * const t = buf + (endPos_ - startPos);
+		const char *p = data + (startPos_ - startPos);
+		const char * const t = data + (endPos_ - startPos);
 		while (p < t) {
 			*s++ = MakeLowerCase(*p++);
 		}
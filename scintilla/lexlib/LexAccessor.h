@@ -17,6 +17,8 @@ public:
 	};
 private:
 	IDocument * const pAccess;
+	// nullptr when the document is older than dvRangePointer.
+	IDocumentRangePointer * const pRangeAccess;
 	/** @a bufferSize is a trade off between time taken to copy the characters
 	 * and retrieval overhead.
 	 * @a slopSize positions the buffer before the desired position
@@ -25,6 +27,8 @@ private:
 		bufferSize = 4096, slopSize = bufferSize / 8
 	};
 	char buf[bufferSize + 1];
+	// points either into the document when [startPos, endPos) doesn't contain the gap or to buf.
+	const char *data;
 	Sci_Position startPos;
 	Sci_Position endPos;
 	const int codePage;
@@ -49,13 +53,36 @@ private:
 			endPos = lenDoc;
 		}
 
+		// text on either side of the gap is contiguous, read it in place
+		// and only copy the window when it straddles the gap.
+		// reading at the end of document also copies, buf provides the terminating NUL.
+		if (pRangeAccess != nullptr && position < lenDoc) {
+			const Sci_Position gapPos = pRangeAccess->GapPosition();
+			if (endPos <= gapPos) {
+				startPos = 0;
+				endPos = gapPos;
+				data = pRangeAccess->RangePointer(startPos, endPos);
+				return;
+			}
+			if (startPos >= gapPos) {
+				startPos = gapPos;
+				endPos = lenDoc;
+				data = pRangeAccess->RangePointer(startPos, endPos - startPos);
+				return;
+			}
+		}
 		pAccess->GetCharRange(buf, startPos, endPos - startPos);
 		buf[endPos - startPos] = '\0';
+		data = buf;
 	}
+	template <typename Scanner>
+	Sci_Position Scan(Sci_Position startPos_, Sci_Position endPos_, Scanner scanner) noexcept;
 
 public:
 	explicit LexAccessor(IDocument * pAccess_) noexcept :
-		pAccess(pAccess_), startPos(extremePosition), endPos(0),
+		pAccess(pAccess_),
+		pRangeAccess((pAccess_->Version() >= dvRangePointer) ? static_cast<IDocumentRangePointer *>(pAccess_) : nullptr),
+		data(buf), startPos(extremePosition), endPos(0),
 		codePage(pAccess->CodePage()),
 		encodingType((codePage == 65001) ? encUnicode : (codePage ? encDBCS : enc8bit)),
 		lenDoc(pAccess->Length()),
@@ -71,7 +98,7 @@ public:
 		if (position < startPos || position >= endPos) {
 			Fill(position);
 		}
-		return buf[position - startPos];
+		return data[position - startPos];
 	}
 	constexpr IDocument *MultiByteAccess() const noexcept {
 		return pAccess;
@@ -85,7 +112,7 @@ public:
 				return '\0';
 			}
 		}
-		return buf[position - startPos];
+		return data[position - startPos];
 	}
 	[[deprecated]]
 	char SafeGetCharAt(Sci_Position position, char chDefault) noexcept {
@@ -96,7 +123,7 @@ public:
 				return chDefault;
 			}
 		}
-		return buf[position - startPos];
+		return data[position - startPos];
 	}
 	bool IsLeadByte(unsigned char ch) const noexcept {
 		return encodingType == encDBCS && ch > 0x80 && pAccess->IsDBCSLeadByte(ch);
@@ -115,6 +142,12 @@ public:
 	}
 	bool MatchIgnoreCase(Sci_Position pos, const char *s) noexcept;
 
+	// Bulk scanning on raw bytes, trail byte in DBCS character is not skipped.
+	// Find first position in [startPos_, endPos_) with any of (at most 16) characters in chars, or endPos_ when not found.
+	Sci_Position FindAnyOf(Sci_Position startPos_, Sci_Position endPos_, const char *chars) noexcept;
+	// Find first position in [startPos_, endPos_) not space or tab, or endPos_ when not found.
+	Sci_Position SkipSpaceTab(Sci_Position startPos_, Sci_Position endPos_) noexcept;
+
 	// Get first len - 1 characters in range [startPos_, endPos_).
 	void GetRange(Sci_PositionU startPos_, Sci_PositionU endPos_, char *s, Sci_PositionU len) noexcept;
 	void GetRangeLowered(Sci_PositionU startPos_, Sci_PositionU endPos_, char *s, Sci_PositionU len) noexcept;
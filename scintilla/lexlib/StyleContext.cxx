@@ -7,6 +7,9 @@
 
 #include <cstdlib>
 #include <cassert>
+#include <cstring>
+
+#include <algorithm>
 
 #include "ILexer.h"
 
@@ -33,3 +36,69 @@ bool StyleContext::MatchIgnoreCase(const char *s) const noexcept {
 	}
 	return true;
 }
+
+void StyleContext::SeekBefore(Sci_PositionU position) noexcept {
+	const Sci_PositionU startPos = currentPos + width;
+	if (position <= startPos) {
+		return;
+	}
+
+	// start of last character before position
+	Sci_PositionU target = position - 1;
+	if (multiByteAccess) {
+		// UTF-8, position is at ASCII character or the end of line or styling range
+		while (target > startPos && (static_cast<unsigned char>(styler[target]) & 0xC0) == 0x80) {
+			--target;
+		}
+	}
+	if (target > startPos) {
+		// jump to the character before target, then forward to target to get correct chPrev
+		Sci_PositionU pos = target - 1;
+		if (multiByteAccess) {
+			while (pos > startPos && (static_cast<unsigned char>(styler[pos]) & 0xC0) == 0x80) {
+				--pos;
+			}
+		}
+		currentPos = pos;
+		width = 0;
+		GetNextChar();
+		ch = chNext;
+		width = widthNext;
+		GetNextChar();
+	}
+	while (currentPos < target) {
+		Forward();
+	}
+}
+
+Sci_PositionU StyleContext::ForwardBefore(const char *chars) noexcept {
+	const Sci_PositionU position = currentPos;
+	const Sci_PositionU startPos = currentPos + width;
+	const Sci_PositionU limit = std::min<Sci_PositionU>(endPos, lineStartNext);
+	const size_t len = strlen(chars);
+	// FindAnyOf() accepts at most 16 characters, two are used for line end.
+	assert(len <= 14);
+	if (len <= 14 && startPos < limit && styler.Encoding() != encDBCS) {
+		char stops[16 + 1] = "\r\n";
+		memcpy(stops + 2, chars, len);
+		SeekBefore(styler.FindAnyOf(startPos, limit, stops));
+	}
+	return position;
+}
+
+int StyleContext::CountNonSpace(Sci_PositionU startPos, int &chLast) const noexcept {
+	int count = 0;
+	while (startPos < currentPos) {
+		int chCurrent = static_cast<unsigned char>(styler[startPos]);
+		Sci_Position widthCurrent = 1;
+		if (multiByteAccess && chCurrent >= 0x80) {
+			chCurrent = multiByteAccess->GetCharacterAndWidth(startPos, &widthCurrent);
+		}
+		if (!isspacechar(chCurrent)) {
+			++count;
+			chLast = chCurrent;
+		}
+		startPos += widthCurrent;
+	}
+	return count;
+}
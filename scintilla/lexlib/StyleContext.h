@@ -40,6 +40,7 @@ private:
 			atLineEnd = static_cast<Sci_Position>(currentPos) >= lineStartNext;
 		}
 	}
+	void SeekBefore(Sci_PositionU position) noexcept;
 
 public:
 	Sci_PositionU currentPos;
@@ -145,6 +146,18 @@ public:
 			}
 		}
 	}
+	// Bulk forward for states only interested in few characters, it moves to the last character
+	// before the stop position, so Forward() in the lexer loop will land on the stop character.
+	// Stops before line end and end of styling range, does nothing for DBCS.
+	// Returns the position before moving, characters in [returned position, currentPos) are skipped
+	// without passing through the lexer loop, see CountNonSpace().
+	Sci_PositionU ForwardBefore(const char *chars) noexcept;
+	// Count characters in [startPos, currentPos) that are not space, chLast is set to the last one.
+	int CountNonSpace(Sci_PositionU startPos, int &chLast) const noexcept;
+	int CountNonSpace(Sci_PositionU startPos) const noexcept {
+		int chLast = 0;
+		return CountNonSpace(startPos, chLast);
+	}
 	void ChangeState(int state_) noexcept {
 		state = state_;
 	}
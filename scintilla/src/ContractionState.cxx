@@ -332,14 +332,24 @@ bool ContractionState<LINE>::SetVisible(Sci::Line lineDocStart, Sci::Line lineDo
 		Sci::Line delta = 0;
 		Check();
 		if ((lineDocStart <= lineDocEnd) && (lineDocStart >= 0) && (lineDocEnd < LinesInDoc())) {
-			for (Sci::Line line = lineDocStart; line <= lineDocEnd; line++) {
-				if (GetVisible(line) != isVisible) {
-					const int heightLine = heights->ValueAt(static_cast<LINE>(line));
-					const int difference = isVisible ? heightLine : -heightLine;
-					visible->SetValueAt(static_cast<LINE>(line), isVisible ? 1 : 0);
-					displayLines->InsertText(static_cast<LINE>(line), difference);
-					delta += difference;
+			// Skip whole runs already in the wanted state, then set the visible flag
+			// of the range with one fill instead of splitting runs line by line.
+			const LINE lineEnd = static_cast<LINE>(lineDocEnd + 1);
+			LINE line = static_cast<LINE>(lineDocStart);
+			while (line < lineEnd) {
+				const LINE runEnd = std::min(visible->EndRun(line), lineEnd);
+				if ((visible->ValueAt(line) == 1) != isVisible) {
+					for (; line < runEnd; line++) {
+						const int heightLine = heights->ValueAt(line);
+						const int difference = isVisible ? heightLine : -heightLine;
+						displayLines->InsertText(line, difference);
+						delta += difference;
+					}
 				}
+				line = runEnd;
+			}
+			if (delta != 0) {
+				visible->FillRange(static_cast<LINE>(lineDocStart), isVisible ? 1 : 0, lineEnd - static_cast<LINE>(lineDocStart));
 			}
 		} else {
 			return false;
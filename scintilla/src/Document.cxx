@@ -70,13 +70,31 @@ void LexInterface::Colourise(Sci::Position start, Sci::Position end) {
 
 		if (len > 0) {
 			instance->Lex(start, len, styleStart, pdoc);
-			instance->Fold(start, len, styleStart, pdoc);
+			if (!pdoc->FoldOnDemand()) {
+				FoldRange(std::min(start, endFolded), end);
+			}
 		}
 
 		performingStyle = false;
 	}
 }
 
+void LexInterface::EnsureFoldedTo(Sci::Position pos) {
+	if (pdoc && instance && !performingStyle && pos > endFolded) {
+		performingStyle = true;
+		FoldRange(endFolded, pos);
+		performingStyle = false;
+	}
+}
+
+void LexInterface::FoldRange(Sci::Position start, Sci::Position end) {
+	// Folding continues from the level of previous line, so start at line start.
+	start = pdoc->LineStart(pdoc->SciLineFromPosition(start));
+	const int styleStart = (start > 0) ? pdoc->StyleAt(start - 1) : 0;
+	instance->Fold(start, end - start, styleStart, pdoc);
+	endFolded = std::max(endFolded, end);
+}
+
 int LexInterface::LineEndTypesSupported() const noexcept {
 	if (instance) {
 		return instance->LineEndTypesSupported();
@@ -119,6 +137,7 @@ Document::Document(int options) :
 	dbcsCharClass = nullptr;
 	lineEndBitSet = SC_LINE_END_TYPE_DEFAULT;
 	endStyled = 0;
+	foldOnDemand = false;
 	styleClock = 0;
 	enteredModification = 0;
 	enteredStyling = 0;
@@ -491,13 +510,14 @@ static bool IsSubordinate(int levelStart, int levelTry) noexcept {
 }
 
 Sci::Line Document::GetLastChild(Sci::Line lineParent, int level, Sci::Line lastLine) {
+	EnsureFoldedTo(LineStart(lineParent + 1));
 	if (level == -1)
 		level = LevelNumber(GetLevel(lineParent));
 	const Sci::Line maxLine = LinesTotal();
 	const Sci::Line lookLastLine = (lastLine != -1) ? std::min(LinesTotal() - 1, lastLine) : -1;
 	Sci::Line lineMaxSubord = lineParent;
 	while (lineMaxSubord < maxLine - 1) {
-		EnsureStyledTo(LineStart(lineMaxSubord + 2));
+		EnsureFoldedTo(LineStart(lineMaxSubord + 2));
 		if (!IsSubordinate(level, GetLevel(lineMaxSubord + 1)))
 			break;
 		if ((lookLastLine != -1) && (lineMaxSubord >= lookLastLine) && !(GetLevel(lineMaxSubord) & SC_FOLDLEVELWHITEFLAG))
@@ -1097,6 +1117,8 @@ EncodingFamily Document::CodePageFamily() const noexcept {
 void Document::ModifiedAt(Sci::Position pos) noexcept {
 	if (endStyled > pos)
 		endStyled = pos;
+	if (pli)
+		pli->InvalidateFold(pos);
 }
 
 void Document::CheckReadOnly() noexcept {
@@ -2185,6 +2207,19 @@ void Document::EnsureStyledTo(Sci::Position pos) {
 	}
 }
 
+void Document::EnsureFoldedTo(Sci::Position pos) {
+	if (pli && !pli->UseContainerLexing()) {
+		// Fold levels are per line, include whole line containing pos.
+		pos = std::min(pos, Length());
+		const Sci::Line line = SciLineFromPosition(pos);
+		if (pos > LineStart(line)) {
+			pos = LineStart(line + 1);
+		}
+		EnsureStyledTo(pos);
+		pli->EnsureFoldedTo(std::min(pos, GetEndStyled()));
+	}
+}
+
 void Document::StyleToAdjustingLineDuration(Sci::Position pos) {
 	const Sci::Line lineFirst = SciLineFromPosition(GetEndStyled());
 	ElapsedPeriod epStyling;
@@ -173,10 +173,18 @@ protected:
 	Document *pdoc;
 	ILexer5 *instance;
 	bool performingStyle;	///< Prevent reentrance
+	Sci::Position endFolded;	///< Fold levels are valid before this position
+	void FoldRange(Sci::Position start, Sci::Position end);
 public:
-	explicit LexInterface(Document *pdoc_) noexcept : pdoc(pdoc_), instance(nullptr), performingStyle(false) {}
+	explicit LexInterface(Document *pdoc_) noexcept : pdoc(pdoc_), instance(nullptr), performingStyle(false), endFolded(0) {}
 	virtual ~LexInterface() = default;
 	void Colourise(Sci::Position start, Sci::Position end);
+	void EnsureFoldedTo(Sci::Position pos);
+	void InvalidateFold(Sci::Position pos) noexcept {
+		if (endFolded > pos) {
+			endFolded = pos;
+		}
+	}
 	virtual int LineEndTypesSupported() const noexcept;
 	bool UseContainerLexing() const noexcept {
 		return instance == nullptr;
@@ -209,7 +217,7 @@ public:
 
 /**
  */
-class Document : PerLine, public IDocument, public ILoader {
+class Document : PerLine, public IDocumentRangePointer, public ILoader {
 
 public:
 	/** Used to pair watcher pointer with user data. */
@@ -232,6 +240,7 @@ private:
 #endif
 	std::unique_ptr<CaseFolder> pcf;
 	Sci::Position endStyled;
+	bool foldOnDemand;
 	int styleClock;
 	int enteredModification;
 	int enteredStyling;
@@ -313,7 +322,7 @@ public:
 	}
 
 	int SCI_METHOD Version() const noexcept override {
-		return dvRelease4;
+		return dvRangePointer;
 	}
 
 	void SCI_METHOD SetErrorStatus(int status) noexcept override;
@@ -397,10 +406,10 @@ public:
 	const char * SCI_METHOD BufferPointer() override {
 		return cb.BufferPointer();
 	}
-	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) noexcept {
+	const char * SCI_METHOD RangePointer(Sci_Position position, Sci_Position rangeLength) noexcept override {
 		return cb.RangePointer(position, rangeLength);
 	}
-	Sci::Position GapPosition() const noexcept {
+	Sci_Position SCI_METHOD GapPosition() const noexcept override {
 		return cb.GapPosition();
 	}
 
@@ -513,6 +522,14 @@ public:
 		return endStyled;
 	}
 	void EnsureStyledTo(Sci::Position pos);
+	// When fold levels are not shown, folding is deferred until levels are requested.
+	void SetFoldOnDemand(bool onDemand) noexcept {
+		foldOnDemand = onDemand;
+	}
+	bool FoldOnDemand() const noexcept {
+		return foldOnDemand;
+	}
+	void EnsureFoldedTo(Sci::Position pos);
 	void StyleToAdjustingLineDuration(Sci::Position pos);
 	void LexerChanged();
 	int GetStyleClock() const noexcept {
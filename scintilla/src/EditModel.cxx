@@ -18,6 +18,7 @@
 #include <map>
 #include <algorithm>
 #include <memory>
+#include <mutex>
 
 #include "Platform.h"
 
@@ -68,6 +68,8 @@ public:
 	virtual Point GetVisibleOriginInMain() const noexcept = 0;
 	virtual Sci::Line LinesOnScreen() const noexcept = 0;
 	virtual Range GetHotSpotRange() const noexcept = 0;
+	// Whether any part of rc, in client coordinates, is in the area being painted.
+	virtual bool PaintIntersects(PRectangle rc) const noexcept = 0;
 	bool BidirectionalEnabled() const noexcept;
 	bool BidirectionalR2L() const noexcept;
 	void SetDefaultFoldDisplayText(const char *text);
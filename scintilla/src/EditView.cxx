@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <chrono>
 
 #include "Platform.h"
@@ -176,8 +177,88 @@ void DrawStyledText(Surface *surface, const ViewStyle &vs, int styleOffset, PRec
 
 constexpr XYPOSITION epsilon = 0.0001f;	// A small nudge to avoid floating point precision issues
 
+namespace {
+
+constexpr size_t paintTimingFrames = 128;
+
+// Blocks of a windowed line laid out together when measuring from the line start.
+constexpr size_t blocksMeasuredTogether = 16;
+
+// Hash of the text and styles of [start, end), which are left in buffer with the styles after the text.
+size_t BlockHash(const Document *pdoc, Sci::Position start, Sci::Position end, std::string &buffer) {
+	const Sci::Position length = end - start;
+	buffer.resize(length * 2);
+	pdoc->GetCharRange(&buffer[0], start, length);
+	pdoc->GetStyleRange(reinterpret_cast<unsigned char *>(&buffer[length]), start, length);
+	return std::hash<std::string>{}(buffer);
+}
+
+int EdgeColumn(Document *pdoc, const ViewStyle &vstyle, Sci::Line line, Sci::Position posLineStart) {
+	if (vstyle.edgeState == EDGE_BACKGROUND) {
+		Sci::Position edgePosition = pdoc->FindColumn(line, vstyle.theEdge.column);
+		if (edgePosition >= posLineStart) {
+			edgePosition -= posLineStart;
+		}
+		return static_cast<int>(edgePosition);
+	}
+	return -1;
+}
+
+}
+
+PaintTiming::PaintTiming() noexcept :
+	enabled(false), nextFrame(0), framesRecorded(0), frameStart(0.0), current{} {
+}
+
+void PaintTiming::Enable(bool enable) {
+	enabled = enable;
+	frames.clear();
+	if (enabled) {
+		frames.resize(paintTimingFrames);
+	}
+	nextFrame = 0;
+	framesRecorded = 0;
+	current = {};
+}
+
+void PaintTiming::StartFrame() noexcept {
+	current = {};
+	if (enabled) {
+		frameStart = Clock();
+	}
+}
+
+void PaintTiming::EndFrame() noexcept {
+	if (enabled) {
+		current.total = Clock() - frameStart;
+		frames[nextFrame] = current;
+		nextFrame = (nextFrame + 1) % frames.size();
+		framesRecorded = std::min(framesRecorded + 1, frames.size());
+	}
+}
+
+size_t PaintTiming::Frames(size_t count, Sci_PaintFrameTiming *timings) const noexcept {
+	if (!timings) {
+		return framesRecorded;
+	}
+	count = std::min(count, framesRecorded);
+	// oldest of the requested frames first
+	size_t frame = (nextFrame + frames.size() - count) % std::max<size_t>(frames.size(), 1);
+	for (size_t i = 0; i < count; i++) {
+		timings[i] = frames[frame];
+		frame = (frame + 1) % frames.size();
+	}
+	return count;
+}
+
+double PaintTiming::Clock() noexcept {
+	const auto sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::duration<double>>(sinceEpoch).count();
+}
+
 EditView::EditView() {
 	tabWidthMinimumPixels = 2; // needed for calculating tab stops for fractional proportional fonts
+	windowedLength = LineLayout::lengthWindowed;
 	hideSelection = false;
 	drawOverstrikeCaret = true;
 	bufferedDraw = true;
@@ -338,8 +419,7 @@ LineLayout *EditView::RetrieveLineLayout(Sci::Line lineNumber, const EditModel &
 	const Sci::Position posLineStart = model.pdoc->LineStart(lineNumber);
 	const Sci::Position posLineEnd = model.pdoc->LineStart(lineNumber + 1);
 	PLATFORM_ASSERT(posLineEnd >= posLineStart);
-	const Sci::Line lineCaret = model.pdoc->SciLineFromPosition(model.sel.MainCaret());
-	return llc.Retrieve(lineNumber, lineCaret,
+	return llc.Retrieve(lineNumber,
 		static_cast<int>(posLineEnd - posLineStart), model.pdoc->GetStyleClock(),
 		model.LinesOnScreen() + 1, model.pdoc->LinesTotal());
 }
@@ -410,25 +490,320 @@ inline WrapBreak GetWrapBreakEx(unsigned int ch, bool isUtf8) noexcept {
 	return WrapBreak::Undefined;
 }
 
+// Whether text only contains space and ASCII graphic characters,
+// which all have the same width in a font with monospaceASCII set.
+inline bool AllGraphicASCII(const char *text, size_t length) noexcept {
+	for (size_t i = 0; i < length; i++) {
+		const unsigned char ch = text[i];
+		if (ch < ' ' || ch > '~') {
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+/**
+* Determine the x position of each character in range of a line layout, starting from the position of range.start.
+* Returns whether the last segment is italic.
+*/
+bool EditView::LayoutSegments(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
+	LineLayout *ll, Range range, bool callerMultiThreaded) {
+
+	const Sci::Position posLineStart = model.pdoc->LineStart(line);
+	bool lastSegItalics = false;
+	BreakFinder bfLayout(ll, nullptr, range, posLineStart, 0, false, model.pdoc, &model.reprs, nullptr);
+	while (bfLayout.More()) {
+
+		const TextSegment ts = bfLayout.Next();
+		XYPOSITION *positions = ll->positions.Data(ts.start);	// positions[0] is the start of the segment
+
+		std::fill(positions + 1, positions + ts.length + 1, 0.0f);
+		if (vstyle.styles[ll->styles[ts.start]].visible) {
+			if (ts.representation) {
+				XYPOSITION representationWidth = vstyle.controlCharWidth;
+				if (ll->chars[ts.start] == '\t') {
+					// Tab is a special case of representation, taking a variable amount of space
+					const XYPOSITION x = positions[0];
+					representationWidth = NextTabstopPos(line, x, vstyle.tabWidth) - positions[0];
+				} else {
+					if (representationWidth <= 0.0) {
+						const std::string &stringRep = ts.representation->stringRep;
+						const Style &styleCtrl = vstyle.styles[STYLE_CONTROLCHAR];
+						if (styleCtrl.monospaceASCII && AllGraphicASCII(stringRep.c_str(), stringRep.length())) {
+							representationWidth = styleCtrl.monospaceCharacterWidth * stringRep.length() + vstyle.ctrlCharPadding;
+						} else {
+							XYPOSITION positionsRepr[256];	// Should expand when needed
+							posCache.MeasureWidths(surface, vstyle, STYLE_CONTROLCHAR, stringRep.c_str(),
+								static_cast<unsigned int>(stringRep.length()), positionsRepr, model.pdoc, callerMultiThreaded);
+							representationWidth = positionsRepr[stringRep.length() - 1] + vstyle.ctrlCharPadding;
+						}
+					}
+				}
+				for (int ii = 0; ii < ts.length; ii++) {
+					positions[1 + ii] = representationWidth;
+				}
+			} else {
+				const Style &style = vstyle.styles[ll->styles[ts.start]];
+				if ((ts.length == 1) && (' ' == ll->chars[ts.start])) {
+					// Over half the segments are single characters and of these about half are space characters.
+					positions[1] = style.spaceWidth;
+				} else if (style.monospaceASCII && AllGraphicASCII(&ll->chars[ts.start], ts.length)) {
+					// Fixed pitch font: position of each character is a multiple of the character width.
+					for (int ii = 0; ii < ts.length; ii++) {
+						positions[1 + ii] = style.monospaceCharacterWidth * (ii + 1);
+					}
+				} else {
+					posCache.MeasureWidths(surface, vstyle, ll->styles[ts.start], &ll->chars[ts.start],
+						ts.length, positions + 1, model.pdoc, callerMultiThreaded);
+				}
+			}
+			lastSegItalics = (!ts.representation) && ((ll->chars[ts.end() - 1] != ' ') && vstyle.styles[ll->styles[ts.start]].italic);
+		}
+
+		for (int ii = 1; ii <= ts.length; ii++) {
+			positions[ii] += positions[0];
+		}
+	}
+	return lastSegItalics;
+}
+
+/**
+* Check the blocks of a windowed line against the document and split the line again from the first
+* block that changed. Blocks before it keep their measured positions.
+*/
+void EditView::UpdateBlocks(const EditModel &model, Sci::Line line, const ViewStyle &vstyle, LineLayout *ll, bool callerMultiThreaded) {
+	const Sci::Position posLineStart = model.pdoc->LineStart(line);
+	const Sci::Position lineLength = model.pdoc->LineStart(line + 1) - posLineStart;
+	const int numCharsBeforeEOL = static_cast<int>(model.pdoc->LineEnd(line) - posLineStart);
+	const int numCharsInLine = vstyle.viewEOL ? static_cast<int>(lineLength) : numCharsBeforeEOL;
+	size_t first = 0;
+	if (ll->validity == LineLayout::llCheckTextAndStyle) {
+		// The last block includes the end of line so its hash changes when text is appended
+		std::string buffer;
+		while (first < ll->Blocks()) {
+			const Range range = ll->BlockRange(first, first + 1);
+			const bool lastBlock = range.end == ll->numCharsInLine;
+			if (range.end > numCharsInLine || lastBlock != (range.end == numCharsInLine)) {
+				break;
+			}
+			const Sci::Position end = lastBlock ? lineLength : range.end;
+			if (BlockHash(model.pdoc, posLineStart + range.start, posLineStart + end, buffer) != ll->blockHashes[first]) {
+				break;
+			}
+			first++;
+		}
+		if (first == ll->Blocks()) {
+			ll->validity = LineLayout::llPositions;
+			return;
+		}
+	}
+	if (paintTiming.Enabled() && !callerMultiThreaded) {
+		paintTiming.current.linesLaidOut++;
+	}
+	ll->widthLine = LineLayout::wrapWidthInfinite;
+	ll->lines = 1;
+	ll->edgeColumn = EdgeColumn(model.pdoc, vstyle, line, posLineStart);
+	ll->xHighlightGuide = 0;
+	ll->numCharsInLine = numCharsInLine;
+	ll->numCharsBeforeEOL = numCharsBeforeEOL;
+	SplitBlocks(model, line, vstyle, ll, first);
+	ll->validity = LineLayout::llPositions;
+}
+
+/**
+* Split a windowed line into blocks at character boundaries from block first, estimating the
+* width of each block from the average character width of its styles.
+* Nothing is held until the blocks are measured.
+*/
+void EditView::SplitBlocks(const EditModel &model, Sci::Line line, const ViewStyle &vstyle, LineLayout *ll, size_t first) {
+	const Sci::Position posLineStart = model.pdoc->LineStart(line);
+	const Sci::Position lineLength = model.pdoc->LineStart(line + 1) - posLineStart;
+	const bool isUtf8 = SC_CP_UTF8 == model.pdoc->dbcsCodePage;
+	std::vector<int> &blockStarts = ll->positions.blockStarts;
+	std::vector<XYPOSITION> &blockX = ll->positions.blockX;
+	first = blockStarts.empty() ? 0 : std::min(first, ll->Blocks());
+	blockStarts.resize(first + 1);
+	blockX.resize(first + 1);
+	ll->blockHashes.resize(first);
+	ll->blocksMeasured = std::min(ll->blocksMeasured, first);
+	ll->blockHeldFirst = 0;
+	ll->blockHeldEnd = 0;
+	ll->Hold(0, 0);
+	ll->chars[0] = 0;
+	ll->styles[0] = 0;
+	*ll->positions.Data(0) = 0;
+
+	std::string buffer;
+	int start = blockStarts[first];
+	XYPOSITION x = blockX[first];
+	while (start < ll->numCharsInLine) {
+		const int end = std::min(ll->numCharsInLine, static_cast<int>(
+			model.pdoc->MovePositionOutsideChar(posLineStart + start + LineLayout::lengthWindowBlock, 1) - posLineStart));
+		const Sci::Position endHashed = (end == ll->numCharsInLine) ? lineLength : end;
+		ll->blockHashes.push_back(BlockHash(model.pdoc, posLineStart + start, posLineStart + endHashed, buffer));
+		const char *chars = buffer.data();
+		const unsigned char *styles = reinterpret_cast<const unsigned char *>(buffer.data() + (endHashed - start));
+		for (int i = 0; i < end - start; i++) {
+			const Style &style = vstyle.styles[styles[i]];
+			const unsigned char ch = chars[i];
+			if (!style.visible || (isUtf8 && UTF8IsTrailByte(ch))) {
+				continue;
+			}
+			if (ch == '\t') {
+				x = NextTabstopPos(line, x, vstyle.tabWidth);
+			} else if (IsControlCharacter(ch)) {
+				x += (vstyle.controlCharWidth > 0) ? vstyle.controlCharWidth : 3 * vstyle.styles[STYLE_CONTROLCHAR].aveCharWidth;
+			} else {
+				x += style.aveCharWidth;
+			}
+		}
+		blockStarts.push_back(end);
+		blockX.push_back(x);
+		start = end;
+	}
+}
+
+/**
+* Hold the text of blocks [first, end) of a windowed line and lay out each block from the x of its start.
+* Blocks are measured in order from the line start, so first must not be after the measured blocks.
+* Estimated positions after the blocks move by the difference between estimated and measured widths.
+*/
+void EditView::HoldBlocks(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
+	LineLayout *ll, size_t first, size_t end, bool callerMultiThreaded) {
+	PLATFORM_ASSERT(first <= ll->blocksMeasured);
+	const Sci::Position posLineStart = model.pdoc->LineStart(line);
+	const Range range = ll->BlockRange(first, end);
+	const int start = static_cast<int>(range.start);
+	const int length = static_cast<int>(range.end - range.start);
+	ll->Hold(start, length);
+	// The character after the blocks is held for its position and, at the line end, for eolFilled
+	const Sci::Position lengthDocument = std::min<Sci::Position>(length + 1, model.pdoc->LineStart(line + 1) - posLineStart - start);
+	model.pdoc->GetCharRange(ll->chars.Data(start), posLineStart + start, lengthDocument);
+	model.pdoc->GetStyleRange(ll->styles.Data(start), posLineStart + start, lengthDocument);
+	if (range.end == ll->numCharsInLine) {
+		const Sci::Position lineLength = model.pdoc->LineStart(line + 1) - posLineStart;
+		ll->chars[range.end] = 0;
+		ll->styles[range.end] = static_cast<unsigned char>(model.pdoc->StyleIndexAt(posLineStart + lineLength - 1));
+	}
+	if (vstyle.someStylesForceCase) {
+		char chPrevious = (start > 0) ? model.pdoc->CharAt(posLineStart + start - 1) : '\0';
+		for (int charInLine = start; charInLine < range.end; charInLine++) {
+			const char chDoc = ll->chars[charInLine];
+			ll->chars[charInLine] = CaseForce(vstyle.styles[ll->styles[charInLine]].caseForce, chDoc, chPrevious);
+			chPrevious = chDoc;
+		}
+	}
+
+	std::vector<XYPOSITION> &blockX = ll->positions.blockX;
+	const XYPOSITION endEstimated = blockX[end];
+	for (size_t block = first; block < end; block++) {
+		const Range rangeBlock = ll->BlockRange(block, block + 1);
+		*ll->positions.Data(rangeBlock.start) = blockX[block];
+		const bool lastSegItalics = LayoutSegments(model, line, surface, vstyle, ll, rangeBlock, callerMultiThreaded);
+		// Small hack to make lines that end with italics not cut off the edge of the last character
+		if (lastSegItalics && rangeBlock.end == ll->numCharsInLine) {
+			*ll->positions.Data(rangeBlock.end) += vstyle.lastSegItalicsOffset;
+		}
+		if (block == ll->blocksMeasured) {
+			blockX[block + 1] = ll->positions[rangeBlock.end];
+			ll->blocksMeasured++;
+		}
+	}
+	const XYPOSITION delta = blockX[end] - endEstimated;
+	if (delta != 0) {
+		for (size_t block = end + 1; block < blockX.size(); block++) {
+			blockX[block] += delta;
+		}
+	}
+	ll->blockHeldFirst = first;
+	ll->blockHeldEnd = end;
+}
+
+/**
+* Hold blocks [first, end) of a windowed line unless already held, measuring the blocks before them.
+*/
+void EditView::HoldWindow(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
+	LineLayout *ll, size_t first, size_t end, bool callerMultiThreaded) {
+	if (first >= ll->blockHeldFirst && end <= ll->blockHeldEnd) {
+		return;
+	}
+	while (ll->blocksMeasured < first) {
+		const size_t measured = ll->blocksMeasured;
+		HoldBlocks(model, line, surface, vstyle, ll, measured, std::min(first, measured + blocksMeasuredTogether), callerMultiThreaded);
+	}
+	HoldBlocks(model, line, surface, vstyle, ll, first, end, callerMultiThreaded);
+}
+
+/**
+* Hold the blocks of a windowed line that overlap [xLeft, xRight) with exact positions.
+* Blocks are measured from the line start until one starts at or after xRight.
+*/
+void EditView::MeasureWindow(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
+	LineLayout *ll, XYPOSITION xLeft, XYPOSITION xRight, bool callerMultiThreaded) {
+	if (!ll->Windowed()) {
+		return;
+	}
+	const std::vector<XYPOSITION> &blockX = ll->positions.blockX;
+	const size_t blocks = ll->Blocks();
+	// Measuring moves the estimated positions after the measured blocks so repeat until
+	// the block found starts at a measured position.
+	size_t end = 0;
+	while (true) {
+		end = std::lower_bound(blockX.begin(), blockX.begin() + blocks, xRight) - blockX.begin();
+		if (end <= ll->blocksMeasured) {
+			break;
+		}
+		HoldWindow(model, line, surface, vstyle, ll, ll->blocksMeasured, std::min(end, ll->blocksMeasured + blocksMeasuredTogether), callerMultiThreaded);
+	}
+	end = std::max<size_t>(end, 1);
+	size_t first = std::upper_bound(blockX.begin(), blockX.begin() + end, xLeft) - blockX.begin();
+	first = std::max<size_t>(first, 1) - 1;
+	HoldWindow(model, line, surface, vstyle, ll, first, end, callerMultiThreaded);
+}
+
+/**
+* Hold the block of a windowed line that contains posInLine with exact positions.
+*/
+void EditView::MeasurePosition(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
+	LineLayout *ll, Sci::Position posInLine, bool callerMultiThreaded) {
+	if (!ll->Windowed()) {
+		return;
+	}
+	const std::vector<int> &blockStarts = ll->positions.blockStarts;
+	const size_t blocks = ll->Blocks();
+	size_t block = std::upper_bound(blockStarts.begin(), blockStarts.begin() + blocks, posInLine) - blockStarts.begin();
+	block = std::max<size_t>(block, 1) - 1;
+	HoldWindow(model, line, surface, vstyle, ll, block, block + 1, callerMultiThreaded);
 }
 
 /**
 * Fill in the LineLayout data for the given line.
 * Copy the given @a line and its styles from the document into local arrays.
 * Also determine the x position at which each character starts.
+* Lines longer than windowedLength are windowed when not wrapped: only their blocks are
+* found here and MeasureWindow or MeasurePosition hold and measure the blocks needed.
 */
-void EditView::LayoutLine(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, int width) {
+void EditView::LayoutLine(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle, LineLayout *ll, int width, bool callerMultiThreaded) {
 	if (!ll)
 		return;
 
 	PLATFORM_ASSERT(line < model.pdoc->LinesTotal());
-	PLATFORM_ASSERT(ll->chars != nullptr);
 	const Sci::Position posLineStart = model.pdoc->LineStart(line);
 	Sci::Position posLineEnd = model.pdoc->LineStart(line + 1);
 	// If the line is very long, limit the treatment to a length that should fit in the viewport
 	if (posLineEnd > (posLineStart + ll->maxLineLength)) {
 		posLineEnd = posLineStart + ll->maxLineLength;
 	}
+	const Sci::Position lengthShown = (vstyle.viewEOL ? posLineEnd : model.pdoc->LineEnd(line)) - posLineStart;
+	const bool windowed = lengthShown > windowedLength && width == LineLayout::wrapWidthInfinite && !model.BidirectionalEnabled();
+	if (windowed != ll->Windowed()) {
+		ll->validity = LineLayout::llInvalid;
+	}
+	if (windowed && ll->validity <= LineLayout::llCheckTextAndStyle) {
+		UpdateBlocks(model, line, vstyle, ll, callerMultiThreaded);
+	}
 	if (ll->validity == LineLayout::llCheckTextAndStyle) {
 		Sci::Position lineLength = posLineEnd - posLineStart;
 		if (!vstyle.viewEOL) {
@@ -477,22 +852,21 @@ void EditView::LayoutLine(const EditModel &model, Sci::Line line, Surface *surfa
 		}
 	}
 	if (ll->validity == LineLayout::llInvalid) {
+		if (paintTiming.Enabled() && !callerMultiThreaded) {
+			paintTiming.current.linesLaidOut++;
+		}
 		ll->widthLine = LineLayout::wrapWidthInfinite;
 		ll->lines = 1;
-		if (vstyle.edgeState == EDGE_BACKGROUND) {
-			Sci::Position edgePosition = model.pdoc->FindColumn(line, vstyle.theEdge.column);
-			if (edgePosition >= posLineStart) {
-				edgePosition -= posLineStart;
-			}
-			ll->edgeColumn = static_cast<int>(edgePosition);
-		} else {
-			ll->edgeColumn = -1;
-		}
+		ll->edgeColumn = EdgeColumn(model.pdoc, vstyle, line, posLineStart);
 
 		// Fill base line layout
 		const int lineLength = static_cast<int>(posLineEnd - posLineStart);
-		model.pdoc->GetCharRange(ll->chars.get(), posLineStart, lineLength);
-		model.pdoc->GetStyleRange(ll->styles.get(), posLineStart, lineLength);
+		ll->positions.blockStarts.clear();
+		ll->positions.blockX.clear();
+		ll->blockHashes.clear();
+		ll->Hold(0, lineLength);
+		model.pdoc->GetCharRange(ll->chars.Data(0), posLineStart, lineLength);
+		model.pdoc->GetStyleRange(ll->styles.Data(0), posLineStart, lineLength);
 		const int numCharsBeforeEOL = static_cast<int>(model.pdoc->LineEnd(line) - posLineStart);
 		const int numCharsInLine = (vstyle.viewEOL) ? lineLength : numCharsBeforeEOL;
 		const unsigned char styleByteLast = (lineLength > 0) ? ll->styles[lineLength - 1] : 0;
@@ -512,53 +886,12 @@ void EditView::LayoutLine(const EditModel &model, Sci::Line line, Surface *surfa
 
 		// Layout the line, determining the position of each character,
 		// with an extra element at the end for the end of the line.
-		ll->positions[0] = 0;
-		bool lastSegItalics = false;
-
-		BreakFinder bfLayout(ll, nullptr, Range(0, numCharsInLine), posLineStart, 0, false, model.pdoc, &model.reprs, nullptr);
-		while (bfLayout.More()) {
-
-			const TextSegment ts = bfLayout.Next();
-
-			std::fill(&ll->positions[ts.start + 1], &ll->positions[ts.end() + 1], 0.0f);
-			if (vstyle.styles[ll->styles[ts.start]].visible) {
-				if (ts.representation) {
-					XYPOSITION representationWidth = vstyle.controlCharWidth;
-					if (ll->chars[ts.start] == '\t') {
-						// Tab is a special case of representation, taking a variable amount of space
-						const XYPOSITION x = ll->positions[ts.start];
-						representationWidth = NextTabstopPos(line, x, vstyle.tabWidth) - ll->positions[ts.start];
-					} else {
-						if (representationWidth <= 0.0) {
-							XYPOSITION positionsRepr[256];	// Should expand when needed
-							posCache.MeasureWidths(surface, vstyle, STYLE_CONTROLCHAR, ts.representation->stringRep.c_str(),
-								static_cast<unsigned int>(ts.representation->stringRep.length()), positionsRepr, model.pdoc);
-							representationWidth = positionsRepr[ts.representation->stringRep.length() - 1] + vstyle.ctrlCharPadding;
-						}
-					}
-					for (int ii = 0; ii < ts.length; ii++) {
-						ll->positions[ts.start + 1 + ii] = representationWidth;
-					}
-				} else {
-					if ((ts.length == 1) && (' ' == ll->chars[ts.start])) {
-						// Over half the segments are single characters and of these about half are space characters.
-						ll->positions[ts.start + 1] = vstyle.styles[ll->styles[ts.start]].spaceWidth;
-					} else {
-						posCache.MeasureWidths(surface, vstyle, ll->styles[ts.start], &ll->chars[ts.start],
-							ts.length, &ll->positions[ts.start + 1], model.pdoc);
-					}
-				}
-				lastSegItalics = (!ts.representation) && ((ll->chars[ts.end() - 1] != ' ') && vstyle.styles[ll->styles[ts.start]].italic);
-			}
-
-			for (Sci::Position posToIncrease = ts.start + 1; posToIncrease <= ts.end(); posToIncrease++) {
-				ll->positions[posToIncrease] += ll->positions[ts.start];
-			}
-		}
+		*ll->positions.Data(0) = 0;
+		const bool lastSegItalics = LayoutSegments(model, line, surface, vstyle, ll, Range(0, numCharsInLine), callerMultiThreaded);
 
 		// Small hack to make lines that end with italics not cut off the edge of the last character
 		if (lastSegItalics) {
-			ll->positions[numCharsInLine] += vstyle.lastSegItalicsOffset;
+			*ll->positions.Data(numCharsInLine) += vstyle.lastSegItalicsOffset;
 		}
 		ll->numCharsInLine = numCharsInLine;
 		ll->numCharsBeforeEOL = numCharsBeforeEOL;
@@ -799,6 +1132,7 @@ Point EditView::LocationFromPosition(Surface *surface, const EditModel &model, S
 	if (surface && ll) {
 		LayoutLine(model, lineDoc, surface, vs, ll, model.wrapWidth);
 		const int posInLine = static_cast<int>(pos.Position() - posLineStart);
+		MeasurePosition(model, lineDoc, surface, vs, ll, posInLine);
 		pt = ll->PointFromPosition(posInLine, vs.lineHeight, pe);
 		pt.x += vs.textStart - model.xOffset;
 
@@ -869,6 +1203,7 @@ SelectionPosition EditView::SPositionFromLocation(Surface *surface, const EditMo
 	AutoLineLayout ll(llc, RetrieveLineLayout(lineDoc, model));
 	if (surface && ll) {
 		LayoutLine(model, lineDoc, surface, vs, ll, model.wrapWidth);
+		MeasureWindow(model, lineDoc, surface, vs, ll, pt.x, pt.x);
 		const Sci::Line lineStartSet = model.pcs->DisplayFromDoc(lineDoc);
 		const int subLine = static_cast<int>(visibleLine - lineStartSet);
 		if (subLine < ll->lines) {
@@ -921,6 +1256,7 @@ SelectionPosition EditView::SPositionFromLineX(Surface *surface, const EditModel
 	if (surface && ll) {
 		const Sci::Position posLineStart = model.pdoc->LineStart(lineDoc);
 		LayoutLine(model, lineDoc, surface, vs, ll, model.wrapWidth);
+		MeasureWindow(model, lineDoc, surface, vs, ll, static_cast<XYPOSITION>(x), static_cast<XYPOSITION>(x));
 		const Range rangeSubLine = ll->SubLineRange(0, LineLayout::Scope::visibleOnly);
 		const XYPOSITION subLineStart = ll->positions[rangeSubLine.start];
 		const Sci::Position positionInLine = ll->FindPositionFromX(x + subLineStart, rangeSubLine, false);
@@ -1135,7 +1471,7 @@ void EditView::DrawEOL(Surface *surface, const EditModel &model, const ViewStyle
 
 	// Draw the [CR], [LF], or [CR][LF] blobs if visible line ends are on
 	XYPOSITION blobsWidth = 0;
-	if (lastSubLine) {
+	if (lastSubLine && ll->chars.Contains(ll->numCharsInLine)) {
 		for (Sci::Position eolPos = ll->numCharsBeforeEOL; eolPos < ll->numCharsInLine; eolPos++) {
 			rcSegment.left = xStart + ll->positions[eolPos] - static_cast<XYPOSITION>(subLineStart) + virtualSpace;
 			rcSegment.right = xStart + ll->positions[eolPos + 1] - static_cast<XYPOSITION>(subLineStart) + virtualSpace;
@@ -1560,6 +1896,11 @@ static void DrawBlockCaret(Surface *surface, const EditModel &model, const ViewS
 	// This character is where the caret block is, we override the colours
 	// (inversed) for drawing the caret here.
 	const int styleMain = ll->styles[offsetFirstChar];
+	if (!ll->chars.Contains(offsetFirstChar + numCharsToDraw - 1)) {
+		// Text of a windowed line outside the held blocks is not drawn
+		surface->FillRectangle(rcCaret, caretColour);
+		return;
+	}
 	FontAlias fontText = vsDraw.styles[styleMain].font;
 	const std::string_view text(&ll->chars[offsetFirstChar], numCharsToDraw);
 	surface->DrawTextClipped(rcCaret, fontText,
@@ -2203,6 +2544,7 @@ void EditView::DrawLine(Surface *surface, const EditModel &model, const ViewStyl
 
 	if (phasesDraw != phasesOne) {
 		if (phase & drawBack) {
+			const PhaseTimer timer(paintTiming, &Sci_PaintFrameTiming::background);
 			DrawBackground(surface, model, vsDraw, ll, rcLine, lineRange, posLineStart, xStart,
 				subLine, background);
 			DrawFoldDisplayText(surface, model, vsDraw, ll, line, xStart, rcLine, subLine, subLineStart, drawBack);
@@ -2214,6 +2556,7 @@ void EditView::DrawLine(Surface *surface, const EditModel &model, const ViewStyl
 		}
 
 		if (phase & drawIndicatorsBack) {
+			const PhaseTimer timer(paintTiming, &Sci_PaintFrameTiming::indicators);
 			DrawIndicators(surface, model, vsDraw, ll, line, xStart, rcLine, subLine,
 				lineRangeIncludingEnd.end, true, tabWidthMinimumPixels);
 			DrawEdgeLine(surface, vsDraw, ll, rcLine, lineRange, xStart);
@@ -2222,6 +2565,7 @@ void EditView::DrawLine(Surface *surface, const EditModel &model, const ViewStyl
 	}
 
 	if (phase & drawText) {
+		const PhaseTimer timer(paintTiming, &Sci_PaintFrameTiming::text);
 		DrawForeground(surface, model, vsDraw, ll, lineVisible, rcLine, lineRange, posLineStart, xStart,
 			subLine, background);
 	}
@@ -2231,6 +2575,7 @@ void EditView::DrawLine(Surface *surface, const EditModel &model, const ViewStyl
 	}
 
 	if (phase & drawIndicatorsFore) {
+		const PhaseTimer timer(paintTiming, &Sci_PaintFrameTiming::indicators);
 		DrawIndicators(surface, model, vsDraw, ll, line, xStart, rcLine, subLine,
 			lineRangeIncludingEnd.end, false, tabWidthMinimumPixels);
 	}
@@ -2337,6 +2682,9 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 			(vsDraw.braceBadLightIndicatorSet && (model.bracesMatchStyle == STYLE_BRACEBAD)));
 		const bool needDrawFoldLines = (model.foldFlags & (SC_FOLDFLAG_LINEBEFORE_EXPANDED | SC_FOLDFLAG_LINEBEFORE_CONTRACTED
 			| SC_FOLDFLAG_LINEAFTER_EXPANDED | SC_FOLDFLAG_LINEAFTER_CONTRACTED)) != 0;
+		// Lines inside the bounding rectangle of the paint but outside the invalidated region
+		// can be skipped unless lines overlap so that each line depends on its neighbours.
+		const bool skipUnchangedLines = !LinesOverlap();
 
 		Sci::Line lineDocPrevious = -1;	// Used to avoid laying out one document line multiple times
 		AutoLineLayout ll(llc, nullptr);
@@ -2360,6 +2708,18 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 			int yposScreen = screenLinePaintFirst * vsDraw.lineHeight;
 			Sci::Line visibleLine = model.TopLineOfMain() + screenLinePaintFirst;
 			while (visibleLine < model.pcs->LinesDisplayed() && yposScreen < rcArea.bottom) {
+				if (skipUnchangedLines) {
+					const PRectangle rcLineScreen(rcTextArea.left - leftTextOverlap, static_cast<XYPOSITION>(yposScreen),
+						rcTextArea.right, static_cast<XYPOSITION>(yposScreen + vsDraw.lineHeight));
+					if (!model.PaintIntersects(rcLineScreen)) {
+						if (!bufferedDraw) {
+							ypos += vsDraw.lineHeight;
+						}
+						yposScreen += vsDraw.lineHeight;
+						visibleLine++;
+						continue;
+					}
+				}
 
 				const Sci::Line lineDoc = model.pcs->DocFromDisplay(visibleLine);
 				// Only visible lines should be handled by the code within the loop
@@ -2373,10 +2733,23 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 				ElapsedPeriod ep;
 #endif
 				if (lineDoc != lineDocPrevious) {
+					const PhaseTimer timer(paintTiming, &Sci_PaintFrameTiming::layout);
+					const int linesLaidOut = paintTiming.current.linesLaidOut;
 					ll.Set(nullptr);
 					ll.Set(RetrieveLineLayout(lineDoc, model));
 					LayoutLine(model, lineDoc, surface, vsDraw, ll, model.wrapWidth);
+					if (ll) {
+						// Measure text of very long lines around the visible area.
+						const XYPOSITION widthText = rcClient.Width();
+						MeasureWindow(model, lineDoc, surface, vsDraw, ll, model.xOffset - widthText, model.xOffset + 2 * widthText);
+					}
 					lineDocPrevious = lineDoc;
+					if (paintTiming.Enabled()) {
+						paintTiming.current.linesPainted++;
+						if (linesLaidOut == paintTiming.current.linesLaidOut) {
+							paintTiming.current.layoutCacheHits++;
+						}
+					}
 				}
 #if defined(TIME_PAINTING)
 				durLayout += ep.Duration(true);
@@ -2421,6 +2794,7 @@ void EditView::PaintText(Surface *surfaceWindow, const EditModel &model, PRectan
 					}
 
 					if (phase & drawCarets) {
+						const PhaseTimer timer(paintTiming, &Sci_PaintFrameTiming::caret);
 						DrawCarets(surface, model, vsDraw, ll, lineDoc, xStart, rcLine, subLine);
 					}
 
@@ -2641,6 +3015,8 @@ Sci::Position EditView::FormatRange(bool draw, const Sci_RangeToFormat *pfr, Sur
 		// and determine the x position at which each character starts.
 		LineLayout ll(static_cast<int>(model.pdoc->LineStart(lineDoc + 1) - model.pdoc->LineStart(lineDoc) + 1));
 		LayoutLine(model, lineDoc, surfaceMeasure, vsPrint, &ll, widthPrint);
+		// Only the start of long lines fits on the page when not wrapping.
+		MeasureWindow(model, lineDoc, surfaceMeasure, vsPrint, &ll, 0, pfr->rc.right - pfr->rc.left);
 
 		ll.containsCaret = false;
 
@@ -41,6 +41,55 @@ void DrawStyledText(Surface *surface, const ViewStyle &vs, int styleOffset, PRec
 
 typedef void (*DrawTabArrowFn)(Surface *surface, PRectangle rcTab, int ymid);
 
+/**
+* Records how long the phases of painting take for recent frames.
+*/
+class PaintTiming {
+	bool enabled;
+	std::vector<Sci_PaintFrameTiming> frames;	// ring buffer of recent frames
+	size_t nextFrame;
+	size_t framesRecorded;
+	double frameStart;
+public:
+	Sci_PaintFrameTiming current;
+
+	PaintTiming() noexcept;
+	bool Enabled() const noexcept {
+		return enabled;
+	}
+	void Enable(bool enable);
+	// The clock is only read while timing is enabled.
+	void StartFrame() noexcept;
+	void EndFrame() noexcept;
+	size_t Frames(size_t count, Sci_PaintFrameTiming *timings) const noexcept;
+	// Seconds from an arbitrary start.
+	static double Clock() noexcept;
+};
+
+/**
+* Adds the time until it goes out of scope to a phase of the frame being painted.
+* Does nothing, not even reading the clock, while timing is disabled.
+*/
+class PhaseTimer {
+	double *duration;
+	double start;
+public:
+	PhaseTimer(PaintTiming &paintTiming, double Sci_PaintFrameTiming::*phase) noexcept :
+		duration(paintTiming.Enabled() ? &(paintTiming.current.*phase) : nullptr),
+		start(duration ? PaintTiming::Clock() : 0.0) {
+	}
+	// Deleted so PhaseTimer objects can not be copied.
+	PhaseTimer(const PhaseTimer &) = delete;
+	PhaseTimer(PhaseTimer &&) = delete;
+	void operator=(const PhaseTimer &) = delete;
+	void operator=(PhaseTimer &&) = delete;
+	~PhaseTimer() {
+		if (duration) {
+			*duration += PaintTiming::Clock() - start;
+		}
+	}
+};
+
 class LineTabstops;
 
 /**
@@ -82,6 +131,11 @@ public:
 	LineLayoutCache llc;
 	PositionCache posCache;
 
+	PaintTiming paintTiming;
+
+	// Lines longer than this are windowed when not wrapped, only changed by tests.
+	int windowedLength;
+
 	int tabArrowHeight; // draw arrow heads this many pixels above/below line midpoint
 	/** Some platforms, notably PLAT_CURSES, do not support Scintilla's native
 	 * DrawTabArrow function for drawing tab characters. Allow those platforms to
@@ -114,8 +168,22 @@ public:
 	void RefreshPixMaps(Surface *surfaceWindow, WindowID wid, const ViewStyle &vsDraw) const;
 
 	LineLayout *RetrieveLineLayout(Sci::Line lineNumber, const EditModel &model);
+	bool LayoutSegments(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, Range range, bool callerMultiThreaded);
+private:
+	void UpdateBlocks(const EditModel &model, Sci::Line line, const ViewStyle &vstyle, LineLayout *ll, bool callerMultiThreaded);
+	void SplitBlocks(const EditModel &model, Sci::Line line, const ViewStyle &vstyle, LineLayout *ll, size_t first);
+	void HoldBlocks(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, size_t first, size_t end, bool callerMultiThreaded);
+	void HoldWindow(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, size_t first, size_t end, bool callerMultiThreaded);
+public:
 	void LayoutLine(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
-		LineLayout *ll, int width = LineLayout::wrapWidthInfinite);
+		LineLayout *ll, int width = LineLayout::wrapWidthInfinite, bool callerMultiThreaded = false);
+	void MeasureWindow(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, XYPOSITION xLeft, XYPOSITION xRight, bool callerMultiThreaded = false);
+	void MeasurePosition(const EditModel &model, Sci::Line line, Surface *surface, const ViewStyle &vstyle,
+		LineLayout *ll, Sci::Position posInLine, bool callerMultiThreaded = false);
 
 	static void UpdateBidiData(const EditModel &model, const ViewStyle &vstyle, LineLayout *ll);
 
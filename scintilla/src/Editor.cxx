@@ -21,6 +21,10 @@
 #include <algorithm>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <future>
 #include <chrono>
 
 #include "Platform.h"
@@ -112,6 +116,8 @@ static constexpr bool IsAllSpacesOrTabs(std::string_view sv) noexcept {
 Editor::Editor() : durationWrapOneLine(0.00001, 0.000001, 0.0001) {
 	ctrlID = 0;
 
+	wrapThreadsMax = std::max(std::thread::hardware_concurrency(), 1U);
+
 	stylesValid = false;
 	technology = SC_TECHNOLOGY_DEFAULT;
 	scaleRGBAImage = 100.0f;
@@ -192,6 +198,10 @@ Editor::Editor() : durationWrapOneLine(0.00001, 0.000001, 0.0001) {
 
 	recordingMacro = false;
 	foldAutomatic = 0;
+	foldBatchDepth = 0;
+	foldBatchStart = Sci::invalidPosition;
+	foldBatchEnd = Sci::invalidPosition;
+	foldBatchGoTo = Sci::invalidPosition;
 
 	convertPastes = true;
 
@@ -296,6 +306,7 @@ void Editor::RefreshStyleData() {
 		}
 		SetScrollBars();
 		SetRectangularRange();
+		pdoc->SetFoldOnDemand(!vs.FoldMarginVisible());
 	}
 }
 
@@ -565,6 +576,29 @@ void Editor::InvalidateRange(Sci::Position start, Sci::Position end) noexcept {
 	RedrawRect(RectangleFromRange(Range(start, end), view.LinesOverlap() ? vs.lineOverlap : 0));
 }
 
+/**
+ * Indicators do not change the layout of text so when a change is within one
+ * display line only the columns it covers need to be repainted.
+ */
+void Editor::InvalidateIndicatorRange(Sci::Position start, Sci::Position end) {
+	PRectangle rc = RectangleFromRange(Range(start, end), view.LinesOverlap() ? vs.lineOverlap : 0);
+	if (rc.Empty()) {
+		return;
+	}
+	const Sci::Line line = pdoc->SciLineFromPosition(start);
+	if (!BidirectionalEnabled() && (end < pdoc->LineEnd(line))) {
+		const Point ptStart = LocationFromPosition(start);
+		const Point ptEnd = LocationFromPosition(end);
+		if (ptStart.y == ptEnd.y) {
+			// Allow for decorations like boxes and squiggles drawn past character bounds.
+			const XYPOSITION margin = static_cast<XYPOSITION>(vs.lineHeight);
+			rc.left = std::max(rc.left, std::floor(ptStart.x - margin));
+			rc.right = std::min(rc.right, std::ceil(ptEnd.x + margin));
+		}
+	}
+	RedrawRect(rc);
+}
+
 Sci::Position Editor::CurrentPosition() const {
 	return sel.MainCaret();
 }
@@ -1480,6 +1514,12 @@ bool Editor::Wrapping() const noexcept {
 
 void Editor::NeedWrapping(Sci::Line docLineStart, Sci::Line docLineEnd) noexcept {
 	//Platform::DebugPrintf("\nNeedWrapping: %0d..%0d\n", docLineStart, docLineEnd);
+	ForgetWrapWidths(docLineStart, docLineEnd);
+	NeedRewrapForWidth(docLineStart, docLineEnd);
+}
+
+// Only the wrap width changed so lines that fit within both old and new width are not rewrapped.
+void Editor::NeedRewrapForWidth(Sci::Line docLineStart, Sci::Line docLineEnd) noexcept {
 	if (wrapPending.AddRange(docLineStart, docLineEnd)) {
 		view.llc.Invalidate(LineLayout::llPositions);
 	}
@@ -1489,17 +1529,146 @@ void Editor::NeedWrapping(Sci::Line docLineStart, Sci::Line docLineEnd) noexcept
 	}
 }
 
+void Editor::ForgetWrapWidths(Sci::Line docLineStart, Sci::Line docLineEnd) noexcept {
+	const Sci::Line lines = pdoc->LinesTotal();
+	if (docLineStart == 0 && docLineEnd >= lines) {
+		if (wrapLineWidths.Length() != lines) {
+			try {
+				wrapLineWidths.DeleteAll();
+				wrapLineWidths.InsertValue(0, lines, 0);
+			} catch (...) {
+				// lines without a width are always wrapped
+				wrapLineWidths.DeleteAll();
+			}
+			return;
+		}
+	}
+	docLineEnd = std::min<Sci::Line>(docLineEnd, wrapLineWidths.Length());
+	for (Sci::Line line = docLineStart; line < docLineEnd; line++) {
+		wrapLineWidths.SetValueAt(line, 0);
+	}
+}
+
+void Editor::SetWrapWidth(Sci::Line line, const LineLayout *ll) noexcept {
+	if (line < wrapLineWidths.Length()) {
+		const int width = static_cast<int>(std::ceil(ll->positions[ll->numCharsInLine]));
+		wrapLineWidths.SetValueAt(line, width + 1);
+	}
+}
+
+// Whether a line that fitted on one display line when last wrapped still fits at the current width.
+bool Editor::WrapUnchanged(Sci::Line line) const noexcept {
+	const int widthPlusOne = wrapLineWidths.ValueAt(line);
+	return widthPlusOne != 0 && (widthPlusOne - 1) < std::max(wrapWidth, 20) &&
+		pcs->GetHeight(line) == 1 + (vs.annotationVisible ? pdoc->AnnotationLines(line) : 0);
+}
+
 bool Editor::WrapOneLine(Surface *surface, Sci::Line lineToWrap) {
+	if (WrapUnchanged(lineToWrap)) {
+		return false;
+	}
 	AutoLineLayout ll(view.llc, view.RetrieveLineLayout(lineToWrap, *this));
 	int linesWrapped = 1;
 	if (ll) {
 		view.LayoutLine(*this, lineToWrap, surface, vs, ll, wrapWidth);
 		linesWrapped = ll->lines;
+		SetWrapWidth(lineToWrap, ll);
 	}
 	return pcs->SetHeight(lineToWrap, linesWrapped +
 		(vs.annotationVisible ? pdoc->AnnotationLines(lineToWrap) : 0));
 }
 
+namespace {
+
+// wrapping fewer lines on multiple threads does not pay for starting the threads.
+constexpr size_t minLinesPerWrapThread = 256;
+constexpr size_t maxWrapThreads = 16;
+
+}
+
+// Wrap lines in [lineToWrap, lineToWrapEnd).
+// When the surface supports measuring from multiple threads, lines are laid out by workers,
+// each with its own surface and line layout, then heights are applied in document order.
+bool Editor::WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToWrapEnd) {
+	const size_t linesBeingWrapped = lineToWrapEnd - lineToWrap;
+	size_t threads = 1;
+	if (linesBeingWrapped >= 2*minLinesPerWrapThread && surface->SupportsThreadSafeMeasureWidths()) {
+		threads = std::min({ wrapThreadsMax, maxWrapThreads, linesBeingWrapped / minLinesPerWrapThread });
+	}
+
+	bool wrapOccurred = false;
+	if (threads <= 1) {
+		while (lineToWrap < lineToWrapEnd) {
+			if (WrapOneLine(surface, lineToWrap)) {
+				wrapOccurred = true;
+			}
+			wrapPending.Wrapped(lineToWrap);
+			lineToWrap++;
+		}
+		return wrapOccurred;
+	}
+
+	// 0 for lines that do not need wrapping.
+	std::vector<int> linesAfterWrap(linesBeingWrapped);
+	std::vector<int> widthsAfterWrap(linesBeingWrapped);
+	std::atomic<size_t> nextIndex{0};
+	const auto wrapWorker = [&](Surface *surfaceThread) {
+		LineLayout ll(0);
+		while (true) {
+			const size_t index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+			if (index >= linesBeingWrapped) {
+				break;
+			}
+			const Sci::Line line = lineToWrap + index;
+			if (WrapUnchanged(line)) {
+				continue;
+			}
+			const Sci::Position lineLength = pdoc->LineStart(line + 1) - pdoc->LineStart(line);
+			ll.Resize(static_cast<int>(lineLength));
+			ll.validity = LineLayout::llInvalid;
+			view.LayoutLine(*this, line, surfaceThread, vs, &ll, wrapWidth, true);
+			linesAfterWrap[index] = ll.lines;
+			widthsAfterWrap[index] = static_cast<int>(std::ceil(ll.positions[ll.numCharsInLine]));
+		}
+	};
+
+	// surfaces are created on this thread, the calling thread uses its own surface.
+	std::vector<std::unique_ptr<AutoSurface>> surfaces;
+	for (size_t i = 1; i < threads; i++) {
+		auto surfaceThread = std::make_unique<AutoSurface>(this);
+		if (*surfaceThread) {
+			surfaces.push_back(std::move(surfaceThread));
+		}
+	}
+	{
+		// futures are destroyed before state used by workers, waiting for all workers to finish.
+		std::vector<std::future<void>> futures;
+		for (const auto &surfaceThread : surfaces) {
+			futures.push_back(std::async(std::launch::async, wrapWorker, static_cast<Surface *>(*surfaceThread)));
+		}
+		wrapWorker(surface);
+		for (auto &future : futures) {
+			future.get();
+		}
+	}
+
+	for (size_t index = 0; index < linesBeingWrapped; index++) {
+		const int lines = linesAfterWrap[index];
+		if (lines != 0) {
+			if (pcs->SetHeight(lineToWrap, lines +
+				(vs.annotationVisible ? pdoc->AnnotationLines(lineToWrap) : 0))) {
+				wrapOccurred = true;
+			}
+			if (lineToWrap < wrapLineWidths.Length()) {
+				wrapLineWidths.SetValueAt(lineToWrap, widthsAfterWrap[index] + 1);
+			}
+		}
+		wrapPending.Wrapped(lineToWrap);
+		lineToWrap++;
+	}
+	return wrapOccurred;
+}
+
 // Perform  wrapping for a subset of the lines needing wrapping.
 // wsAll: wrap all lines which need wrapping in this single call
 // wsVisible: wrap currently visible lines
@@ -1574,13 +1743,7 @@ bool Editor::WrapLines(WrapScope ws) {
 
 				const Sci::Line linesBeingWrapped = lineToWrapEnd - lineToWrap;
 				ElapsedPeriod epWrapping;
-				while (lineToWrap < lineToWrapEnd) {
-					if (WrapOneLine(surface, lineToWrap)) {
-						wrapOccurred = true;
-					}
-					wrapPending.Wrapped(lineToWrap);
-					lineToWrap++;
-				}
+				wrapOccurred = WrapBlock(surface, lineToWrap, lineToWrapEnd);
 				durationWrapOneLine.AddSample(linesBeingWrapped, epWrapping.Duration());
 
 				goodTopLine = pcs->DisplayFromDoc(lineDocTop) + std::min(
@@ -1736,7 +1899,13 @@ void Editor::Paint(Surface *surfaceWindow, PRectangle rcArea) {
 
 	paintAbandonedByStyling = false;
 
-	StyleAreaBounded(rcArea, false);
+	PaintTiming &paintTiming = view.paintTiming;
+	paintTiming.StartFrame();
+
+	{
+		const PhaseTimer timer(paintTiming, &Sci_PaintFrameTiming::styling);
+		StyleAreaBounded(rcArea, false);
+	}
 
 	const PRectangle rcClient = GetClientRectangle();
 	//Platform::DebugPrintf("Client: (%.0f,%.0f) ... (%.0f,%.0f)\n",
@@ -1747,14 +1916,17 @@ void Editor::Paint(Surface *surfaceWindow, PRectangle rcArea) {
 		RefreshPixMaps(surfaceWindow);
 	}
 
-	// Wrap the visible lines if needed.
-	if (WrapLines(WrapScope::wsVisible)) {
-		// The wrapping process has changed the height of some lines so
-		// abandon this paint for a complete repaint.
-		if (AbandonPaint()) {
-			return;
+	{
+		// Wrap the visible lines if needed.
+		const PhaseTimer timer(paintTiming, &Sci_PaintFrameTiming::layout);
+		if (WrapLines(WrapScope::wsVisible)) {
+			// The wrapping process has changed the height of some lines so
+			// abandon this paint for a complete repaint.
+			if (AbandonPaint()) {
+				return;
+			}
+			RefreshPixMaps(surfaceWindow);	// In case pixmaps invalidated by scrollbar change
 		}
-		RefreshPixMaps(surfaceWindow);	// In case pixmaps invalidated by scrollbar change
 	}
 	PLATFORM_ASSERT(marginView.pixmapSelPattern->Initialised());
 
@@ -1763,7 +1935,10 @@ void Editor::Paint(Surface *surfaceWindow, PRectangle rcArea) {
 
 	if (paintState != paintAbandoned) {
 		if (vs.marginInside) {
-			PaintSelMargin(surfaceWindow, rcArea);
+			{
+				const PhaseTimer timer(paintTiming, &Sci_PaintFrameTiming::margin);
+				PaintSelMargin(surfaceWindow, rcArea);
+			}
 			PRectangle rcRightMargin = rcClient;
 			rcRightMargin.left = rcRightMargin.right - vs.rightMarginWidth;
 			if (rcArea.Intersects(rcRightMargin)) {
@@ -1803,6 +1978,8 @@ void Editor::Paint(Surface *surfaceWindow, PRectangle rcArea) {
 	}
 
 	NotifyPainted();
+
+	paintTiming.EndFrame();
 }
 
 // This is mostly copied from the Paint method but with some things omitted
@@ -1867,7 +2044,7 @@ void Editor::ChangeSize() {
 		rcTextArea.left = static_cast<XYPOSITION>(vs.textStart);
 		rcTextArea.right -= vs.rightMarginWidth;
 		if (wrapWidth != rcTextArea.Width()) {
-			NeedWrapping();
+			NeedRewrapForWidth();
 			Redraw();
 		}
 	}
@@ -2612,15 +2789,24 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 		}
 		if (paintState == notPainting) {
 			const Sci::Line lineDocTop = pcs->DocFromDisplay(topLine);
-			if (mh.position < pdoc->LineStart(lineDocTop)) {
+			const Sci::Line lineDocBottom = pcs->DocFromDisplay(topLine + LinesOnScreen());
+			const Sci::Position posTop = pdoc->LineStart(lineDocTop);
+			if (mh.position + mh.length <= posTop || mh.position > pdoc->LineEnd(lineDocBottom)) {
+				// Changed text is not visible
+			} else if (mh.position < posTop) {
 				// Styling performed before this view
 				Redraw();
-			} else {
+			} else if (mh.modificationType & SC_MOD_CHANGESTYLE) {
 				InvalidateRange(mh.position, mh.position + mh.length);
+			} else {
+				InvalidateIndicatorRange(mh.position, mh.position + mh.length);
 			}
 		}
 		if (mh.modificationType & SC_MOD_CHANGESTYLE) {
 			view.llc.Invalidate(LineLayout::llCheckTextAndStyle);
+			// widths of restyled lines may differ
+			ForgetWrapWidths(pdoc->SciLineFromPosition(mh.position),
+				pdoc->SciLineFromPosition(mh.position + mh.length) + 1);
 		}
 	} else {
 		// Move selection and brace highlights
@@ -2662,8 +2848,14 @@ void Editor::NotifyModified(Document *, DocModification mh, void *) {
 				lineOfPos++;	// Affecting subsequent lines
 			if (mh.linesAdded > 0) {
 				pcs->InsertLines(lineOfPos, mh.linesAdded);
+				if (lineOfPos <= wrapLineWidths.Length()) {
+					wrapLineWidths.InsertValue(lineOfPos, mh.linesAdded, 0);
+				}
 			} else {
 				pcs->DeleteLines(lineOfPos, -mh.linesAdded);
+				if (lineOfPos < wrapLineWidths.Length()) {
+					wrapLineWidths.DeleteRange(lineOfPos, std::min<Sci::Line>(-mh.linesAdded, wrapLineWidths.Length() - lineOfPos));
+				}
 			}
 			view.LinesAddedOrRemoved(lineOfPos, mh.linesAdded);
 		}
@@ -5101,6 +5293,11 @@ void Editor::StyleToPositionInView(Sci::Position pos) {
 		// DiscardOverdraw may have truncated client drawing area so recalculate endWindow
 		endWindow = PositionAfterArea(GetClientDrawingRectangle());
 		pdoc->EnsureStyledTo(endWindow);
+		pos = endWindow;
+	}
+	if (!pdoc->FoldOnDemand()) {
+		// fold margin may just become visible while text already styled.
+		pdoc->EnsureFoldedTo(pos);
 	}
 }
 
@@ -5186,6 +5383,10 @@ bool Editor::PaintContains(PRectangle rc) const noexcept {
 	}
 }
 
+bool Editor::PaintIntersects(PRectangle rc) const noexcept {
+	return rcPaint.Intersects(rc);
+}
+
 bool Editor::PaintContainsMargin() const noexcept {
 	if (wMargin.GetID()) {
 		// With separate margin view, paint of text view
@@ -5271,6 +5472,7 @@ void Editor::SetDocPointer(Document *document) {
 		pdoc = document;
 	}
 	pdoc->AddRef();
+	pdoc->SetFoldOnDemand(!vs.FoldMarginVisible());
 	pcs = ContractionStateCreate(pdoc->IsLarge());
 
 	// Ensure all positions within document
@@ -5348,6 +5550,7 @@ void Editor::SetFoldExpanded(Sci::Line lineDoc, bool expanded) {
 
 void Editor::FoldLine(Sci::Line line, int action) {
 	if (line >= 0) {
+		pdoc->EnsureFoldedTo(pdoc->LineStart(line + 1));
 		if (action == SC_FOLDACTION_TOGGLE) {
 			if ((pdoc->GetLevel(line) & SC_FOLDLEVELHEADERFLAG) == 0) {
 				line = pdoc->GetFoldParent(line);
@@ -5357,6 +5560,11 @@ void Editor::FoldLine(Sci::Line line, int action) {
 			action = (pcs->GetExpanded(line)) ? SC_FOLDACTION_CONTRACT : SC_FOLDACTION_EXPAND;
 		}
 
+		if (foldBatchDepth > 0) {
+			FoldBatchLine(line, action);
+			return;
+		}
+
 		if (action == SC_FOLDACTION_CONTRACT) {
 			const Sci::Line lineMaxSubord = pdoc->GetLastChild(line);
 			if (lineMaxSubord > line) {
@@ -5437,6 +5645,8 @@ void Editor::EnsureLineVisible(Sci::Line lineDoc, bool enforcePolicy) {
 	}
 
 	if (!pcs->GetVisible(lineDoc)) {
+		// Fold levels may be deferred, see Document::FoldOnDemand().
+		pdoc->EnsureFoldedTo(pdoc->LineStart(lineDoc + 1));
 		// Back up to find a non-blank line
 		Sci::Line lookLine = lineDoc;
 		int lookLineLevel = pdoc->GetLevel(lookLine);
@@ -5483,7 +5693,7 @@ void Editor::EnsureLineVisible(Sci::Line lineDoc, bool enforcePolicy) {
 }
 
 void Editor::FoldAll(int action) {
-	pdoc->EnsureStyledTo(pdoc->Length());
+	pdoc->EnsureFoldedTo(pdoc->Length());
 	const Sci::Line maxLine = pdoc->LinesTotal();
 	bool expanding = action == SC_FOLDACTION_EXPAND;
 	if (action == SC_FOLDACTION_TOGGLE) {
@@ -5520,7 +5730,116 @@ void Editor::FoldAll(int action) {
 	Redraw();
 }
 
+void Editor::BeginFoldBatch() noexcept {
+	if (foldBatchDepth == 0) {
+		foldBatchStart = Sci::invalidPosition;
+		foldBatchEnd = Sci::invalidPosition;
+		foldBatchGoTo = Sci::invalidPosition;
+	}
+	foldBatchDepth++;
+}
+
+/**
+ * Record a fold action inside a batch: only the expansion state changes now,
+ * visibility of the affected lines is recalculated by EndFoldBatch.
+ */
+void Editor::FoldBatchLine(Sci::Line line, int action) {
+	Sci::Line lineMaxSubord = pdoc->GetLastChild(line);
+	if (action == SC_FOLDACTION_CONTRACT) {
+		if (lineMaxSubord <= line) {
+			return;
+		}
+		pcs->SetExpanded(line, false);
+	} else {
+		pcs->SetExpanded(line, true);
+		// Visibility is stale inside the batch: the line will be hidden when it ends if a fold
+		// parent is contracted or it is hidden outside the lines to recalculate.
+		const Sci::Line lineExpanded = line;
+		bool hidden = !pcs->GetVisible(line) && (foldBatchStart < 0 || line < foldBatchStart || line > foldBatchEnd);
+		// As EnsureLineVisible would do, expand the headers hiding this line.
+		for (Sci::Line lineParent = pdoc->GetFoldParent(line); lineParent >= 0; lineParent = pdoc->GetFoldParent(lineParent)) {
+			if (!pcs->GetExpanded(lineParent)) {
+				pcs->SetExpanded(lineParent, true);
+				line = lineParent;
+				hidden = true;
+			}
+		}
+		lineMaxSubord = std::max(lineMaxSubord, pdoc->GetLastChild(line));
+		if (hidden) {
+			// As FoldLine does for a hidden line, the caret goes to it when the batch ends.
+			foldBatchGoTo = lineExpanded;
+		}
+	}
+	if (foldBatchStart < 0 || line < foldBatchStart) {
+		foldBatchStart = line;
+	}
+	foldBatchEnd = std::max(foldBatchEnd, lineMaxSubord);
+	RedrawSelMargin();
+}
+
+/**
+ * Recalculate visibility of lines touched by the batch in a single forward pass:
+ * contracted headers hide their children and everything else is shown.
+ */
+void Editor::EndFoldBatch() {
+	if (foldBatchDepth == 0 || --foldBatchDepth > 0) {
+		return;
+	}
+	const Sci::Line lineEnd = std::min(foldBatchEnd, pdoc->LinesTotal() - 1);
+	if (foldBatchStart < 0 || foldBatchStart > lineEnd) {
+		return;
+	}
+
+	Sci::Line line = foldBatchStart;
+	// Lines may be hidden by a contracted header before the batch range.
+	Sci::Line lineHiddenEnd = -1;
+	for (Sci::Line lineParent = pdoc->GetFoldParent(line); lineParent >= 0; lineParent = pdoc->GetFoldParent(lineParent)) {
+		if (!pcs->GetExpanded(lineParent)) {
+			lineHiddenEnd = std::max(lineHiddenEnd, pdoc->GetLastChild(lineParent));
+		}
+	}
+	if (lineHiddenEnd >= line) {
+		pcs->SetVisible(line, std::min(lineHiddenEnd, lineEnd), false);
+		line = lineHiddenEnd + 1;
+	}
+
+	Sci::Line lineShown = line;
+	while (line <= lineEnd) {
+		if ((pdoc->GetLevel(line) & SC_FOLDLEVELHEADERFLAG) && !pcs->GetExpanded(line)) {
+			const Sci::Line lineMaxSubord = pdoc->GetLastChild(line);
+			if (lineMaxSubord > line) {
+				pcs->SetVisible(lineShown, line, true);
+				pcs->SetVisible(line + 1, std::min(lineMaxSubord, lineEnd), false);
+				line = lineMaxSubord + 1;
+				lineShown = line;
+				continue;
+			}
+		}
+		line++;
+	}
+	if (lineShown <= lineEnd) {
+		pcs->SetVisible(lineShown, lineEnd, true);
+	}
+
+	foldBatchStart = Sci::invalidPosition;
+	foldBatchEnd = Sci::invalidPosition;
+	if (foldBatchGoTo >= 0) {
+		GoToLine(foldBatchGoTo);
+		foldBatchGoTo = Sci::invalidPosition;
+	} else {
+		const Sci::Line lineCurrent = pdoc->SciLineFromPosition(sel.MainCaret());
+		if (!pcs->GetVisible(lineCurrent)) {
+			// This does not re-expand the fold
+			EnsureCaretVisible();
+		}
+	}
+	SetScrollBars();
+	Redraw();
+}
+
 void Editor::FoldChanged(Sci::Line line, int levelNow, int levelPrev) {
+	// levels of previous lines and fold parent are read below.
+	pdoc->EnsureFoldedTo(pdoc->LineStart(line + 1));
 	if (levelNow & SC_FOLDLEVELHEADERFLAG) {
 		if (!(levelPrev & SC_FOLDLEVELHEADERFLAG)) {
 			// Adding a fold point.
@@ -5734,7 +6053,22 @@ void Editor::StyleSetMessage(unsigned int iMessage, uptr_t wParam, sptr_t lParam
 		vs.styles[wParam].hotspot = lParam != 0;
 		break;
 	}
-	InvalidateStyleRedraw();
+	switch (iMessage) {
+	case SCI_STYLESETFORE:
+	case SCI_STYLESETBACK:
+	case SCI_STYLESETEOLFILLED:
+	case SCI_STYLESETUNDERLINE:
+	case SCI_STYLESETSTRIKE:
+	case SCI_STYLESETCHANGEABLE:
+	case SCI_STYLESETHOTSPOT:
+		// Text positions do not change so wrapping is still valid.
+		InvalidateStyleData();
+		Redraw();
+		break;
+	default:
+		InvalidateStyleRedraw();
+		break;
+	}
 }
 
 sptr_t Editor::StyleGetMessage(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
@@ -6758,6 +7092,13 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 	case SCI_GETLAYOUTCACHE:
 		return view.llc.GetLevel();
 
+	case SCI_SETLAYOUTCACHEMEMORY:
+		view.llc.SetMemoryBudget(wParam);
+		break;
+
+	case SCI_GETLAYOUTCACHEMEMORY:
+		return view.llc.GetMemoryBudget();
+
 	case SCI_SETPOSITIONCACHE:
 		view.posCache.SetSize(wParam);
 		break;
@@ -6765,6 +7106,23 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 	case SCI_GETPOSITIONCACHE:
 		return view.posCache.GetSize();
 
+	case SCI_GETPOSITIONCACHESTATISTIC:
+		return view.posCache.GetStatistic(static_cast<int>(wParam));
+
+	case SCI_RESETPOSITIONCACHESTATISTICS:
+		view.posCache.ResetStatistics();
+		break;
+
+	case SCI_SETPAINTTIMING:
+		view.paintTiming.Enable(wParam != 0);
+		break;
+
+	case SCI_GETPAINTTIMING:
+		return view.paintTiming.Enabled();
+
+	case SCI_GETPAINTTIMINGS:
+		return view.paintTiming.Frames(wParam, reinterpret_cast<Sci_PaintFrameTiming *>(lParam));
+
 	case SCI_SETSCROLLWIDTH:
 		PLATFORM_ASSERT(wParam > 0);
 		if ((wParam > 0) && (wParam != static_cast<unsigned int>(scrollWidth))) {
@@ -7243,12 +7601,14 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 		}
 
 	case SCI_GETFOLDLEVEL:
+		pdoc->EnsureFoldedTo(pdoc->LineStart(wParam + 1));
 		return pdoc->GetLevel(wParam);
 
 	case SCI_GETLASTCHILD:
 		return pdoc->GetLastChild(wParam, static_cast<int>(lParam));
 
 	case SCI_GETFOLDPARENT:
+		pdoc->EnsureFoldedTo(pdoc->LineStart(wParam + 1));
 		return pdoc->GetFoldParent(wParam);
 
 	case SCI_SHOWLINES:
@@ -7321,6 +7681,7 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 		break;
 
 	case SCI_FOLDCHILDREN:
+		pdoc->EnsureFoldedTo(pdoc->LineStart(wParam + 1));
 		FoldExpand(wParam, static_cast<int>(lParam), pdoc->GetLevel(static_cast<int>(wParam)));
 		break;
 
@@ -7328,6 +7689,14 @@ sptr_t Editor::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) {
 		FoldAll(static_cast<int>(wParam));
 		break;
 
+	case SCI_BEGINFOLDBATCH:
+		BeginFoldBatch();
+		break;
+
+	case SCI_ENDFOLDBATCH:
+		EndFoldBatch();
+		break;
+
 	case SCI_EXPANDCHILDREN:
 		FoldExpand(wParam, SC_FOLDACTION_EXPAND, static_cast<int>(lParam));
 		break;
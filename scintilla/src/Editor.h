@@ -262,10 +262,22 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	bool recordingMacro;
 
 	int foldAutomatic;
+	// Nesting depth of SCI_BEGINFOLDBATCH and the range of lines whose
+	// visibility must be recalculated when the outermost batch ends.
+	int foldBatchDepth;
+	Sci::Line foldBatchStart;
+	Sci::Line foldBatchEnd;
+	// Line expanded in the batch while hidden, the caret goes there when the batch ends.
+	Sci::Line foldBatchGoTo;
 
 	// Wrapping support
 	WrapPending wrapPending;
 	ActionDuration durationWrapOneLine;
+	// Unwrapped width + 1 of each line when last wrapped, 0 when not known.
+	// Lets a change of wrap width skip lines narrower than both widths.
+	SplitVector<int> wrapLineWidths;
+	// Upper bound of threads laying out lines in WrapBlock, 1 wraps on the calling thread only.
+	size_t wrapThreadsMax;
 
 	bool convertPastes;
 
@@ -311,6 +323,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void RedrawSelMargin(Sci::Line line = -1, bool allAfter = false) noexcept;
 	PRectangle RectangleFromRange(Range r, int overlap) const noexcept;
 	void InvalidateRange(Sci::Position start, Sci::Position end) noexcept;
+	void InvalidateIndicatorRange(Sci::Position start, Sci::Position end);
 
 	bool UserVirtualSpace() const noexcept {
 		return ((virtualSpaceOptions & SCVS_USERACCESSIBLE) != 0);
@@ -383,7 +396,12 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 
 	bool Wrapping() const noexcept;
 	void NeedWrapping(Sci::Line docLineStart = 0, Sci::Line docLineEnd = WrapPending::lineLarge) noexcept;
+	void NeedRewrapForWidth(Sci::Line docLineStart = 0, Sci::Line docLineEnd = WrapPending::lineLarge) noexcept;
+	void ForgetWrapWidths(Sci::Line docLineStart, Sci::Line docLineEnd) noexcept;
+	void SetWrapWidth(Sci::Line line, const LineLayout *ll) noexcept;
+	bool WrapUnchanged(Sci::Line line) const noexcept;
 	bool WrapOneLine(Surface *surface, Sci::Line lineToWrap);
+	bool WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToWrapEnd);
 	enum class WrapScope {
 		wsAll, wsVisible, wsIdle
 	};
@@ -556,6 +574,7 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	virtual void QueueIdleWork(WorkNeeded::workItems items, Sci::Position upTo = 0) noexcept;
 
 	virtual bool SCICALL PaintContains(PRectangle rc) const noexcept;
+	bool PaintIntersects(PRectangle rc) const noexcept override;
 	bool PaintContainsMargin() const noexcept;
 	void CheckForChangeOutsidePaint(Range r) noexcept;
 	void SetBraceHighlight(Sci::Position pos0, Sci::Position pos1, int matchStyle) noexcept;
@@ -574,6 +593,9 @@ protected:	// ScintillaBase subclass needs access to much of Editor
 	void FoldChanged(Sci::Line line, int levelNow, int levelPrev);
 	void NeedShown(Sci::Position pos, Sci::Position len);
 	void FoldAll(int action);
+	void BeginFoldBatch() noexcept;
+	void EndFoldBatch();
+	void FoldBatchLine(Sci::Line line, int action);
 
 	Sci::Position GetTag(char *tagValue, int tagNumber);
 	Sci::Position ReplaceTarget(bool replacePatterns, const char *text, Sci::Position length = -1);
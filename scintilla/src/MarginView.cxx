@@ -19,6 +19,7 @@
 #include <map>
 #include <algorithm>
 #include <memory>
+#include <mutex>
 
 #include "Platform.h"
 
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <iterator>
 #include <memory>
+#include <mutex>
 
 #include "Platform.h"
 
@@ -54,10 +55,27 @@ void BidiData::Resize(size_t maxLineLength_) {
 	widthReprs.resize(maxLineLength_ + 1);
 }
 
+XYPOSITION LinePositions::Outside(Sci::Position position) const noexcept {
+	if (blockStarts.empty()) {
+		// Whole line held, only reached for positions after its end
+		return (held.Length() > 0) ? held[held.Start() + held.Length() - 1] : 0.0f;
+	}
+	// Interpolate within the block, exact at block starts
+	const size_t blocks = blockStarts.size() - 1;
+	size_t block = std::upper_bound(blockStarts.begin(), blockStarts.end(), position) - blockStarts.begin();
+	block = std::clamp<size_t>(block, 1, blocks) - 1;
+	const int start = blockStarts[block];
+	const int length = blockStarts[block + 1] - start;
+	const Sci::Position offset = std::clamp<Sci::Position>(position - start, 0, length);
+	return blockX[block] + (blockX[block + 1] - blockX[block]) * offset / std::max(length, 1);
+}
+
 LineLayout::LineLayout(int maxLineLength_) :
 	lenLineStarts(0),
 	lineNumber(-1),
 	inCache(false),
+	lastUse(0),
+	bytesInCache(0),
 	maxLineLength(-1),
 	numCharsInLine(0),
 	numCharsBeforeEOL(0),
@@ -67,6 +85,9 @@ LineLayout::LineLayout(int maxLineLength_) :
 	containsCaret(false),
 	edgeColumn(0),
 	bracePreviousStyles{},
+	blocksMeasured(0),
+	blockHeldFirst(0),
+	blockHeldEnd(0),
 	hotspot(0, 0),
 	widthLine(wrapWidthInfinite),
 	lines(1),
@@ -80,20 +101,19 @@ LineLayout::~LineLayout() {
 
 void LineLayout::Resize(int maxLineLength_) {
 	if (maxLineLength_ > maxLineLength) {
+		// Arrays are allocated by Hold when the line is laid out
 		Free();
-		chars = std::make_unique<char[]>(maxLineLength_ + 1);
-		styles = std::make_unique<unsigned char[]>(maxLineLength_ + 1);
-		// Extra position allocated as sometimes the Windows
-		// GetTextExtentExPoint API writes an extra element.
-		positions = std::make_unique<XYPOSITION[]>(maxLineLength_ + 1 + 1);
-		if (bidiData) {
-			bidiData->Resize(maxLineLength_);
-		}
-
 		maxLineLength = maxLineLength_;
 	}
 }
 
+// Hold chars, styles and positions from start, the last position is at start + length.
+void LineLayout::Hold(int start, int length) {
+	chars.Hold(start, length + 1);
+	styles.Hold(start, length + 1);
+	positions.Hold(start, length + 1);
+}
+
 void LineLayout::EnsureBidiData() {
 	if (!bidiData) {
 		bidiData = std::make_unique<BidiData>();
@@ -102,13 +122,29 @@ void LineLayout::EnsureBidiData() {
 }
 
 void LineLayout::Free() noexcept {
-	chars.reset();
-	styles.reset();
-	positions.reset();
+	chars.Free();
+	styles.Free();
+	positions.Free();
+	blockHashes.clear();
+	blocksMeasured = 0;
+	blockHeldFirst = 0;
+	blockHeldEnd = 0;
 	lineStarts.reset();
+	lenLineStarts = 0;
 	bidiData.reset();
 }
 
+size_t LineLayout::AllocatedBytes() const noexcept {
+	const size_t length = maxLineLength + 1;
+	size_t bytes = sizeof(LineLayout) + chars.AllocatedBytes() + styles.AllocatedBytes() + positions.AllocatedBytes();
+	bytes += lenLineStarts * sizeof(int);
+	bytes += blockHashes.capacity() * sizeof(size_t);
+	if (bidiData) {
+		bytes += sizeof(BidiData) + length * (sizeof(FontAlias) + sizeof(XYPOSITION));
+	}
+	return bytes;
+}
+
 void LineLayout::Invalidate(validLevel validity_) noexcept {
 	if (validity > validity_)
 		validity = validity_;
@@ -352,55 +388,60 @@ XYPOSITION ScreenLine::TabPositionAfter(XYPOSITION xPosition) const noexcept {
 
 LineLayoutCache::LineLayoutCache() :
 	level(0),
-	allInvalidated(false), styleClock(-1), useCount(0) {
-	Allocate(0);
+	allInvalidated(false), styleClock(-1), useCount(0),
+	useClock(0), memoryUsed(0), memoryBudget(16*1024*1024) {
 }
 
 LineLayoutCache::~LineLayoutCache() {
 	Deallocate();
 }
 
-void LineLayoutCache::Allocate(size_t length_) {
-	PLATFORM_ASSERT(cache.empty());
-	allInvalidated = false;
-	cache.resize(length_);
-}
-
-void LineLayoutCache::AllocateForLevel(Sci::Line linesOnScreen, Sci::Line linesInDoc) {
+// Discard least recently used layouts until memory used is below three quarters of budget,
+// so trimming is not needed again for a while.
+// A screen of layouts is always kept so painting does not discard layouts it is about to reuse.
+void LineLayoutCache::Trim(Sci::Line linesOnScreen, Sci::Line linesInDoc) {
 	PLATFORM_ASSERT(useCount == 0);
-	size_t lengthForLevel = 0;
-	if (level == llcCaret) {
-		lengthForLevel = 1;
-	} else if (level == llcPage) {
-		lengthForLevel = linesOnScreen + 1;
-	} else if (level == llcDocument) {
-		lengthForLevel = linesInDoc;
-	}
-	if (lengthForLevel > cache.size()) {
-		Deallocate();
-		Allocate(lengthForLevel);
-	} else {
-		if (lengthForLevel < cache.size()) {
-			for (size_t i = lengthForLevel; i < cache.size(); i++) {
-				cache[i].reset();
-			}
+	const size_t memoryTarget = memoryBudget - memoryBudget / 4;
+	const size_t minLayouts = linesOnScreen + 1;
+
+	// lines beyond the document end are never retrieved again
+	auto it = cache.lower_bound(linesInDoc);
+	while (it != cache.end()) {
+		memoryUsed -= it->second->bytesInCache;
+		it = cache.erase(it);
+	}
+	if (memoryUsed <= memoryTarget || cache.size() <= minLayouts) {
+		return;
+	}
+
+	std::vector<std::pair<size_t, Sci::Line>> uses;
+	uses.reserve(cache.size());
+	for (const auto &entry : cache) {
+		uses.emplace_back(entry.second->lastUse, entry.first);
+	}
+	std::sort(uses.begin(), uses.end());
+	size_t layouts = cache.size();
+	for (const auto &use : uses) {
+		if (memoryUsed <= memoryTarget || layouts <= minLayouts) {
+			break;
 		}
-		cache.resize(lengthForLevel);
+		it = cache.find(use.second);
+		memoryUsed -= it->second->bytesInCache;
+		cache.erase(it);
+		layouts--;
 	}
-	PLATFORM_ASSERT(cache.size() == lengthForLevel);
 }
 
 void LineLayoutCache::Deallocate() noexcept {
 	PLATFORM_ASSERT(useCount == 0);
 	cache.clear();
+	memoryUsed = 0;
 }
 
 void LineLayoutCache::Invalidate(LineLayout::validLevel validity_) noexcept {
 	if (!cache.empty() && !allInvalidated) {
-		for (const auto &ll : cache) {
-			if (ll) {
-				ll->Invalidate(validity_);
-			}
+		for (const auto &entry : cache) {
+			entry.second->Invalidate(validity_);
 		}
 		if (validity_ == LineLayout::llInvalid) {
 			allInvalidated = true;
@@ -416,44 +457,41 @@ void LineLayoutCache::SetLevel(int level_) noexcept {
 	}
 }
 
-LineLayout *LineLayoutCache::Retrieve(Sci::Line lineNumber, Sci::Line lineCaret, int maxChars, int styleClock_,
+void LineLayoutCache::SetMemoryBudget(size_t memoryBudget_) noexcept {
+	memoryBudget = memoryBudget_;
+}
+
+LineLayout *LineLayoutCache::Retrieve(Sci::Line lineNumber, int maxChars, int styleClock_,
 	Sci::Line linesOnScreen, Sci::Line linesInDoc) {
-	AllocateForLevel(linesOnScreen, linesInDoc);
 	if (styleClock != styleClock_) {
 		Invalidate(LineLayout::llCheckTextAndStyle);
 		styleClock = styleClock_;
 	}
 	allInvalidated = false;
-	Sci::Position pos = -1;
 	LineLayout *ret = nullptr;
-	if (level == llcCaret) {
-		pos = 0;
-	} else if (level == llcPage) {
-		if (lineNumber == lineCaret) {
-			pos = 0;
-		} else if (cache.size() > 1) {
-			pos = 1 + (lineNumber % (cache.size() - 1));
-		}
-	} else if (level == llcDocument) {
-		pos = lineNumber;
-	}
-	if (pos >= 0) {
+	if (level != llcNone) {
 		PLATFORM_ASSERT(useCount == 0);
-		if (!cache.empty() && (pos < static_cast<int>(cache.size()))) {
-			if (cache[pos]) {
-				if ((cache[pos]->lineNumber != lineNumber) ||
-					(cache[pos]->maxLineLength < maxChars)) {
-					cache[pos].reset();
-				}
+		if (level == llcCaret) {
+			// Only a single layout, for any line.
+			if (!cache.empty() && cache.begin()->first != lineNumber) {
+				Deallocate();
 			}
-			if (!cache[pos]) {
-				cache[pos] = std::make_unique<LineLayout>(maxChars);
-			}
-			cache[pos]->lineNumber = lineNumber;
-			cache[pos]->inCache = true;
-			ret = cache[pos].get();
-			useCount++;
+		} else if (memoryUsed > memoryBudget) {
+			Trim(linesOnScreen, linesInDoc);
+		}
+		std::unique_ptr<LineLayout> &ll = cache[lineNumber];
+		if (ll && (ll->maxLineLength < maxChars)) {
+			memoryUsed -= ll->bytesInCache;
+			ll.reset();
 		}
+		if (!ll) {
+			ll = std::make_unique<LineLayout>(maxChars);
+			ll->lineNumber = lineNumber;
+			ll->inCache = true;
+		}
+		ll->lastUse = ++useClock;
+		ret = ll.get();
+		useCount++;
 	}
 
 	if (!ret) {
@@ -471,6 +509,10 @@ void LineLayoutCache::Dispose(LineLayout *ll) noexcept {
 			delete ll;
 		} else {
 			useCount--;
+			// layout may have grown while in use
+			const size_t bytes = ll->AllocatedBytes();
+			memoryUsed = memoryUsed - ll->bytesInCache + bytes;
+			ll->bytesInCache = bytes;
 		}
 	}
 }
@@ -556,9 +598,9 @@ void BreakFinder::Insert(Sci::Position val) {
 BreakFinder::BreakFinder(const LineLayout *ll_, const Selection *psel, Range lineRange_, Sci::Position posLineStart_,
 	int xStart, bool breakForSelection, const Document *pdoc_, const SpecialRepresentations *preprs_, const ViewStyle *pvsDraw) :
 	ll(ll_),
-	lineRange(lineRange_),
+	lineRange(ll_->HeldPart(lineRange_)),
 	posLineStart(posLineStart_),
-	nextBreak(static_cast<int>(lineRange_.start)),
+	nextBreak(static_cast<int>(lineRange.start)),
 	saeCurrentPos(0),
 	saeNext(0),
 	subBreak(-1),
@@ -613,7 +655,7 @@ TextSegment BreakFinder::Next() {
 		while (nextBreak < lineRange.end) {
 			int charWidth = 1;
 			if (encodingFamily == efUnicode)
-				charWidth = UTF8DrawBytes(reinterpret_cast<unsigned char *>(&ll->chars[nextBreak]),
+				charWidth = UTF8DrawBytes(reinterpret_cast<const unsigned char *>(&ll->chars[nextBreak]),
 					static_cast<int>(lineRange.end - nextBreak));
 			else if (encodingFamily == efDBCS)
 				charWidth = pdoc->DBCSDrawBytes(
@@ -722,21 +764,38 @@ bool PositionCacheEntry::Retrieve(unsigned int styleNumber_, const char *s_,
 	}
 }
 
-// FNV-1 http://www.isthe.com/chongo/tech/comp/fnv/
+// FNV-1a http://www.isthe.com/chongo/tech/comp/fnv/
+// followed by the MurmurHash3 finalizer so both low bits (slot) and high bits (shard) are well mixed.
 unsigned int PositionCacheEntry::Hash(unsigned int styleNumber_, const char *s, unsigned int len_) noexcept {
 	const unsigned char *us = reinterpret_cast<const unsigned char *>(s);
-	unsigned int ret = us[0] << 7;
+	unsigned int ret = 2166136261U;
 	for (unsigned int i = 0; i < len_; i++) {
-		ret *= 1000003;
 		ret ^= us[i];
+		ret *= 16777619U;
 	}
-	ret *= 1000003;
-	ret ^= len_;
-	ret *= 1000003;
-	ret ^= styleNumber_;
+	ret ^= (styleNumber_ << 8) | len_;
+	ret *= 16777619U;
+	ret ^= ret >> 16;
+	ret *= 0x85ebca6bU;
+	ret ^= ret >> 13;
+	ret *= 0xc2b2ae35U;
+	ret ^= ret >> 16;
 	return ret;
 }
 
+// Hash of the cached text, used to place the entry when the cache grows.
+unsigned int PositionCacheEntry::Hash() const noexcept {
+	return Hash(styleNumber, reinterpret_cast<const char *>(&positions[len]), len);
+}
+
+void PositionCacheEntry::MoveFrom(PositionCacheEntry &other) noexcept {
+	styleNumber = other.styleNumber;
+	len = other.len;
+	clock = other.clock;
+	positions = std::move(other.positions);
+	other.Clear();
+}
+
 bool PositionCacheEntry::NewerThan(const PositionCacheEntry &other) const noexcept {
 	return clock > other.clock;
 }
@@ -747,35 +806,15 @@ void PositionCacheEntry::ResetClock() noexcept {
 	}
 }
 
-#define PositionCacheHashSizeUsePowerOfTwo	1
-PositionCache::PositionCache() {
-	clock = 1;
-#if PositionCacheHashSizeUsePowerOfTwo
-	pces.resize(2048);
-#else
-	pces.resize(2039);
-#endif
-	allClear = true;
-}
-
-PositionCache::~PositionCache() {
-	Clear();
+bool PositionCacheEntry::Empty() const noexcept {
+	return positions == nullptr;
 }
 
-void PositionCache::Clear() noexcept {
-	if (!allClear) {
-		for (auto &pce : pces) {
-			pce.Clear();
-		}
-	}
-	clock = 1;
-	allClear = true;
-}
+namespace {
 
-#if PositionCacheHashSizeUsePowerOfTwo
 // https://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2
 // Bit Twiddling Hacks Copyright 1997-2005 Sean Eron Anderson
-static constexpr size_t NextPowerOfTwo(size_t x) noexcept {
+constexpr size_t NextPowerOfTwo(size_t x) noexcept {
 	x--;
 	x |= x >> 1;
 	x |= x >> 2;
@@ -788,54 +827,216 @@ static constexpr size_t NextPowerOfTwo(size_t x) noexcept {
 	x++;
 	return x;
 }
-#endif
 
-void PositionCache::SetSize(size_t size_) {
+// The cache may grow up to this multiple of the size set by SCI_SETPOSITIONCACHE.
+constexpr size_t positionCacheGrowthLimit = 8;
+// Growth is considered after this many lookups in a shard.
+constexpr unsigned int positionCachePeriod = 1024;
+
+// Shards are selected by the top bits of the hash, slots by the low bits.
+constexpr size_t ShardFromHash(unsigned int hashValue) noexcept {
+	return hashValue >> 29;
+}
+
+// Two way associative: the second slot always differs from the first in its lowest bit.
+constexpr size_t SecondProbe(unsigned int hashValue, size_t mask) noexcept {
+	return (hashValue ^ ((hashValue >> 16) | 1)) & mask;
+}
+
+}
+
+void PositionCache::Shard::Clear() noexcept {
+	if (!allClear) {
+		for (auto &pce : pces) {
+			pce.Clear();
+		}
+	}
+	clock = 1;
+	allClear = true;
+	lookupsInPeriod = 0;
+	evictionsInPeriod = 0;
+}
+
+void PositionCache::Shard::Resize(size_t size_) {
 	Clear();
 	if (size_ != pces.size()) {
-#if PositionCacheHashSizeUsePowerOfTwo
-		if (size_ & (size_ - 1)) {
-			size_ = NextPowerOfTwo(size_);
-		}
-#endif
+		pces.clear();
 		pces.resize(size_);
 	}
 }
 
-void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
-	const char *s, unsigned int len, XYPOSITION *positions, const Document *pdoc) {
+// Entries are kept when growing, each is placed in one of its two slots for the new size.
+void PositionCache::Shard::Grow(size_t size_) {
+	std::vector<PositionCacheEntry> old(size_);
+	pces.swap(old);
+	const size_t mask = size_ - 1;
+	for (PositionCacheEntry &pce : old) {
+		if (!pce.Empty()) {
+			const unsigned int hashValue = pce.Hash();
+			size_t probe = hashValue & mask;
+			if (!pces[probe].Empty()) {
+				const size_t probe2 = SecondProbe(hashValue, mask);
+				if (pces[probe].NewerThan(pces[probe2])) {
+					probe = probe2;
+				}
+				if (!pces[probe].Empty() && pces[probe].NewerThan(pce)) {
+					continue;
+				}
+			}
+			pces[probe].MoveFrom(pce);
+		}
+	}
+}
 
+// Returns the slot holding the text or pces.size() when not cached.
+size_t PositionCache::Shard::Probe(unsigned int hashValue, unsigned int styleNumber, const char *s, unsigned int len, XYPOSITION *positions) {
+	const size_t size = pces.size();
+	if (size == 0) {
+		return size;
+	}
 	allClear = false;
-	size_t probe = pces.size();	// Out of bounds
-	if ((len < 64)) {
-		// Only store short strings in the cache so it doesn't churn with
-		// long comments with only a single comment.
-#if PositionCacheHashSizeUsePowerOfTwo
-		const size_t mask = probe - 1;
-#else
-		const size_t modulo = probe;
-#endif
-		// Two way associative: try two probe positions.
-		const unsigned int hashValue = PositionCacheEntry::Hash(styleNumber, s, len);
-#if PositionCacheHashSizeUsePowerOfTwo
-		probe = hashValue & mask;
-#else
-		probe = hashValue % modulo;
-#endif
-		if (pces[probe].Retrieve(styleNumber, s, len, positions)) {
-			return;
+	lookupsInPeriod++;
+	const size_t mask = size - 1;
+	const size_t probe = hashValue & mask;
+	if (pces[probe].Retrieve(styleNumber, s, len, positions)) {
+		hits++;
+		return probe;
+	}
+	const size_t probe2 = SecondProbe(hashValue, mask);
+	if (pces[probe2].Retrieve(styleNumber, s, len, positions)) {
+		hits++;
+		return probe2;
+	}
+	misses++;
+	return size;
+}
+
+void PositionCache::Shard::Store(unsigned int hashValue, unsigned int styleNumber, const char *s, unsigned int len, const XYPOSITION *positions, size_t sizeLimit) {
+	size_t size = pces.size();
+	if (size == 0) {
+		return;
+	}
+	if (lookupsInPeriod >= positionCachePeriod) {
+		// Grow when a quarter of recent lookups had to throw away a live entry.
+		if (evictionsInPeriod >= positionCachePeriod / 4 && size < sizeLimit) {
+			size *= 2;
+			Grow(size);
 		}
-#if PositionCacheHashSizeUsePowerOfTwo
-		const unsigned int probe2 = (hashValue * 37) & mask;
-#else
-		const unsigned int probe2 = (hashValue * 37) % modulo;
-#endif
-		if (pces[probe2].Retrieve(styleNumber, s, len, positions)) {
+		lookupsInPeriod = 0;
+		evictionsInPeriod = 0;
+	}
+
+	// Slots are chosen here rather than in Probe as another thread may have filled or resized the shard.
+	const size_t mask = size - 1;
+	size_t probe = hashValue & mask;
+	const size_t probe2 = SecondProbe(hashValue, mask);
+	// Choose the oldest of the two slots to replace
+	if (pces[probe].NewerThan(pces[probe2])) {
+		probe = probe2;
+	}
+	if (!pces[probe].Empty()) {
+		evictions++;
+		evictionsInPeriod++;
+	}
+
+	clock++;
+	if (clock > 60000) {
+		// Since there are only 16 bits for the clock, wrap it round and
+		// reset all cache entries so none get stuck with a high clock.
+		for (PositionCacheEntry &pce : pces) {
+			pce.ResetClock();
+		}
+		clock = 2;
+	}
+	pces[probe].Set(styleNumber, s, len, positions, clock);
+}
+
+PositionCache::PositionCache() {
+	sizeShardLimit = 0;
+	sizeRequested = 0;
+	SetSize(2048);
+}
+
+PositionCache::~PositionCache() {
+	Clear();
+}
+
+void PositionCache::Clear() noexcept {
+	for (Shard &shard : shards) {
+		shard.Clear();
+	}
+}
+
+void PositionCache::SetSize(size_t size_) {
+	size_t sizeShard = 0;
+	if (size_ != 0) {
+		sizeShard = NextPowerOfTwo((size_ + shardCount - 1) / shardCount);
+	}
+	sizeShardLimit = sizeShard * positionCacheGrowthLimit;
+	sizeRequested = size_;
+	for (Shard &shard : shards) {
+		shard.Resize(sizeShard);
+	}
+}
+
+// The size set, shards round it up and may grow on demand.
+size_t PositionCache::GetSize() const noexcept {
+	return sizeRequested;
+}
+
+size_t PositionCache::GetStatistic(int statistic) const noexcept {
+	size_t value = 0;
+	for (const Shard &shard : shards) {
+		// counters are updated under the lock by threads laying out lines.
+		std::lock_guard<std::mutex> guard(shard.mutex);
+		switch (statistic) {
+		case SC_POSITIONCACHESTATISTIC_HITS:
+			value += shard.hits;
+			break;
+		case SC_POSITIONCACHESTATISTIC_MISSES:
+			value += shard.misses;
+			break;
+		case SC_POSITIONCACHESTATISTIC_EVICTIONS:
+			value += shard.evictions;
+			break;
+		default:
+			break;
+		}
+	}
+	return value;
+}
+
+void PositionCache::ResetStatistics() noexcept {
+	for (Shard &shard : shards) {
+		std::lock_guard<std::mutex> guard(shard.mutex);
+		shard.hits = 0;
+		shard.misses = 0;
+		shard.evictions = 0;
+	}
+}
+
+void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
+	const char *s, unsigned int len, XYPOSITION *positions, const Document *pdoc, bool callerMultiThreaded) {
+
+	// Only store short strings in the cache so it doesn't churn with
+	// long comments with only a single comment.
+	const bool cacheable = len < 64;
+	unsigned int hashValue = 0;
+	Shard *shard = nullptr;
+	// the lock is not held while measuring, other threads can use the shard meanwhile.
+	std::unique_lock<std::mutex> guard;
+	if (cacheable) {
+		hashValue = PositionCacheEntry::Hash(styleNumber, s, len);
+		shard = &shards[ShardFromHash(hashValue)];
+		if (callerMultiThreaded) {
+			guard = std::unique_lock<std::mutex>(shard->mutex);
+		}
+		const size_t probe = shard->Probe(hashValue, styleNumber, s, len, positions);
+		if (probe < shard->pces.size()) {
 			return;
 		}
-		// Not found. Choose the oldest of the two slots to replace
-		if (pces[probe].NewerThan(pces[probe2])) {
-			probe = probe2;
+		if (callerMultiThreaded) {
+			guard.unlock();
 		}
 	}
 	const FontAlias fontStyle = vstyle.styles[styleNumber].font;
@@ -855,17 +1056,11 @@ void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, uns
 	} else {
 		surface->MeasureWidths(fontStyle, std::string_view(s, len), positions);
 	}
-	if (probe < pces.size()) {
+	if (shard) {
 		// Store into cache
-		clock++;
-		if (clock > 60000) {
-			// Since there are only 16 bits for the clock, wrap it round and
-			// reset all cache entries so none get stuck with a high clock.
-			for (PositionCacheEntry &pce : pces) {
-				pce.ResetClock();
-			}
-			clock = 2;
+		if (callerMultiThreaded) {
+			guard.lock();
 		}
-		pces[probe].Set(styleNumber, s, len, positions, clock);
+		shard->Store(hashValue, styleNumber, s, len, positions, sizeShardLimit);
 	}
 }
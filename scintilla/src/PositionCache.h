@@ -43,6 +43,99 @@ public:
 	void Resize(size_t maxLineLength_);
 };
 
+/**
+* Characters or styles of a line layout, indexed by position in the line.
+* Only the held part of the line is stored, reading elsewhere gives a placeholder.
+*/
+template <typename T>
+class LineArray {
+	std::unique_ptr<T[]> data;
+	int start = 0;
+	int length = 0;
+	int allocated = 0;
+	T outside {};
+public:
+	// Hold length_ elements from start_ with room for extra more, contents are not kept.
+	void Hold(int start_, int length_, int extra = 0) {
+		const int size = length_ + extra;
+		if (size > allocated || (allocated > 2 * size && allocated > 0x10000)) {
+			data = std::make_unique<T[]>(size);
+			allocated = size;
+		}
+		start = start_;
+		length = length_;
+	}
+	void Free() noexcept {
+		data.reset();
+		start = 0;
+		length = 0;
+		allocated = 0;
+	}
+	int Start() const noexcept {
+		return start;
+	}
+	int Length() const noexcept {
+		return length;
+	}
+	bool Contains(Sci::Position position) const noexcept {
+		return position >= start && position < start + length;
+	}
+	// Writes must be inside the held range, block indexing bugs should fail instead of writing outside.
+	T &operator[](Sci::Position position) noexcept {
+		PLATFORM_ASSERT(Contains(position));
+		return data[position - start];
+	}
+	// Reads outside of the held range return a default element.
+	const T &operator[](Sci::Position position) const noexcept {
+		return Contains(position) ? data[position - start] : outside;
+	}
+	// Elements from a held position, for filling the array or passing to platform calls.
+	T *Data(Sci::Position position) noexcept {
+		return data.get() + (position - start);
+	}
+	size_t AllocatedBytes() const noexcept {
+		return allocated * sizeof(T);
+	}
+};
+
+/**
+* X positions of a line layout, indexed by position in the line.
+* A windowed line holds positions for part of the line, elsewhere positions are interpolated
+* from the x of each block start.
+*/
+class LinePositions {
+	LineArray<XYPOSITION> held;
+	XYPOSITION Outside(Sci::Position position) const noexcept;
+public:
+	// For windowed lines: start of each block followed by the line length, and x of each of these.
+	std::vector<int> blockStarts;
+	std::vector<XYPOSITION> blockX;
+
+	void Hold(int start_, int length_) {
+		// Extra position allocated as sometimes the Windows
+		// GetTextExtentExPoint API writes an extra element.
+		held.Hold(start_, length_, 1);
+	}
+	void Free() noexcept {
+		held.Free();
+		blockStarts.clear();
+		blockX.clear();
+	}
+	bool Contains(Sci::Position position) const noexcept {
+		return held.Contains(position);
+	}
+	XYPOSITION operator[](Sci::Position position) const noexcept {
+		return held.Contains(position) ? held[position] : Outside(position);
+	}
+	// Positions from a held position, for layout.
+	XYPOSITION *Data(Sci::Position position) noexcept {
+		return held.Data(position);
+	}
+	size_t AllocatedBytes() const noexcept {
+		return held.AllocatedBytes() + blockStarts.capacity() * sizeof(int) + blockX.capacity() * sizeof(XYPOSITION);
+	}
+};
+
 /**
  */
 class LineLayout {
@@ -53,10 +146,18 @@ private:
 	/// Drawing is only performed for @a maxLineLength characters on each line.
 	Sci::Line lineNumber;
 	bool inCache;
+	// when last retrieved from and how much memory is accounted to the cache
+	size_t lastUse;
+	size_t bytesInCache;
 public:
 	enum {
 		wrapWidthInfinite = 0x7ffffff
 	};
+	// Lines longer than this are windowed when not wrapped: the line is split into blocks
+	// which are measured in order from the line start as far as display or queries need,
+	// and only the blocks around where the line is used are held.
+	static constexpr int lengthWindowed = 256*1024;
+	static constexpr int lengthWindowBlock = 4096;
 
 	int maxLineLength;
 	int numCharsInLine;
@@ -68,13 +169,20 @@ public:
 	bool highlightColumn;
 	bool containsCaret;
 	int edgeColumn;
-	std::unique_ptr<char[]> chars;
-	std::unique_ptr<unsigned char[]> styles;
-	std::unique_ptr<XYPOSITION[]> positions;
+	LineArray<char> chars;
+	LineArray<unsigned char> styles;
+	LinePositions positions;
 	char bracePreviousStyles[2];
 
 	std::unique_ptr<BidiData> bidiData;
 
+	// For windowed lines: hash of the text and styles of each block, how many blocks from the
+	// line start have their positions measured and the range of blocks held.
+	std::vector<size_t> blockHashes;
+	size_t blocksMeasured;
+	size_t blockHeldFirst;
+	size_t blockHeldEnd;
+
 	// Hotspot support
 	Range hotspot;
 
@@ -91,8 +199,25 @@ public:
 	void operator=(LineLayout &&) = delete;
 	virtual ~LineLayout();
 	void Resize(int maxLineLength_);
+	void Hold(int start, int length);
+	bool Windowed() const noexcept {
+		return !positions.blockStarts.empty();
+	}
+	size_t Blocks() const noexcept {
+		return blockHashes.size();
+	}
+	// Part of range whose text is held, only differs from range for windowed lines.
+	Range HeldPart(Range range) const noexcept {
+		const Sci::Position heldEnd = chars.Start() + chars.Length() - 1;
+		const Sci::Position start = std::clamp<Sci::Position>(range.start, chars.Start(), heldEnd);
+		return Range(start, std::clamp<Sci::Position>(range.end, start, heldEnd));
+	}
+	Range BlockRange(size_t first, size_t end) const noexcept {
+		return Range(positions.blockStarts[first], positions.blockStarts[end]);
+	}
 	void EnsureBidiData();
 	void Free() noexcept;
+	size_t AllocatedBytes() const noexcept;
 	void Invalidate(validLevel validity_) noexcept;
 	int LineStart(int line) const;
 	int LineLength(int line) const;
@@ -147,12 +272,16 @@ struct ScreenLine : public IScreenLine {
  */
 class LineLayoutCache {
 	int level;
-	std::vector<std::unique_ptr<LineLayout>>cache;
+	// Layouts by line. For page and document levels, least recently used layouts
+	// are discarded when memory used exceeds memoryBudget.
+	std::map<Sci::Line, std::unique_ptr<LineLayout>> cache;
 	bool allInvalidated;
 	int styleClock;
 	int useCount;
-	void Allocate(size_t length_);
-	void AllocateForLevel(Sci::Line linesOnScreen, Sci::Line linesInDoc);
+	size_t useClock;
+	size_t memoryUsed;
+	size_t memoryBudget;
+	void Trim(Sci::Line linesOnScreen, Sci::Line linesInDoc);
 public:
 	LineLayoutCache();
 	// Deleted so LineLayoutCache objects can not be copied.
@@ -173,7 +302,11 @@ public:
 	int GetLevel() const noexcept {
 		return level;
 	}
-	LineLayout *Retrieve(Sci::Line lineNumber, Sci::Line lineCaret, int maxChars, int styleClock_,
+	void SetMemoryBudget(size_t memoryBudget_) noexcept;
+	size_t GetMemoryBudget() const noexcept {
+		return memoryBudget;
+	}
+	LineLayout *Retrieve(Sci::Line lineNumber, int maxChars, int styleClock_,
 		Sci::Line linesOnScreen, Sci::Line linesInDoc);
 	void Dispose(LineLayout *ll) noexcept;
 };
@@ -196,8 +329,11 @@ public:
 	void Clear() noexcept;
 	bool Retrieve(unsigned int styleNumber_, const char *s_, unsigned int len_, XYPOSITION *positions_) const;
 	static unsigned int Hash(unsigned int styleNumber_, const char *s, unsigned int len_) noexcept;
+	unsigned int Hash() const noexcept;
+	void MoveFrom(PositionCacheEntry &other) noexcept;
 	bool NewerThan(const PositionCacheEntry &other) const noexcept;
 	void ResetClock() noexcept;
+	bool Empty() const noexcept;
 };
 
 class Representation {
@@ -268,9 +404,32 @@ public:
 };
 
 class PositionCache {
-	std::vector<PositionCacheEntry> pces;
-	unsigned int clock;
-	bool allClear;
+	// Entries are split into shards chosen by hash, each with its own lock, clock and statistics,
+	// so threads laying out lines at the same time seldom wait for each other.
+	struct Shard {
+		std::vector<PositionCacheEntry> pces;
+		unsigned int clock = 1;
+		bool allClear = true;
+		// guards the shard when layout is performed on multiple threads.
+		mutable std::mutex mutex;
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t evictions = 0;
+		// lookups and evictions since last considering growth
+		unsigned int lookupsInPeriod = 0;
+		unsigned int evictionsInPeriod = 0;
+		void Clear() noexcept;
+		void Resize(size_t size_);
+		void Grow(size_t size_);
+		size_t Probe(unsigned int hashValue, unsigned int styleNumber, const char *s, unsigned int len, XYPOSITION *positions);
+		void Store(unsigned int hashValue, unsigned int styleNumber, const char *s, unsigned int len, const XYPOSITION *positions, size_t sizeLimit);
+	};
+	static constexpr size_t shardCount = 8;
+	Shard shards[shardCount];
+	// shards grow on demand up to this size
+	size_t sizeShardLimit;
+	// size set by SCI_SETPOSITIONCACHE
+	size_t sizeRequested;
 public:
 	PositionCache();
 	// Deleted so PositionCache objects can not be copied.
@@ -281,11 +440,11 @@ public:
 	~PositionCache();
 	void Clear() noexcept;
 	void SetSize(size_t size_);
-	size_t GetSize() const noexcept {
-		return pces.size();
-	}
+	size_t GetSize() const noexcept;
+	size_t GetStatistic(int statistic) const noexcept;
+	void ResetStatistics() noexcept;
 	void MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
-		const char *s, unsigned int len, XYPOSITION *positions, const Document *pdoc);
+		const char *s, unsigned int len, XYPOSITION *positions, const Document *pdoc, bool callerMultiThreaded = false);
 };
 
 }
@@ -18,6 +18,7 @@
 #include <map>
 #include <algorithm>
 #include <memory>
+#include <mutex>
 
 #include "Platform.h"
 
@@ -1111,6 +1112,8 @@ sptr_t ScintillaBase::WndProc(unsigned int iMessage, uptr_t wParam, sptr_t lPara
 			NotifyStyleToNeeded((lParam == -1) ? pdoc->Length() : lParam);
 		} else {
 			DocumentLexState()->Colourise(wParam, lParam);
+			// explicit request also computes fold levels deferred by fold on demand.
+			pdoc->EnsureFoldedTo((lParam == -1) ? pdoc->Length() : lParam);
 		}
 		Redraw();
 		break;
@@ -46,6 +46,8 @@ struct FontMeasurements {
 	XYPOSITION capitalHeight;	// Top of capital letter to baseline: ascent - internal leading
 	XYPOSITION aveCharWidth;
 	XYPOSITION spaceWidth;
+	XYPOSITION monospaceCharacterWidth;	// width of each ASCII graphic character when monospaceASCII
+	bool monospaceASCII;	// space and all ASCII graphic characters have the same width
 	int sizeZoomed;
 	FontMeasurements() noexcept;
 	void ClearMeasurements() noexcept;
@@ -6,20 +6,246 @@
 // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
 
 #include <stdexcept>
 #include <string>
 #include <string_view>
 
+#include "VectorISA.h"
 #include "UniConversion.h"
 
 using namespace Scintilla;
 
+namespace {
+
+#if NP2_USE_SSE2
+// Runs of ASCII are converted 32 bytes or 16 UTF-16 code units at a time, runs of 2 byte
+// UTF-8 characters and, with AVX2 (which implies SSSE3), of 3 byte characters 8 at a time.
+// Each block is validated first and only its leading well-formed characters are converted
+// and stored, other characters are handled by the scalar code, so results are identical.
+// UTF-16 code units are kept in 16-bit lanes whatever the size of wchar_t.
+constexpr size_t asciiBlockUTF8 = 32;
+constexpr size_t asciiBlockUTF16 = 16;
+constexpr size_t blockUTF16 = 8;
+// bytes read for 8 characters of 2 bytes, and of 3 bytes in two overlapped loads.
+constexpr size_t twoByteBlockUTF8 = 16;
+constexpr size_t threeByteBlockUTF8 = 12 + 16;
+
+// 8 code units at ptr, units above 0xFFFF become a lone surrogate so they are left to the scalar code.
+inline __m128i LoadUTF16(const wchar_t *ptr) noexcept {
+	if constexpr (sizeof(wchar_t) == 2) {
+		return _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+	} else {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i bias = _mm_set1_epi32(0x8000);
+		const __m128i chunk1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+		const __m128i chunk2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr + sizeof(__m128i)/sizeof(wchar_t)));
+		// signed saturation keeps 0 to 0xFFFF when biased
+		const __m128i units = _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(chunk1, bias), _mm_sub_epi32(chunk2, bias)), _mm_set1_epi16(static_cast<short>(0x8000)));
+		const __m128i bmp = _mm_packs_epi32(_mm_cmpeq_epi32(_mm_srli_epi32(chunk1, 16), zero), _mm_cmpeq_epi32(_mm_srli_epi32(chunk2, 16), zero));
+		return _mm_or_si128(_mm_and_si128(bmp, units), _mm_andnot_si128(bmp, _mm_set1_epi16(static_cast<short>(SURROGATE_LEAD_FIRST))));
+	}
+}
+
+// store the first length bytes of value, the buffer after them is left as is unless whole is set:
+// storing all 16 bytes is faster when the rest is overwritten later or is not used.
+inline void StoreBytes(char *ptr, __m128i value, size_t length, bool whole) noexcept {
+	if (whole || length == sizeof(__m128i)) {
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(ptr), value);
+		return;
+	}
+	if (length & 8) {
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(ptr), value);
+		value = _mm_srli_si128(value, 8);
+		ptr += 8;
+	}
+	if (length & 4) {
+		const uint32_t dword = _mm_cvtsi128_si32(value);
+		memcpy(ptr, &dword, 4);
+		value = _mm_srli_si128(value, 4);
+		ptr += 4;
+	}
+	uint32_t rest = _mm_cvtsi128_si32(value);
+	if (length & 2) {
+		memcpy(ptr, &rest, 2);
+		rest >>= 16;
+		ptr += 2;
+	}
+	if (length & 1) {
+		*ptr = static_cast<char>(rest);
+	}
+}
+
+// store the leading count of the 8 code units, or all of them when whole is set.
+inline void StoreUTF16(wchar_t *ptr, __m128i units, size_t count, bool whole) noexcept {
+	if constexpr (sizeof(wchar_t) == 2) {
+		StoreBytes(reinterpret_cast<char *>(ptr), units, count*sizeof(wchar_t), whole);
+	} else {
+		const __m128i zero = _mm_setzero_si128();
+		constexpr size_t half = sizeof(__m128i)/sizeof(wchar_t);
+		if (count <= half && !whole) {
+			StoreBytes(reinterpret_cast<char *>(ptr), _mm_unpacklo_epi16(units, zero), count*sizeof(wchar_t), false);
+		} else {
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(ptr), _mm_unpacklo_epi16(units, zero));
+			StoreBytes(reinterpret_cast<char *>(ptr + half), _mm_unpackhi_epi16(units, zero), (count - half)*sizeof(wchar_t), whole);
+		}
+	}
+}
+
+// number of leading 16-bit lanes set in mask returned by _mm_movemask_epi8().
+inline uint32_t LeadingLanes(uint32_t mask) noexcept {
+	return np2_ctz(~mask) / 2;
+}
+
+// bit set for each byte >= 0x80 in the 32 bytes at ptr.
+inline uint32_t NonASCIIMaskUTF8(const char *ptr) noexcept {
+#if NP2_USE_AVX2
+	return _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr)));
+#else
+	const uint32_t mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr)));
+	return mask | (static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr + sizeof(__m128i))))) << sizeof(__m128i));
+#endif
+}
+
+// bit set for each code unit in the 16 at ptr that is not ASCII or is NUL,
+// packed contains the code units as bytes when all are ASCII.
+inline uint32_t NonASCIIMaskUTF16(const wchar_t *ptr, __m128i &packed) noexcept {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i highBits = _mm_set1_epi16(static_cast<short>(0xFF80));
+	const __m128i chunk1 = LoadUTF16(ptr);
+	const __m128i chunk2 = LoadUTF16(ptr + blockUTF16);
+	const __m128i ascii1 = _mm_andnot_si128(_mm_cmpeq_epi16(chunk1, zero), _mm_cmpeq_epi16(_mm_and_si128(chunk1, highBits), zero));
+	const __m128i ascii2 = _mm_andnot_si128(_mm_cmpeq_epi16(chunk2, zero), _mm_cmpeq_epi16(_mm_and_si128(chunk2, highBits), zero));
+	packed = _mm_packus_epi16(chunk1, chunk2);
+	return ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(ascii1, ascii2))) & 0xffff;
+}
+
+// number of leading well-formed 2 byte characters in the 16 bytes at ptr, converted into units.
+inline uint32_t UTF16FromUTF8TwoBytes(const char *ptr, __m128i &units) noexcept {
+	const __m128i zero = _mm_setzero_si128();
+	// lead byte in low byte and trail byte in high byte of each 16-bit lane
+	const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+	const __m128i form = _mm_cmpeq_epi16(_mm_and_si128(chunk, _mm_set1_epi16(static_cast<short>(0xC0E0))), _mm_set1_epi16(static_cast<short>(0x80C0)));
+	units = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(chunk, _mm_set1_epi16(0x1F)), 6), _mm_and_si128(_mm_srli_epi16(chunk, 8), _mm_set1_epi16(0x3F)));
+	// overlong when below 0x80
+	const __m128i overlong = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(0x780)), zero);
+	return LeadingLanes(_mm_movemask_epi8(_mm_andnot_si128(overlong, form)));
+}
+
+#if NP2_USE_AVX2
+// 4 characters of 3 bytes from the 12 bytes at ptr in 32-bit lanes, form is set for well-formed ones.
+inline __m128i UTF16FromUTF8FourChars(const char *ptr, __m128i &form) noexcept {
+	// bytes of each character as lead << 16 | trail << 8 | trail
+	const __m128i spread = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+	const __m128i lanes = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr)), spread);
+	form = _mm_cmpeq_epi32(_mm_and_si128(lanes, _mm_set1_epi32(0xF0C0C0)), _mm_set1_epi32(0xE08080));
+	const __m128i lead = _mm_and_si128(_mm_srli_epi32(lanes, 4), _mm_set1_epi32(0xF000));
+	const __m128i trail = _mm_and_si128(_mm_srli_epi32(lanes, 2), _mm_set1_epi32(0x0FC0));
+	return _mm_or_si128(_mm_or_si128(lead, trail), _mm_and_si128(lanes, _mm_set1_epi32(0x3F)));
+}
+
+// number of leading well-formed 3 byte characters in the 28 bytes at ptr, converted into units.
+inline uint32_t UTF16FromUTF8ThreeBytes(const char *ptr, __m128i &units) noexcept {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i narrow = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+	__m128i form1;
+	__m128i form2;
+	const __m128i value1 = UTF16FromUTF8FourChars(ptr, form1);
+	const __m128i value2 = UTF16FromUTF8FourChars(ptr + 12, form2);
+	units = _mm_unpacklo_epi64(_mm_shuffle_epi8(value1, narrow), _mm_shuffle_epi8(value2, narrow));
+	// overlong when below 0x800, surrogates are not encoded in UTF-8
+	const __m128i high = _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xF800)));
+	const __m128i invalid = _mm_or_si128(_mm_cmpeq_epi16(high, zero), _mm_cmpeq_epi16(high, _mm_set1_epi16(static_cast<short>(SURROGATE_LEAD_FIRST))));
+	return LeadingLanes(_mm_movemask_epi8(_mm_andnot_si128(invalid, _mm_packs_epi32(form1, form2))));
+}
+#endif
+
+// UTF-8 length of the leading code units that are not NUL or surrogate, count is set to number of them.
+inline uint32_t UTF8LengthOfUnits(__m128i units, uint32_t &count) noexcept {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i high = _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xF800)));
+	const __m128i stop = _mm_or_si128(_mm_cmpeq_epi16(units, zero), _mm_cmpeq_epi16(high, _mm_set1_epi16(static_cast<short>(SURROGATE_LEAD_FIRST))));
+	count = LeadingLanes(~_mm_movemask_epi8(stop) & 0xffff);
+	// 3 bytes, less 1 below 0x800 and 1 more below 0x80
+	const __m128i below80 = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xFF80))), zero);
+	const __m128i below800 = _mm_cmpeq_epi16(high, zero);
+	const __m128i leading = _mm_cmplt_epi16(_mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7), _mm_set1_epi16(static_cast<short>(count)));
+	const __m128i bytes = _mm_and_si128(leading, _mm_add_epi16(_mm_add_epi16(_mm_set1_epi16(3), below80), below800));
+	__m128i sum = _mm_madd_epi16(bytes, _mm_set1_epi16(1));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+// number of leading code units from 0x80 to 0x7FF, converted to 2 byte characters in bytes.
+inline uint32_t UTF8FromUTF16TwoBytes(__m128i units, __m128i &bytes) noexcept {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i valid = _mm_andnot_si128(_mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xFF80))), zero),
+		_mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xF800))), zero));
+	const __m128i lead = _mm_or_si128(_mm_srli_epi16(units, 6), _mm_set1_epi16(0xC0));
+	const __m128i trail = _mm_slli_epi16(_mm_or_si128(_mm_and_si128(units, _mm_set1_epi16(0x3F)), _mm_set1_epi16(0x80)), 8);
+	bytes = _mm_or_si128(lead, trail);
+	return LeadingLanes(_mm_movemask_epi8(valid));
+}
+
+#if NP2_USE_AVX2
+// number of leading code units from 0x800 to 0xFFFF except surrogates, converted to 3 byte characters,
+// 12 bytes for first 4 units in bytes1 and for last 4 units in bytes2.
+inline uint32_t UTF8FromUTF16ThreeBytes(__m128i units, __m128i &bytes1, __m128i &bytes2) noexcept {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i high = _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xF800)));
+	const __m128i invalid = _mm_or_si128(_mm_cmpeq_epi16(high, zero), _mm_cmpeq_epi16(high, _mm_set1_epi16(static_cast<short>(SURROGATE_LEAD_FIRST))));
+	const __m128i mask = _mm_set1_epi16(0x3F);
+	const __m128i tag = _mm_set1_epi16(0x80);
+	// lead byte and first trail byte in each 16-bit lane, last trail bytes packed after them
+	const __m128i lead = _mm_or_si128(_mm_srli_epi16(units, 12), _mm_set1_epi16(0xE0));
+	const __m128i trail1 = _mm_slli_epi16(_mm_or_si128(_mm_and_si128(_mm_srli_epi16(units, 6), mask), tag), 8);
+	const __m128i heads = _mm_or_si128(lead, trail1);
+	const __m128i trail2 = _mm_packus_epi16(_mm_or_si128(_mm_and_si128(units, mask), tag), zero);
+	const __m128i join1 = _mm_setr_epi8(0, 1, 8, 2, 3, 9, 4, 5, 10, 6, 7, 11, -1, -1, -1, -1);
+	const __m128i join2 = _mm_setr_epi8(0, 1, 12, 2, 3, 13, 4, 5, 14, 6, 7, 15, -1, -1, -1, -1);
+	bytes1 = _mm_shuffle_epi8(_mm_unpacklo_epi64(heads, trail2), join1);
+	bytes2 = _mm_shuffle_epi8(_mm_unpackhi_epi64(heads, _mm_slli_si128(trail2, 8)), join2);
+	return LeadingLanes(~_mm_movemask_epi8(invalid) & 0xffff);
+}
+#endif
+#endif
+
+}
+
 namespace Scintilla {
 
 size_t UTF8Length(std::wstring_view wsv) noexcept {
 	size_t len = 0;
 	for (size_t i = 0; i < wsv.length() && wsv[i];) {
+#if NP2_USE_SSE2
+		if (i + asciiBlockUTF16 <= wsv.length() && static_cast<unsigned int>(wsv[i]) < 0x80 && static_cast<unsigned int>(wsv[i + 1]) < 0x80) {
+			__m128i packed;
+			const uint32_t mask = NonASCIIMaskUTF16(wsv.data() + i, packed);
+			if (mask == 0) {
+				i += asciiBlockUTF16;
+				len += asciiBlockUTF16;
+				continue;
+			}
+			const uint32_t ascii = np2_ctz(mask);
+			i += ascii;
+			len += ascii;
+			if (!wsv[i]) {
+				break;
+			}
+		}
+		if (i + blockUTF16 <= wsv.length()) {
+			uint32_t count;
+			const uint32_t bytes = UTF8LengthOfUnits(LoadUTF16(wsv.data() + i), count);
+			if (count != 0) {
+				i += count;
+				len += bytes;
+				continue;
+			}
+		}
+#endif
 		const unsigned int uch = wsv[i];
 		if (uch < 0x80) {
 			len++;
@@ -49,10 +275,52 @@ size_t UTF8PositionFromUTF16Position(std::string_view u8Text, size_t positionUTF
 	return positionUTF8;
 }
 
+// putf has room for len bytes, a NUL is added when there is room after the text, bytes after the NUL may be changed.
 void UTF8FromUTF16(std::wstring_view wsv, char *putf, size_t len) noexcept {
 	size_t k = 0;
 	for (size_t i = 0; i < wsv.length() && wsv[i];) {
 		const unsigned int uch = wsv[i];
+#if NP2_USE_SSE2
+		// only for runs of characters of same width
+		if (uch < 0x80) {
+			if (i + asciiBlockUTF16 <= wsv.length() && static_cast<unsigned int>(wsv[i + 1]) < 0x80) {
+				__m128i packed;
+				const uint32_t mask = NonASCIIMaskUTF16(wsv.data() + i, packed);
+				const uint32_t ascii = (mask == 0) ? asciiBlockUTF16 : np2_ctz(mask);
+				StoreBytes(putf + k, packed, ascii, k + sizeof(__m128i) <= len);
+				i += ascii;
+				k += ascii;
+				continue;
+			}
+		} else if (uch < 0x800) {
+			if (i + blockUTF16 <= wsv.length() && static_cast<unsigned int>(wsv[i + 1]) - 0x80 < 0x780) {
+				__m128i bytes;
+				const uint32_t count = UTF8FromUTF16TwoBytes(LoadUTF16(wsv.data() + i), bytes);
+				StoreBytes(putf + k, bytes, 2*count, k + sizeof(__m128i) <= len);
+				i += count;
+				k += 2*count;
+				continue;
+			}
+		}
+#if NP2_USE_AVX2
+		else if (i + blockUTF16 <= wsv.length() && static_cast<unsigned int>(wsv[i + 1]) >= 0x800) {
+			__m128i bytes;
+			__m128i bytes2;
+			const uint32_t count = UTF8FromUTF16ThreeBytes(LoadUTF16(wsv.data() + i), bytes, bytes2);
+			if (count != 0) {
+				if (count <= blockUTF16/2) {
+					StoreBytes(putf + k, bytes, 3*count, k + sizeof(__m128i) <= len);
+				} else {
+					StoreBytes(putf + k, bytes, 3*blockUTF16/2, k + sizeof(__m128i) <= len);
+					StoreBytes(putf + k + 3*blockUTF16/2, bytes2, 3*(count - blockUTF16/2), k + 3*blockUTF16/2 + sizeof(__m128i) <= len);
+				}
+				i += count;
+				k += 3*count;
+				continue;
+			}
+		}
+#endif
+#endif
 		if (uch < 0x80) {
 			putf[k++] = static_cast<char>(uch);
 		} else if (uch < 0x800) {
@@ -103,6 +371,44 @@ size_t UTF16Length(std::string_view svu8) noexcept {
 	size_t i = 0;
 	unsigned int byteCount = 0;
 	while (i < svu8.length()) {
+#if NP2_USE_SSE2
+		const unsigned char lead = svu8[i];
+		if (UTF8IsAscii(lead)) {
+			if (i + asciiBlockUTF8 <= svu8.length() && UTF8IsAscii(svu8[i + 1])) {
+				const uint32_t mask = NonASCIIMaskUTF8(svu8.data() + i);
+				const uint32_t ascii = (mask == 0) ? asciiBlockUTF8 : np2_ctz(mask);
+				i += ascii;
+				ulen += ascii;
+				byteCount = 1;
+				continue;
+			}
+		} else if ((lead & 0xE0) == 0xC0) {
+			if (i + twoByteBlockUTF8 <= svu8.length() && (svu8[i + 2] & 0xE0) == 0xC0) {
+				__m128i units;
+				const uint32_t count = UTF16FromUTF8TwoBytes(svu8.data() + i, units);
+				if (count != 0) {
+					i += 2*count;
+					ulen += count;
+					byteCount = 2;
+					continue;
+				}
+			}
+		}
+#if NP2_USE_AVX2
+		else if ((lead & 0xF0) == 0xE0) {
+			if (i + threeByteBlockUTF8 <= svu8.length() && (svu8[i + 3] & 0xF0) == 0xE0) {
+				__m128i units;
+				const uint32_t count = UTF16FromUTF8ThreeBytes(svu8.data() + i, units);
+				if (count != 0) {
+					i += 3*count;
+					ulen += count;
+					byteCount = 3;
+					continue;
+				}
+			}
+		}
+#endif
+#endif
 		const unsigned char ch = svu8[i];
 		byteCount = UTF8BytesOfLead(ch);
 		i += byteCount;
@@ -130,6 +436,63 @@ size_t UTF16Length(std::string_view svu8) noexcept {
 size_t UTF16FromUTF8(std::string_view svu8, wchar_t *tbuf, size_t tlen) {
 	size_t ui = 0;
 	for (size_t i = 0; i < svu8.length();) {
+#if NP2_USE_SSE2
+		const unsigned char lead = svu8[i];
+		if (UTF8IsAscii(lead)) {
+			if (i + asciiBlockUTF8 <= svu8.length() && ui + asciiBlockUTF8 <= tlen && UTF8IsAscii(svu8[i + 1])) {
+				const char *ptr = svu8.data() + i;
+				const uint32_t mask = NonASCIIMaskUTF8(ptr);
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i chunk1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+				if (mask == 0) {
+					const __m128i chunk2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr + sizeof(__m128i)));
+					StoreUTF16(tbuf + ui, _mm_unpacklo_epi8(chunk1, zero), blockUTF16, true);
+					StoreUTF16(tbuf + ui + blockUTF16, _mm_unpackhi_epi8(chunk1, zero), blockUTF16, true);
+					StoreUTF16(tbuf + ui + 2*blockUTF16, _mm_unpacklo_epi8(chunk2, zero), blockUTF16, true);
+					StoreUTF16(tbuf + ui + 3*blockUTF16, _mm_unpackhi_epi8(chunk2, zero), blockUTF16, true);
+					i += asciiBlockUTF8;
+					ui += asciiBlockUTF8;
+					continue;
+				}
+				const uint32_t ascii = np2_ctz(mask);
+				if (ascii <= blockUTF16) {
+					StoreUTF16(tbuf + ui, _mm_unpacklo_epi8(chunk1, zero), ascii, svu8.length() - i - ascii >= 3*blockUTF16);
+				} else {
+					for (uint32_t j = 0; j < ascii; j++) {
+						tbuf[ui + j] = static_cast<unsigned char>(ptr[j]);
+					}
+				}
+				i += ascii;
+				ui += ascii;
+				continue;
+			}
+		} else if ((lead & 0xE0) == 0xC0) {
+			if (i + twoByteBlockUTF8 <= svu8.length() && ui + blockUTF16 <= tlen && (svu8[i + 2] & 0xE0) == 0xC0) {
+				__m128i units;
+				const uint32_t count = UTF16FromUTF8TwoBytes(svu8.data() + i, units);
+				if (count != 0) {
+					StoreUTF16(tbuf + ui, units, count, svu8.length() - i - 2*count >= 3*blockUTF16);
+					i += 2*count;
+					ui += count;
+					continue;
+				}
+			}
+		}
+#if NP2_USE_AVX2
+		else if ((lead & 0xF0) == 0xE0) {
+			if (i + threeByteBlockUTF8 <= svu8.length() && ui + blockUTF16 <= tlen && (svu8[i + 3] & 0xF0) == 0xE0) {
+				__m128i units;
+				const uint32_t count = UTF16FromUTF8ThreeBytes(svu8.data() + i, units);
+				if (count != 0) {
+					StoreUTF16(tbuf + ui, units, count, svu8.length() - i - 3*count >= 3*blockUTF16);
+					i += 3*count;
+					ui += count;
+					continue;
+				}
+			}
+		}
+#endif
+#endif
 		unsigned char ch = svu8[i];
 		const unsigned int byteCount = UTF8BytesOfLead(ch);
 		unsigned int value;
@@ -52,6 +52,23 @@ void FontRealised::Realise(Surface &surface, int zoomLevel, int technology, cons
 	capitalHeight = surface.Ascent(font) - surface.InternalLeading(font);
 	aveCharWidth = surface.AverageCharWidth(font);
 	spaceWidth = surface.WidthText(font, " ");
+
+	// Check whether space and all ASCII graphic characters have the same width,
+	// so runs of them can be laid out without measuring.
+	constexpr std::string_view allASCIIGraphic(" !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~");
+	XYPOSITION positions[allASCIIGraphic.length() + 1]{};	// extra element as GDI may write past end
+	surface.MeasureWidths(font, allASCIIGraphic, positions);
+	XYPOSITION minWidth = positions[0];
+	XYPOSITION maxWidth = positions[0];
+	for (size_t i = 1; i < allASCIIGraphic.length(); i++) {
+		const XYPOSITION width = positions[i] - positions[i - 1];
+		minWidth = std::min(minWidth, width);
+		maxWidth = std::max(maxWidth, width);
+	}
+	// tolerate accumulated rounding from fractional advances
+	constexpr XYPOSITION monospaceWidthEpsilon = 0.001f;
+	monospaceASCII = minWidth > 0 && (maxWidth - minWidth) < monospaceWidthEpsilon * minWidth;
+	monospaceCharacterWidth = monospaceASCII ? positions[allASCIIGraphic.length() - 1] / allASCIIGraphic.length() : minWidth;
 }
 
 ViewStyle::ViewStyle() : markers(MARKER_MAX + 1), indicators(INDICATOR_MAX + 1) {
@@ -416,6 +433,12 @@ int ViewStyle::ExternalMarginWidth() const noexcept {
 	return marginInside ? 0 : fixedColumnWidth;
 }
 
+bool ViewStyle::FoldMarginVisible() const noexcept {
+	return std::any_of(ms.begin(), ms.end(), [](const MarginStyle &m) noexcept {
+		return m.width > 0 && (m.mask & SC_MASK_FOLDERS) != 0;
+	});
+}
+
 int ViewStyle::MarginFromLocation(Point pt) const {
 	int margin = -1;
 	int x = marginInside ? 0 : -fixedColumnWidth;
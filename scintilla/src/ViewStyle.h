@@ -184,6 +184,7 @@ public:
 	void SetFontLocaleName(const char *name);
 	bool ProtectionActive() const noexcept;
 	int ExternalMarginWidth() const noexcept;
+	bool FoldMarginVisible() const noexcept;
 	int SCICALL MarginFromLocation(Point pt) const;
 	bool ValidStyle(size_t styleIndex) const noexcept;
 	void CalcLargestMarkerHeight() noexcept;
@@ -0,0 +1,136 @@
+// Scintilla source code edit control
+/** @file BenchCharacterCategory.cxx
+ ** Time CategoriseCharacter() and identifier checks from UAX #31 on CJK, emoji and other
+ ** scripts. Built with the multi-stage table and with CHARACTERCATEGORY_USE_BINARY_SEARCH,
+ ** both builds print the same checksums, only the speed differs.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#include "CharacterCategory.h"
+
+using namespace Scintilla;
+
+namespace {
+
+struct CodeRange {
+	int first;
+	int last;
+	int weight;
+};
+
+// CJK ideographs, kana, Hangul, CJK punctuation and full width forms.
+const CodeRange cjkRanges[] = {
+	{ 0x4E00, 0x9FFF, 60 },
+	{ 0x3041, 0x3096, 10 },
+	{ 0x30A1, 0x30FA, 8 },
+	{ 0xAC00, 0xD7A3, 12 },
+	{ 0x3000, 0x303F, 5 },
+	{ 0xFF01, 0xFF5E, 3 },
+	{ 0x20000, 0x2A6DF, 2 },
+};
+
+// emoji with ZWJ sequences, variation selectors and skin tone modifiers between ASCII words.
+const CodeRange emojiRanges[] = {
+	{ 0x1F300, 0x1F5FF, 20 },
+	{ 0x1F600, 0x1F64F, 20 },
+	{ 0x1F900, 0x1FAFF, 10 },
+	{ 0x2600, 0x27BF, 5 },
+	{ 0x200D, 0x200D, 8 },
+	{ 0xFE0F, 0xFE0F, 8 },
+	{ 0x1F3FB, 0x1F3FF, 4 },
+	{ 'a', 'z', 20 },
+	{ ' ', ' ', 5 },
+};
+
+// Latin-1, Latin Extended, Greek, Cyrillic, Arabic and combining marks.
+const CodeRange otherRanges[] = {
+	{ 0x00C0, 0x00FF, 20 },
+	{ 0x0100, 0x024F, 15 },
+	{ 0x0370, 0x03FF, 15 },
+	{ 0x0400, 0x04FF, 20 },
+	{ 0x0600, 0x06FF, 10 },
+	{ 0x0300, 0x036F, 5 },
+	{ 0x2000, 0x206F, 5 },
+};
+
+template <size_t N>
+std::vector<int> MakeText(const CodeRange (&ranges)[N], size_t length) {
+	int total = 0;
+	for (const CodeRange &range : ranges) {
+		total += range.weight;
+	}
+	std::vector<int> text;
+	text.reserve(length);
+	uint32_t seed = 1;
+	while (text.size() < length) {
+		seed = seed * 1103515245 + 12345;
+		int pick = static_cast<int>((seed >> 8) % total);
+		const CodeRange *range = ranges;
+		while (pick >= range->weight) {
+			pick -= range->weight;
+			++range;
+		}
+		seed = seed * 1103515245 + 12345;
+		text.push_back(range->first + static_cast<int>((seed >> 8) % (range->last - range->first + 1)));
+	}
+	return text;
+}
+
+template <typename Function>
+double Time(const std::vector<int> &text, Function function, int repeat, unsigned int &checksum) {
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < repeat; i++) {
+		unsigned int sum = 0;
+		for (const int ch : text) {
+			sum = sum * 31 + function(ch);
+		}
+		if (i == 0) {
+			checksum = checksum * 31 + sum;
+		}
+	}
+	const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return static_cast<double>(text.size()) * repeat / duration.count() / 1e6;
+}
+
+}
+
+int main() {
+	constexpr size_t length = 4*1024*1024;
+	constexpr int repeat = 10;
+	std::cout << "million characters per second, "
+		<< (CHARACTERCATEGORY_USE_BINARY_SEARCH ? "binary search" : "multi-stage table") << "\n";
+	std::cout << std::left << std::setw(8) << "text" << std::right << std::setw(20) << "CategoriseCharacter"
+		<< std::setw(12) << "IsIdStart" << std::setw(14) << "IsIdContinue" << std::setw(15) << "IsXidContinue"
+		<< std::setw(12) << "checksum" << "\n" << std::fixed << std::setprecision(0);
+
+	const std::vector<int> texts[] = {
+		MakeText(cjkRanges, length),
+		MakeText(emojiRanges, length),
+		MakeText(otherRanges, length),
+	};
+	const char *const names[] = { "cjk", "emoji", "other" };
+	for (size_t i = 0; i < std::size(texts); i++) {
+		const std::vector<int> &text = texts[i];
+		unsigned int checksum = 0;
+		const double speeds[] = {
+			Time(text, [](int ch) noexcept { return static_cast<unsigned int>(CategoriseCharacter(ch)); }, repeat, checksum),
+			Time(text, [](int ch) noexcept { return static_cast<unsigned int>(IsIdStart(ch)); }, repeat, checksum),
+			Time(text, [](int ch) noexcept { return static_cast<unsigned int>(IsIdContinue(ch)); }, repeat, checksum),
+			Time(text, [](int ch) noexcept { return static_cast<unsigned int>(IsXidContinue(ch)); }, repeat, checksum),
+		};
+		std::cout << std::left << std::setw(8) << names[i] << std::right << std::setw(20) << speeds[0]
+			<< std::setw(12) << speeds[1] << std::setw(14) << speeds[2] << std::setw(15) << speeds[3]
+			<< std::setw(12) << std::hex << checksum << std::dec << "\n";
+	}
+	return 0;
+}
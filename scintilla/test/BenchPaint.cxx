@@ -0,0 +1,380 @@
+// Scintilla source code edit control
+/** @file BenchPaint.cxx
+ ** Paint benchmark on the headless platform.
+ ** Each scenario fills a document, then scrolls through it painting one frame per step
+ ** and prints the time and the draw calls per frame.
+ ** Change scenarios fill indicators or restyle while lines 1000 onwards are shown and print
+ ** the pixels invalidated, the pixels of the window painted and the pixels drawn on any surface
+ ** while repainting, then the same for invalidating every changed line whole.
+ ** BenchPaint [frames] [scenario]
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <chrono>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+#include "CellBuffer.h"
+#include "KeyMap.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "Selection.h"
+#include "PositionCache.h"
+#include "EditModel.h"
+#include "MarginView.h"
+#include "EditView.h"
+#include "Editor.h"
+
+#include "HeadlessPlatform.h"
+#include "HeadlessEditor.h"
+
+using namespace Scintilla;
+
+namespace {
+
+const char *const words[] = {
+	"static", "int", "value", "=", "compute(index,", "42);", "return", "buffer[offset]",
+	"if", "(count", ">", "limit)", "{", "}", "//", "comment", "text", "for", "auto", "&item",
+	":", "items)", "std::string", "name;", "while", "(pos", "<", "length)", "++pos;", "é中文",
+};
+constexpr size_t wordCount = std::size(words);
+
+// Deterministic line of about width bytes, indented by depth tabs.
+std::string MakeLine(size_t seed, size_t width, int depth) {
+	std::string line(depth, '\t');
+	size_t index = seed * 7;
+	while (line.length() < width) {
+		line += words[index % wordCount];
+		line += ' ';
+		index = index * 31 + 17;
+	}
+	line += '\n';
+	return line;
+}
+
+struct Scenario {
+	const char *name;
+	size_t lines;
+	size_t width;
+	bool indicators;
+	bool folding;
+	bool wrap;
+	int xStep;		// pixels scrolled horizontally per frame
+};
+
+const Scenario scenarios[] = {
+	{ "plain", 20000, 80, false, false, false, 0 },
+	{ "long-lines", 200, 20000, false, false, false, 200 },
+	{ "indicators", 20000, 80, true, false, false, 0 },
+	{ "folding", 20000, 80, false, true, false, 0 },
+	{ "wrap", 5000, 600, false, false, true, 0 },
+};
+
+void SetupStyles(HeadlessEditor &editor) {
+	editor.CallString(SCI_STYLESETFONT, STYLE_DEFAULT, "Verdana");
+	editor.Call(SCI_STYLESETSIZE, STYLE_DEFAULT, 10);
+	editor.Call(SCI_STYLECLEARALL);
+	editor.Call(SCI_STYLESETFORE, 1, 0x800000);
+	editor.Call(SCI_STYLESETFORE, 2, 0x008000);
+	editor.Call(SCI_STYLESETBOLD, 2, 1);
+	editor.Call(SCI_STYLESETFORE, 3, 0x000080);
+	editor.Call(SCI_SETMARGINTYPEN, 0, SC_MARGIN_NUMBER);
+	editor.Call(SCI_SETMARGINWIDTHN, 0, 40);
+}
+
+// Style every word with one of four styles, as a lexer would.
+void StyleDocument(HeadlessEditor &editor, const std::string &text) {
+	std::vector<char> styles(text.length());
+	int style = 0;
+	for (size_t pos = 0; pos < text.length(); pos++) {
+		if (text[pos] == ' ') {
+			style = (style + 1) % 4;
+		}
+		styles[pos] = static_cast<char>(style);
+	}
+	editor.Call(SCI_STARTSTYLING, 0);
+	editor.Call(SCI_SETSTYLINGEX, styles.size(), reinterpret_cast<sptr_t>(styles.data()));
+}
+
+void AddIndicators(HeadlessEditor &editor, const std::string &text) {
+	const int indicatorStyles[] = { INDIC_ROUNDBOX, INDIC_SQUIGGLE, INDIC_BOX, INDIC_STRAIGHTBOX };
+	for (int indicator = 0; indicator < 4; indicator++) {
+		editor.Call(SCI_INDICSETSTYLE, indicator, indicatorStyles[indicator]);
+	}
+	// mark every fifth word like mark occurrences would.
+	size_t wordStart = 0;
+	size_t word = 0;
+	for (size_t pos = 0; pos < text.length(); pos++) {
+		if (text[pos] == ' ' || text[pos] == '\n') {
+			if (word % 5 == 0 && pos > wordStart) {
+				editor.Call(SCI_SETINDICATORCURRENT, word % 4);
+				editor.Call(SCI_INDICATORFILLRANGE, wordStart, pos - wordStart);
+			}
+			word++;
+			wordStart = pos + 1;
+		}
+	}
+}
+
+void AddFolding(HeadlessEditor &editor, const std::vector<int> &depths) {
+	editor.Call(SCI_SETMARGINTYPEN, 2, SC_MARGIN_SYMBOL);
+	editor.Call(SCI_SETMARGINMASKN, 2, SC_MASK_FOLDERS);
+	editor.Call(SCI_SETMARGINWIDTHN, 2, 16);
+	editor.Call(SCI_MARKERDEFINE, SC_MARKNUM_FOLDEROPEN, SC_MARK_BOXMINUS);
+	editor.Call(SCI_MARKERDEFINE, SC_MARKNUM_FOLDER, SC_MARK_BOXPLUS);
+	editor.Call(SCI_MARKERDEFINE, SC_MARKNUM_FOLDERSUB, SC_MARK_VLINE);
+	editor.Call(SCI_MARKERDEFINE, SC_MARKNUM_FOLDERTAIL, SC_MARK_LCORNER);
+	editor.Call(SCI_MARKERDEFINE, SC_MARKNUM_FOLDEREND, SC_MARK_BOXPLUSCONNECTED);
+	editor.Call(SCI_MARKERDEFINE, SC_MARKNUM_FOLDEROPENMID, SC_MARK_BOXMINUSCONNECTED);
+	editor.Call(SCI_MARKERDEFINE, SC_MARKNUM_FOLDERMIDTAIL, SC_MARK_TCORNER);
+	for (size_t line = 0; line < depths.size(); line++) {
+		int level = SC_FOLDLEVELBASE + depths[line];
+		if (line + 1 < depths.size() && depths[line + 1] > depths[line]) {
+			level |= SC_FOLDLEVELHEADERFLAG;
+		}
+		editor.Call(SCI_SETFOLDLEVEL, line, level);
+	}
+	// contract every third header so the display has a mix of folded and expanded blocks.
+	for (size_t line = 0; line < depths.size(); line += 3) {
+		if (editor.Call(SCI_GETFOLDLEVEL, line) & SC_FOLDLEVELHEADERFLAG) {
+			editor.Call(SCI_FOLDLINE, line, SC_FOLDACTION_CONTRACT);
+		}
+	}
+}
+
+struct ChangeScenario {
+	const char *name;
+	sptr_t lineFirst;	// first line changed
+	sptr_t lines;
+	bool style;			// restyle the lines instead of marking every fifth word with an indicator
+};
+
+constexpr sptr_t lineShown = 1000;
+
+const ChangeScenario changeScenarios[] = {
+	{ "mark-visible", lineShown + 5, 20, false },
+	{ "mark-below", 5000, 2000, false },
+	{ "mark-above", 100, 500, false },
+	{ "mark-all", 0, 20000, false },
+	{ "style-line", lineShown + 10, 1, true },
+};
+
+// Words of the lines as ranges, every fifth one as mark occurrences would find.
+std::vector<Range> MarkedWords(HeadlessEditor &editor, const std::string &text, const ChangeScenario &scenario) {
+	std::vector<Range> ranges;
+	const size_t start = editor.Call(SCI_POSITIONFROMLINE, scenario.lineFirst);
+	const size_t end = editor.Call(SCI_POSITIONFROMLINE, scenario.lineFirst + scenario.lines);
+	size_t wordStart = start;
+	size_t word = 0;
+	for (size_t pos = start; pos < end; pos++) {
+		if (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\t') {
+			if (word % 5 == 0 && pos > wordStart) {
+				ranges.emplace_back(wordStart, pos);
+			}
+			word++;
+			wordStart = pos + 1;
+		}
+	}
+	return ranges;
+}
+
+struct Repaint {
+	double invalidated = 0;
+	DrawStatistics statistics;
+};
+
+Repaint PaintChanges(HeadlessEditor &editor) {
+	Repaint repaint;
+	repaint.invalidated = editor.MainWindow().InvalidatedArea();
+	ResetDrawStatistics();
+	editor.PaintInvalidated();
+	repaint.statistics = GetDrawStatistics();
+	return repaint;
+}
+
+// What invalidating every changed line whole, and the whole window for changes above it, repaints.
+Repaint PaintWholeLines(HeadlessEditor &editor, const std::vector<Range> &ranges) {
+	const PRectangle rcClient = editor.MainWindow().position;
+	HeadlessWindow lines(rcClient);
+	const sptr_t lineFirst = editor.Call(SCI_GETFIRSTVISIBLELINE);
+	const XYPOSITION lineHeight = static_cast<XYPOSITION>(editor.Call(SCI_TEXTHEIGHT, lineFirst));
+	const XYPOSITION textStart = static_cast<XYPOSITION>(editor.Call(SCI_POINTXFROMPOSITION, 0, editor.Call(SCI_POSITIONFROMLINE, lineFirst)));
+	for (const Range &range : ranges) {
+		const sptr_t line = editor.Call(SCI_LINEFROMPOSITION, range.start);
+		if (line < lineFirst) {
+			lines.invalidatedAll = true;
+		}
+		const XYPOSITION top = (line - lineFirst) * lineHeight;
+		if (top < rcClient.Height()) {
+			lines.invalidated.emplace_back(textStart, top, rcClient.Width(), top + lineHeight);
+		}
+	}
+	PRectangle rcBounds = lines.invalidatedAll ? PRectangle(0, 0, rcClient.Width(), rcClient.Height()) : PRectangle();
+	for (const PRectangle &rc : lines.invalidated) {
+		rcBounds = rcBounds.Empty() ? rc : PRectangle(std::min(rcBounds.left, rc.left), std::min(rcBounds.top, rc.top),
+			std::max(rcBounds.right, rc.right), std::max(rcBounds.bottom, rc.bottom));
+	}
+	Repaint repaint;
+	repaint.invalidated = lines.InvalidatedArea();
+	ResetDrawStatistics();
+	if (!rcBounds.Empty()) {
+		editor.PaintRectangle(rcBounds);
+	}
+	repaint.statistics = GetDrawStatistics();
+	return repaint;
+}
+
+void RunChangeScenario(const ChangeScenario &scenario) {
+	HeadlessEditor editor(PRectangle(0, 0, 1000, 800));
+	editor.Call(SCI_SETCODEPAGE, SC_CP_UTF8);
+	SetupStyles(editor);
+	editor.Call(SCI_INDICSETSTYLE, 0, INDIC_ROUNDBOX);
+
+	std::string text;
+	for (size_t line = 0; line < 20000; line++) {
+		text += MakeLine(line, 80, 0);
+	}
+	editor.CallString(SCI_SETTEXT, 0, text.c_str());
+	StyleDocument(editor, text);
+	editor.Call(SCI_SETFIRSTVISIBLELINE, lineShown);
+	editor.PaintAll();
+
+	std::vector<Range> ranges;
+	if (scenario.style) {
+		for (sptr_t line = scenario.lineFirst; line < scenario.lineFirst + scenario.lines; line++) {
+			const sptr_t start = editor.Call(SCI_POSITIONFROMLINE, line);
+			const sptr_t end = editor.Call(SCI_GETLINEENDPOSITION, line);
+			ranges.emplace_back(start, end);
+			editor.Call(SCI_STARTSTYLING, start);
+			editor.Call(SCI_SETSTYLING, end - start, 2);
+		}
+	} else {
+		ranges = MarkedWords(editor, text, scenario);
+		editor.Call(SCI_SETINDICATORCURRENT, 0);
+		for (const Range &range : ranges) {
+			editor.Call(SCI_INDICATORFILLRANGE, range.start, range.end - range.start);
+		}
+	}
+
+	const Repaint changes = PaintChanges(editor);
+	const Repaint wholeLines = PaintWholeLines(editor, ranges);
+	printf("%-12s %7zu %11.0f %10.0f %10.0f %6zu %11.0f %10.0f %10.0f %6zu\n", scenario.name, ranges.size(),
+		changes.invalidated, changes.statistics.paintedArea, changes.statistics.filledArea, changes.statistics.texts,
+		wholeLines.invalidated, wholeLines.statistics.paintedArea, wholeLines.statistics.filledArea, wholeLines.statistics.texts);
+}
+
+double Median(std::vector<double> values) {
+	std::sort(values.begin(), values.end());
+	return values.empty() ? 0 : values[values.size() / 2];
+}
+
+void RunScenario(const Scenario &scenario, int frames) {
+	HeadlessEditor editor(PRectangle(0, 0, 1000, 800));
+	editor.Call(SCI_SETCODEPAGE, SC_CP_UTF8);
+	SetupStyles(editor);
+
+	std::string text;
+	std::vector<int> depths;
+	for (size_t line = 0; line < scenario.lines; line++) {
+		const int depth = static_cast<int>((line % 40 < 20) ? line % 20 / 4 : (39 - line % 40) / 4);
+		depths.push_back(depth);
+		text += MakeLine(line, scenario.width, depth);
+	}
+	editor.CallString(SCI_SETTEXT, 0, text.c_str());
+	StyleDocument(editor, text);
+	if (scenario.indicators) {
+		AddIndicators(editor, text);
+	}
+	if (scenario.folding) {
+		AddFolding(editor, depths);
+	}
+	if (scenario.wrap) {
+		editor.Call(SCI_SETWRAPMODE, SC_WRAP_WORD);
+	}
+	editor.PaintAll();
+	editor.RunIdle();
+
+	const sptr_t linesOnScreen = std::max<sptr_t>(editor.Call(SCI_LINESONSCREEN), 1);
+	std::vector<double> times;
+	DrawStatistics total;
+	for (int frame = 1; frame <= frames; frame++) {
+		if (scenario.xStep) {
+			editor.Call(SCI_SETXOFFSET, (frame * scenario.xStep) % (scenario.width * 4));
+		}
+		editor.Call(SCI_SETFIRSTVISIBLELINE, (frame * linesOnScreen / 2) % scenario.lines);
+		ResetDrawStatistics();
+		const auto start = std::chrono::steady_clock::now();
+		editor.PaintInvalidated();
+		const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+		times.push_back(duration.count());
+
+		const DrawStatistics statistics = GetDrawStatistics();
+		total.rectangles += statistics.rectangles;
+		total.lines += statistics.lines;
+		total.texts += statistics.texts;
+		total.textBytes += statistics.textBytes;
+		total.images += statistics.images;
+		total.copies += statistics.copies;
+		total.measures += statistics.measures;
+		total.filledArea += statistics.filledArea;
+	}
+
+	const double perFrame = 1.0 / frames;
+	printf("%-12s %8.3f %8.3f %9.1f %9.1f %8.1f %8.1f %8.1f %10.0f\n", scenario.name,
+		*std::min_element(times.begin(), times.end()), Median(times),
+		total.DrawCalls() * perFrame, total.rectangles * perFrame, total.texts * perFrame,
+		total.lines * perFrame, total.measures * perFrame, total.filledArea * perFrame);
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	const int frames = (argc > 1) ? std::max(atoi(argv[1]), 1) : 200;
+	const char *only = (argc > 2) ? argv[2] : nullptr;
+
+	printf("%-12s %8s %8s %9s %9s %8s %8s %8s %10s\n", "scenario", "best ms", "median", "calls",
+		"rects", "texts", "lines", "measures", "pixels");
+	for (const Scenario &scenario : scenarios) {
+		if (!only || strcmp(only, scenario.name) == 0) {
+			RunScenario(scenario, frames);
+		}
+	}
+
+	printf("\n%-12s %7s %11s %10s %10s %6s %11s %10s %10s %6s\n", "change", "changes", "invalidated", "painted", "drawn", "texts",
+		"whole lines", "painted", "drawn", "texts");
+	for (const ChangeScenario &scenario : changeScenarios) {
+		if (!only || strcmp(only, scenario.name) == 0) {
+			RunChangeScenario(scenario);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,208 @@
+// Scintilla source code edit control
+/** @file HeadlessEditor.cxx
+ ** Editor on the headless platform, driven by messages and painted on request.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <chrono>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+#include "CellBuffer.h"
+#include "KeyMap.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "UniConversion.h"
+#include "Selection.h"
+#include "PositionCache.h"
+#include "EditModel.h"
+#include "MarginView.h"
+#include "EditView.h"
+#include "Editor.h"
+
+#include "HeadlessPlatform.h"
+#include "HeadlessEditor.h"
+
+using namespace Scintilla;
+
+HeadlessEditor::HeadlessEditor(PRectangle rcWindow) : window(rcWindow) {
+	wMain = &window;
+	Initialise();
+}
+
+HeadlessEditor::~HeadlessEditor() {
+	Finalise();
+	wMain = nullptr;
+}
+
+void HeadlessEditor::Initialise() noexcept {
+}
+
+void HeadlessEditor::SetVerticalScrollPos() noexcept {
+}
+
+void HeadlessEditor::SetHorizontalScrollPos() noexcept {
+}
+
+bool HeadlessEditor::ModifyScrollBars(Sci::Line, Sci::Line) noexcept {
+	return false;
+}
+
+void HeadlessEditor::Copy(bool) {
+}
+
+void HeadlessEditor::Paste(bool) {
+}
+
+void HeadlessEditor::ClaimSelection() noexcept {
+}
+
+void HeadlessEditor::NotifyChange() noexcept {
+}
+
+void HeadlessEditor::NotifyParent(SCNotification) noexcept {
+}
+
+void HeadlessEditor::CopyToClipboard(const SelectionText &) {
+}
+
+bool HeadlessEditor::SetIdle(bool on) noexcept {
+	idleRequested = on;
+	return true;
+}
+
+void HeadlessEditor::SetMouseCapture(bool) noexcept {
+}
+
+// There are no timers, so caret blinking, scrolling and dwell never tick.
+bool HeadlessEditor::FineTickerRunning(TickReason) noexcept {
+	return false;
+}
+
+void HeadlessEditor::FineTickerStart(TickReason, int, int) noexcept {
+}
+
+void HeadlessEditor::FineTickerCancel(TickReason) noexcept {
+}
+
+bool HeadlessEditor::HaveMouseCapture() noexcept {
+	return false;
+}
+
+// As the update region on Win32: lines inside the bounding rectangle of the invalidated
+// rectangles are skipped unless one of the rectangles covers them.
+bool HeadlessEditor::PaintIntersects(PRectangle rc) const noexcept {
+	if (!rcPaint.Intersects(rc)) {
+		return false;
+	}
+	if (paintState == painting && !paintingAllText && !window.invalidated.empty()) {
+		return std::any_of(window.invalidated.begin(), window.invalidated.end(), [rc](PRectangle rcInvalidated) noexcept {
+			return rcInvalidated.Intersects(rc);
+		});
+	}
+	return true;
+}
+
+sptr_t HeadlessEditor::DefWndProc(unsigned int, uptr_t, sptr_t) noexcept {
+	return 0;
+}
+
+void HeadlessEditor::PaintArea(PRectangle rcArea) {
+	std::unique_ptr<Surface> surfaceWindow(Surface::Allocate(technology));
+	surfaceWindow->Init(wMain.GetID());
+	surfaceWindow->SetUnicodeMode(SC_CP_UTF8 == CodePage());
+	surfaceWindow->SetDBCSMode(CodePage());
+
+	paintState = painting;
+	rcPaint = rcArea;
+	paintingAllText = rcArea.Contains(GetClientRectangle());
+	if (window.invalidatedAll || window.invalidated.empty()) {
+		window.paintRegion.assign(1, rcArea);
+	} else {
+		window.paintRegion = window.invalidated;
+	}
+	Paint(surfaceWindow.get(), rcPaint);
+	if (paintState == paintAbandoned) {
+		// Painting area was insufficient to cover new styling or wrapping
+		rcPaint = GetClientRectangle();
+		paintingAllText = true;
+		paintState = painting;
+		window.paintRegion.assign(1, rcPaint);
+		Paint(surfaceWindow.get(), rcPaint);
+	}
+	paintState = notPainting;
+	window.paintRegion.clear();
+	window.ClearInvalidated();
+}
+
+void HeadlessEditor::Resize(PRectangle rcWindow) {
+	window.position = rcWindow;
+	ChangeSize();
+}
+
+void HeadlessEditor::PaintAll() {
+	PaintArea(GetClientRectangle());
+}
+
+void HeadlessEditor::PaintRectangle(PRectangle rc) {
+	window.ClearInvalidated();
+	PaintArea(rc);
+}
+
+bool HeadlessEditor::PaintInvalidated() {
+	if (window.invalidatedAll) {
+		PaintAll();
+		return true;
+	}
+	if (window.invalidated.empty()) {
+		return false;
+	}
+	PRectangle rcBounds = window.invalidated.front();
+	for (const PRectangle &rc : window.invalidated) {
+		rcBounds = PRectangle(std::min(rcBounds.left, rc.left), std::min(rcBounds.top, rc.top),
+			std::max(rcBounds.right, rc.right), std::max(rcBounds.bottom, rc.bottom));
+	}
+	PaintArea(rcBounds);
+	return true;
+}
+
+void HeadlessEditor::RunIdle() {
+	while (idleRequested) {
+		idleRequested = Idle();
+	}
+}
+
+void HeadlessEditor::WrapAll() {
+	WrapLines(WrapScope::wsAll);
+}
@@ -0,0 +1,72 @@
+// Scintilla source code edit control
+/** @file HeadlessEditor.h
+ ** Editor on the headless platform, driven by messages and painted on request.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+#pragma once
+
+namespace Scintilla {
+
+class HeadlessEditor : public Editor {
+	HeadlessWindow window;
+	bool idleRequested = false;
+
+	void Initialise() noexcept override;
+	void SetVerticalScrollPos() noexcept override;
+	void SetHorizontalScrollPos() noexcept override;
+	bool ModifyScrollBars(Sci::Line nMax, Sci::Line nPage) noexcept override;
+	void Copy(bool asBinary) override;
+	void Paste(bool asBinary) override;
+	void ClaimSelection() noexcept override;
+	void NotifyChange() noexcept override;
+	void NotifyParent(SCNotification scn) noexcept override;
+	void CopyToClipboard(const SelectionText &selectedText) override;
+	bool SetIdle(bool on) noexcept override;
+	bool FineTickerRunning(TickReason reason) noexcept override;
+	void FineTickerStart(TickReason reason, int millis, int tolerance) noexcept override;
+	void FineTickerCancel(TickReason reason) noexcept override;
+	void SetMouseCapture(bool on) noexcept override;
+	bool HaveMouseCapture() noexcept override;
+	bool PaintIntersects(PRectangle rc) const noexcept override;
+	sptr_t DefWndProc(unsigned int iMessage, uptr_t wParam, sptr_t lParam) noexcept override;
+
+	void PaintArea(PRectangle rcArea);
+
+public:
+	explicit HeadlessEditor(PRectangle rcWindow);
+	~HeadlessEditor() override;
+
+	sptr_t Call(unsigned int iMessage, uptr_t wParam = 0, sptr_t lParam = 0) {
+		return WndProc(iMessage, wParam, lParam);
+	}
+	sptr_t CallString(unsigned int iMessage, uptr_t wParam, const char *s) {
+		return WndProc(iMessage, wParam, reinterpret_cast<sptr_t>(s));
+	}
+	HeadlessWindow &MainWindow() noexcept {
+		return window;
+	}
+	// Limit the threads used for wrapping, whatever the hardware has.
+	void SetWrapThreads(size_t threads) noexcept {
+		wrapThreadsMax = threads;
+	}
+	// Lay out lines longer than length in windows of blocks instead of whole, set before adding text.
+	void SetWindowedLength(int length) noexcept {
+		view.windowedLength = length;
+	}
+	// Move or resize the window, as for a size message.
+	void Resize(PRectangle rcWindow);
+
+	// Paint the whole client area, as after the window is shown.
+	void PaintAll();
+	// Paint what was invalidated since the last paint, as for a paint message, then clear it.
+	// Returns false when nothing was invalidated.
+	bool PaintInvalidated();
+	// Paint all lines in rc, as if only rc had been invalidated.
+	void PaintRectangle(PRectangle rc);
+	// Run the idle work, such as background wrapping, until no more is requested.
+	void RunIdle();
+	// Wrap every line now instead of in idle time.
+	void WrapAll();
+};
+
+}
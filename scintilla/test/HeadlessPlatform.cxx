@@ -0,0 +1,455 @@
+// Scintilla source code edit control
+/** @file HeadlessPlatform.cxx
+ ** Platform layer without a display, so Editor can be painted in tests and benchmarks.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cmath>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <atomic>
+
+#include "Platform.h"
+#include "Scintilla.h"
+#include "UniConversion.h"
+
+#include "HeadlessPlatform.h"
+
+using namespace Scintilla;
+
+namespace {
+
+DrawStatistics statistics;
+std::atomic<size_t> measureCount{0};
+
+struct FontHeadless {
+	float size;
+	bool monospace;
+};
+
+const FontHeadless *FontFromID(const Font &font) noexcept {
+	return static_cast<const FontHeadless *>(font.GetID());
+}
+
+float Area(PRectangle rc) noexcept {
+	return rc.Empty() ? 0.0f : rc.Width() * rc.Height();
+}
+
+// Width of a character in units of the font size.
+float ProportionalFactor(unsigned int ch) noexcept {
+	if (ch >= 0x2E80) {
+		// CJK and other wide characters
+		return 1.0f;
+	}
+	if (ch >= 0x80) {
+		return 0.6f;
+	}
+	if (strchr("fijlrt.,:;'|!()[] \t", static_cast<int>(ch))) {
+		return 0.3f;
+	}
+	if (strchr("mwMW@", static_cast<int>(ch))) {
+		return 0.85f;
+	}
+	if (ch >= 'A' && ch <= 'Z') {
+		return 0.65f;
+	}
+	return 0.5f;
+}
+
+class SurfaceHeadless : public Surface {
+	bool initialised = false;
+	bool unicodeMode = false;
+	int codePage = 0;
+	// Window drawn on directly, null for pixmaps.
+	const HeadlessWindow *window = nullptr;
+
+	void Painted(PRectangle rc) const {
+		if (window) {
+			statistics.paintedArea += window->PaintedArea(rc);
+		}
+	}
+public:
+	SurfaceHeadless() noexcept = default;
+
+	void Init(WindowID wid) noexcept override {
+		initialised = true;
+		window = static_cast<const HeadlessWindow *>(wid);
+	}
+	void Init(SurfaceID, WindowID) noexcept override {
+		initialised = true;
+	}
+	void InitPixMap(int, int, Surface *, WindowID) noexcept override {
+		initialised = true;
+	}
+
+	void Release() noexcept override {
+		initialised = false;
+	}
+	bool Initialised() const noexcept override {
+		return initialised;
+	}
+	void PenColour(ColourDesired) override {
+	}
+	int LogPixelsY() const noexcept override {
+		return 96;
+	}
+	int DeviceHeightFont(int points) const noexcept override {
+		return (points * LogPixelsY() + 36) / 72;
+	}
+	void SCICALL MoveTo(int, int) noexcept override {
+	}
+	void SCICALL LineTo(int, int) noexcept override {
+		statistics.lines++;
+	}
+	void SCICALL Polygon(const Point *, size_t, ColourDesired, ColourDesired) override {
+		statistics.lines++;
+	}
+	void SCICALL RectangleDraw(PRectangle rc, ColourDesired, ColourDesired) override {
+		statistics.rectangles++;
+		statistics.filledArea += Area(rc);
+		Painted(rc);
+	}
+	void SCICALL FillRectangle(PRectangle rc, ColourDesired) override {
+		statistics.rectangles++;
+		statistics.filledArea += Area(rc);
+		Painted(rc);
+	}
+	void SCICALL FillRectangle(PRectangle rc, Surface &) override {
+		statistics.rectangles++;
+		statistics.filledArea += Area(rc);
+		Painted(rc);
+	}
+	void SCICALL RoundedRectangle(PRectangle rc, ColourDesired, ColourDesired) override {
+		statistics.rectangles++;
+		statistics.filledArea += Area(rc);
+		Painted(rc);
+	}
+	void SCICALL AlphaRectangle(PRectangle rc, int, ColourDesired, int alphaFill, ColourDesired, int, int) override {
+		statistics.rectangles++;
+		if (alphaFill == 0xff) {
+			statistics.filledArea += Area(rc);
+		Painted(rc);
+		}
+	}
+	void SCICALL GradientRectangle(PRectangle rc, const std::vector<ColourStop> &, GradientOptions) override {
+		statistics.rectangles++;
+		statistics.filledArea += Area(rc);
+		Painted(rc);
+	}
+	void SCICALL DrawRGBAImage(PRectangle, int, int, const unsigned char *) override {
+		statistics.images++;
+	}
+	void SCICALL Ellipse(PRectangle, ColourDesired, ColourDesired) override {
+		statistics.rectangles++;
+	}
+	void SCICALL Copy(PRectangle rc, Point, Surface &) override {
+		statistics.copies++;
+		statistics.copiedArea += Area(rc);
+		Painted(rc);
+	}
+
+	std::unique_ptr<IScreenLineLayout> Layout(const IScreenLine *) override {
+		return {};
+	}
+
+	void SCICALL DrawTextNoClip(PRectangle rc, const Font &, XYPOSITION, std::string_view text, ColourDesired, ColourDesired) override {
+		statistics.texts++;
+		statistics.textBytes += text.length();
+		statistics.filledArea += Area(rc);
+		Painted(rc);
+	}
+	void SCICALL DrawTextClipped(PRectangle rc, const Font &, XYPOSITION, std::string_view text, ColourDesired, ColourDesired) override {
+		statistics.texts++;
+		statistics.textBytes += text.length();
+		statistics.filledArea += Area(rc);
+		Painted(rc);
+	}
+	void SCICALL DrawTextTransparent(PRectangle, const Font &, XYPOSITION, std::string_view text, ColourDesired) override {
+		statistics.texts++;
+		statistics.textBytes += text.length();
+	}
+	void SCICALL MeasureWidths(const Font &font_, std::string_view text, XYPOSITION *positions) override {
+		measureCount++;
+		const unsigned char *us = reinterpret_cast<const unsigned char *>(text.data());
+		const size_t length = text.length();
+		XYPOSITION position = 0;
+		size_t i = 0;
+		while (i < length) {
+			unsigned int ch = us[i];
+			size_t width = 1;
+			if (unicodeMode && ch >= 0x80) {
+				const int classified = UTF8Classify(us + i, length - i);
+				if (!(classified & UTF8MaskInvalid)) {
+					width = classified & UTF8MaskWidth;
+					ch = UnicodeFromUTF8(us + i);
+				}
+			} else if (codePage != 0 && ch >= 0x80 && i + 1 < length) {
+				// treat every high byte as a double byte lead, enough for measuring.
+				width = 2;
+				ch = 0x4E00;
+			}
+			position += HeadlessCharacterWidth(font_, ch);
+			for (size_t j = 0; j < width; j++) {
+				positions[i++] = position;
+			}
+		}
+	}
+	XYPOSITION WidthText(const Font &font_, std::string_view text) override {
+		std::vector<XYPOSITION> positions(text.length());
+		MeasureWidths(font_, text, positions.data());
+		return text.empty() ? 0 : positions.back();
+	}
+	XYPOSITION Ascent(const Font &font_) noexcept override {
+		const FontHeadless *font = FontFromID(font_);
+		return std::ceil((font ? font->size : 10.0f) * 0.8f);
+	}
+	XYPOSITION Descent(const Font &font_) noexcept override {
+		const FontHeadless *font = FontFromID(font_);
+		return std::ceil((font ? font->size : 10.0f) * 0.25f);
+	}
+	XYPOSITION InternalLeading(const Font &) noexcept override {
+		return 0;
+	}
+	XYPOSITION Height(const Font &font_) noexcept override {
+		return Ascent(font_) + Descent(font_);
+	}
+	XYPOSITION AverageCharWidth(const Font &font_) override {
+		return HeadlessCharacterWidth(font_, 'x');
+	}
+
+	void SCICALL SetClip(PRectangle) noexcept override {
+	}
+	void FlushCachedState() noexcept override {
+	}
+
+	void SetUnicodeMode(bool unicodeMode_) noexcept override {
+		unicodeMode = unicodeMode_;
+	}
+	void SetDBCSMode(int codePage_) noexcept override {
+		codePage = (codePage_ == SC_CP_UTF8) ? 0 : codePage_;
+	}
+	void SetBidiR2L(bool) noexcept override {
+	}
+
+	bool SupportsThreadSafeMeasureWidths() const noexcept override {
+		return true;
+	}
+};
+
+HeadlessWindow *WindowFromID(WindowID wid) noexcept {
+	return static_cast<HeadlessWindow *>(wid);
+}
+
+}
+
+namespace Scintilla {
+
+DrawStatistics GetDrawStatistics() noexcept {
+	DrawStatistics result = statistics;
+	result.measures = measureCount;
+	return result;
+}
+
+void ResetDrawStatistics() noexcept {
+	statistics = DrawStatistics();
+	measureCount = 0;
+}
+
+namespace {
+
+// Area inside rcClip covered by the rectangles, overlaps counted once.
+double CoveredArea(const std::vector<PRectangle> &rectangles, PRectangle rcClip) {
+	// split rcClip into cells at every rectangle edge, sum the cells covered by any rectangle.
+	std::vector<PRectangle> clipped;
+	std::vector<XYPOSITION> xs;
+	std::vector<XYPOSITION> ys;
+	for (const PRectangle &rc : rectangles) {
+		const PRectangle rcClipped(std::max(rc.left, rcClip.left), std::max(rc.top, rcClip.top),
+			std::min(rc.right, rcClip.right), std::min(rc.bottom, rcClip.bottom));
+		if (!rcClipped.Empty()) {
+			clipped.push_back(rcClipped);
+			xs.push_back(rcClipped.left);
+			xs.push_back(rcClipped.right);
+			ys.push_back(rcClipped.top);
+			ys.push_back(rcClipped.bottom);
+		}
+	}
+	std::sort(xs.begin(), xs.end());
+	xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+	std::sort(ys.begin(), ys.end());
+	ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+	double area = 0;
+	for (size_t ix = 1; ix < xs.size(); ix++) {
+		for (size_t iy = 1; iy < ys.size(); iy++) {
+			const PRectangle cell(xs[ix - 1], ys[iy - 1], xs[ix], ys[iy]);
+			for (const PRectangle &rc : clipped) {
+				if (rc.Contains(cell)) {
+					area += Area(cell);
+					break;
+				}
+			}
+		}
+	}
+	return area;
+}
+
+}
+
+double HeadlessWindow::InvalidatedArea() const {
+	const PRectangle rcClient(0, 0, position.Width(), position.Height());
+	return invalidatedAll ? Area(rcClient) : CoveredArea(invalidated, rcClient);
+}
+
+double HeadlessWindow::PaintedArea(PRectangle rc) const {
+	return CoveredArea(paintRegion, rc);
+}
+
+XYPOSITION HeadlessCharacterWidth(const Font &font, unsigned int ch) noexcept {
+	const FontHeadless *fontHeadless = FontFromID(font);
+	const float size = fontHeadless ? fontHeadless->size : 10.0f;
+	if (fontHeadless && fontHeadless->monospace) {
+		const float width = std::round(size * 0.6f);
+		return (ch >= 0x2E80) ? width * 2 : width;
+	}
+	return std::max(std::round(size * ProportionalFactor(ch)), 1.0f);
+}
+
+Font::Font() noexcept : fid{} {
+}
+
+Font::~Font() {
+	Release();
+}
+
+void Font::Create(const FontParameters &fp) {
+	Release();
+	if (fp.faceName) {
+		const bool monospace = strstr(fp.faceName, "Mono") || strstr(fp.faceName, "Courier") || strstr(fp.faceName, "Consolas");
+		fid = new FontHeadless{ fp.size, monospace };
+	}
+}
+
+void Font::Release() noexcept {
+	delete static_cast<FontHeadless *>(fid);
+	fid = nullptr;
+}
+
+Surface *Surface::Allocate(int) {
+	return new SurfaceHeadless;
+}
+
+Window::~Window() = default;
+
+void Window::Destroy() noexcept {
+	// the HeadlessWindow is owned by whoever created it.
+	wid = nullptr;
+}
+
+PRectangle Window::GetPosition() const noexcept {
+	return wid ? WindowFromID(wid)->position : PRectangle();
+}
+
+void Window::SetPosition(PRectangle rc) noexcept {
+	if (wid) {
+		WindowFromID(wid)->position = rc;
+	}
+}
+
+void Window::SetPositionRelative(PRectangle rc, const Window *) noexcept {
+	SetPosition(rc);
+}
+
+PRectangle Window::GetClientPosition() const noexcept {
+	const PRectangle rc = GetPosition();
+	return PRectangle(0, 0, rc.Width(), rc.Height());
+}
+
+void Window::Show(bool) const noexcept {
+}
+
+void Window::InvalidateAll() noexcept {
+	if (wid) {
+		WindowFromID(wid)->invalidatedAll = true;
+	}
+}
+
+void Window::InvalidateRectangle(PRectangle rc) noexcept {
+	if (wid) {
+		WindowFromID(wid)->invalidated.push_back(rc);
+	}
+}
+
+void Window::SetFont(const Font &) noexcept {
+}
+
+void Window::SetCursor(Cursor curs) noexcept {
+	cursorLast = curs;
+}
+
+PRectangle Window::GetMonitorRect(Point) const noexcept {
+	return GetPosition();
+}
+
+Menu::Menu() noexcept : mid{} {
+}
+
+void Menu::CreatePopUp() noexcept {
+}
+
+void Menu::Destroy() noexcept {
+	mid = nullptr;
+}
+
+void Menu::Show(Point, const Window &) noexcept {
+}
+
+ColourDesired Platform::Chrome() noexcept {
+	return ColourDesired(0xf0, 0xf0, 0xf0);
+}
+
+ColourDesired Platform::ChromeHighlight() noexcept {
+	return ColourDesired(0xff, 0xff, 0xff);
+}
+
+const char *Platform::DefaultFont() noexcept {
+	return "Verdana";
+}
+
+int Platform::DefaultFontSize() noexcept {
+	return 10;
+}
+
+unsigned int Platform::DoubleClickTime() noexcept {
+	return 500;
+}
+
+void Platform::DebugDisplay(const char *s) noexcept {
+	fputs(s, stderr);
+}
+
+void Platform::DebugPrintf(const char *format, ...) noexcept {
+	va_list pArguments;
+	va_start(pArguments, format);
+	vfprintf(stderr, format, pArguments);
+	va_end(pArguments);
+}
+
+bool Platform::ShowAssertionPopUps(bool) noexcept {
+	return false;
+}
+
+void Platform::Assert(const char *c, const char *file, int line) noexcept {
+	fprintf(stderr, "Assertion [%s] failed at %s %d\n", c, file, line);
+	abort();
+}
+
+}
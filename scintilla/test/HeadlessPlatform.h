@@ -0,0 +1,58 @@
+// Scintilla source code edit control
+/** @file HeadlessPlatform.h
+ ** Platform layer without a display, so Editor can be painted in tests and benchmarks.
+ ** Surfaces record what is drawn instead of drawing it.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+#pragma once
+
+namespace Scintilla {
+
+// Calls made through all headless surfaces since the last ResetDrawStatistics().
+struct DrawStatistics {
+	size_t rectangles = 0;	// FillRectangle, RectangleDraw, RoundedRectangle, AlphaRectangle, GradientRectangle, Ellipse
+	size_t lines = 0;		// LineTo and Polygon
+	size_t texts = 0;		// DrawTextNoClip, DrawTextClipped and DrawTextTransparent
+	size_t textBytes = 0;
+	size_t images = 0;		// DrawRGBAImage
+	size_t copies = 0;		// Copy from a pixmap
+	size_t measures = 0;	// MeasureWidths and WidthText, may be called from several threads
+	double filledArea = 0;	// pixels covered by opaque rectangles and text backgrounds
+	double copiedArea = 0;
+	double paintedArea = 0;	// pixels of windows written by fills, text and copies, inside the paint region
+
+	size_t DrawCalls() const noexcept {
+		return rectangles + lines + texts + images + copies;
+	}
+};
+
+DrawStatistics GetDrawStatistics() noexcept;
+void ResetDrawStatistics() noexcept;
+
+// What a WindowID points to on the headless platform.
+// Invalidated rectangles are collected until ClearInvalidated() so callers can see how much
+// of the window a change asked to repaint.
+// While painting, drawing on the window is clipped to the paint region, as the update region
+// clips it on Win32.
+struct HeadlessWindow {
+	PRectangle position;
+	bool invalidatedAll = false;
+	std::vector<PRectangle> invalidated;
+	std::vector<PRectangle> paintRegion;
+
+	explicit HeadlessWindow(PRectangle position_) noexcept : position(position_) {}
+	void ClearInvalidated() noexcept {
+		invalidatedAll = false;
+		invalidated.clear();
+	}
+	// area inside the client rectangle covered by the invalidated rectangles, overlaps counted once.
+	double InvalidatedArea() const;
+	// area of rc inside the paint region.
+	double PaintedArea(PRectangle rc) const;
+};
+
+// Fonts whose face name contains "Mono", "Courier" or "Consolas" have fixed width characters,
+// others use fixed proportional widths so measurements are the same on every machine.
+XYPOSITION HeadlessCharacterWidth(const Font &font, unsigned int ch) noexcept;
+
+}
@@ -0,0 +1,228 @@
+// Scintilla source code edit control
+/** @file TestDocument.cxx
+ ** Lexer testing.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cassert>
+#include <cstring>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "TestDocument.h"
+
+using namespace Scintilla;
+
+namespace {
+
+constexpr bool IsTrailByte(unsigned char ch) noexcept {
+	return (ch & 0xC0) == 0x80;
+}
+
+}
+
+void TestDocument::Set(std::string_view sv, int codePage_, Sci_Position gapPosition_, int version_) {
+	text = sv;
+	codePage = codePage_;
+	version = version_;
+	gapPosition = std::min<Sci_Position>(gapPosition_, text.length());
+	// fill the gap with garbage, any read into it shows up as a styling difference.
+	gapLength = 31;
+	buffer = text.substr(0, gapPosition);
+	buffer.append(gapLength, '\x7f');
+	buffer.append(text, gapPosition);
+	textStyles.assign(text.length(), '\0');
+	endStyled = 0;
+
+	lineStarts.clear();
+	lineStarts.push_back(0);
+	for (size_t pos = 0; pos < text.length(); pos++) {
+		if (text[pos] == '\n' || (text[pos] == '\r' && (pos + 1 == text.length() || text[pos + 1] != '\n'))) {
+			lineStarts.push_back(pos + 1);
+		}
+	}
+	lineStarts.push_back(text.length());
+	lineStates.assign(lineStarts.size(), 0);
+	lineLevels.assign(lineStarts.size(), SC_FOLDLEVELBASE);
+}
+
+int SCI_METHOD TestDocument::Version() const noexcept {
+	return version;
+}
+
+void SCI_METHOD TestDocument::SetErrorStatus(int) noexcept {
+}
+
+Sci_Position SCI_METHOD TestDocument::Length() const noexcept {
+	return text.length();
+}
+
+void SCI_METHOD TestDocument::GetCharRange(char *buffer_, Sci_Position position, Sci_Position lengthRetrieve) const noexcept {
+	text.copy(buffer_, lengthRetrieve, position);
+}
+
+unsigned char SCI_METHOD TestDocument::StyleAt(Sci_Position position) const noexcept {
+	if (position < 0 || position >= static_cast<Sci_Position>(textStyles.length())) {
+		return 0;
+	}
+	return textStyles[position];
+}
+
+Sci_Position SCI_METHOD TestDocument::LineFromPosition(Sci_Position position) const noexcept {
+	if (position >= static_cast<Sci_Position>(text.length())) {
+		return LineCount() - 1;
+	}
+	const auto it = std::upper_bound(lineStarts.begin(), lineStarts.end() - 1, position);
+	return std::max<Sci_Position>(it - lineStarts.begin() - 1, 0);
+}
+
+Sci_Position SCI_METHOD TestDocument::LineStart(Sci_Position line) const noexcept {
+	if (line < 0) {
+		return 0;
+	}
+	if (line >= LineCount()) {
+		return text.length();
+	}
+	return lineStarts[line];
+}
+
+int SCI_METHOD TestDocument::GetLevel(Sci_Position line) const noexcept {
+	return (line >= 0 && line < LineCount()) ? lineLevels[line] : SC_FOLDLEVELBASE;
+}
+
+int SCI_METHOD TestDocument::SetLevel(Sci_Position line, int level) {
+	if (line >= 0 && line < LineCount()) {
+		lineLevels[line] = level;
+	}
+	return 0;
+}
+
+int SCI_METHOD TestDocument::GetLineState(Sci_Position line) const noexcept {
+	return (line >= 0 && line < LineCount()) ? lineStates[line] : 0;
+}
+
+int SCI_METHOD TestDocument::SetLineState(Sci_Position line, int state) {
+	if (line >= 0 && line < LineCount()) {
+		lineStates[line] = state;
+	}
+	return 0;
+}
+
+void SCI_METHOD TestDocument::StartStyling(Sci_Position position) noexcept {
+	endStyled = position;
+}
+
+bool SCI_METHOD TestDocument::SetStyleFor(Sci_Position length, unsigned char style) {
+	assert(endStyled + length <= static_cast<Sci_Position>(textStyles.length()));
+	textStyles.replace(endStyled, length, length, style);
+	endStyled += length;
+	return true;
+}
+
+bool SCI_METHOD TestDocument::SetStyles(Sci_Position length, const unsigned char *styles) {
+	assert(endStyled + length <= static_cast<Sci_Position>(textStyles.length()));
+	textStyles.replace(endStyled, length, reinterpret_cast<const char *>(styles), length);
+	endStyled += length;
+	return true;
+}
+
+void SCI_METHOD TestDocument::DecorationSetCurrentIndicator(int) noexcept {
+}
+
+void SCI_METHOD TestDocument::DecorationFillRange(Sci_Position, int, Sci_Position) {
+}
+
+void SCI_METHOD TestDocument::ChangeLexerState(Sci_Position, Sci_Position) {
+}
+
+int SCI_METHOD TestDocument::CodePage() const noexcept {
+	return codePage;
+}
+
+bool SCI_METHOD TestDocument::IsDBCSLeadByte(unsigned char) const noexcept {
+	return false;
+}
+
+const char * SCI_METHOD TestDocument::BufferPointer() {
+	return text.c_str();
+}
+
+int SCI_METHOD TestDocument::GetLineIndentation(Sci_Position) const noexcept {
+	return 0;
+}
+
+Sci_Position SCI_METHOD TestDocument::LineEnd(Sci_Position line) const noexcept {
+	Sci_Position position = LineStart(line + 1);
+	if (line + 1 < LineCount()) {
+		if (position > 0 && text[position - 1] == '\n') {
+			--position;
+		}
+		if (position > 0 && text[position - 1] == '\r') {
+			--position;
+		}
+	}
+	return position;
+}
+
+Sci_Position SCI_METHOD TestDocument::GetRelativePosition(Sci_Position positionStart, Sci_Position characterOffset) const noexcept {
+	Sci_Position position = positionStart;
+	while (characterOffset > 0 && position < static_cast<Sci_Position>(text.length())) {
+		Sci_Position width = 1;
+		GetCharacterAndWidth(position, &width);
+		position += width;
+		--characterOffset;
+	}
+	while (characterOffset < 0 && position > 0) {
+		--position;
+		if (codePage == SC_CP_UTF8) {
+			while (position > 0 && IsTrailByte(text[position])) {
+				--position;
+			}
+		}
+		++characterOffset;
+	}
+	return (characterOffset == 0) ? position : -1;
+}
+
+int SCI_METHOD TestDocument::GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const noexcept {
+	Sci_Position width = 1;
+	int character = 0;
+	if (position >= 0 && position < static_cast<Sci_Position>(text.length())) {
+		const unsigned char lead = text[position];
+		character = lead;
+		if (codePage == SC_CP_UTF8 && lead >= 0xC2 && lead <= 0xF4) {
+			const int count = (lead < 0xE0) ? 2 : ((lead < 0xF0) ? 3 : 4);
+			int value = lead & (0x3F >> (count - 1));
+			bool valid = position + count <= static_cast<Sci_Position>(text.length());
+			for (int i = 1; valid && i < count; i++) {
+				const unsigned char trail = text[position + i];
+				valid = IsTrailByte(trail);
+				value = (value << 6) | (trail & 0x3F);
+			}
+			if (valid) {
+				width = count;
+				character = value;
+			}
+		}
+	}
+	if (pWidth) {
+		*pWidth = width;
+	}
+	return character;
+}
+
+const char * SCI_METHOD TestDocument::RangePointer(Sci_Position position, Sci_Position rangeLength) noexcept {
+	// callers must not ask for a range straddling the gap.
+	assert(position + rangeLength <= gapPosition || position >= gapPosition);
+	return buffer.c_str() + ((position < gapPosition) ? position : position + gapLength);
+}
+
+Sci_Position SCI_METHOD TestDocument::GapPosition() const noexcept {
+	return gapPosition;
+}
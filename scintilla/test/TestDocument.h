@@ -0,0 +1,57 @@
+// Scintilla source code edit control
+/** @file TestDocument.h
+ ** Lexer testing.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+#pragma once
+
+// Minimal IDocument with a gap in the middle of its buffer, so lexers reading through
+// RangePointer() have to handle both halves. Version() selects which interface is reported.
+class TestDocument : public Scintilla::IDocumentRangePointer {
+	std::string text;
+	std::string buffer;
+	Sci_Position gapPosition = 0;
+	Sci_Position gapLength = 0;
+	int codePage = 0;
+	int version = Scintilla::dvRangePointer;
+	std::string textStyles;
+	std::vector<Sci_Position> lineStarts;
+	std::vector<int> lineStates;
+	std::vector<int> lineLevels;
+	Sci_Position endStyled = 0;
+public:
+	void Set(std::string_view sv, int codePage_, Sci_Position gapPosition_, int version_);
+	const std::string &Styles() const noexcept {
+		return textStyles;
+	}
+	Sci_Position LineCount() const noexcept {
+		return lineStarts.size() - 1;
+	}
+
+	int SCI_METHOD Version() const noexcept override;
+	void SCI_METHOD SetErrorStatus(int status) noexcept override;
+	Sci_Position SCI_METHOD Length() const noexcept override;
+	void SCI_METHOD GetCharRange(char *buffer_, Sci_Position position, Sci_Position lengthRetrieve) const noexcept override;
+	unsigned char SCI_METHOD StyleAt(Sci_Position position) const noexcept override;
+	Sci_Position SCI_METHOD LineFromPosition(Sci_Position position) const noexcept override;
+	Sci_Position SCI_METHOD LineStart(Sci_Position line) const noexcept override;
+	int SCI_METHOD GetLevel(Sci_Position line) const noexcept override;
+	int SCI_METHOD SetLevel(Sci_Position line, int level) override;
+	int SCI_METHOD GetLineState(Sci_Position line) const noexcept override;
+	int SCI_METHOD SetLineState(Sci_Position line, int state) override;
+	void SCI_METHOD StartStyling(Sci_Position position) noexcept override;
+	bool SCI_METHOD SetStyleFor(Sci_Position length, unsigned char style) override;
+	bool SCI_METHOD SetStyles(Sci_Position length, const unsigned char *styles) override;
+	void SCI_METHOD DecorationSetCurrentIndicator(int indicator) noexcept override;
+	void SCI_METHOD DecorationFillRange(Sci_Position position, int value, Sci_Position fillLength) override;
+	void SCI_METHOD ChangeLexerState(Sci_Position start, Sci_Position end) override;
+	int SCI_METHOD CodePage() const noexcept override;
+	bool SCI_METHOD IsDBCSLeadByte(unsigned char ch) const noexcept override;
+	const char * SCI_METHOD BufferPointer() override;
+	int SCI_METHOD GetLineIndentation(Sci_Position line) const noexcept override;
+	Sci_Position SCI_METHOD LineEnd(Sci_Position line) const noexcept override;
+	Sci_Position SCI_METHOD GetRelativePosition(Sci_Position positionStart, Sci_Position characterOffset) const noexcept override;
+	int SCI_METHOD GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const noexcept override;
+	const char * SCI_METHOD RangePointer(Sci_Position position, Sci_Position rangeLength) noexcept override;
+	Sci_Position SCI_METHOD GapPosition() const noexcept override;
+};
@@ -0,0 +1,158 @@
+// Scintilla source code edit control
+/** @file TestFoldBatch.cxx
+ ** Fold actions inside SCI_BEGINFOLDBATCH and SCI_ENDFOLDBATCH must end with the same
+ ** folds, visible lines and caret as doing them one at a time.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <iostream>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+#include "CellBuffer.h"
+#include "KeyMap.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "Selection.h"
+#include "PositionCache.h"
+#include "EditModel.h"
+#include "MarginView.h"
+#include "EditView.h"
+#include "Editor.h"
+
+#include "HeadlessPlatform.h"
+#include "HeadlessEditor.h"
+
+using namespace Scintilla;
+
+namespace {
+
+constexpr sptr_t lineCount = 400;
+
+// Nested folds up to 5 deep, as an indented document has.
+void Configure(HeadlessEditor &editor) {
+	std::string text;
+	for (sptr_t line = 0; line < lineCount; line++) {
+		text += "line " + std::to_string(line) + "\n";
+	}
+	editor.CallString(SCI_SETTEXT, 0, text.c_str());
+	std::vector<int> depths;
+	unsigned int seed = 1;
+	int depth = 0;
+	for (sptr_t line = 0; line <= lineCount; line++) {
+		depths.push_back(depth);
+		seed = seed * 1103515245 + 12345;
+		const unsigned int step = (seed >> 16) % 4;
+		if (step == 0 && depth < 5) {
+			depth++;
+		} else if (step == 1 && depth > 0) {
+			depth--;
+		}
+	}
+	for (sptr_t line = 0; line <= lineCount; line++) {
+		int level = SC_FOLDLEVELBASE + depths[line];
+		if (line < lineCount && depths[line + 1] > depths[line]) {
+			level |= SC_FOLDLEVELHEADERFLAG;
+		}
+		editor.Call(SCI_SETFOLDLEVEL, line, level);
+	}
+}
+
+struct FoldState {
+	std::vector<sptr_t> visible;
+	std::vector<sptr_t> expanded;
+	sptr_t caret;
+};
+
+FoldState State(HeadlessEditor &editor) {
+	FoldState state;
+	for (sptr_t line = 0; line <= lineCount; line++) {
+		state.visible.push_back(editor.Call(SCI_GETLINEVISIBLE, line));
+		state.expanded.push_back(editor.Call(SCI_GETFOLDEXPANDED, line));
+	}
+	state.caret = editor.Call(SCI_GETCURRENTPOS);
+	return state;
+}
+
+bool Compare(int round, const FoldState &single, const FoldState &batch) {
+	bool success = true;
+	for (sptr_t line = 0; line <= lineCount; line++) {
+		if (single.visible[line] != batch.visible[line] || single.expanded[line] != batch.expanded[line]) {
+			std::cout << "round " << round << ": line " << line << " visible " << single.visible[line]
+				<< " expanded " << single.expanded[line] << " one at a time, visible " << batch.visible[line]
+				<< " expanded " << batch.expanded[line] << " in a batch\n";
+			success = false;
+			break;
+		}
+	}
+	if (single.caret != batch.caret) {
+		std::cout << "round " << round << ": caret at " << single.caret << " one at a time and at "
+			<< batch.caret << " in a batch\n";
+		success = false;
+	}
+	return success;
+}
+
+}
+
+int main() {
+	const PRectangle rcWindow(0, 0, 600, 400);
+	HeadlessEditor single(rcWindow);
+	HeadlessEditor batch(rcWindow);
+	Configure(single);
+	Configure(batch);
+
+	const int actions[] = { SC_FOLDACTION_CONTRACT, SC_FOLDACTION_EXPAND, SC_FOLDACTION_TOGGLE };
+	unsigned int seed = 7;
+	int rounds = 0;
+	int failures = 0;
+	for (int round = 0; round < 200; round++) {
+		// A few actions per batch so later ones see lines hidden or shown by earlier ones
+		const int count = 1 + round % 8;
+		batch.Call(SCI_BEGINFOLDBATCH);
+		for (int i = 0; i < count; i++) {
+			seed = seed * 1103515245 + 12345;
+			const sptr_t line = (seed >> 8) % lineCount;
+			const int action = actions[(seed >> 20) % std::size(actions)];
+			single.Call(SCI_FOLDLINE, line, action);
+			batch.Call(SCI_FOLDLINE, line, action);
+		}
+		batch.Call(SCI_ENDFOLDBATCH);
+		++rounds;
+		if (!Compare(round, State(single), State(batch))) {
+			++failures;
+		}
+	}
+
+	std::cout << "Folded in " << rounds << " batches, " << failures << " failed.\n";
+	return (failures == 0) ? 0 : 1;
+}
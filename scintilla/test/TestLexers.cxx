@@ -0,0 +1,222 @@
+// Scintilla source code edit control
+/** @file TestLexers.cxx
+ ** Lexer testing.
+ ** Each file in examples directory is styled and folded, the result is compared with
+ ** file.styled and file.folded, differences are written to file.styled.new and file.folded.new.
+ ** TestLexers --bench file [repeat] prints time to style and fold the file instead.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+#include "ILexer.h"
+#include "Scintilla.h"
+#include "SciLexer.h"
+#include "LexerModule.h"
+
+#include "TestDocument.h"
+
+using namespace Scintilla;
+
+extern LexerModule lmCPP;
+extern LexerModule lmHTML;
+extern LexerModule lmJSON;
+extern LexerModule lmPython;
+
+namespace {
+
+struct LexerForExtension {
+	const char *extension;
+	const LexerModule *module;
+	const char *langType;
+};
+
+const LexerForExtension lexerForExtension[] = {
+	{ ".cpp", &lmCPP, nullptr },
+	{ ".js", &lmCPP, "4" },
+	{ ".php", &lmCPP, "29" },
+	{ ".html", &lmHTML, nullptr },
+	{ ".json", &lmJSON, nullptr },
+	{ ".py", &lmPython, nullptr },
+};
+
+std::string ReadFile(const std::filesystem::path &path) {
+	std::ifstream ifs(path, std::ios::binary);
+	std::ostringstream oss;
+	oss << ifs.rdbuf();
+	return oss.str();
+}
+
+void WriteFile(const std::filesystem::path &path, std::string_view text) {
+	std::ofstream ofs(path, std::ios::binary);
+	ofs << text;
+}
+
+// text with {style} inserted before each run of same style.
+std::string MarkedDocument(std::string_view text, const std::string &styles) {
+	std::string marked;
+	int prevStyle = -1;
+	for (size_t pos = 0; pos < text.length(); pos++) {
+		const int style = static_cast<unsigned char>(styles[pos]);
+		if (style != prevStyle) {
+			marked += '{' + std::to_string(style) + '}';
+			prevStyle = style;
+		}
+		marked += text[pos];
+	}
+	return marked;
+}
+
+// fold level in hex before each line.
+std::string FoldedDocument(std::string_view text, const TestDocument &doc) {
+	std::string folded;
+	for (Sci_Position line = 0; line < doc.LineCount(); line++) {
+		char level[16];
+		snprintf(level, sizeof(level), "%4x ", doc.GetLevel(line));
+		folded += level;
+		folded += text.substr(doc.LineStart(line), doc.LineStart(line + 1) - doc.LineStart(line));
+	}
+	return folded;
+}
+
+bool CompareWithExpected(const std::filesystem::path &path, const std::string &actual) {
+	const std::filesystem::path pathNew = path.string() + ".new";
+	if (std::filesystem::exists(path) && ReadFile(path) == actual) {
+		std::filesystem::remove(pathNew);
+		return true;
+	}
+	std::cout << "\n" << path.string() << ":1: is different\n";
+	WriteFile(pathNew, actual);
+	return false;
+}
+
+const LexerForExtension *FindLexer(const std::filesystem::path &path) {
+	const std::string extension = path.extension().string();
+	for (const auto &item : lexerForExtension) {
+		if (extension == item.extension) {
+			return &item;
+		}
+	}
+	return nullptr;
+}
+
+ILexer5 *CreateLexer(const LexerForExtension &config) {
+	ILexer5 *lexer = config.module->Create();
+	lexer->PropertySet("fold", "1");
+	lexer->PropertySet("fold.compact", "0");
+	if (config.langType) {
+		lexer->PropertySet("lexer.lang.type", config.langType);
+	}
+	return lexer;
+}
+
+bool TestFile(const std::filesystem::path &path, const LexerForExtension &config) {
+	const std::string text = ReadFile(path);
+	const Sci_Position length = text.length();
+	const int versions[] = { dvRelease4, dvRangePointer };
+	const Sci_Position gaps[] = { 0, length / 3, length / 2 + 1, length };
+
+	std::string styledFirst;
+	std::string foldedFirst;
+	bool success = true;
+	for (const int version : versions) {
+		for (const Sci_Position gap : gaps) {
+			ILexer5 *lexer = CreateLexer(config);
+			TestDocument doc;
+			doc.Set(text, SC_CP_UTF8, gap, version);
+			lexer->Lex(0, length, 0, &doc);
+			lexer->Fold(0, length, 0, &doc);
+			lexer->Release();
+
+			const std::string styled = MarkedDocument(text, doc.Styles());
+			const std::string folded = FoldedDocument(text, doc);
+			if (styledFirst.empty() && foldedFirst.empty()) {
+				styledFirst = styled;
+				foldedFirst = folded;
+			} else if (styled != styledFirst || folded != foldedFirst) {
+				std::cout << "\n" << path.string() << ":1: different result with version " << version << " and gap at " << gap << "\n";
+				success = false;
+			}
+		}
+	}
+
+	success = CompareWithExpected(path.string() + ".styled", styledFirst) && success;
+	success = CompareWithExpected(path.string() + ".folded", foldedFirst) && success;
+	return success;
+}
+
+// best and median time of styling and folding whole file, gap at document end as after loading.
+int BenchFile(const std::filesystem::path &path, int repeat) {
+	const LexerForExtension *config = FindLexer(path);
+	if (config == nullptr) {
+		std::cout << path.string() << ": no lexer for the extension\n";
+		return 1;
+	}
+
+	const std::string text = ReadFile(path);
+	const Sci_Position length = text.length();
+	std::vector<double> times;
+	TestDocument doc;
+	for (int i = 0; i < repeat; i++) {
+		doc.Set(text, SC_CP_UTF8, length, dvRangePointer);
+		ILexer5 *lexer = CreateLexer(*config);
+		const auto start = std::chrono::steady_clock::now();
+		lexer->Lex(0, length, 0, &doc);
+		lexer->Fold(0, length, 0, &doc);
+		const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+		lexer->Release();
+		times.push_back(duration.count());
+	}
+
+	std::sort(times.begin(), times.end());
+	const double best = times.front();
+	const double median = times[times.size() / 2];
+	printf("%s: %zu bytes, best %.2f ms, median %.2f ms, %.1f MB/s\n", path.string().c_str(),
+		text.length(), best, median, length / (best * 1000.0));
+	return 0;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	if (argc > 2 && strcmp(argv[1], "--bench") == 0) {
+		const int repeat = (argc > 3) ? std::max(atoi(argv[3]), 1) : 10;
+		return BenchFile(argv[2], repeat);
+	}
+
+	const std::filesystem::path examples = (argc > 1) ? argv[1] : "examples";
+	std::vector<std::filesystem::path> paths;
+	for (const auto &entry : std::filesystem::recursive_directory_iterator(examples)) {
+		if (entry.is_regular_file()) {
+			paths.push_back(entry.path());
+		}
+	}
+	std::sort(paths.begin(), paths.end());
+
+	int files = 0;
+	int failures = 0;
+	for (const auto &path : paths) {
+		const LexerForExtension *config = FindLexer(path);
+		if (config != nullptr) {
+			++files;
+			if (!TestFile(path, *config)) {
+				++failures;
+			}
+		}
+	}
+
+	std::cout << "Lexed " << files << " files, " << failures << " failed.\n";
+	return (files != 0 && failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,258 @@
+// Scintilla source code edit control
+/** @file TestLongLine.cxx
+ ** Windowed layout of long lines must give the same positions as laying them out whole.
+ ** The same document is loaded in an editor that windows lines over a few blocks and in one
+ ** that never windows, then points, hit tests and caret moves are compared.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <cmath>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <iostream>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+#include "CellBuffer.h"
+#include "KeyMap.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "Selection.h"
+#include "PositionCache.h"
+#include "EditModel.h"
+#include "MarginView.h"
+#include "EditView.h"
+#include "Editor.h"
+
+#include "HeadlessPlatform.h"
+#include "HeadlessEditor.h"
+
+using namespace Scintilla;
+
+namespace {
+
+// Lines longer than this are windowed in the windowed editor, a few times the block length.
+constexpr int windowedLength = 10000;
+
+const char *const fragments[] = {
+	"word", "longerword", "x", "\t", "\t\t", "  ", "a,b,c", "é", "中文字符", "😀", "\x01", "\x1b",
+	"(call)", "12345", "\xE2\x80\x8B",
+};
+
+// Deterministic line of about width bytes.
+std::string MakeLine(size_t width, unsigned int seed) {
+	std::string line;
+	while (line.length() < width) {
+		seed = seed * 1103515245 + 12345;
+		line += fragments[(seed >> 16) % std::size(fragments)];
+		if ((seed >> 8) % 3) {
+			line += ' ';
+		}
+	}
+	return line;
+}
+
+// Style every word with one of four styles, as a lexer would.
+void StyleDocument(HeadlessEditor &editor) {
+	const sptr_t length = editor.Call(SCI_GETLENGTH);
+	std::vector<char> styles(length);
+	int style = 0;
+	for (sptr_t pos = 0; pos < length; pos++) {
+		if (editor.Call(SCI_GETCHARAT, pos) == ' ') {
+			style = (style + 1) % 4;
+		}
+		styles[pos] = static_cast<char>(style);
+	}
+	editor.Call(SCI_STARTSTYLING, 0);
+	editor.Call(SCI_SETSTYLINGEX, styles.size(), reinterpret_cast<sptr_t>(styles.data()));
+}
+
+void Configure(HeadlessEditor &editor, int length, const std::string &text) {
+	editor.SetWindowedLength(length);
+	editor.Call(SCI_SETCODEPAGE, SC_CP_UTF8);
+	editor.CallString(SCI_STYLESETFONT, STYLE_DEFAULT, "Verdana");
+	editor.Call(SCI_STYLECLEARALL);
+	editor.Call(SCI_STYLESETBOLD, 1, 1);
+	editor.Call(SCI_STYLESETITALIC, 2, 1);
+	editor.CallString(SCI_STYLESETFONT, 3, "Consolas");
+	editor.Call(SCI_SETTABWIDTH, 4);
+	editor.CallString(SCI_SETTEXT, 0, text.c_str());
+	StyleDocument(editor);
+}
+
+class Comparison {
+	HeadlessEditor &windowed;
+	HeadlessEditor &whole;
+	int failures = 0;
+public:
+	Comparison(HeadlessEditor &windowed_, HeadlessEditor &whole_) noexcept : windowed(windowed_), whole(whole_) {}
+	int Failures() const noexcept {
+		return failures;
+	}
+	// Result of a message sent to both editors, reported when different by more than tolerance.
+	sptr_t Same(const char *what, unsigned int message, uptr_t wParam, sptr_t lParam, sptr_t tolerance = 0) {
+		const sptr_t resultWindowed = windowed.Call(message, wParam, lParam);
+		const sptr_t resultWhole = whole.Call(message, wParam, lParam);
+		if (std::abs(resultWindowed - resultWhole) > tolerance) {
+			if (failures < 20) {
+				std::cout << what << " (" << wParam << ", " << lParam << "): " << resultWindowed
+					<< " when windowed and " << resultWhole << " when whole\n";
+			}
+			failures++;
+		}
+		return resultWhole;
+	}
+	void Both(unsigned int message, uptr_t wParam = 0, sptr_t lParam = 0) {
+		windowed.Call(message, wParam, lParam);
+		whole.Call(message, wParam, lParam);
+	}
+	void Fail(const char *what) {
+		std::cout << what << "\n";
+		failures++;
+	}
+
+	// Points of positions on a line in scattered order, then the positions at points next to them.
+	void Points(sptr_t line, unsigned int seed) {
+		const sptr_t start = whole.Call(SCI_POSITIONFROMLINE, line);
+		const sptr_t end = whole.Call(SCI_GETLINEENDPOSITION, line);
+		const sptr_t y = whole.Call(SCI_POINTYFROMPOSITION, 0, start) + 1;
+		for (int i = 0; i < 300; i++) {
+			seed = seed * 1103515245 + 12345;
+			const sptr_t pos = whole.Call(SCI_POSITIONAFTER, start + (seed >> 8) % (end - start + 1));
+			const sptr_t x = Same("point x", SCI_POINTXFROMPOSITION, 0, pos, 1);
+			Same("position from point", SCI_POSITIONFROMPOINT, x + 2, y);
+			Same("position from point close", SCI_CHARPOSITIONFROMPOINTCLOSE, x + 2, y);
+		}
+		// line end, where the end of all blocks is measured
+		Same("point x of line end", SCI_POINTXFROMPOSITION, 0, end, 1);
+	}
+
+	// Caret moves that use the x of the caret on long lines.
+	void CaretMoves(sptr_t line, unsigned int seed) {
+		const sptr_t start = whole.Call(SCI_POSITIONFROMLINE, line);
+		const sptr_t end = whole.Call(SCI_GETLINEENDPOSITION, line);
+		const unsigned int moves[] = { SCI_CHARRIGHT, SCI_LINEDOWN, SCI_LINEUP, SCI_WORDRIGHT, SCI_LINEEND, SCI_CHARLEFT, SCI_VCHOME };
+		for (int i = 0; i < 40; i++) {
+			seed = seed * 1103515245 + 12345;
+			const sptr_t pos = whole.Call(SCI_POSITIONAFTER, start + (seed >> 8) % (end - start + 1));
+			Both(SCI_GOTOPOS, pos);
+			for (const unsigned int move : moves) {
+				Both(move);
+				Same("caret after move", SCI_GETCURRENTPOS, 0, 0);
+			}
+		}
+	}
+};
+
+// Painting the start of a long line only measures the blocks on screen.
+bool MeasuredWhenPainting(const std::string &text) {
+	const PRectangle rcWindow(0, 0, 1000, 800);
+	HeadlessEditor windowed(rcWindow);
+	HeadlessEditor whole(rcWindow);
+	Configure(windowed, windowedLength, text);
+	Configure(whole, INT_MAX, text);
+	// without the position cache every segment laid out is measured
+	windowed.Call(SCI_SETPOSITIONCACHE, 0);
+	whole.Call(SCI_SETPOSITIONCACHE, 0);
+	ResetDrawStatistics();
+	windowed.PaintAll();
+	const size_t measuresWindowed = GetDrawStatistics().measures;
+	ResetDrawStatistics();
+	whole.PaintAll();
+	const size_t measuresWhole = GetDrawStatistics().measures;
+	if (measuresWindowed * 4 > measuresWhole) {
+		std::cout << "painting the line starts measured " << measuresWindowed << " times when windowed and "
+			<< measuresWhole << " times when whole\n";
+		return false;
+	}
+	return true;
+}
+
+int TestWindowed(const std::string &text) {
+	const PRectangle rcWindow(0, 0, 1000, 800);
+	HeadlessEditor windowed(rcWindow);
+	HeadlessEditor whole(rcWindow);
+	Configure(windowed, windowedLength, text);
+	Configure(whole, INT_MAX, text);
+	Comparison comparison(windowed, whole);
+
+	const sptr_t lines = whole.Call(SCI_GETLINECOUNT);
+	for (sptr_t line = 0; line < lines; line++) {
+		comparison.Points(line, static_cast<unsigned int>(line + 1));
+		comparison.CaretMoves(line, static_cast<unsigned int>(line + 7));
+	}
+
+	// Painting across the line, with a block caret and visible line ends
+	comparison.Both(SCI_SETCARETSTYLE, CARETSTYLE_BLOCK);
+	comparison.Both(SCI_SETVIEWEOL, 1);
+	comparison.Both(SCI_GOTOPOS, whole.Call(SCI_GETLINEENDPOSITION, 1) / 2);
+	const sptr_t widthLine = whole.Call(SCI_POINTXFROMPOSITION, 0, whole.Call(SCI_GETLINEENDPOSITION, 1));
+	for (int step = 0; step <= 20; step++) {
+		windowed.Call(SCI_SETXOFFSET, widthLine * step / 20);
+		windowed.PaintAll();
+	}
+	comparison.Both(SCI_SETXOFFSET, 0);
+
+	// Edits in the middle of a long line keep the blocks before them, appending changes the last block
+	for (sptr_t line = 1; line < lines; line++) {
+		const sptr_t start = whole.Call(SCI_POSITIONFROMLINE, line);
+		const sptr_t end = whole.Call(SCI_GETLINEENDPOSITION, line);
+		comparison.Both(SCI_GOTOPOS, whole.Call(SCI_POSITIONAFTER, start + (end - start) / 3));
+		comparison.Both(SCI_ADDTEXT, 5, reinterpret_cast<sptr_t>("\tw中"));
+		comparison.Points(line, static_cast<unsigned int>(line + 11));
+		comparison.Both(SCI_GOTOPOS, whole.Call(SCI_GETLINEENDPOSITION, line));
+		comparison.Both(SCI_ADDTEXT, 3, reinterpret_cast<sptr_t>("\txy"));
+		comparison.Points(line, static_cast<unsigned int>(line + 13));
+	}
+	// Changing a style lays out every block again
+	comparison.Both(SCI_STYLESETBOLD, 0, 1);
+	comparison.Points(1, 17);
+
+	return comparison.Failures();
+}
+
+}
+
+int main() {
+	std::string text = MakeLine(100, 1) + "\r\n";
+	text += MakeLine(60000, 2) + "\r\n";
+	text += MakeLine(45000, 3) + "\n";
+	text += MakeLine(8000, 4) + "\n";
+	text += MakeLine(30000, 5);
+
+	int failures = TestWindowed(text);
+	if (!MeasuredWhenPainting(text)) {
+		failures++;
+	}
+
+	std::cout << "Compared windowed long lines, " << failures << " failed.\n";
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+// Scintilla source code edit control
+/** @file TestReloadFolds.cxx
+ ** Reloading a file replaces only the changed bytes found by EditDiff_GetHunks() and
+ ** EditDiff_TrimHunk(), as EditReplaceTextByDiff() in Notepad2 does, contracted folds and
+ ** hidden lines must be kept.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <iostream>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+#include "CellBuffer.h"
+#include "KeyMap.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "Selection.h"
+#include "PositionCache.h"
+#include "EditModel.h"
+#include "MarginView.h"
+#include "EditView.h"
+#include "Editor.h"
+
+#include "HeadlessPlatform.h"
+#include "HeadlessEditor.h"
+
+#include "../../src/EditDiff.h"
+
+using namespace Scintilla;
+
+namespace {
+
+constexpr sptr_t lineCount = 200;
+
+std::string LineText(sptr_t line, bool changed) {
+	return (changed ? "changed " : "line ") + std::to_string(line) + "\r\n";
+}
+
+// every 10th line is a fold header for the next 9 lines.
+void Configure(HeadlessEditor &editor) {
+	std::string text;
+	for (sptr_t line = 0; line < lineCount; line++) {
+		text += LineText(line, false);
+	}
+	editor.CallString(SCI_SETTEXT, 0, text.c_str());
+	for (sptr_t line = 0; line <= lineCount; line++) {
+		const int level = (line % 10 == 0) ? (SC_FOLDLEVELBASE | SC_FOLDLEVELHEADERFLAG) : (SC_FOLDLEVELBASE + 1);
+		editor.Call(SCI_SETFOLDLEVEL, line, level);
+	}
+	// contract every other fold
+	for (sptr_t line = 0; line < lineCount; line += 20) {
+		editor.Call(SCI_FOLDLINE, line, SC_FOLDACTION_CONTRACT);
+	}
+}
+
+struct FoldState {
+	std::vector<sptr_t> visible;
+	std::vector<sptr_t> expanded;
+};
+
+FoldState State(HeadlessEditor &editor) {
+	FoldState state;
+	for (sptr_t line = 0; line < lineCount; line++) {
+		state.visible.push_back(editor.Call(SCI_GETLINEVISIBLE, line));
+		state.expanded.push_back(editor.Call(SCI_GETFOLDEXPANDED, line));
+	}
+	return state;
+}
+
+// replace changed lines in the document with the new text, from last hunk to first.
+bool Reload(HeadlessEditor &editor, const std::string &newText) {
+	const sptr_t length = editor.Call(SCI_GETLENGTH);
+	const char *oldText = reinterpret_cast<const char *>(editor.Call(SCI_GETCHARACTERPOINTER));
+	EditDiffHunk *hunks = nullptr;
+	const int count = EditDiff_GetHunks(oldText, static_cast<uint32_t>(length), newText.data(), static_cast<uint32_t>(newText.length()), &hunks);
+	if (count < 0) {
+		return false;
+	}
+	for (int i = 0; i < count; i++) {
+		EditDiff_TrimHunk(oldText, newText.data(), &hunks[i]);
+	}
+	editor.Call(SCI_BEGINUNDOACTION);
+	for (int i = count; i != 0; i--) {
+		const EditDiffHunk &hunk = hunks[i - 1];
+		editor.Call(SCI_SETTARGETRANGE, hunk.oldStart, hunk.oldEnd);
+		editor.CallString(SCI_REPLACETARGET, hunk.newEnd - hunk.newStart, newText.data() + hunk.newStart);
+	}
+	editor.Call(SCI_ENDUNDOACTION);
+	std::free(hunks);
+	return true;
+}
+
+}
+
+int main() {
+	const PRectangle rcWindow(0, 0, 600, 400);
+	int rounds = 0;
+	int failures = 0;
+	// one changed line in each position: header or body line of contracted and expanded folds.
+	for (sptr_t changed = 0; changed < 40; changed++) {
+		HeadlessEditor editor(rcWindow);
+		Configure(editor);
+		const FoldState before = State(editor);
+
+		std::string text;
+		for (sptr_t line = 0; line < lineCount; line++) {
+			text += LineText(line, line == changed);
+		}
+		++rounds;
+		if (!Reload(editor, text)) {
+			std::cout << "line " << changed << ": out of memory\n";
+			++failures;
+			continue;
+		}
+
+		const sptr_t length = editor.Call(SCI_GETLENGTH);
+		const char *documentText = reinterpret_cast<const char *>(editor.Call(SCI_GETCHARACTERPOINTER));
+		if (std::string_view(documentText, length) != text) {
+			std::cout << "line " << changed << ": document differs from reloaded text\n";
+			++failures;
+			continue;
+		}
+		const FoldState after = State(editor);
+		for (sptr_t line = 0; line < lineCount; line++) {
+			if (before.visible[line] != after.visible[line] || before.expanded[line] != after.expanded[line]) {
+				std::cout << "line " << changed << " changed: line " << line << " visible " << before.visible[line]
+					<< " expanded " << before.expanded[line] << " before reload, visible " << after.visible[line]
+					<< " expanded " << after.expanded[line] << " after reload\n";
+				++failures;
+				break;
+			}
+		}
+	}
+
+	std::cout << "Reloaded with one changed line " << rounds << " times, " << failures << " failed.\n";
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,456 @@
+// Scintilla source code edit control
+/** @file TestUniConversion.cxx
+ ** UTF-8 and UTF-16 conversion with SIMD must give the same results as the scalar loops.
+ ** Random and mutated text is converted with both and the lengths, output and exceptions compared.
+ ** Built for SSE2 and for AVX2, so both sets of kernels are checked.
+ ** TestUniConversion --bench prints conversion speed of both for a few scripts instead.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#include <stdexcept>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#include "VectorISA.h"
+#include "UniConversion.h"
+
+using namespace Scintilla;
+
+namespace {
+
+// The scalar loops without SIMD.
+namespace Scalar {
+
+size_t UTF8Length(std::wstring_view wsv) noexcept {
+	size_t len = 0;
+	for (size_t i = 0; i < wsv.length() && wsv[i];) {
+		const unsigned int uch = wsv[i];
+		if (uch < 0x80) {
+			len++;
+		} else if (uch < 0x800) {
+			len += 2;
+		} else if ((uch >= SURROGATE_LEAD_FIRST) &&
+			(uch <= SURROGATE_TRAIL_LAST)) {
+			len += 4;
+			i++;
+		} else {
+			len += 3;
+		}
+		i++;
+	}
+	return len;
+}
+
+void UTF8FromUTF16(std::wstring_view wsv, char *putf, size_t len) noexcept {
+	size_t k = 0;
+	for (size_t i = 0; i < wsv.length() && wsv[i];) {
+		const unsigned int uch = wsv[i];
+		if (uch < 0x80) {
+			putf[k++] = static_cast<char>(uch);
+		} else if (uch < 0x800) {
+			putf[k++] = static_cast<char>(0xC0 | (uch >> 6));
+			putf[k++] = static_cast<char>(0x80 | (uch & 0x3f));
+		} else if ((uch >= SURROGATE_LEAD_FIRST) &&
+			(uch <= SURROGATE_TRAIL_LAST)) {
+			i++;
+			const unsigned int xch = 0x10000 + ((uch & 0x3ff) << 10) + (wsv[i] & 0x3ff);
+			putf[k++] = static_cast<char>(0xF0 | (xch >> 18));
+			putf[k++] = static_cast<char>(0x80 | ((xch >> 12) & 0x3f));
+			putf[k++] = static_cast<char>(0x80 | ((xch >> 6) & 0x3f));
+			putf[k++] = static_cast<char>(0x80 | (xch & 0x3f));
+		} else {
+			putf[k++] = static_cast<char>(0xE0 | (uch >> 12));
+			putf[k++] = static_cast<char>(0x80 | ((uch >> 6) & 0x3f));
+			putf[k++] = static_cast<char>(0x80 | (uch & 0x3f));
+		}
+		i++;
+	}
+	if (k < len)
+		putf[k] = '\0';
+}
+
+size_t UTF16Length(std::string_view svu8) noexcept {
+	size_t ulen = 0;
+	size_t i = 0;
+	unsigned int byteCount = 0;
+	while (i < svu8.length()) {
+		const unsigned char ch = svu8[i];
+		byteCount = UTF8BytesOfLead(ch);
+		i += byteCount;
+		ulen += UTF16LengthFromUTF8ByteCount(byteCount);
+	}
+	const unsigned mask = (1 << (byteCount & 4)) - 1;
+	if (mask & (i ^ svu8.length())) {
+		ulen--;
+	}
+	return ulen;
+}
+
+size_t UTF16FromUTF8(std::string_view svu8, wchar_t *tbuf, size_t tlen) {
+	size_t ui = 0;
+	for (size_t i = 0; i < svu8.length();) {
+		unsigned char ch = svu8[i];
+		const unsigned int byteCount = UTF8BytesOfLead(ch);
+		unsigned int value;
+
+		if (i + byteCount > svu8.length()) {
+			if (ui < tlen) {
+				tbuf[ui] = ch;
+				ui++;
+			}
+			break;
+		}
+
+		const size_t outLen = UTF16LengthFromUTF8ByteCount(byteCount);
+		if (ui + outLen > tlen) {
+			throw std::runtime_error("UTF16FromUTF8: attempted write beyond end");
+		}
+
+		i++;
+		switch (byteCount) {
+		case 1:
+			tbuf[ui] = ch;
+			break;
+		case 2:
+			value = (ch & 0x1F) << 6;
+			ch = svu8[i++];
+			value += ch & 0x3F;
+			tbuf[ui] = static_cast<wchar_t>(value);
+			break;
+		case 3:
+			value = (ch & 0xF) << 12;
+			ch = svu8[i++];
+			value += (ch & 0x3F) << 6;
+			ch = svu8[i++];
+			value += ch & 0x3F;
+			tbuf[ui] = static_cast<wchar_t>(value);
+			break;
+		default:
+			value = (ch & 0x7) << 18;
+			ch = svu8[i++];
+			value += (ch & 0x3F) << 12;
+			ch = svu8[i++];
+			value += (ch & 0x3F) << 6;
+			ch = svu8[i++];
+			value += ch & 0x3F;
+			tbuf[ui] = static_cast<wchar_t>(((value - 0x10000) >> 10) + SURROGATE_LEAD_FIRST);
+			ui++;
+			tbuf[ui] = static_cast<wchar_t>((value & 0x3ff) + SURROGATE_TRAIL_FIRST);
+			break;
+		}
+		ui++;
+	}
+	return ui;
+}
+
+}
+
+class Random {
+	uint32_t seed;
+public:
+	explicit Random(uint32_t seed_) noexcept : seed(seed_) {}
+	uint32_t Next(uint32_t range) noexcept {
+		seed = seed * 1103515245 + 12345;
+		return ((seed >> 8) & 0xffffff) % range;
+	}
+	uint32_t Between(uint32_t low, uint32_t high) noexcept {
+		return low + Next(high - low + 1);
+	}
+};
+
+void AppendUTF8(std::string &text, unsigned int ch) {
+	char buffer[UTF8MaxBytes + 1];
+	UTF8FromUTF32Character(static_cast<int>(ch), buffer);
+	text += buffer;
+}
+
+// Runs of characters of the same width, as text in one script has, with a few mistakes:
+// overlong forms, encoded surrogates, stray trail bytes and truncated characters.
+std::string MakeUTF8(Random &random, size_t length) {
+	std::string text;
+	while (text.length() < length) {
+		const uint32_t kind = random.Next(12);
+		const uint32_t run = random.Between(1, 40);
+		for (uint32_t j = 0; j < run; j++) {
+			switch (kind) {
+			case 0:
+			case 1:
+				text += static_cast<char>(random.Between(1, 0x7F));
+				break;
+			case 2:
+			case 3:
+				AppendUTF8(text, random.Between(0x80, 0x7FF));
+				break;
+			case 4:
+			case 5:
+				AppendUTF8(text, random.Between(0x800, 0xD7FF));
+				break;
+			case 6:
+				AppendUTF8(text, random.Between(0xE000, 0xFFFF));
+				break;
+			case 7:
+				AppendUTF8(text, random.Between(0x10000, 0x10FFFF));
+				break;
+			case 8: {
+				// overlong or encoded surrogate
+				const char *const bad[] = { "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xED\xBF\xBF", "\xF0\x80\x80\x80" };
+				text += bad[random.Next(std::size(bad))];
+			} break;
+			case 9:
+				text += static_cast<char>(random.Between(0x80, 0xFF));
+				break;
+			case 10: {
+				// truncated character followed by ASCII
+				std::string ch;
+				AppendUTF8(ch, random.Between(0x800, 0xFFFF));
+				text += ch.substr(0, random.Between(1, 2));
+				text += 'a';
+			} break;
+			default:
+				text += static_cast<char>(random.Next(0x100));
+				break;
+			}
+		}
+	}
+	text.resize(length);
+	return text;
+}
+
+// Runs of code units in the same range with lone surrogates and NUL, and values outside
+// of UTF-16 when wchar_t is 32 bits.
+std::wstring MakeUTF16(Random &random, size_t length) {
+	std::wstring text;
+	while (text.length() < length) {
+		const uint32_t kind = random.Next(10);
+		const uint32_t run = random.Between(1, 40);
+		for (uint32_t j = 0; j < run; j++) {
+			unsigned int ch;
+			switch (kind) {
+			case 0:
+			case 1:
+				ch = random.Between(1, 0x7F);
+				break;
+			case 2:
+			case 3:
+				ch = random.Between(0x80, 0x7FF);
+				break;
+			case 4:
+			case 5:
+				ch = random.Between(0x800, 0xFFFF);
+				break;
+			case 6:
+				ch = random.Between(SURROGATE_LEAD_FIRST, SURROGATE_LEAD_LAST);
+				text += static_cast<wchar_t>(ch);
+				ch = random.Between(SURROGATE_TRAIL_FIRST, SURROGATE_TRAIL_LAST);
+				break;
+			case 7:
+				ch = random.Between(SURROGATE_LEAD_FIRST, SURROGATE_TRAIL_LAST);
+				break;
+			case 8:
+				ch = random.Next(50) ? random.Between(1, 0xFFFF) : 0;
+				break;
+			default:
+				if constexpr (sizeof(wchar_t) == 2) {
+					ch = random.Next(0x10000);
+				} else {
+					const unsigned int values[] = { 0x10000, 0x1F600, 0x10FFFF, 0x110000, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF, 0x1D800 };
+					ch = values[random.Next(std::size(values))];
+				}
+				break;
+			}
+			text += static_cast<wchar_t>(ch);
+		}
+	}
+	text.resize(length);
+	return text;
+}
+
+constexpr size_t guard = 40;
+constexpr wchar_t fillUTF16 = 0x5A5A;
+constexpr char fillUTF8 = '\x5A';
+
+int failures = 0;
+
+void Fail(const char *what, size_t round, size_t length) {
+	if (failures < 20) {
+		std::cout << what << ": round " << round << ", length " << length << "\n";
+	}
+	failures++;
+}
+
+// Converts into buffers longer than the length given, the part after must be untouched.
+void CompareUTF16FromUTF8(size_t round, std::string_view text, size_t tlen) {
+	std::vector<wchar_t> expected(tlen + guard, fillUTF16);
+	std::vector<wchar_t> actual(tlen + guard, fillUTF16);
+	size_t lenExpected = 0;
+	size_t lenActual = 0;
+	bool throwExpected = false;
+	bool throwActual = false;
+	try {
+		lenExpected = Scalar::UTF16FromUTF8(text, expected.data(), tlen);
+	} catch (const std::runtime_error &) {
+		throwExpected = true;
+	}
+	try {
+		lenActual = UTF16FromUTF8(text, actual.data(), tlen);
+	} catch (const std::runtime_error &) {
+		throwActual = true;
+	}
+	if (throwExpected != throwActual) {
+		Fail("UTF16FromUTF8 exception", round, text.length());
+	} else if (throwExpected) {
+		// output before the exception is not used
+	} else if (lenExpected != lenActual || expected != actual) {
+		Fail("UTF16FromUTF8", round, text.length());
+	}
+}
+
+void CompareUTF8FromUTF16(size_t round, std::wstring_view text, size_t len) {
+	std::vector<char> expected(len + guard, fillUTF8);
+	std::vector<char> actual(len + guard, fillUTF8);
+	Scalar::UTF8FromUTF16(text, expected.data(), len);
+	UTF8FromUTF16(text, actual.data(), len);
+	// bytes after the NUL up to len may differ, the part after len must be untouched
+	const auto nul = std::find(expected.begin(), expected.begin() + len, '\0');
+	const size_t terminated = (nul - expected.begin()) + (nul != expected.begin() + len);
+	if (!std::equal(expected.begin(), expected.begin() + terminated, actual.begin())
+		|| !std::equal(expected.begin() + len, expected.end(), actual.begin() + len)) {
+		Fail("UTF8FromUTF16", round, text.length());
+	}
+}
+
+void Fuzz(size_t rounds) {
+	Random random(1);
+	for (size_t round = 0; round < rounds; round++) {
+		const size_t length = random.Next(4) ? random.Next(100) : random.Next(2000);
+
+		const std::string u8 = MakeUTF8(random, length);
+		const size_t len16 = Scalar::UTF16Length(u8);
+		if (UTF16Length(u8) != len16) {
+			Fail("UTF16Length", round, length);
+		}
+		CompareUTF16FromUTF8(round, u8, len16);
+		CompareUTF16FromUTF8(round, u8, len16 + random.Next(40));
+		CompareUTF16FromUTF8(round, u8, random.Next(static_cast<uint32_t>(len16 + 1)));
+
+		const std::wstring u16 = MakeUTF16(random, length);
+		const size_t len8 = Scalar::UTF8Length(u16);
+		if (UTF8Length(u16) != len8) {
+			Fail("UTF8Length", round, length);
+		}
+		CompareUTF8FromUTF16(round, u16, len8);
+		CompareUTF8FromUTF16(round, u16, len8 + 1 + random.Next(40));
+	}
+}
+
+// Text in one script, with the spaces and punctuation it has.
+std::string MakeScript(const char *name, size_t length) {
+	Random random(7);
+	std::string text;
+	while (text.length() < length) {
+		const uint32_t word = random.Between(2, 8);
+		for (uint32_t j = 0; j < word; j++) {
+			if (strcmp(name, "ascii") == 0) {
+				text += static_cast<char>(random.Between('a', 'z'));
+			} else if (strcmp(name, "cyrillic") == 0) {
+				AppendUTF8(text, random.Between(0x430, 0x44F));
+			} else if (strcmp(name, "cjk") == 0) {
+				AppendUTF8(text, random.Between(0x4E00, 0x9FFF));
+			} else {
+				// mixed: mostly ASCII with accented letters
+				if (random.Next(5) == 0) {
+					AppendUTF8(text, random.Between(0xE0, 0xFF));
+				} else {
+					text += static_cast<char>(random.Between('a', 'z'));
+				}
+			}
+		}
+		if (strcmp(name, "cjk") == 0) {
+			AppendUTF8(text, random.Next(4) ? 0xFF0C : 0x3002);
+		} else {
+			text += random.Next(10) ? " " : ".\n";
+		}
+	}
+	return text;
+}
+
+template <typename Function>
+double Time(Function function, size_t bytes, int repeat) {
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < repeat; i++) {
+		function();
+	}
+	const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return static_cast<double>(bytes) * repeat / duration.count() / (1024 * 1024);
+}
+
+int Bench() {
+	constexpr int repeat = 20;
+	std::cout << "MB/s of UTF-8" << (NP2_USE_AVX2 ? " (AVX2)" : " (SSE2)") << "\n";
+	std::cout << std::left << std::setw(10) << "script" << std::right
+		<< std::setw(24) << "UTF16Length" << std::setw(24) << "UTF16FromUTF8"
+		<< std::setw(24) << "UTF8Length" << std::setw(24) << "UTF8FromUTF16" << "\n";
+	std::cout << std::left << std::setw(10) << "" << std::right;
+	for (int i = 0; i < 4; i++) {
+		std::cout << std::setw(8) << "scalar" << std::setw(8) << "simd" << std::setw(8) << "ratio";
+	}
+	std::cout << "\n" << std::fixed << std::setprecision(0);
+	for (const char *name : { "ascii", "mixed", "cyrillic", "cjk" }) {
+		const std::string u8 = MakeScript(name, 8*1024*1024);
+		const size_t len16 = UTF16Length(u8);
+		std::wstring u16(len16, L'\0');
+		std::string back(u8.length() + 1, '\0');
+		size_t sink = 0;
+		const double speeds[] = {
+			Time([&] { sink += Scalar::UTF16Length(u8); }, u8.length(), repeat),
+			Time([&] { sink += UTF16Length(u8); }, u8.length(), repeat),
+			Time([&] { sink += Scalar::UTF16FromUTF8(u8, u16.data(), len16); }, u8.length(), repeat),
+			Time([&] { sink += UTF16FromUTF8(u8, u16.data(), len16); }, u8.length(), repeat),
+			Time([&] { sink += Scalar::UTF8Length(u16); }, u8.length(), repeat),
+			Time([&] { sink += UTF8Length(u16); }, u8.length(), repeat),
+			Time([&] { Scalar::UTF8FromUTF16(u16, back.data(), back.length()); sink += back[0]; }, u8.length(), repeat),
+			Time([&] { UTF8FromUTF16(u16, back.data(), back.length()); sink += back[0]; }, u8.length(), repeat),
+		};
+		std::cout << std::left << std::setw(10) << name << std::right;
+		for (int i = 0; i < 8; i += 2) {
+			std::cout << std::setw(8) << speeds[i] << std::setw(8) << speeds[i + 1]
+				<< std::setw(7) << std::setprecision(1) << speeds[i + 1] / speeds[i] << "x" << std::setprecision(0);
+		}
+		std::cout << "\n";
+		if (back.compare(0, u8.length(), u8) != 0 || sink == 0) {
+			std::cout << name << ": round trip changed the text\n";
+			return 1;
+		}
+	}
+	return 0;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+#if NP2_USE_AVX2
+	if (!__builtin_cpu_supports("avx2")) {
+		std::cout << "AVX2 not supported, skipped.\n";
+		return 0;
+	}
+#endif
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+		return Bench();
+	}
+
+	constexpr size_t rounds = 20000;
+	Fuzz(rounds);
+	std::cout << "Converted " << rounds << " random texts" << (NP2_USE_AVX2 ? " with AVX2" : "")
+		<< ", " << failures << " failed.\n";
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// Scintilla source code edit control
+/** @file TestWrap.cxx
+ ** Wrapping on several threads must give the same result as wrapping on one.
+ ** Documents are wrapped on the headless platform with 1 and with 4 threads, whatever the
+ ** hardware has, and the wrap count of every line is compared.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <iostream>
+
+#include "Platform.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+#include "CellBuffer.h"
+#include "KeyMap.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "Selection.h"
+#include "PositionCache.h"
+#include "EditModel.h"
+#include "MarginView.h"
+#include "EditView.h"
+#include "Editor.h"
+
+#include "HeadlessPlatform.h"
+#include "HeadlessEditor.h"
+
+using namespace Scintilla;
+
+namespace {
+
+const char *const fragments[] = {
+	"word", "longerword", "x", "\t", "  ", "a,b,c", "averyveryverylongidentifierwithoutanybreak",
+	"é", "中文字符", "😀", "-", "(call)", "/path/to/file", "12345", "\xE2\x80\x8B",
+};
+
+// Deterministic document with lines from empty to several times the window width.
+std::string MakeDocument(size_t lines, unsigned int seed) {
+	std::string text;
+	for (size_t line = 0; line < lines; line++) {
+		seed = seed * 1103515245 + 12345;
+		const size_t words = (seed >> 16) % ((line % 7 == 0) ? 300 : 40);
+		for (size_t word = 0; word < words; word++) {
+			seed = seed * 1103515245 + 12345;
+			text += fragments[(seed >> 16) % std::size(fragments)];
+			if ((seed >> 8) % 3) {
+				text += ' ';
+			}
+		}
+		text += (line % 5 == 0) ? "\r\n" : "\n";
+	}
+	return text;
+}
+
+struct WrapSettings {
+	int wrapMode;
+	int indentMode;
+	int visualFlags;
+	int width;
+};
+
+// Wrap count of every line followed by the display line of the document end.
+std::vector<sptr_t> WrapResult(HeadlessEditor &editor) {
+	std::vector<sptr_t> result;
+	const sptr_t lines = editor.Call(SCI_GETLINECOUNT);
+	for (sptr_t line = 0; line < lines; line++) {
+		result.push_back(editor.Call(SCI_WRAPCOUNT, line));
+	}
+	result.push_back(editor.Call(SCI_VISIBLEFROMDOCLINE, lines));
+	return result;
+}
+
+void Configure(HeadlessEditor &editor, const std::string &text, const WrapSettings &settings) {
+	editor.Call(SCI_SETCODEPAGE, SC_CP_UTF8);
+	editor.CallString(SCI_STYLESETFONT, STYLE_DEFAULT, "Verdana");
+	editor.Call(SCI_STYLECLEARALL);
+	editor.Call(SCI_SETTABWIDTH, 4);
+	editor.Call(SCI_SETWRAPINDENTMODE, settings.indentMode);
+	editor.Call(SCI_SETWRAPVISUALFLAGS, settings.visualFlags);
+	editor.CallString(SCI_SETTEXT, 0, text.c_str());
+	editor.Call(SCI_SETWRAPMODE, settings.wrapMode);
+}
+
+bool Compare(const char *what, const WrapSettings &settings, const std::vector<sptr_t> &serial, const std::vector<sptr_t> &threaded) {
+	if (serial == threaded) {
+		return true;
+	}
+	const auto mismatch = std::mismatch(serial.begin(), serial.end(), threaded.begin(), threaded.end());
+	std::cout << what << ": wrap mode " << settings.wrapMode << ", indent mode " << settings.indentMode
+		<< ", width " << settings.width << ": line " << (mismatch.first - serial.begin())
+		<< " wraps to " << *mismatch.first << " lines on one thread and "
+		<< *mismatch.second << " lines on several\n";
+	return false;
+}
+
+bool TestSettings(const std::string &text, const WrapSettings &settings) {
+	const PRectangle rcWindow(0, 0, static_cast<XYPOSITION>(settings.width), 600);
+	HeadlessEditor serial(rcWindow);
+	HeadlessEditor threaded(rcWindow);
+	serial.SetWrapThreads(1);
+	threaded.SetWrapThreads(4);
+	Configure(serial, text, settings);
+	Configure(threaded, text, settings);
+
+	// wrapping in idle time, as after the mode is set
+	serial.RunIdle();
+	threaded.RunIdle();
+	bool success = Compare("idle", settings, WrapResult(serial), WrapResult(threaded));
+
+	// a narrower window rewraps everything at once
+	const PRectangle rcNarrow(0, 0, static_cast<XYPOSITION>(settings.width * 2 / 3), 600);
+	serial.Resize(rcNarrow);
+	threaded.Resize(rcNarrow);
+	serial.WrapAll();
+	threaded.WrapAll();
+	success = Compare("resized", settings, WrapResult(serial), WrapResult(threaded)) && success;
+
+	// and both must match a fresh editor that wrapped on one thread at that width
+	HeadlessEditor fresh(rcNarrow);
+	fresh.SetWrapThreads(1);
+	Configure(fresh, text, settings);
+	fresh.WrapAll();
+	success = Compare("fresh", settings, WrapResult(fresh), WrapResult(threaded)) && success;
+	return success;
+}
+
+}
+
+int main() {
+	const std::string text = MakeDocument(3000, 1);
+	const int wrapModes[] = { SC_WRAP_WORD, SC_WRAP_CHAR, SC_WRAP_WHITESPACE };
+	const int indentModes[] = { SC_WRAPINDENT_FIXED, SC_WRAPINDENT_INDENT };
+	const int widths[] = { 300, 1000 };
+
+	int runs = 0;
+	int failures = 0;
+	for (const int wrapMode : wrapModes) {
+		for (const int indentMode : indentModes) {
+			for (const int width : widths) {
+				const WrapSettings settings{ wrapMode, indentMode, (indentMode == SC_WRAPINDENT_FIXED) ? SC_WRAPVISUALFLAG_END : SC_WRAPVISUALFLAG_NONE, width };
+				++runs;
+				if (!TestSettings(text, settings)) {
+					++failures;
+				}
+			}
+		}
+	}
+
+	std::cout << "Wrapped with " << runs << " settings, " << failures << " failed.\n";
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,16 @@
+#include "file name.h"
+#include <vector>
+#pragma message("message text")
+/* block comment
+ * second line ** stars */
+/// doc comment @param value <tag> \brief text
+/** doc block @return {int} */
+int main() {
+	const char *s = "text with spaces \"escaped\" \\ end";
+	const char *t = "line \
+continued";
+	auto r = R"(raw "string")";
+	// comment line \
+	continued comment
+	return s[0] + 'c';
+}
@@ -0,0 +1,13 @@
+var a = "(=\t "</script>
+"(=\t "</script>
+x = "a b" /re/g;
+f("x", /re/)
+var s = "  " < b;
+"(=	 "</script>
+x = "	" /re/;
+// line comment "string" </script>
+/* block * comment ** with stars */ x = 1 / 2;
+/** doc @param {string} name <b>bold</b> */
+var t = 'single \' quote' / 2;
+var u = "line \
+continued" /re/;
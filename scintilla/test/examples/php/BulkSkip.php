@@ -0,0 +1,8 @@
+<?php
+$name = "text $var and ${expr} and {$obj->x}";
+$plain = "plain text without variables";
+// comment ?> text after
+<?php
+# hash comment
+/* block */ echo 'single $notvar';
+?>
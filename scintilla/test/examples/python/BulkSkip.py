@@ -0,0 +1,22 @@
+x = '''
+abc'''@param
+y = '''
+é'''@param
+z = r'''
+é'''@param
+w = '''
+ab'''@param
+v = 'ab\
+c'@param
+"a b" @deco
+  @deco
+@decorator
+def f(): pass
+'''@param
+# comment with 'quote' and "double" @param
+s = "tab	inside \" escaped"
+b = b'bytes\'' @ m
+f = f"{x} and {y!r}"
+t = """
+  text @param
+""" @ m
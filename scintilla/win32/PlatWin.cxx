@@ -540,6 +540,7 @@ public:
 	void SetUnicodeMode(bool unicodeMode_) noexcept override;
 	void SetDBCSMode(int codePage_) noexcept override;
 	void SetBidiR2L(bool bidiR2L_) noexcept override;
+	bool SupportsThreadSafeMeasureWidths() const noexcept override;
 };
 
 SurfaceGDI::~SurfaceGDI() noexcept {
@@ -1023,6 +1024,11 @@ void SurfaceGDI::SetDBCSMode(int codePage_) noexcept {
 void SurfaceGDI::SetBidiR2L(bool) noexcept {
 }
 
+bool SurfaceGDI::SupportsThreadSafeMeasureWidths() const noexcept {
+	// fonts are selected into device context.
+	return false;
+}
+
 #if defined(USE_D2D)
 
 class BlobInline;
@@ -1109,6 +1115,7 @@ public:
 	void SetUnicodeMode(bool unicodeMode_) noexcept override;
 	void SetDBCSMode(int codePage_) noexcept override;
 	void SetBidiR2L(bool bidiR2L_) noexcept override;
+	bool SupportsThreadSafeMeasureWidths() const noexcept override;
 };
 
 SurfaceD2D::SurfaceD2D() noexcept :
@@ -2156,6 +2163,11 @@ void SurfaceD2D::SetDBCSMode(int codePage_) noexcept {
 void SurfaceD2D::SetBidiR2L(bool) noexcept {
 }
 
+bool SurfaceD2D::SupportsThreadSafeMeasureWidths() const noexcept {
+	// text layout is created by the shared DirectWrite factory, which is thread safe.
+	return true;
+}
+
 #endif
 
 Surface *Surface::Allocate(int technology) {
@@ -21,6 +21,7 @@
 #include <map>
 #include <algorithm>
 #include <memory>
+#include <mutex>
 #include <chrono>
 
 // Want to use std::min and std::max so don't want Windows.h version of min and max
@@ -468,6 +469,7 @@ class ScintillaWin :
 	bool HaveMouseCapture() noexcept override;
 	void SetTrackMouseLeaveEvent(bool on) noexcept;
 	bool SCICALL PaintContains(PRectangle rc) const noexcept override;
+	bool PaintIntersects(PRectangle rc) const noexcept override;
 	void ScrollText(Sci::Line linesToMove) override;
 	void NotifyCaretMove() noexcept override;
 	void UpdateSystemCaret() override;
@@ -2139,6 +2141,18 @@ bool ScintillaWin::PaintContains(PRectangle rc) const noexcept {
 	return true;
 }
 
+bool ScintillaWin::PaintIntersects(PRectangle rc) const noexcept {
+	if (!rcPaint.Intersects(rc)) {
+		return false;
+	}
+	if (paintState == painting && hRgnUpdate) {
+		// Bounding rectangle of several invalidated areas may cover lines that were not invalidated
+		const RECT rcw = RectFromPRectangle(rc);
+		return ::RectInRegion(hRgnUpdate, &rcw) != FALSE;
+	}
+	return true;
+}
+
 void ScintillaWin::ScrollText(Sci::Line /* linesToMove */) {
 	//Platform::DebugPrintf("ScintillaWin::ScrollText %d\n", linesToMove);
 	//::ScrollWindow(MainHWND(), 0,
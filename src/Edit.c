@@ -28,6 +28,7 @@
 #endif
 #include <time.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <limits.h>
 #include <inttypes.h>
 #include "SciCall.h"
@@ -35,6 +36,9 @@
 #include "Helpers.h"
 #include "Notepad2.h"
 #include "Edit.h"
+#include "EditChunk.h"
+#include "EditDetect.h"
+#include "EditDiff.h"
 #include "Styles.h"
 #include "Dialogs.h"
 #include "resource.h"
@@ -61,6 +65,8 @@ extern BOOL bLoadANSIasUTF8;
 extern BOOL bLoadNFOasOEM;
 extern int iSrcEncoding;
 extern int iWeakSrcEncoding;
+extern int iSrcHexView;
+extern BOOL bHexViewBinaryFile;
 
 extern int g_DOSEncoding;
 
@@ -81,7 +87,32 @@ static struct EditMarkAllStatus {
 	LPSTR pszText;
 } editMarkAllStatus;
 
+// last bytes loaded from current file, used to check whether the file only grew.
+#define EDIT_FILE_TAIL_SIZE		4096
+
+static struct EditFileTail {
+	BOOL bValid;
+	int iEncoding;
+	uint64_t fileSize;		// bytes loaded from the file
+	DWORD cbTail;
+	char tail[EDIT_FILE_TAIL_SIZE];
+} editFileTail;
+
+static inline void EditFileTail_Update(const char *lpData, SIZE_T cbData) {
+	if (cbData >= EDIT_FILE_TAIL_SIZE) {
+		memcpy(editFileTail.tail, lpData + cbData - EDIT_FILE_TAIL_SIZE, EDIT_FILE_TAIL_SIZE);
+		editFileTail.cbTail = EDIT_FILE_TAIL_SIZE;
+	} else {
+		const DWORD cbKeep = min_u(editFileTail.cbTail, EDIT_FILE_TAIL_SIZE - (DWORD)cbData);
+		memmove(editFileTail.tail, editFileTail.tail + editFileTail.cbTail - cbKeep, cbKeep);
+		memcpy(editFileTail.tail + cbKeep, lpData, cbData);
+		editFileTail.cbTail = cbKeep + (DWORD)cbData;
+	}
+	editFileTail.fileSize += cbData;
+}
+
 void Edit_ReleaseResources(void) {
+	EditPagedView_Close();
 	DStringW_Free(&wchPrefixSelection);
 	DStringW_Free(&wchAppendSelection);
 	DStringW_Free(&wchPrefixLines);
@@ -107,9 +138,10 @@ extern BOOL bLargeFileMode;
 #endif
 extern FILEVARS fvCurFile;
 
-void EditSetNewText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount) {
+void EditSetNewText(LPCSTR lpstrText, SIZE_T cbText, Sci_Line lineCount) {
 	bFreezeAppTitle = TRUE;
 	bLockedForEditing = FALSE;
+	editFileTail.bValid = FALSE;
 
 	SciCall_SetReadOnly(FALSE);
 	SciCall_Cancel();
@@ -123,7 +155,7 @@ void EditSetNewText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount) {
 
 #if defined(_WIN64)
 	// enable conversion between line endings
-	if (bLargeFileMode || cbText + lineCount >= MAX_NON_UTF8_SIZE) {
+	if (bLargeFileMode || cbText + lineCount >= (SIZE_T)MAX_NON_UTF8_SIZE) {
 		int options = SciCall_GetDocumentOptions();
 		if (!(options & SC_DOCUMENTOPTION_TEXT_LARGE)) {
 			options |= SC_DOCUMENTOPTION_TEXT_LARGE;
@@ -141,7 +173,7 @@ void EditSetNewText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount) {
 		StopWatch_Start(watch);
 #endif
 		SciCall_SetInitLineCount(lineCount);
-		SciCall_AddText(cbText, lpstrText);
+		SciCall_AddText((Sci_Position)cbText, lpstrText);
 #if 0
 		StopWatch_Stop(watch);
 		StopWatch_ShowLog(&watch, "AddText time");
@@ -162,52 +194,232 @@ void EditSetNewText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount) {
 //
 // EditConvertText()
 //
+// The document is split into chunks at character boundaries of the source code page,
+// chunks are converted in parallel into per chunk buffers, then appended in order
+// to a new document, so extra memory is bounded by chunk size and thread count.
+#define EDIT_CONVERT_CHUNK_SIZE		(1024*1024)
+#define EDIT_CONVERT_MAX_THREADS	8
+
+typedef struct EditConvertChunk {
+	UINT cpSource;
+	UINT cpDest;
+	const char *lpSource;
+	DWORD cbSource;
+	LPWSTR lpWide;		// EDIT_CONVERT_CHUNK_SIZE characters
+	char *lpOutput;		// EDIT_CONVERT_CHUNK_SIZE * kMaxMultiByteCount bytes
+	int cbOutput;
+} EditConvertChunk;
+
+static DWORD WINAPI EditConvertChunk_Thread(LPVOID lpParam) {
+	EditConvertChunk *chunk = (EditConvertChunk *)lpParam;
+	const int cchWide = MultiByteToWideChar(chunk->cpSource, 0, chunk->lpSource, chunk->cbSource, chunk->lpWide, EDIT_CONVERT_CHUNK_SIZE);
+	chunk->cbOutput = WideCharToMultiByte(chunk->cpDest, 0, chunk->lpWide, cchWide, chunk->lpOutput, EDIT_CONVERT_CHUNK_SIZE * kMaxMultiByteCount, NULL, NULL);
+	return 0;
+}
+
+typedef struct EditLoadedText {
+	EditConvertChunk chunk;
+	const char *lpData;
+	char *lpUTF8;
+	SIZE_T cbAlloc;
+	SIZE_T cbUTF8;
+} EditLoadedText;
+
+static const char *EditLoadedText_Read(void *context, size_t position, size_t cbData) {
+	UNREFERENCED_PARAMETER(cbData);
+	const EditLoadedText *text = (const EditLoadedText *)context;
+	return text->lpData + position;
+}
+
+static int EditLoadedText_Write(void *context, const char *lpData, size_t cbData) {
+	EditLoadedText *text = (EditLoadedText *)context;
+	EditConvertChunk *chunk = &text->chunk;
+	chunk->lpSource = lpData;
+	chunk->cbSource = (DWORD)cbData;
+	EditConvertChunk_Thread(chunk);
+	if (chunk->cbOutput > 0) {
+		const SIZE_T cbNeeded = text->cbUTF8 + chunk->cbOutput + 16;
+		if (cbNeeded > text->cbAlloc) {
+			text->cbAlloc += text->cbAlloc/2;
+			if (text->cbAlloc < cbNeeded) {
+				text->cbAlloc = cbNeeded;
+			}
+			text->lpUTF8 = (char *)NP2HeapReAlloc(text->lpUTF8, text->cbAlloc);
+		}
+		memcpy(text->lpUTF8 + text->cbUTF8, chunk->lpOutput, chunk->cbOutput);
+		text->cbUTF8 += chunk->cbOutput;
+	}
+	return TRUE;
+}
+
+// convert loaded text to UTF-8 chunk by chunk, as MultiByteToWideChar() and
+// WideCharToMultiByte() only accept int length. returned buffer is freed by caller.
+static char *EditConvertLoadedText(UINT cpSource, const char *lpData, SIZE_T cbData, SIZE_T *pcbUTF8) {
+	EditLoadedText text;
+	text.chunk.cpSource = cpSource;
+	text.chunk.cpDest = CP_UTF8;
+	text.chunk.lpWide = (LPWSTR)NP2HeapAlloc(EDIT_CONVERT_CHUNK_SIZE * sizeof(WCHAR));
+	text.chunk.lpOutput = (char *)NP2HeapAlloc(EDIT_CONVERT_CHUNK_SIZE * kMaxMultiByteCount);
+	text.lpData = lpData;
+	// most text is ASCII, grow the buffer when needed instead of allocating cbData * kMaxMultiByteCount.
+	text.cbAlloc = cbData + cbData/2 + 16;
+	text.lpUTF8 = (char *)NP2HeapAlloc(text.cbAlloc);
+	text.cbUTF8 = 0;
+
+	EditChunk_Split(cpSource, cbData, EDIT_CONVERT_CHUNK_SIZE, EditLoadedText_Read, EditLoadedText_Write, &text);
+
+	NP2HeapFree(text.chunk.lpWide);
+	NP2HeapFree(text.chunk.lpOutput);
+	*pcbUTF8 = text.cbUTF8;
+	return text.lpUTF8;
+}
+
 BOOL EditConvertText(UINT cpSource, UINT cpDest, BOOL bSetSavePoint) {
 	if (cpSource == cpDest) {
 		return TRUE;
 	}
 
 	const Sci_Position length = SciCall_GetLength();
-	if (length >= (int)MAX_NON_UTF8_SIZE) {
-		return TRUE;
-	}
-
-	char *pchText = NULL;
-	int cbText = 0;
-	if (length > 0) {
-		// DBCS: length -> WCHAR: sizeof(WCHAR) * (length / 2) -> UTF-8: kMaxMultiByteCount * (length / 2)
-		pchText = (char *)NP2HeapAlloc((length + 1) * sizeof(WCHAR));
-		SciCall_GetText(NP2HeapSize(pchText), pchText);
-
-		WCHAR *pwchText = (WCHAR *)NP2HeapAlloc((length + 1) * sizeof(WCHAR));
-		const int cbwText = MultiByteToWideChar(cpSource, 0, pchText, (int)length, pwchText, (int)(NP2HeapSize(pwchText) / sizeof(WCHAR)));
-		cbText = WideCharToMultiByte(cpDest, 0, pwchText, cbwText, pchText, (int)(NP2HeapSize(pchText)), NULL, NULL);
-		NP2HeapFree(pwchText);
+#if !defined(_WIN64)
+	if (length >= (Sci_Position)MAX_NON_UTF8_SIZE) {
+		return FALSE;
 	}
+#endif
 
+	const BOOL bLocked = bLockedForEditing;
 	bLockedForEditing = FALSE;
 	SciCall_SetReadOnly(FALSE);
 	SciCall_Cancel();
-	SciCall_SetUndoCollection(FALSE);
-	SciCall_EmptyUndoBuffer();
-	SciCall_ClearAll();
-	SciCall_ClearMarker();
+
+	if (length == 0) {
+		SciCall_SetUndoCollection(FALSE);
+		SciCall_EmptyUndoBuffer();
+		SciCall_ClearMarker();
+		SciCall_SetCodePage(cpDest);
+		SciCall_SetUndoCollection(TRUE);
+		if (bSetSavePoint) {
+			SciCall_SetSavePoint();
+		}
+		return TRUE;
+	}
+
+	// keep source document alive after switching to the new document,
+	// it's restored when conversion fails.
+	const char *lpSource = SciCall_GetCharacterPointer();
+	HANDLE pdocSource = SciCall_GetDocPointer();
+	SciCall_AddRefDocument(pdocSource);
+
+	int options = SciCall_GetDocumentOptions();
+#if defined(_WIN64)
+	const BOOL bOldLargeFileMode = bLargeFileMode;
+	// DBCS or 8-bit text may triple when converted to UTF-8.
+	const Sci_Position maxLength = (cpDest == SC_CP_UTF8) ? length * kMaxMultiByteCount : length;
+	if (maxLength >= (Sci_Position)MAX_NON_UTF8_SIZE) {
+		options |= SC_DOCUMENTOPTION_TEXT_LARGE;
+		bLargeFileMode = TRUE;
+	}
+#endif
+	HANDLE pdoc = SciCall_CreateDocument(length + 1, options);
+	EditReplaceDocument(pdoc);
 	SciCall_SetCodePage(cpDest);
+	SciCall_SetUndoCollection(FALSE);
+	SciCall_SetModEventMask(SC_MOD_NONE);
+	SciCall_SetStatus(SC_STATUS_OK);
+
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	const Sci_Position chunkCount = (length + EDIT_CONVERT_CHUNK_SIZE - 1) / EDIT_CONVERT_CHUNK_SIZE;
+	int threadCount = (int)min_u(info.dwNumberOfProcessors, EDIT_CONVERT_MAX_THREADS);
+	if (chunkCount < threadCount) {
+		threadCount = (int)chunkCount;
+	}
+
+	EditConvertChunk chunks[EDIT_CONVERT_MAX_THREADS];
+	HANDLE hThreads[EDIT_CONVERT_MAX_THREADS];
+	for (int i = 0; i < threadCount; i++) {
+		EditConvertChunk *chunk = &chunks[i];
+		chunk->cpSource = cpSource;
+		chunk->cpDest = cpDest;
+		chunk->lpWide = (LPWSTR)NP2HeapAlloc(EDIT_CONVERT_CHUNK_SIZE * sizeof(WCHAR));
+		chunk->lpOutput = (char *)NP2HeapAlloc(EDIT_CONVERT_CHUNK_SIZE * kMaxMultiByteCount);
+	}
+
+	BOOL bSuccess = TRUE;
+	Sci_Position position = 0;
+	while (bSuccess && position < length) {
+		int count = 0;
+		while (count < threadCount && position < length) {
+			EditConvertChunk *chunk = &chunks[count];
+			DWORD cbSource = (length - position < EDIT_CONVERT_CHUNK_SIZE) ? (DWORD)(length - position) : EDIT_CONVERT_CHUNK_SIZE;
+			if (position + cbSource < length) {
+				cbSource = (DWORD)EditConvert_AlignedLength(cpSource, lpSource + position, cbSource);
+			}
+			chunk->lpSource = lpSource + position;
+			chunk->cbSource = cbSource;
+			position += cbSource;
+			++count;
+		}
+
+		// first chunk is converted on current thread.
+		int started = 1;
+		for (int i = 1; i < count; i++) {
+			DWORD dwThreadId;
+			HANDLE hThread = CreateThread(NULL, 0, EditConvertChunk_Thread, &chunks[i], 0, &dwThreadId);
+			if (hThread == NULL) {
+				break;
+			}
+			hThreads[started - 1] = hThread;
+			++started;
+		}
+		EditConvertChunk_Thread(&chunks[0]);
+		for (int i = started; i < count; i++) {
+			EditConvertChunk_Thread(&chunks[i]);
+		}
+		if (started > 1) {
+			WaitForMultipleObjects(started - 1, hThreads, TRUE, INFINITE);
+			for (int i = 0; i < started - 1; i++) {
+				CloseHandle(hThreads[i]);
+			}
+		}
 
-	if (cbText > 0) {
-		SciCall_AddText(cbText, pchText);
+		for (int i = 0; i < count && bSuccess; i++) {
+			// non-empty source always converts to some text, allocation failure is reported by status.
+			if (chunks[i].cbOutput <= 0) {
+				bSuccess = FALSE;
+			} else {
+				SciCall_AppendText(chunks[i].cbOutput, chunks[i].lpOutput);
+				bSuccess = SciCall_GetStatus() == SC_STATUS_OK;
+			}
+		}
 	}
-	if (pchText != NULL) {
-		NP2HeapFree(pchText);
+
+	for (int i = 0; i < threadCount; i++) {
+		NP2HeapFree(chunks[i].lpWide);
+		NP2HeapFree(chunks[i].lpOutput);
+	}
+
+	if (!bSuccess) {
+		// switch back to source document, which releases the partially converted one.
+		SciCall_SetStatus(SC_STATUS_OK);
+		EditReplaceDocument(pdocSource);
+		SciCall_SetCodePage(cpSource);
+		SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT);
+		SciCall_SetUndoCollection(TRUE);
+#if defined(_WIN64)
+		bLargeFileMode = bOldLargeFileMode;
+#endif
+		bLockedForEditing = bLocked;
+		SciCall_SetReadOnly(bLocked);
+		return FALSE;
 	}
 
+	SciCall_ReleaseDocument(pdocSource);
+	SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT);
 	SciCall_EmptyUndoBuffer();
 	SciCall_SetUndoCollection(TRUE);
 	SciCall_GotoPos(0);
 	SciCall_ChooseCaretX();
-	if (length == 0 && bSetSavePoint) {
-		SciCall_SetSavePoint();
-	}
+	Style_SetLexer(pLexCurrent, TRUE);
 	return TRUE;
 }
 
@@ -454,7 +666,7 @@ static __forceinline unsigned int bth_popcount(unsigned int v) {
 //
 // EditDetectEOLMode()
 //
-void EditDetectEOLMode(LPCSTR lpData, DWORD cbData, EditFileIOStatus *status) {
+void EditDetectEOLMode(LPCSTR lpData, SIZE_T cbData, EditFileIOStatus *status) {
 	if (cbData == 0) {
 		return;
 	}
@@ -641,10 +853,970 @@ void EditDetectEOLMode(LPCSTR lpData, DWORD cbData, EditFileIOStatus *status) {
 	status->linesCount[2] = lineCountCR;
 }
 
+//=============================================================================
+//
+// EditReplaceTextByDiff()
+//
+// Reloading replaces only changed lines, found by a line hash diff between the document and
+// the new text, so undo history, markers, folding and styles outside changed lines are kept.
+static BOOL EditReplaceTextByDiff(LPCSTR lpstrText, SIZE_T cbText, Sci_Line lineCount) {
+	const Sci_Position length = SciCall_GetLength();
+	// offsets in diff are DWORD, large document is handled by EditSetNewText()
+	if (length == 0 || length >= (Sci_Position)MAX_NON_UTF8_SIZE || cbText + lineCount >= (SIZE_T)MAX_NON_UTF8_SIZE) {
+		return FALSE;
+	}
+
+	EditDiffHunk *hunks;
+	const char *oldText = SciCall_GetCharacterPointer();
+	const int count = EditDiff_GetHunks(oldText, (DWORD)length, lpstrText, (DWORD)cbText, &hunks);
+	if (count < 0) {
+		return FALSE;
+	}
+
+	bLockedForEditing = FALSE;
+	SciCall_SetReadOnly(FALSE);
+	SciCall_Cancel();
+	FileVars_Apply(&fvCurFile);
+
+	if (count != 0) {
+		// trim before replacing, which invalidates the character pointer.
+		for (int i = 0; i < count; i++) {
+			EditDiff_TrimHunk(oldText, lpstrText, &hunks[i]);
+		}
+		// apply from end, so positions of earlier hunks are unchanged.
+		SciCall_BeginUndoAction();
+		for (int i = count; i != 0; i--) {
+			const EditDiffHunk *hunk = &hunks[i - 1];
+			SciCall_SetTargetRange(hunk->oldStart, hunk->oldEnd);
+			SciCall_ReplaceTarget(hunk->newEnd - hunk->newStart, lpstrText + hunk->newStart);
+		}
+		SciCall_EndUndoAction();
+		free(hunks);
+	}
+	SciCall_SetSavePoint();
+	return TRUE;
+}
+
+static void EditSetLoadedText(LPCSTR lpstrText, SIZE_T cbText, EditFileIOStatus *status, UINT cpEdit) {
+	status->bDiffApplied = status->bReload && SciCall_GetCodePage() == cpEdit
+		&& EditReplaceTextByDiff(lpstrText, cbText, status->totalLineCount);
+	if (!status->bDiffApplied) {
+		EditSetNewText(lpstrText, cbText, status->totalLineCount);
+	}
+}
+
+//=============================================================================
+//
+// EditPagedView
+//
+// Read-only view for file larger than maximum loadable size. The document only holds
+// a window of whole lines, file content is read through a LRU page cache with fixed
+// memory budget, and a sampled line index is built by a background thread.
+// In hex view, each document line shows offset, hex and ASCII columns for fixed number
+// of bytes, lines are formatted from the page cache when the window is moved.
+#define EDIT_PAGE_SIZE				(1024*1024)
+#define EDIT_PAGE_CACHE_COUNT		32			// 32 MiB page cache
+#define EDIT_PAGE_WINDOW_SIZE		(8*EDIT_PAGE_SIZE)
+#define EDIT_LINE_INDEX_STEP		65536		// record file offset of every 65536th line
+#define EDIT_HEX_BYTES_PER_LINE		16
+#define EDIT_HEX_WINDOW_SIZE		EDIT_PAGE_SIZE	// about 5.5 MiB text
+
+typedef struct EditPage {
+	uint64_t index;		// page number in file
+	DWORD cbData;
+	DWORD lastUse;
+	char *lpData;		// NULL when unused
+} EditPage;
+
+static struct EditPagedView {
+	BOOL bActive;
+	BOOL bUTF8;
+	BOOL bHexView;
+	BOOL bMovePending;
+	int hexDigits;			// digits for offset column in hex view
+	HANDLE hFile;
+	HANDLE hIndexFile;
+	HANDLE hIndexThread;
+	uint64_t fileSize;
+	uint64_t dataStart;		// after UTF-8 BOM
+	uint64_t windowStart;	// file offset of document text
+	uint64_t windowEnd;
+	Sci_Line windowLine;	// line number of first document line, -1 when not yet indexed
+	LONG windowLineCount;	// lineOffsetCount when windowLine was computed
+	DWORD useCount;
+	EditPage pages[EDIT_PAGE_CACHE_COUNT];
+	// written by indexing thread, entry is filled before lineOffsetCount is increased.
+	uint64_t *lineOffsets;	// lineOffsets[i] is file offset of line i*EDIT_LINE_INDEX_STEP
+	volatile LONG lineOffsetCount;
+	volatile LONG bStopIndex;
+	volatile LONG bIndexDone;
+	Sci_Line totalLineCount;// valid after bIndexDone is set
+} pagedView;
+
+static BOOL EditPagedView_ReadFile(HANDLE hFile, uint64_t offset, char *lpData, DWORD cbData, DWORD *pcbRead) {
+	OVERLAPPED overlapped;
+	ZeroMemory(&overlapped, sizeof(overlapped));
+	overlapped.Offset = (DWORD)offset;
+	overlapped.OffsetHigh = (DWORD)(offset >> 32);
+	if (!ReadFile(hFile, lpData, cbData, pcbRead, &overlapped)) {
+		*pcbRead = 0;
+		return GetLastError() == ERROR_HANDLE_EOF;
+	}
+	return TRUE;
+}
+
+static const EditPage *EditPagedView_GetPage(uint64_t index) {
+	EditPage *victim = &pagedView.pages[0];
+	++pagedView.useCount;
+	for (int i = 0; i < EDIT_PAGE_CACHE_COUNT; i++) {
+		EditPage *page = &pagedView.pages[i];
+		if (page->lpData != NULL && page->index == index) {
+			page->lastUse = pagedView.useCount;
+			return page;
+		}
+		if (victim->lpData != NULL && (page->lpData == NULL || page->lastUse < victim->lastUse)) {
+			victim = page;
+		}
+	}
+
+	if (victim->lpData == NULL) {
+		victim->lpData = (char *)NP2HeapAlloc(EDIT_PAGE_SIZE);
+	}
+	victim->index = index;
+	victim->lastUse = pagedView.useCount;
+	EditPagedView_ReadFile(pagedView.hFile, index * EDIT_PAGE_SIZE, victim->lpData, EDIT_PAGE_SIZE, &victim->cbData);
+	return victim;
+}
+
+// copy file content at offset, returns bytes copied.
+static SIZE_T EditPagedView_Copy(uint64_t offset, char *lpData, SIZE_T cbData) {
+	SIZE_T cbCopied = 0;
+	while (cbCopied < cbData) {
+		const EditPage *page = EditPagedView_GetPage(offset / EDIT_PAGE_SIZE);
+		const DWORD start = (DWORD)(offset % EDIT_PAGE_SIZE);
+		if (start >= page->cbData) {
+			break;
+		}
+		DWORD cbCopy = page->cbData - start;
+		if (cbCopy > cbData - cbCopied) {
+			cbCopy = (DWORD)(cbData - cbCopied);
+		}
+		memcpy(lpData + cbCopied, page->lpData + start, cbCopy);
+		cbCopied += cbCopy;
+		offset += cbCopy;
+	}
+	return cbCopied;
+}
+
+// file offset after first line break in [offset, maxOffset), or maxOffset when not found.
+static uint64_t EditPagedView_NextLineStart(uint64_t offset, uint64_t maxOffset) {
+	while (offset < maxOffset) {
+		const EditPage *page = EditPagedView_GetPage(offset / EDIT_PAGE_SIZE);
+		const DWORD start = (DWORD)(offset % EDIT_PAGE_SIZE);
+		if (start >= page->cbData) {
+			break;
+		}
+		DWORD cbSearch = page->cbData - start;
+		if (cbSearch > maxOffset - offset) {
+			cbSearch = (DWORD)(maxOffset - offset);
+		}
+		const char *lpData = page->lpData + start;
+		const char *p = (const char *)memchr(lpData, '\n', cbSearch);
+		if (p != NULL) {
+			return offset + (p - lpData) + 1;
+		}
+		offset += cbSearch;
+	}
+	return maxOffset;
+}
+
+// start of first line at or after offset, or maxOffset when not found.
+static inline uint64_t EditPagedView_LineStartAfter(uint64_t offset, uint64_t maxOffset) {
+	if (offset <= pagedView.dataStart) {
+		return pagedView.dataStart;
+	}
+	return EditPagedView_NextLineStart(offset - 1, maxOffset);
+}
+
+// end of line containing offset, a very long line is split one page after offset.
+static inline uint64_t EditPagedView_LineEndAfter(uint64_t offset) {
+	if (offset >= pagedView.fileSize) {
+		return pagedView.fileSize;
+	}
+	const uint64_t maxOffset = offset + EDIT_PAGE_SIZE;
+	return EditPagedView_NextLineStart(offset - 1, (maxOffset < pagedView.fileSize) ? maxOffset : pagedView.fileSize);
+}
+
+static DWORD WINAPI EditPagedView_IndexThread(LPVOID lpParam) {
+	UNREFERENCED_PARAMETER(lpParam);
+
+	char *lpData = (char *)NP2HeapAlloc(EDIT_PAGE_SIZE);
+	uint64_t offset = 0;
+	Sci_Line line = 0;
+	LONG count = 1;
+	while (offset < pagedView.fileSize && !pagedView.bStopIndex) {
+		DWORD cbRead = 0;
+		if (!EditPagedView_ReadFile(pagedView.hIndexFile, offset, lpData, EDIT_PAGE_SIZE, &cbRead) || cbRead == 0) {
+			break;
+		}
+		const char *ptr = lpData;
+		const char * const end = lpData + cbRead;
+		while ((ptr = (const char *)memchr(ptr, '\n', end - ptr)) != NULL) {
+			++ptr;
+			++line;
+			if ((line % EDIT_LINE_INDEX_STEP) == 0) {
+				pagedView.lineOffsets[count] = offset + (ptr - lpData);
+				++count;
+				InterlockedExchange(&pagedView.lineOffsetCount, count);
+			}
+		}
+		offset += cbRead;
+	}
+
+	NP2HeapFree(lpData);
+	pagedView.totalLineCount = line + 1;
+	InterlockedExchange(&pagedView.bIndexDone, TRUE);
+	return 0;
+}
+
+// count line breaks in [offset, maxOffset).
+static Sci_Line EditPagedView_CountLines(uint64_t offset, uint64_t maxOffset) {
+	Sci_Line count = 0;
+	while (offset < maxOffset) {
+		const EditPage *page = EditPagedView_GetPage(offset / EDIT_PAGE_SIZE);
+		const DWORD start = (DWORD)(offset % EDIT_PAGE_SIZE);
+		if (start >= page->cbData) {
+			break;
+		}
+		DWORD cbSearch = page->cbData - start;
+		if (cbSearch > maxOffset - offset) {
+			cbSearch = (DWORD)(maxOffset - offset);
+		}
+		const char *ptr = page->lpData + start;
+		const char * const end = ptr + cbSearch;
+		while ((ptr = (const char *)memchr(ptr, '\n', end - ptr)) != NULL) {
+			++ptr;
+			++count;
+		}
+		offset += cbSearch;
+	}
+	return count;
+}
+
+// line number of the line containing offset, -1 when it's not yet indexed.
+static Sci_Line EditPagedView_LineFromOffset(uint64_t offset) {
+	const LONG count = pagedView.lineOffsetCount;
+	LONG low = 0;
+	LONG high = count - 1;
+	while (low < high) {
+		const LONG middle = (low + high + 1) / 2;
+		if (pagedView.lineOffsets[middle] <= offset) {
+			low = middle;
+		} else {
+			high = middle - 1;
+		}
+	}
+
+	// after last sample, the line is only known when there are fewer lines than the sample step.
+	const BOOL bPartial = low == count - 1 && !pagedView.bIndexDone;
+	if (bPartial && offset - pagedView.lineOffsets[low] > EDIT_PAGE_WINDOW_SIZE) {
+		return -1;
+	}
+	const Sci_Line lines = EditPagedView_CountLines(pagedView.lineOffsets[low], offset);
+	if (bPartial && lines >= EDIT_LINE_INDEX_STEP) {
+		return -1;
+	}
+	return (Sci_Line)low * EDIT_LINE_INDEX_STEP + lines;
+}
+
+// file offset of zero based line, -1 when it's not yet indexed.
+static int64_t EditPagedView_OffsetFromLine(Sci_Line line) {
+	const LONG count = pagedView.lineOffsetCount;
+	const Sci_Line index = line / EDIT_LINE_INDEX_STEP;
+	if (index >= count) {
+		return -1;
+	}
+
+	uint64_t offset = pagedView.lineOffsets[index];
+	Sci_Line remain = line % EDIT_LINE_INDEX_STEP;
+	while (remain != 0 && offset < pagedView.fileSize) {
+		offset = EditPagedView_NextLineStart(offset, pagedView.fileSize);
+		--remain;
+	}
+	return (remain == 0) ? (int64_t)offset : -1;
+}
+
+static void EditPagedView_LoadRange(uint64_t start, uint64_t end) {
+	SIZE_T cbData = (SIZE_T)(end - start);
+	char *lpData = (char *)NP2HeapAlloc(cbData + 16);
+	cbData = EditPagedView_Copy(start, lpData, cbData);
+	const char *lpText = lpData;
+	if (pagedView.bUTF8) {
+		// window boundary inside a very long line
+		while (cbData != 0 && start != pagedView.dataStart && lpText - lpData < 3 && ((uint8_t)*lpText & 0xC0) == 0x80) {
+			++lpText;
+			--cbData;
+		}
+		if (end != pagedView.fileSize) {
+			cbData = UTF8_AlignedLength(lpText, cbData);
+		}
+	}
+
+	EditFileIOStatus status;
+	ZeroMemory(&status, sizeof(status));
+	status.totalLineCount = 1;
+	EditDetectEOLMode(lpText, cbData, &status);
+	EditSetNewText(lpText, cbData, status.totalLineCount);
+	SciCall_SetReadOnly(TRUE);
+	bLockedForEditing = TRUE;
+
+	pagedView.windowStart = start + (lpText - lpData);
+	pagedView.windowEnd = pagedView.windowStart + cbData;
+	pagedView.windowLineCount = pagedView.lineOffsetCount;
+	pagedView.windowLine = EditPagedView_LineFromOffset(pagedView.windowStart);
+	NP2HeapFree(lpData);
+}
+
+static inline Sci_Position EditPagedView_HexLineWidth(void) {
+	// offset, two spaces, 16 hex bytes with extra space in middle, |ASCII| and line feed.
+	return pagedView.hexDigits + 2 + EDIT_HEX_BYTES_PER_LINE*3 + 1 + EDIT_HEX_BYTES_PER_LINE + 3;
+}
+
+// document column of byte index in hex column.
+static inline Sci_Position EditPagedView_HexByteColumn(int index) {
+	return pagedView.hexDigits + 2 + index*3 + (index >= EDIT_HEX_BYTES_PER_LINE/2);
+}
+
+// start and end are multiple of EDIT_HEX_BYTES_PER_LINE except end of file.
+static void EditPagedView_LoadHexRange(uint64_t start, uint64_t end) {
+	static const char hexDigits[] = "0123456789ABCDEF";
+	const Sci_Position width = EditPagedView_HexLineWidth();
+	char *lpData = (char *)NP2HeapAlloc((SIZE_T)(end - start) + 16);
+	const SIZE_T cbData = EditPagedView_Copy(start, lpData, (SIZE_T)(end - start));
+	const Sci_Line lineCount = (Sci_Line)((cbData + EDIT_HEX_BYTES_PER_LINE - 1) / EDIT_HEX_BYTES_PER_LINE);
+	char *lpText = (char *)NP2HeapAlloc((SIZE_T)(lineCount * width) + 16);
+
+	char *p = lpText;
+	for (Sci_Line line = 0; line < lineCount; line++) {
+		const uint64_t offset = start + line*EDIT_HEX_BYTES_PER_LINE;
+		const uint8_t *bytes = (const uint8_t *)lpData + line*EDIT_HEX_BYTES_PER_LINE;
+		const SIZE_T remain = cbData - line*EDIT_HEX_BYTES_PER_LINE;
+		const SIZE_T count = (remain < EDIT_HEX_BYTES_PER_LINE) ? remain : EDIT_HEX_BYTES_PER_LINE;
+		for (int shift = (pagedView.hexDigits - 1) * 4; shift >= 0; shift -= 4) {
+			*p++ = hexDigits[(offset >> shift) & 15];
+		}
+		*p++ = ' ';
+		*p++ = ' ';
+		for (SIZE_T i = 0; i < EDIT_HEX_BYTES_PER_LINE; i++) {
+			if (i == EDIT_HEX_BYTES_PER_LINE/2) {
+				*p++ = ' ';
+			}
+			if (i < count) {
+				*p++ = hexDigits[bytes[i] >> 4];
+				*p++ = hexDigits[bytes[i] & 15];
+			} else {
+				*p++ = ' ';
+				*p++ = ' ';
+			}
+			*p++ = ' ';
+		}
+		*p++ = '|';
+		for (SIZE_T i = 0; i < EDIT_HEX_BYTES_PER_LINE; i++) {
+			const uint8_t ch = bytes[i];
+			*p++ = (i >= count) ? ' ' : ((ch >= ' ' && ch < 0x7F) ? (char)ch : '.');
+		}
+		*p++ = '|';
+		*p++ = '\n';
+	}
+
+	// no line feed after last line
+	EditSetNewText(lpText, (p == lpText) ? 0 : (p - lpText - 1), max_pos(lineCount, 1));
+	SciCall_SetReadOnly(TRUE);
+	bLockedForEditing = TRUE;
+
+	pagedView.windowStart = start;
+	pagedView.windowEnd = start + cbData;
+	pagedView.windowLine = (Sci_Line)(start / EDIT_HEX_BYTES_PER_LINE);
+	NP2HeapFree(lpText);
+	NP2HeapFree(lpData);
+}
+
+// load whole lines around offset.
+static void EditPagedView_LoadAround(uint64_t offset) {
+	if (pagedView.bHexView) {
+		offset -= offset % EDIT_HEX_BYTES_PER_LINE;
+		const uint64_t start = (offset > EDIT_HEX_WINDOW_SIZE/2) ? offset - EDIT_HEX_WINDOW_SIZE/2 : 0;
+		const uint64_t end = start + EDIT_HEX_WINDOW_SIZE;
+		EditPagedView_LoadHexRange(start, (end < pagedView.fileSize) ? end : pagedView.fileSize);
+		return;
+	}
+
+	const uint64_t start = (offset > pagedView.dataStart + EDIT_PAGE_WINDOW_SIZE/2) ? offset - EDIT_PAGE_WINDOW_SIZE/2 : pagedView.dataStart;
+	const uint64_t lineStart = EditPagedView_LineStartAfter(start, offset);
+	EditPagedView_LoadRange(lineStart, EditPagedView_LineEndAfter(lineStart + EDIT_PAGE_WINDOW_SIZE));
+}
+
+static Sci_Position EditPagedView_PositionFromOffset(uint64_t offset) {
+	if (offset < pagedView.windowStart) {
+		return 0;
+	}
+	if (offset > pagedView.windowEnd) {
+		offset = pagedView.windowEnd;
+	}
+	if (pagedView.bHexView) {
+		offset -= pagedView.windowStart;
+		const Sci_Position iPos = (Sci_Position)(offset / EDIT_HEX_BYTES_PER_LINE) * EditPagedView_HexLineWidth()
+			+ EditPagedView_HexByteColumn((int)(offset % EDIT_HEX_BYTES_PER_LINE));
+		return min_pos(iPos, SciCall_GetLength());
+	}
+	return (Sci_Position)(offset - pagedView.windowStart);
+}
+
+static uint64_t EditPagedView_OffsetFromPosition(Sci_Position iPos) {
+	if (!pagedView.bHexView) {
+		return pagedView.windowStart + iPos;
+	}
+
+	// map column in hex or ASCII column to byte index
+	const Sci_Position width = EditPagedView_HexLineWidth();
+	const Sci_Position column = iPos % width - EditPagedView_HexByteColumn(0);
+	const Sci_Position asciiColumn = EditPagedView_HexByteColumn(EDIT_HEX_BYTES_PER_LINE) - EditPagedView_HexByteColumn(0) + 1;
+	Sci_Position index = 0;
+	if (column >= asciiColumn) {
+		index = column - asciiColumn;
+	} else if (column > 0) {
+		index = (column - (column > 3*EDIT_HEX_BYTES_PER_LINE/2)) / 3;
+	}
+	index = max_pos(0, min_pos(index, EDIT_HEX_BYTES_PER_LINE - 1));
+	const uint64_t offset = pagedView.windowStart + (uint64_t)(iPos / width) * EDIT_HEX_BYTES_PER_LINE + index;
+	return (offset < pagedView.windowEnd) ? offset : pagedView.windowEnd;
+}
+
+// returns document position of offset, the window is moved when offset is outside of it.
+static Sci_Position EditPagedView_MoveTo(uint64_t offset) {
+	if (offset < pagedView.windowStart || offset > pagedView.windowEnd
+		|| (offset == pagedView.windowEnd && offset != pagedView.fileSize)) {
+		EditPagedView_LoadAround(offset);
+	}
+	return EditPagedView_PositionFromOffset(offset);
+}
+
+static BOOL EditPagedView_Open(HANDLE hFile, LPCWSTR pszFile, uint64_t fileSize, BOOL bHexView, EditFileIOStatus *status) {
+	EditPagedView_Close();
+	ZeroMemory(&pagedView, sizeof(pagedView));
+	pagedView.hFile = hFile;
+	pagedView.fileSize = fileSize;
+	if (bHexView) {
+		// line count is known from file size, no line index is needed.
+		pagedView.bActive = TRUE;
+		pagedView.bHexView = TRUE;
+		pagedView.hIndexFile = INVALID_HANDLE_VALUE;
+		pagedView.hexDigits = (fileSize > UINT32_MAX) ? 16 : 8;
+		pagedView.bIndexDone = TRUE;
+		pagedView.totalLineCount = (fileSize == 0) ? 1 : (Sci_Line)((fileSize + EDIT_HEX_BYTES_PER_LINE - 1) / EDIT_HEX_BYTES_PER_LINE);
+		SciCall_SetCodePage(SC_CP_UTF8);
+		FileVars_Init(NULL, 0, &fvCurFile);
+		EditPagedView_LoadAround(0);
+
+		status->iEOLMode = SC_EOL_LF;
+		status->totalLineCount = SciCall_GetLineCount();
+		status->iEncoding = CPI_DEFAULT;
+		status->bPagedView = TRUE;
+		return TRUE;
+	}
+
+	pagedView.lineOffsets = (uint64_t *)NP2HeapAlloc((SIZE_T)(fileSize / EDIT_LINE_INDEX_STEP + 2) * sizeof(uint64_t));
+	pagedView.lineOffsetCount = 1;
+
+	// text is shown as UTF-8 when the first page is valid, otherwise in default code page without conversion.
+	const EditPage *page = EditPagedView_GetPage(0);
+	const BOOL utf8Sig = page->cbData >= 3 && IsUTF8Signature(page->lpData);
+	pagedView.dataStart = utf8Sig ? 3 : 0;
+	pagedView.bUTF8 = utf8Sig || IsUTF8(page->lpData, UTF8_AlignedLength(page->lpData, page->cbData));
+	SciCall_SetCodePage(pagedView.bUTF8 ? SC_CP_UTF8 : iDefaultCodePage);
+
+	pagedView.bActive = TRUE;
+	FileVars_Init(NULL, 0, &fvCurFile);
+	EditPagedView_LoadRange(pagedView.dataStart, EditPagedView_LineEndAfter(pagedView.dataStart + EDIT_PAGE_WINDOW_SIZE));
+
+	pagedView.hIndexFile = CreateFile(pszFile, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (pagedView.hIndexFile != INVALID_HANDLE_VALUE) {
+		DWORD dwThreadId;
+		pagedView.hIndexThread = CreateThread(NULL, 0, EditPagedView_IndexThread, NULL, 0, &dwThreadId);
+		if (pagedView.hIndexThread != NULL) {
+			SetThreadPriority(pagedView.hIndexThread, THREAD_PRIORITY_BELOW_NORMAL);
+		}
+	}
+
+	const Sci_Position length = SciCall_GetLength();
+	status->iEOLMode = iLineEndings[iDefaultEOLMode];
+	status->totalLineCount = 1;
+	EditDetectEOLMode(SciCall_GetRangePointer(0, length), length, status);
+	status->iEncoding = pagedView.bUTF8 ? (utf8Sig ? CPI_UTF8SIGN : CPI_UTF8) : CPI_DEFAULT;
+	status->bPagedView = TRUE;
+	return TRUE;
+}
+
+void EditPagedView_Close(void) {
+	if (!pagedView.bActive) {
+		return;
+	}
+
+	if (pagedView.hIndexThread != NULL) {
+		InterlockedExchange(&pagedView.bStopIndex, TRUE);
+		WaitForSingleObject(pagedView.hIndexThread, INFINITE);
+		CloseHandle(pagedView.hIndexThread);
+	}
+	if (pagedView.hIndexFile != INVALID_HANDLE_VALUE) {
+		CloseHandle(pagedView.hIndexFile);
+	}
+	CloseHandle(pagedView.hFile);
+	for (int i = 0; i < EDIT_PAGE_CACHE_COUNT; i++) {
+		if (pagedView.pages[i].lpData != NULL) {
+			NP2HeapFree(pagedView.pages[i].lpData);
+		}
+	}
+	if (pagedView.lineOffsets != NULL) {
+		NP2HeapFree(pagedView.lineOffsets);
+	}
+	ZeroMemory(&pagedView, sizeof(pagedView));
+}
+
+BOOL EditPagedView_IsActive(void) {
+	return pagedView.bActive;
+}
+
+BOOL EditPagedView_IsHexView(void) {
+	return pagedView.bHexView;
+}
+
+Sci_Line EditPagedView_GetFirstLine(void) {
+	// retry after indexing thread made progress
+	if (pagedView.windowLine < 0 && (pagedView.windowLineCount != pagedView.lineOffsetCount || pagedView.bIndexDone)) {
+		pagedView.windowLineCount = pagedView.lineOffsetCount;
+		pagedView.windowLine = EditPagedView_LineFromOffset(pagedView.windowStart);
+	}
+	return pagedView.windowLine;
+}
+
+Sci_Line EditPagedView_GetLineCount(BOOL *pbComplete) {
+	*pbComplete = pagedView.bIndexDone;
+	if (pagedView.bIndexDone) {
+		return pagedView.totalLineCount;
+	}
+	return (Sci_Line)(pagedView.lineOffsetCount - 1) * EDIT_LINE_INDEX_STEP;
+}
+
+// called on SCN_UPDATEUI, the window is moved later as the notification is sent when painting.
+void EditPagedView_OnUpdateUI(HWND hwnd) {
+	if (!pagedView.bActive || pagedView.bMovePending) {
+		return;
+	}
+
+	const Sci_Line firstLine = SciCall_GetFirstVisibleLine();
+	const Sci_Line lastLine = SciCall_VisibleFromDocLine(SciCall_GetLineCount() - 1);
+	if ((firstLine == 0 && pagedView.windowStart > pagedView.dataStart)
+		|| (firstLine + SciCall_LinesOnScreen() > lastLine && pagedView.windowEnd < pagedView.fileSize)) {
+		pagedView.bMovePending = TRUE;
+		PostMessage(hwnd, APPM_PAGEDVIEW_MOVE, 0, 0);
+	}
+}
+
+// center the window around first visible line, keep the caret when it's still inside the window.
+void EditPagedView_Scroll(void) {
+	pagedView.bMovePending = FALSE;
+	if (!pagedView.bActive) {
+		return;
+	}
+
+	const Sci_Line firstLine = SciCall_DocLineFromVisible(SciCall_GetFirstVisibleLine());
+	const uint64_t topOffset = EditPagedView_OffsetFromPosition(SciCall_PositionFromLine(firstLine));
+	const uint64_t caretOffset = EditPagedView_OffsetFromPosition(SciCall_GetCurrentPos());
+	EditPagedView_LoadAround(topOffset);
+	const Sci_Position iTopPos = EditPagedView_PositionFromOffset(topOffset);
+	if (caretOffset >= pagedView.windowStart && caretOffset <= pagedView.windowEnd) {
+		SciCall_SetEmptySelection(EditPagedView_PositionFromOffset(caretOffset));
+	} else {
+		SciCall_SetEmptySelection(iTopPos);
+	}
+	SciCall_SetFirstVisibleLine(SciCall_VisibleFromDocLine(SciCall_LineFromPosition(iTopPos)));
+}
+
+// iNewLine is line number in whole file, -1 for end of file.
+BOOL EditPagedView_JumpTo(Sci_Line iNewLine, Sci_Position iNewCol) {
+	uint64_t offset = pagedView.fileSize;
+	if (iNewLine >= 0) {
+		if (pagedView.bIndexDone && iNewLine > pagedView.totalLineCount) {
+			iNewLine = pagedView.totalLineCount;
+		}
+		const Sci_Line line = max_pos(iNewLine, 1) - 1;
+		const int64_t lineOffset = pagedView.bHexView ? (int64_t)line * EDIT_HEX_BYTES_PER_LINE : EditPagedView_OffsetFromLine(line);
+		if (lineOffset < 0) {
+			return FALSE;
+		}
+		offset = (uint64_t)lineOffset;
+	}
+
+	const Sci_Position iPos = EditPagedView_MoveTo(offset);
+	if (iNewLine < 0) {
+		SciCall_GotoPos(iPos);
+	} else {
+		EditJumpTo(SciCall_LineFromPosition(iPos) + 1, iNewCol);
+	}
+	EditEnsureSelectionVisible();
+	return TRUE;
+}
+
+// hex pattern starts with "0x" followed by hex digits, space, tab and comma are ignored.
+// returns number of bytes, zero when it's not a valid hex pattern.
+static DWORD EditPagedView_ParseHexPattern(LPCSTR szFind, uint8_t *pattern) {
+	if (!(szFind[0] == '0' && (szFind[1] | 0x20) == 'x')) {
+		return 0;
+	}
+
+	DWORD count = 0;
+	UINT value = 0;
+	int digits = 0;
+	for (LPCSTR p = szFind + 2; *p; p++) {
+		const char ch = *p;
+		if (ch == ' ' || ch == '\t' || ch == ',') {
+			if (digits != 0) {
+				pattern[count++] = (uint8_t)value;
+				value = 0;
+				digits = 0;
+			}
+			continue;
+		}
+
+		int digit;
+		if (ch >= '0' && ch <= '9') {
+			digit = ch - '0';
+		} else if ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'f') {
+			digit = (ch | 0x20) - 'a' + 10;
+		} else {
+			return 0;
+		}
+		value = (value << 4) | digit;
+		if (++digits == 2) {
+			pattern[count++] = (uint8_t)value;
+			value = 0;
+			digits = 0;
+		}
+	}
+	if (digits != 0) {
+		pattern[count++] = (uint8_t)value;
+	}
+	return count;
+}
+
+static inline BOOL EditPagedView_MatchBytes(const char *lpData, const uint8_t *pattern, DWORD cbPattern, BOOL bIgnoreCase) {
+	if (!bIgnoreCase) {
+		return (uint8_t)(*lpData) == pattern[0] && memcmp(lpData, pattern, cbPattern) == 0;
+	}
+	// pattern is in lower case
+	for (DWORD i = 0; i < cbPattern; i++) {
+		uint8_t ch = (uint8_t)lpData[i];
+		if (ch >= 'A' && ch <= 'Z') {
+			ch |= 0x20;
+		}
+		if (ch != pattern[i]) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static const char *EditPagedView_SearchBytes(const char *lpData, SIZE_T cbData, const uint8_t *pattern, DWORD cbPattern, BOOL bIgnoreCase, BOOL bBackward) {
+	if (cbData < cbPattern) {
+		return NULL;
+	}
+
+	const char * const last = lpData + (cbData - cbPattern);
+	if (bBackward) {
+		for (const char *p = last + 1; p != lpData; ) {
+			--p;
+			if (EditPagedView_MatchBytes(p, pattern, cbPattern, bIgnoreCase)) {
+				return p;
+			}
+		}
+	} else if (bIgnoreCase) {
+		for (const char *p = lpData; p <= last; p++) {
+			if (EditPagedView_MatchBytes(p, pattern, cbPattern, TRUE)) {
+				return p;
+			}
+		}
+	} else {
+		const char *p = lpData;
+		while ((p = (const char *)memchr(p, pattern[0], last - p + 1)) != NULL) {
+			if (memcmp(p, pattern, cbPattern) == 0) {
+				return p;
+			}
+			if (p == last) {
+				break;
+			}
+			++p;
+		}
+	}
+	return NULL;
+}
+
+// search file content through the page cache, forward for match starts at or after offset,
+// backward for match ends at or before offset. returns file offset of the match, or UINT64_MAX.
+static uint64_t EditPagedView_SearchFile(uint64_t offset, const uint8_t *pattern, DWORD cbPattern, BOOL bIgnoreCase, BOOL bBackward) {
+	// buffer overlaps previous one by cbPattern - 1 bytes for match across page boundary.
+	const SIZE_T cbBuffer = EDIT_PAGE_SIZE + cbPattern - 1;
+	char *lpData = (char *)NP2HeapAlloc(cbBuffer);
+	uint64_t found = UINT64_MAX;
+
+	if (bBackward) {
+		uint64_t end = (offset < pagedView.fileSize) ? offset : pagedView.fileSize;
+		while (end >= pagedView.dataStart + cbPattern) {
+			const uint64_t start = (end > pagedView.dataStart + cbBuffer) ? end - cbBuffer : pagedView.dataStart;
+			const SIZE_T cbData = EditPagedView_Copy(start, lpData, (SIZE_T)(end - start));
+			const char *p = EditPagedView_SearchBytes(lpData, cbData, pattern, cbPattern, bIgnoreCase, TRUE);
+			if (p != NULL) {
+				found = start + (p - lpData);
+				break;
+			}
+			if (start == pagedView.dataStart) {
+				break;
+			}
+			end = start + cbPattern - 1;
+		}
+	} else {
+		uint64_t start = (offset > pagedView.dataStart) ? offset : pagedView.dataStart;
+		while (start + cbPattern <= pagedView.fileSize) {
+			const SIZE_T cbData = EditPagedView_Copy(start, lpData, cbBuffer);
+			if (cbData < cbPattern) {
+				break;
+			}
+			const char *p = EditPagedView_SearchBytes(lpData, cbData, pattern, cbPattern, bIgnoreCase, FALSE);
+			if (p != NULL) {
+				found = start + (p - lpData);
+				break;
+			}
+			start += cbData - cbPattern + 1;
+		}
+	}
+
+	NP2HeapFree(lpData);
+	return found;
+}
+
+// offset before start of file wraps around to UINT64_MAX.
+static inline BOOL EditPagedView_IsWordByte(uint64_t offset) {
+	char ch = '\0';
+	if (offset < pagedView.dataStart || offset >= pagedView.fileSize || EditPagedView_Copy(offset, &ch, 1) == 0) {
+		return FALSE;
+	}
+	// default word characters in Scintilla
+	return (uint8_t)ch >= 0x80 || isalnum((uint8_t)ch) || ch == '_';
+}
+
+// whether match at offset is a whole word or at word start as required by searchFlags.
+static BOOL EditPagedView_IsWordMatch(int searchFlags, uint64_t offset, DWORD cbPattern) {
+	if ((searchFlags & (SCFIND_WHOLEWORD | SCFIND_WORDSTART)) && EditPagedView_IsWordByte(offset - 1)) {
+		return FALSE;
+	}
+	if ((searchFlags & SCFIND_WHOLEWORD) && EditPagedView_IsWordByte(offset + cbPattern)) {
+		return FALSE;
+	}
+	return TRUE;
+}
+
+// search bytes of the file in hex view, matched bytes are selected in hex column.
+// text starts with "0x" is searched as hex bytes, otherwise as ASCII text with match case, whole word
+// and word start options. returns -1 for invalid hex pattern and regular expression.
+int EditPagedView_FindHex(LPCSTR szFind, int searchFlags, BOOL bBackward) {
+	if (!pagedView.bHexView) {
+		return 0;
+	}
+
+	uint8_t pattern[NP2_FIND_REPLACE_LIMIT];
+	const BOOL bHex = szFind[0] == '0' && (szFind[1] | 0x20) == 'x';
+	const BOOL bIgnoreCase = !bHex && !(searchFlags & SCFIND_MATCHCASE);
+	DWORD cbPattern = 0;
+	if (bHex) {
+		cbPattern = EditPagedView_ParseHexPattern(szFind, pattern);
+		searchFlags = 0;
+	} else if (!(searchFlags & SCFIND_REGEXP)) {
+		for (LPCSTR p = szFind; *p; p++) {
+			uint8_t ch = (uint8_t)(*p);
+			if (bIgnoreCase && ch >= 'A' && ch <= 'Z') {
+				ch |= 0x20;
+			}
+			pattern[cbPattern++] = ch;
+		}
+	}
+	if (cbPattern == 0) {
+		return -1;
+	}
+
+	const Sci_Position iSelStart = SciCall_GetSelectionStart();
+	const uint64_t selStart = EditPagedView_OffsetFromPosition(iSelStart);
+	// backward: match starts before current selection; forward: match starts after start of current selection.
+	uint64_t offset = bBackward ? selStart + cbPattern - 1 : selStart + (iSelStart != SciCall_GetSelectionEnd());
+	uint64_t found;
+	BeginWaitCursor();
+	do {
+		found = EditPagedView_SearchFile(offset, pattern, cbPattern, bIgnoreCase, bBackward);
+		offset = bBackward ? found + cbPattern - 1 : found + 1;
+	} while (found != UINT64_MAX && !EditPagedView_IsWordMatch(searchFlags, found, cbPattern));
+
+	if (found != UINT64_MAX) {
+		// move window to the match, then select from first to last matched byte.
+		const uint64_t last = found + cbPattern - 1;
+		if (found < pagedView.windowStart || last >= pagedView.windowEnd) {
+			EditPagedView_LoadAround(found);
+		}
+		const Sci_Position iPos = EditPagedView_PositionFromOffset(found);
+		const Sci_Position iEndPos = EditPagedView_PositionFromOffset(last) + 2;
+		SciCall_SetSel(iPos, iEndPos);
+		EditEnsureSelectionVisible();
+	}
+	EndWaitCursor();
+	return found != UINT64_MAX;
+}
+
+// search windows after or before current window for regular expression and ignoring case of
+// non-ASCII text, which need the text in the document. returns position of the match in the new window.
+static Sci_Position EditPagedView_FindInWindows(int searchFlags, struct Sci_TextToFind *ttf, BOOL bBackward) {
+	const uint64_t windowStart = pagedView.windowStart;
+	const uint64_t windowEnd = pagedView.windowEnd;
+	const Sci_Position iCurrentPos = SciCall_GetCurrentPos();
+	Sci_Position iPos = -1;
+
+	while (iPos < 0) {
+		uint64_t start;
+		uint64_t end;
+		if (bBackward) {
+			if (pagedView.windowStart <= pagedView.dataStart) {
+				break;
+			}
+			end = pagedView.windowStart;
+			start = (end > pagedView.dataStart + EDIT_PAGE_WINDOW_SIZE) ? end - EDIT_PAGE_WINDOW_SIZE : pagedView.dataStart;
+			const uint64_t lineStart = EditPagedView_LineStartAfter(start, end);
+			if (lineStart != end) {
+				start = lineStart;
+			}
+		} else {
+			if (pagedView.windowEnd >= pagedView.fileSize) {
+				break;
+			}
+			start = pagedView.windowEnd;
+			end = EditPagedView_LineEndAfter(start + EDIT_PAGE_WINDOW_SIZE);
+		}
+
+		EditPagedView_LoadRange(start, end);
+		const Sci_Position iLength = SciCall_GetLength();
+		ttf->chrg.cpMin = (Sci_PositionCR)(bBackward ? iLength : 0);
+		ttf->chrg.cpMax = (Sci_PositionCR)(bBackward ? 0 : iLength);
+		iPos = SciCall_FindText(searchFlags, ttf);
+	}
+
+	if (iPos < 0 && (pagedView.windowStart != windowStart || pagedView.windowEnd != windowEnd)) {
+		EditPagedView_LoadRange(windowStart, windowEnd);
+		SciCall_GotoPos(iCurrentPos);
+	}
+	return iPos;
+}
+
+// search file content after (or before) ttf->chrg.cpMin in the page cache, only the window
+// containing the match is loaded, where the match is checked by SciCall_FindText().
+// returns position of the match in the window.
+Sci_Position EditPagedView_FindText(int searchFlags, struct Sci_TextToFind *ttf, BOOL bBackward) {
+	if (!pagedView.bActive) {
+		return -1;
+	}
+
+	const char *szFind = ttf->lpstrText;
+	const DWORD cbPattern = (DWORD)strlen(szFind);
+	const BOOL bIgnoreCase = !(searchFlags & SCFIND_MATCHCASE);
+	BOOL bASCII = TRUE;
+	uint8_t pattern[NP2_FIND_REPLACE_LIMIT];
+	for (DWORD i = 0; i < cbPattern; i++) {
+		uint8_t ch = (uint8_t)szFind[i];
+		bASCII &= ch < 0x80;
+		if (bIgnoreCase && ch >= 'A' && ch <= 'Z') {
+			ch |= 0x20;
+		}
+		pattern[i] = ch;
+	}
+
+	BeginWaitCursor();
+	// case folding of non-ASCII characters depends on code page.
+	if ((searchFlags & SCFIND_REGEXP) || (bIgnoreCase && !bASCII) || cbPattern == 0) {
+		const Sci_Position iPos = EditPagedView_FindInWindows(searchFlags, ttf, bBackward);
+		EndWaitCursor();
+		return iPos;
+	}
+
+	const uint64_t windowStart = pagedView.windowStart;
+	const uint64_t windowEnd = pagedView.windowEnd;
+	const Sci_Position iCurrentPos = SciCall_GetCurrentPos();
+	uint64_t offset = EditPagedView_OffsetFromPosition(ttf->chrg.cpMin);
+	Sci_Position iPos = -1;
+	while (iPos < 0) {
+		const uint64_t found = EditPagedView_SearchFile(offset, pattern, cbPattern, bIgnoreCase, bBackward);
+		if (found == UINT64_MAX) {
+			break;
+		}
+		// next match starts before or after this one
+		offset = bBackward ? found + cbPattern - 1 : found + 1;
+		if (!EditPagedView_IsWordMatch(searchFlags, found, cbPattern)) {
+			continue;
+		}
+
+		if (found < pagedView.windowStart || found + cbPattern > pagedView.windowEnd) {
+			EditPagedView_LoadAround(found);
+		}
+		const Sci_Position iStart = EditPagedView_PositionFromOffset(found);
+		ttf->chrg.cpMin = (Sci_PositionCR)iStart;
+		ttf->chrg.cpMax = (Sci_PositionCR)(iStart + cbPattern);
+		iPos = SciCall_FindText(searchFlags, ttf);
+	}
+
+	if (iPos < 0 && (pagedView.windowStart != windowStart || pagedView.windowEnd != windowEnd)) {
+		EditPagedView_LoadRange(windowStart, windowEnd);
+		SciCall_GotoPos(iCurrentPos);
+	}
+	EndWaitCursor();
+	return iPos;
+}
+
 //=============================================================================
 //
 // EditLoadFile()
 //
+// file is read in pieces, ReadFile() can't read 4 GiB or more at once.
+#define EDIT_LOAD_CHUNK_SIZE	(1024*1024*1024)
+
+// check file header for binary file, Unicode text is not treated as binary.
+// UTF-16 without BOM is checked even when SkipUnicodeDetection is set, its NUL bytes look binary.
+static BOOL EditIsBinaryFile(HANDLE hFile) {
+	char header[1024 + 2];
+	DWORD cbRead = 0;
+	const BOOL bReadSuccess = EditPagedView_ReadFile(hFile, 0, header, 1024, &cbRead);
+	// positioned read also moves file pointer
+	SetFilePointer(hFile, 0, NULL, FILE_BEGIN);
+	if (!bReadSuccess || cbRead == 0) {
+		return FALSE;
+	}
+
+	header[cbRead] = '\0';
+	header[cbRead + 1] = '\0';
+	if ((cbRead >= 3 && IsUTF8Signature(header)) || (cbRead >= 2 && IsUnicode(header, cbRead & ~1U, NULL, NULL))) {
+		return FALSE;
+	}
+	const int confidence = EncodingDetect_UTF16(header, cbRead & ~1U, FALSE);
+	const int confidenceBE = EncodingDetect_UTF16(header, cbRead & ~1U, TRUE);
+	if (max_i(confidence, confidenceBE) >= ENCODING_DETECT_THRESHOLD - ENCODING_DETECT_MARGIN) {
+		return FALSE;
+	}
+	return Style_MaybeBinaryData(header, cbRead);
+}
+
 BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus *status) {
 	HANDLE hFile = CreateFile(pszFile,
 					   GENERIC_READ,
@@ -693,6 +1865,21 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		}
 	}
 
+	// binary file is shown in hex view regardless of file size
+	BOOL bHexView = iSrcHexView > 0;
+	if (iSrcHexView < 0 && iSrcEncoding < 0) {
+		if (status->bReload && EditPagedView_IsHexView()) {
+			bHexView = TRUE;
+		} else if (bHexViewBinaryFile) {
+			bHexView = EditIsBinaryFile(hFile);
+		}
+	}
+	if (bHexView) {
+		iSrcEncoding = -1;
+		iWeakSrcEncoding = -1;
+		return EditPagedView_Open(hFile, pszFile, (uint64_t)fileSize.QuadPart, TRUE, status);
+	}
+
 	// Check if a warning message should be displayed for large files
 #if defined(_WIN64)
 	// less than 1/3 available physical memory:
@@ -700,9 +1887,10 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 	//     2. Scintilla's content buffer and style buffer, see CellBuffer class. The style buffer can be disabled by using SCLEX_NULL and SC_DOCUMENTOPTION_STYLES_NONE.
 	//     3. Extra memory when moving gaps on editing, it may requires more than 2/3 physical memory.
 	// large file TODO: https://github.com/zufuliu/notepad2/issues/125
-	// [ ] [> 4 GiB] use SetFilePointerEx() and ReadFile()/WriteFile() to read/write file.
+	// [x] [> 4 GiB] use SetFilePointerEx() and ReadFile()/WriteFile() to read/write file.
 	// [-] [> 2 GiB] fix encoding conversion with MultiByteToWideChar() and WideCharToMultiByte().
-	LONGLONG maxFileSize = INT64_C(0x100000000);
+	//     8-bit, DBCS and UTF-7 text is converted in chunks, UTF-16 text is still limited to MAX_NON_UTF8_SIZE.
+	LONGLONG maxFileSize = INT64_MAX;
 #else
 	// 2 GiB: ptrdiff_t / Sci_Position used in Scintilla
 	LONGLONG maxFileSize = INT64_C(0x80000000);
@@ -720,8 +1908,6 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 	}
 
 	if (fileSize.QuadPart > maxFileSize) {
-		CloseHandle(hFile);
-		status->bFileTooBig = TRUE;
 		iSrcEncoding = -1;
 		iWeakSrcEncoding = -1;
 		WCHAR tchDocSize[32];
@@ -734,15 +1920,28 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		_i64tow(maxFileSize, tchMaxBytes, 10);
 		FormatNumberStr(tchDocBytes);
 		FormatNumberStr(tchMaxBytes);
-		MsgBox(MBWARN, IDS_WARNLOADBIGFILE, pszFile, tchDocSize, tchDocBytes, tchMaxSize, tchMaxBytes);
+		if (MsgBox(MBYESNOWARN, IDS_WARNLOADBIGFILE, pszFile, tchDocSize, tchDocBytes, tchMaxSize, tchMaxBytes) == IDYES) {
+			return EditPagedView_Open(hFile, pszFile, (uint64_t)fileSize.QuadPart, FALSE, status);
+		}
+		CloseHandle(hFile);
+		status->bFileTooBig = TRUE;
 		return FALSE;
 	}
 
 	char *lpData = (char *)NP2HeapAlloc((SIZE_T)(fileSize.QuadPart) + 16);
-	DWORD cbData = 0;
-	// prevent unsigned integer overflow.
-	const DWORD readLen = max_u((DWORD)(NP2HeapSize(lpData) - 2), (DWORD)fileSize.QuadPart);
-	const BOOL bReadSuccess = ReadFile(hFile, lpData, readLen, &cbData, NULL);
+	SIZE_T cbData = 0;
+	// ReadFile() reads at most 4 GiB at once, keep two zero bytes at end for UTF-16 text.
+	const SIZE_T cbMaxRead = NP2HeapSize(lpData) - 2;
+	BOOL bReadSuccess = TRUE;
+	while (cbData < cbMaxRead) {
+		DWORD cbRead = 0;
+		const DWORD readLen = (cbMaxRead - cbData < EDIT_LOAD_CHUNK_SIZE) ? (DWORD)(cbMaxRead - cbData) : EDIT_LOAD_CHUNK_SIZE;
+		bReadSuccess = ReadFile(hFile, lpData + cbData, readLen, &cbRead, NULL);
+		if (!bReadSuccess || cbRead == 0) {
+			break;
+		}
+		cbData += cbRead;
+	}
 	dwLastIOError = GetLastError();
 	CloseHandle(hFile);
 
@@ -753,6 +1952,18 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		return FALSE;
 	}
 
+	// document is replaced below, file in paged view is no longer needed.
+	if (EditPagedView_IsActive()) {
+		// document only holds a window of the file or hex text, don't diff with it
+		status->bReload = FALSE;
+		EditPagedView_Close();
+	}
+
+	// data may be converted in place, remember file tail before that.
+	editFileTail.fileSize = 0;
+	editFileTail.cbTail = 0;
+	EditFileTail_Update(lpData, cbData);
+
 	BOOL bPreferOEM = FALSE;
 	if (bLoadNFOasOEM) {
 		LPCWSTR const pszExt = pszFile + lstrlen(pszFile) - 4;
@@ -770,6 +1981,8 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		_iDefaultEncoding = iWeakSrcEncoding;
 	}
 
+	// code page of current document, diff is only applied when it's unchanged.
+	const UINT cpEdit = SciCall_GetCodePage();
 	int iEncoding = CPI_DEFAULT;
 	const BOOL utf8Sig = cbData? IsUTF8Signature(lpData) : FALSE;
 	BOOL bBOM = FALSE;
@@ -796,7 +2009,7 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		EditSetEmptyText();
 		SciCall_SetEOLMode(status->iEOLMode);
 	} else if (cbData < MAX_NON_UTF8_SIZE && ((iSrcEncoding == CPI_UNICODE || iSrcEncoding == CPI_UNICODEBE) // reload as UTF-16
-		|| (!bSkipEncodingDetection && iSrcEncoding == -1 && !utf8Sig && IsUnicode(lpData, cbData, &bBOM, &bReverse))
+		|| (!bSkipEncodingDetection && iSrcEncoding == -1 && !utf8Sig && IsUnicode(lpData, (DWORD)cbData, &bBOM, &bReverse))
 		)) {
 		if (iSrcEncoding == CPI_UNICODE) {
 			bBOM = (lpData[0] == '\xFF' && lpData[1] == '\xFE');
@@ -806,7 +2019,7 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		}
 
 		if (iSrcEncoding == CPI_UNICODEBE || bReverse) {
-			_swab(lpData, lpData, cbData);
+			_swab(lpData, lpData, (int)cbData);
 			if (bBOM) {
 				iEncoding = CPI_UNICODEBEBOM;
 			} else {
@@ -834,7 +2047,7 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 		EditDetectEOLMode(lpDataUTF8, cbData - 1, status);
 		FileVars_Init(lpDataUTF8, cbData - 1, &fvCurFile);
 		SciCall_SetCodePage(SC_CP_UTF8);
-		EditSetNewText(lpDataUTF8, cbData - 1, status->totalLineCount);
+		EditSetLoadedText(lpDataUTF8, cbData - 1, status, cpEdit);
 		NP2HeapFree(lpDataUTF8);
 	} else {
 		FileVars_Init(lpData, cbData, &fvCurFile);
@@ -849,11 +2062,11 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 			SciCall_SetCodePage(SC_CP_UTF8);
 			if (utf8Sig) {
 				EditDetectEOLMode(lpData + 3, cbData - 3, status);
-				EditSetNewText(lpData + 3, cbData - 3, status->totalLineCount);
+				EditSetLoadedText(lpData + 3, cbData - 3, status, cpEdit);
 				iEncoding = CPI_UTF8SIGN;
 			} else {
 				EditDetectEOLMode(lpData, cbData, status);
-				EditSetNewText(lpData, cbData, status->totalLineCount);
+				EditSetLoadedText(lpData, cbData, status, cpEdit);
 				iEncoding = CPI_UTF8;
 			}
 		} else {
@@ -866,28 +2079,29 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 						iEncoding = iDefaultEncoding;
 					} else {
 						iEncoding = _iDefaultEncoding;
+						if (!bSkipEncodingDetection && !bPreferOEM && iWeakSrcEncoding == -1) {
+							// rank legacy code pages instead of only trusting the default encoding
+							iEncoding = Encoding_DetectLegacy(lpData, cbData, iEncoding);
+						}
 					}
 				}
 			}
 
 			const UINT uCodePage = mEncoding[iEncoding].uCodePage;
-			if (cbData < MAX_NON_UTF8_SIZE && ((mEncoding[iEncoding].uFlags & NCP_8BIT)
-				|| ((mEncoding[iEncoding].uFlags & NCP_7BIT) && IsUTF7(lpData, cbData))
-			)) {
-				LPWSTR lpDataWide = (LPWSTR)NP2HeapAlloc(cbData * sizeof(WCHAR) + 16);
-				const int cbDataWide = MultiByteToWideChar(uCodePage, 0, lpData, cbData, lpDataWide, (int)(NP2HeapSize(lpDataWide) / sizeof(WCHAR)));
+			if ((mEncoding[iEncoding].uFlags & NCP_8BIT)
+				|| ((mEncoding[iEncoding].uFlags & NCP_7BIT) && cbData < MAX_NON_UTF8_SIZE && IsUTF7(lpData, (DWORD)cbData))
+			) {
+				char *lpDataUTF8 = EditConvertLoadedText(uCodePage, lpData, cbData, &cbData);
 				NP2HeapFree(lpData);
-				lpData = (char *)NP2HeapAlloc(cbDataWide * kMaxMultiByteCount + 16);
-				cbData = WideCharToMultiByte(CP_UTF8, 0, lpDataWide, cbDataWide, lpData, (int)NP2HeapSize(lpData), NULL, NULL);
-				NP2HeapFree(lpDataWide);
+				lpData = lpDataUTF8;
 
 				EditDetectEOLMode(lpData, cbData, status);
 				SciCall_SetCodePage(SC_CP_UTF8);
-				EditSetNewText(lpData, cbData, status->totalLineCount);
+				EditSetLoadedText(lpData, cbData, status, cpEdit);
 			} else {
 				EditDetectEOLMode(lpData, cbData, status);
 				SciCall_SetCodePage(iDefaultCodePage);
-				EditSetNewText(lpData, cbData, status->totalLineCount);
+				EditSetLoadedText(lpData, cbData, status, cpEdit);
 				iEncoding = CPI_DEFAULT;
 			}
 		}
@@ -898,14 +2112,184 @@ BOOL EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, EditFileIOStatus
 	iSrcEncoding = -1;
 	iWeakSrcEncoding = -1;
 
+	editFileTail.bValid = TRUE;
+	editFileTail.iEncoding = iEncoding;
 	return TRUE;
 }
 
+//=============================================================================
+//
+// EditLoadFileTail()
+//
+// When the file only grew since it's loaded (e.g. log file), read and append new data at end,
+// caret, undo history and styles for existing text are kept.
+// Return FALSE when the file needs to be reloaded.
+BOOL EditLoadFileTail(LPCWSTR pszFile, int iEncoding) {
+	const UINT uFlags = mEncoding[iEncoding].uFlags;
+	if (!editFileTail.bValid || editFileTail.iEncoding != iEncoding || editFileTail.cbTail == 0
+		|| !(uFlags & (NCP_DEFAULT | NCP_UTF8 | NCP_8BIT)) || SciCall_GetReadOnly()) {
+		return FALSE;
+	}
+
+	HANDLE hFile = CreateFile(pszFile,
+					   GENERIC_READ,
+					   FILE_SHARE_READ | FILE_SHARE_WRITE,
+					   NULL, OPEN_EXISTING,
+					   FILE_ATTRIBUTE_NORMAL,
+					   NULL);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		return FALSE;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || (uint64_t)fileSize.QuadPart <= editFileTail.fileSize) {
+		CloseHandle(hFile);
+		return FALSE;
+	}
+
+	// check whether data previously loaded is unchanged.
+	char *lpData = (char *)NP2HeapAlloc(EDIT_CONVERT_CHUNK_SIZE + EDIT_FILE_TAIL_SIZE);
+	const DWORD cbTail = editFileTail.cbTail;
+	LARGE_INTEGER offset;
+	offset.QuadPart = (LONGLONG)(editFileTail.fileSize - cbTail);
+	DWORD cbRead = 0;
+	if (!SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN) || !ReadFile(hFile, lpData, cbTail, &cbRead, NULL)
+		|| cbRead != cbTail || memcmp(lpData, editFileTail.tail, cbTail) != 0) {
+		NP2HeapFree(lpData);
+		CloseHandle(hFile);
+		return FALSE;
+	}
+
+	// text in document is UTF-8 except for CPI_DEFAULT.
+	const UINT cpSource = (uFlags & NCP_8BIT) ? mEncoding[iEncoding].uCodePage : ((uFlags & NCP_DEFAULT) ? (UINT)iDefaultCodePage : SC_CP_UTF8);
+	LPWSTR lpWide = NULL;
+	char *lpUTF8 = NULL;
+	if (uFlags & NCP_8BIT) {
+		lpWide = (LPWSTR)NP2HeapAlloc(EDIT_CONVERT_CHUNK_SIZE * sizeof(WCHAR));
+		lpUTF8 = (char *)NP2HeapAlloc(EDIT_CONVERT_CHUNK_SIZE * kMaxMultiByteCount);
+	}
+
+	SciCall_SetUndoCollection(FALSE);
+	SciCall_SetModEventMask(SC_MOD_NONE);
+	uint64_t remaining = (uint64_t)fileSize.QuadPart - editFileTail.fileSize;
+	DWORD cbCarry = 0;
+	BOOL bSuccess = FALSE;
+	while (remaining != 0) {
+		// partial character at end of previous chunk is kept at beginning of the buffer.
+		const DWORD cbChunk = (remaining < EDIT_CONVERT_CHUNK_SIZE - cbCarry) ? (DWORD)remaining : (EDIT_CONVERT_CHUNK_SIZE - cbCarry);
+		if (!ReadFile(hFile, lpData + cbCarry, cbChunk, &cbRead, NULL) || cbRead == 0) {
+			break;
+		}
+		remaining -= cbRead;
+		cbRead += cbCarry;
+		DWORD cbData = (DWORD)EditConvert_AlignedLength(cpSource, lpData, cbRead);
+		if (remaining == 0 && cbData != cbRead) {
+			// incomplete character at end of file: UTF-8 bytes are appended as is (same as loading
+			// the whole file) and join with bytes appended next time, converted text can't be joined.
+			if (uFlags & NCP_8BIT) {
+				break;
+			}
+			cbData = cbRead;
+		}
+		if (cbData != 0) {
+			if (uFlags & NCP_8BIT) {
+				const int cchWide = MultiByteToWideChar(cpSource, 0, lpData, cbData, lpWide, EDIT_CONVERT_CHUNK_SIZE);
+				const int cbUTF8 = WideCharToMultiByte(CP_UTF8, 0, lpWide, cchWide, lpUTF8, EDIT_CONVERT_CHUNK_SIZE * kMaxMultiByteCount, NULL, NULL);
+				SciCall_AppendText(cbUTF8, lpUTF8);
+			} else {
+				SciCall_AppendText(cbData, lpData);
+			}
+			EditFileTail_Update(lpData, cbData);
+		}
+		cbCarry = cbRead - cbData;
+		memmove(lpData, lpData + cbData, cbCarry);
+		bSuccess = remaining == 0;
+	}
+	SciCall_SetModEventMask(SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT);
+	SciCall_SetUndoCollection(TRUE);
+
+	CloseHandle(hFile);
+	NP2HeapFree(lpData);
+	if (lpWide != NULL) {
+		NP2HeapFree(lpWide);
+		NP2HeapFree(lpUTF8);
+	}
+	if (!bSuccess) {
+		// document no longer matches the file after read error, file truncated while reading
+		// or incomplete character at end, the file is reloaded.
+		editFileTail.bValid = FALSE;
+		return FALSE;
+	}
+	SciCall_SetSavePoint();
+	return TRUE;
+}
+
+//=============================================================================
+//
+// EditSaveStream
+//
+// Text is converted and written in chunks read directly from the document buffer,
+// so memory used for saving does not grow with the size of the document.
+#define EDIT_SAVE_CHUNK_SIZE	(1024*1024)
+
+typedef struct EditSaveStream {
+	HANDLE hFile;
+	UINT uFlags;
+	UINT uCodePage;
+	DWORD dwFlags;		// flags for WideCharToMultiByte()
+	BOOL bCheckOnly;	// only check whether converting to the code page loses data
+	BOOL bDataLoss;
+	LPWSTR lpWide;		// EDIT_SAVE_CHUNK_SIZE characters
+	char *lpMultiByte;	// EDIT_SAVE_CHUNK_SIZE * 4 bytes
+} EditSaveStream;
+
+static const char *EditSaveStream_Read(void *context, size_t position, size_t cbData) {
+	UNREFERENCED_PARAMETER(context);
+	// only a chunk across the gap moves it, other chunks point into the buffer.
+	return SciCall_GetRangePointer((Sci_Position)position, (Sci_Position)cbData);
+}
+
+static int EditSaveStream_Write(void *context, const char *lpData, size_t cbData) {
+	EditSaveStream *stream = (EditSaveStream *)context;
+	DWORD dwBytesWritten;
+	const UINT uFlags = stream->uFlags;
+	if (uFlags & NCP_UNICODE) {
+		const int cchWide = MultiByteToWideChar(CP_UTF8, 0, lpData, (int)cbData, stream->lpWide, EDIT_SAVE_CHUNK_SIZE);
+		if (uFlags & NCP_UNICODE_REVERSE) {
+			_swab((char *)stream->lpWide, (char *)stream->lpWide, (int)(cchWide * sizeof(WCHAR)));
+		}
+		return WriteFile(stream->hFile, stream->lpWide, (DWORD)(cchWide * sizeof(WCHAR)), &dwBytesWritten, NULL);
+	}
+	if (uFlags & (NCP_8BIT | NCP_7BIT)) {
+		BOOL bDataLoss = FALSE;
+		const int cchWide = MultiByteToWideChar(CP_UTF8, 0, lpData, (int)cbData, stream->lpWide, EDIT_SAVE_CHUNK_SIZE);
+		const int cbMultiByte = WideCharToMultiByte(stream->uCodePage, stream->dwFlags, stream->lpWide, cchWide,
+			stream->lpMultiByte, EDIT_SAVE_CHUNK_SIZE * sizeof(WCHAR) * 2, NULL,
+			(stream->dwFlags & WC_NO_BEST_FIT_CHARS) ? &bDataLoss : NULL);
+		if (stream->bCheckOnly) {
+			stream->bDataLoss |= bDataLoss;
+			return !bDataLoss;
+		}
+		return WriteFile(stream->hFile, stream->lpMultiByte, cbMultiByte, &dwBytesWritten, NULL);
+	}
+	return WriteFile(stream->hFile, lpData, (DWORD)cbData, &dwBytesWritten, NULL);
+}
+
+static BOOL EditSaveStream_WriteDocument(EditSaveStream *stream) {
+	// converters for UTF-7, ISO-2022 and HZ-GB-2312 return to initial state at end of each chunk,
+	// end chunks after a line break where they are already in initial state.
+	const int bLineBreak = (stream->uFlags & NCP_7BIT) != 0;
+	return EditChunk_SplitUTF8((size_t)SciCall_GetLength(), EDIT_SAVE_CHUNK_SIZE, bLineBreak, EditSaveStream_Read, EditSaveStream_Write, stream);
+}
+
 //=============================================================================
 //
 // EditSaveFile()
 //
 BOOL EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, EditFileIOStatus *status) {
+	if (!bSaveCopy) {
+		editFileTail.bValid = FALSE;
+	}
 	HANDLE hFile = CreateFile(pszFile,
 					   GENERIC_WRITE,
 					   FILE_SHARE_READ | FILE_SHARE_WRITE,
@@ -945,60 +2329,28 @@ BOOL EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, EditFileIOStatus *
 	}
 
 	BOOL bWriteSuccess;
-	// get text
-	DWORD cbData = (DWORD)SciCall_GetLength();
-	char *lpData = NULL;
+	const Sci_Position cbData = SciCall_GetLength();
 
 	if (cbData == 0) {
 		bWriteSuccess = SetEndOfFile(hFile);
 		dwLastIOError = GetLastError();
 	} else {
 		DWORD dwBytesWritten;
-		int iEncoding = status->iEncoding;
-		UINT uFlags = mEncoding[iEncoding].uFlags;
-		if (cbData >= MAX_NON_UTF8_SIZE) {
-			// save in UTF-8 or ANSI
-			if (!(uFlags & (NCP_DEFAULT | NCP_UTF8))) {
-				if (uFlags & NCP_UNICODE_BOM) {
-					iEncoding = CPI_UTF8SIGN;
-				} else {
-					iEncoding = CPI_UTF8;
-				}
-				uFlags = mEncoding[iEncoding].uFlags;
-			}
-		}
-
-		lpData = (char *)NP2HeapAlloc(cbData + 1);
-		SciCall_GetText(NP2HeapSize(lpData), lpData);
-		// FIXME: move checks in front of disk file access
-		/*if ((uFlags & NCP_UNICODE) == 0 && (uFlags & NCP_UTF8_SIGN) == 0) {
-				BOOL bEncodingMismatch = TRUE;
-				FILEVARS fv;
-				FileVars_Init(lpData, cbData, &fv);
-				if (fv.mask & FV_ENCODING) {
-					int iAltEncoding;
-					if (FileVars_IsValidEncoding(&fv)) {
-						iAltEncoding = FileVars_GetEncoding(&fv);
-						if (iAltEncoding == iEncoding)
-							bEncodingMismatch = FALSE;
-						else if ((mEncoding[iAltEncoding].uFlags & NCP_UTF8) && (uFlags & NCP_UTF8))
-							bEncodingMismatch = FALSE;
-					}
-					if (bEncodingMismatch) {
-						Encoding_GetLabel(iAltEncoding);
-						Encoding_GetLabel(iEncoding);
-						InfoBox(0, L"MsgEncodingMismatch", IDS_ENCODINGMISMATCH,
-							mEncoding[iAltEncoding].wchLabel,
-							mEncoding[iEncoding].wchLabel);
-					}
-				}
-			}*/
+		// every encoding is converted and written in chunks, large document keeps its encoding.
+		const int iEncoding = status->iEncoding;
+		const UINT uFlags = mEncoding[iEncoding].uFlags;
+
+		EditSaveStream stream;
+		ZeroMemory(&stream, sizeof(stream));
+		stream.hFile = hFile;
+		stream.uFlags = uFlags;
+		if (uFlags & (NCP_UNICODE | NCP_8BIT | NCP_7BIT)) {
+			stream.lpWide = (LPWSTR)NP2HeapAlloc(EDIT_SAVE_CHUNK_SIZE * sizeof(WCHAR));
+		}
+
 		if (uFlags & NCP_UNICODE) {
 			SetEndOfFile(hFile);
 
-			LPWSTR lpDataWide = (LPWSTR)NP2HeapAlloc(cbData * sizeof(WCHAR) + 16);
-			const int cbDataWide = MultiByteToWideChar(CP_UTF8, 0, lpData, cbData, lpDataWide, (int)(NP2HeapSize(lpDataWide) / sizeof(WCHAR)));
-
 			if (uFlags & NCP_UNICODE_BOM) {
 				if (uFlags & NCP_UNICODE_REVERSE) {
 					WriteFile(hFile, (LPCVOID)"\xFE\xFF", 2, &dwBytesWritten, NULL);
@@ -1007,14 +2359,8 @@ BOOL EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, EditFileIOStatus *
 				}
 			}
 
-			if (uFlags & NCP_UNICODE_REVERSE) {
-				_swab((char *)lpDataWide, (char *)lpDataWide, (int)(cbDataWide * sizeof(WCHAR)));
-			}
-
-			bWriteSuccess = WriteFile(hFile, lpDataWide, cbDataWide * sizeof(WCHAR), &dwBytesWritten, NULL);
+			bWriteSuccess = EditSaveStream_WriteDocument(&stream);
 			dwLastIOError = GetLastError();
-
-			NP2HeapFree(lpDataWide);
 		} else if (uFlags & NCP_UTF8) {
 			SetEndOfFile(hFile);
 
@@ -1022,37 +2368,29 @@ BOOL EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, EditFileIOStatus *
 				WriteFile(hFile, (LPCVOID)"\xEF\xBB\xBF", 3, &dwBytesWritten, NULL);
 			}
 
-			bWriteSuccess = WriteFile(hFile, lpData, cbData, &dwBytesWritten, NULL);
+			bWriteSuccess = EditSaveStream_WriteDocument(&stream);
 			dwLastIOError = GetLastError();
 		} else if (uFlags & (NCP_8BIT | NCP_7BIT)) {
-			BOOL bCancelDataLoss = FALSE;
 			const UINT uCodePage = mEncoding[iEncoding].uCodePage;
-			const BOOL zeroFlags = IsZeroFlagsCodePage(uCodePage);
+			stream.uCodePage = uCodePage;
+			stream.lpMultiByte = (char *)NP2HeapAlloc(EDIT_SAVE_CHUNK_SIZE * sizeof(WCHAR) * 2);
 
-			LPWSTR lpDataWide = (LPWSTR)NP2HeapAlloc(cbData * sizeof(WCHAR) + 16);
-			const int cbDataWide = MultiByteToWideChar(CP_UTF8, 0, lpData, cbData, lpDataWide, (int)(NP2HeapSize(lpDataWide) / sizeof(WCHAR)));
-
-			if (zeroFlags) {
-				NP2HeapFree(lpData);
-				lpData = (char *)NP2HeapAlloc(NP2HeapSize(lpDataWide) * 2);
-			} else {
-				ZeroMemory(lpData, NP2HeapSize(lpData));
-			}
-
-			if (zeroFlags) {
-				cbData = WideCharToMultiByte(uCodePage, 0, lpDataWide, cbDataWide, lpData, (int)NP2HeapSize(lpData), NULL, NULL);
-			} else {
-				cbData = WideCharToMultiByte(uCodePage, WC_NO_BEST_FIT_CHARS, lpDataWide, cbDataWide, lpData, (int)NP2HeapSize(lpData), NULL, &bCancelDataLoss);
+			BOOL bCancelDataLoss = FALSE;
+			if (!IsZeroFlagsCodePage(uCodePage)) {
+				// convert without writing to find unmappable characters before the file is truncated
+				stream.dwFlags = WC_NO_BEST_FIT_CHARS;
+				stream.bCheckOnly = TRUE;
+				EditSaveStream_WriteDocument(&stream);
+				bCancelDataLoss = stream.bDataLoss;
+				stream.bCheckOnly = FALSE;
 				if (!bCancelDataLoss) {
-					cbData = WideCharToMultiByte(uCodePage, 0, lpDataWide, cbDataWide, lpData, (int)NP2HeapSize(lpData), NULL, NULL);
-					bCancelDataLoss = FALSE;
+					stream.dwFlags = 0;
 				}
 			}
-			NP2HeapFree(lpDataWide);
 
 			if (!bCancelDataLoss || InfoBox(MBOKCANCEL, L"MsgConv3", IDS_ERR_UNICODE2) == IDOK) {
 				SetEndOfFile(hFile);
-				bWriteSuccess = WriteFile(hFile, lpData, cbData, &dwBytesWritten, NULL);
+				bWriteSuccess = EditSaveStream_WriteDocument(&stream);
 				dwLastIOError = GetLastError();
 			} else {
 				bWriteSuccess = FALSE;
@@ -1060,13 +2398,16 @@ BOOL EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, EditFileIOStatus *
 			}
 		} else {
 			SetEndOfFile(hFile);
-			bWriteSuccess = WriteFile(hFile, lpData, cbData, &dwBytesWritten, NULL);
+			bWriteSuccess = EditSaveStream_WriteDocument(&stream);
 			dwLastIOError = GetLastError();
 		}
-	}
 
-	if (lpData != NULL) {
-		NP2HeapFree(lpData);
+		if (stream.lpWide != NULL) {
+			NP2HeapFree(stream.lpWide);
+		}
+		if (stream.lpMultiByte != NULL) {
+			NP2HeapFree(stream.lpMultiByte);
+		}
 	}
 
 	CloseHandle(hFile);
@@ -5038,6 +6379,20 @@ BOOL EditFindNext(LPEDITFINDREPLACE lpefr, BOOL fExtendSelection) {
 		return FALSE;
 	}
 
+	if (EditPagedView_IsHexView()) {
+		// search bytes of the file instead of formatted text
+		const int result = EditPagedView_FindHex(szFind2, lpefr->fuFlags | (lpefr->bWildcardSearch ? SCFIND_REGEXP : 0), FALSE);
+		if (result <= 0) {
+			if (result < 0) {
+				InfoBox(0, L"MsgHexViewFind", IDS_HEX_VIEW_FIND);
+			} else {
+				InfoBox(0, L"MsgNotFound", IDS_NOTFOUND);
+			}
+			return FALSE;
+		}
+		return TRUE;
+	}
+
 	if (lpefr->bWildcardSearch) {
 		EscapeWildcards(szFind2, lpefr);
 	}
@@ -5054,7 +6409,11 @@ BOOL EditFindNext(LPEDITFINDREPLACE lpefr, BOOL fExtendSelection) {
 	Sci_Position iPos = SciCall_FindText(lpefr->fuFlags, &ttf);
 	BOOL bSuppressNotFound = FALSE;
 
-	if (iPos == -1 && ttf.chrg.cpMin > 0 && !lpefr->bNoFindWrap && !fExtendSelection) {
+	if (iPos == -1 && EditPagedView_IsActive()) {
+		// search following part of the file, selection can't be extended into another window
+		iPos = EditPagedView_FindText(lpefr->fuFlags, &ttf, FALSE);
+		fExtendSelection = FALSE;
+	} else if (iPos == -1 && ttf.chrg.cpMin > 0 && !lpefr->bNoFindWrap && !fExtendSelection) {
 		if (IDOK == InfoBox(MBOKCANCEL, L"MsgFindWrap1", IDS_FIND_WRAPFW)) {
 			ttf.chrg.cpMin = 0;
 			iPos = SciCall_FindText(lpefr->fuFlags, &ttf);
@@ -5101,6 +6460,20 @@ BOOL EditFindPrev(LPEDITFINDREPLACE lpefr, BOOL fExtendSelection) {
 		return FALSE;
 	}
 
+	if (EditPagedView_IsHexView()) {
+		// search bytes of the file instead of formatted text
+		const int result = EditPagedView_FindHex(szFind2, lpefr->fuFlags | (lpefr->bWildcardSearch ? SCFIND_REGEXP : 0), TRUE);
+		if (result <= 0) {
+			if (result < 0) {
+				InfoBox(0, L"MsgHexViewFind", IDS_HEX_VIEW_FIND);
+			} else {
+				InfoBox(0, L"MsgNotFound", IDS_NOTFOUND);
+			}
+			return FALSE;
+		}
+		return TRUE;
+	}
+
 	if (lpefr->bWildcardSearch) {
 		EscapeWildcards(szFind2, lpefr);
 	}
@@ -5118,7 +6491,11 @@ BOOL EditFindPrev(LPEDITFINDREPLACE lpefr, BOOL fExtendSelection) {
 	const Sci_Position iLength = SciCall_GetLength();
 	BOOL bSuppressNotFound = FALSE;
 
-	if (iPos == -1 && ttf.chrg.cpMin < iLength && !lpefr->bNoFindWrap && !fExtendSelection) {
+	if (iPos == -1 && EditPagedView_IsActive()) {
+		// search previous part of the file, selection can't be extended into another window
+		iPos = EditPagedView_FindText(lpefr->fuFlags, &ttf, TRUE);
+		fExtendSelection = FALSE;
+	} else if (iPos == -1 && ttf.chrg.cpMin < iLength && !lpefr->bNoFindWrap && !fExtendSelection) {
 		if (IDOK == InfoBox(MBOKCANCEL, L"MsgFindWrap2", IDS_FIND_WRAPRE)) {
 			ttf.chrg.cpMin = (Sci_PositionCR)iLength;
 			iPos = SciCall_FindText(lpefr->fuFlags, &ttf);
@@ -5621,9 +6998,15 @@ static INT_PTR CALLBACK EditLineNumDlgProc(HWND hwnd, UINT umsg, WPARAM wParam,
 
 	switch (umsg) {
 	case WM_INITDIALOG: {
-		const Sci_Line iCurLine = SciCall_LineFromPosition(SciCall_GetCurrentPos()) + 1;
-		const Sci_Line iMaxLine = SciCall_GetLineCount();
+		Sci_Line iCurLine = SciCall_LineFromPosition(SciCall_GetCurrentPos()) + 1;
+		Sci_Line iMaxLine = SciCall_GetLineCount();
 		const Sci_Position iLength = SciCall_GetLength();
+		if (EditPagedView_IsActive()) {
+			// line number in whole file
+			BOOL bComplete;
+			iCurLine += max_pos(EditPagedView_GetFirstLine(), 0);
+			iMaxLine = max_pos(EditPagedView_GetLineCount(&bComplete), iCurLine);
+		}
 
 		SendDlgItemMessage(hwnd, IDC_LINENUM, EM_LIMITTEXT, 20, 0);
 		SendDlgItemMessage(hwnd, IDC_COLNUM, EM_LIMITTEXT, 20, 0);
@@ -5692,8 +7075,15 @@ static INT_PTR CALLBACK EditLineNumDlgProc(HWND hwnd, UINT umsg, WPARAM wParam,
 
 			const Sci_Line iMaxLine = SciCall_GetLineCount();
 			const Sci_Position iLength = SciCall_GetLength();
-			// directly goto specific position
-			if (fTranslated2 && !fTranslated) {
+			if (EditPagedView_IsActive() && fTranslated) {
+				// line may not be indexed yet
+				if (iNewLine > 0 && iNewCol > 0 && EditPagedView_JumpTo(iNewLine, iNewCol)) {
+					EndDialog(hwnd, IDOK);
+				} else {
+					PostMessage(hwnd, WM_NEXTDLGCTL, (WPARAM)(GetDlgItem(hwnd, ((iNewCol > 0) ? IDC_LINENUM : IDC_COLNUM))), 1);
+				}
+			} else if (fTranslated2 && !fTranslated) {
+				// directly goto specific position
 				if (iNewCol > 0 && iNewCol <= iLength) {
 					SciCall_GotoPos(iNewCol - 1);
 					SciCall_ChooseCaretX();
@@ -6777,14 +8167,14 @@ void EditOpenSelection(int type) {
 extern BOOL bNoEncodingTags;
 extern int fNoFileVariables;
 
-BOOL FileVars_Init(LPCSTR lpData, DWORD cbData, LPFILEVARS lpfv) {
+BOOL FileVars_Init(LPCSTR lpData, SIZE_T cbData, LPFILEVARS lpfv) {
 	ZeroMemory(lpfv, sizeof(FILEVARS));
 	if ((fNoFileVariables && bNoEncodingTags) || !lpData || !cbData) {
 		return TRUE;
 	}
 
 	char tch[512];
-	strncpy(tch, lpData, min_u(cbData, sizeof(tch)));
+	strncpy(tch, lpData, (cbData < sizeof(tch)) ? cbData : sizeof(tch));
 	tch[sizeof(tch) - 1] = '\0';
 	const BOOL utf8Sig = IsUTF8Signature(lpData);
 	BOOL bDisableFileVariables = FALSE;
@@ -7263,12 +8653,14 @@ void FoldToggleAll(FOLD_ACTION action) {
 	SciCall_ColouriseAll();
 	const Sci_Line lineCount = SciCall_GetLineCount();
 
+	SciCall_BeginFoldBatch();
 	for (Sci_Line line = 0; line < lineCount; ++line) {
 		const int level = SciCall_GetFoldLevel(line);
 		if (level & SC_FOLDLEVELHEADERFLAG) {
 			FoldToggleNode(line, &action, &fToggled);
 		}
 	}
+	SciCall_EndFoldBatch();
 
 	if (fToggled) {
 		SciCall_SetXCaretPolicy(CARET_SLOP | CARET_STRICT | CARET_EVEN, 50);
@@ -7285,6 +8677,7 @@ void FoldToggleLevel(int lev, FOLD_ACTION action) {
 	const Sci_Line lineCount = SciCall_GetLineCount();
 	Sci_Line line = 0;
 
+	SciCall_BeginFoldBatch();
 	if (IsFoldIndentationBased(pLexCurrent->iLexer)) {
 		struct EditFoldStack foldStack = { 0, { 0 }};
 		++lev;
@@ -7314,6 +8707,7 @@ void FoldToggleLevel(int lev, FOLD_ACTION action) {
 			++line;
 		}
 	}
+	SciCall_EndFoldBatch();
 
 	if (fToggled) {
 		SciCall_SetXCaretPolicy(CARET_SLOP | CARET_STRICT | CARET_EVEN, 50);
@@ -7384,6 +8778,7 @@ void FoldToggleDefault(FOLD_ACTION action) {
 	const Sci_Line lineCount = SciCall_GetLineCount();
 	Sci_Line line = 0;
 
+	SciCall_BeginFoldBatch();
 	if (IsFoldIndentationBased(pLexCurrent->iLexer)) {
 		struct EditFoldStack foldStack = { 0, { 0 }};
 		while (line < lineCount) {
@@ -7417,6 +8812,7 @@ void FoldToggleDefault(FOLD_ACTION action) {
 			++line;
 		}
 	}
+	SciCall_EndFoldBatch();
 
 	if (fToggled) {
 		SciCall_SetXCaretPolicy(CARET_SLOP | CARET_STRICT | CARET_EVEN, 50);
@@ -7443,18 +8839,20 @@ static void FoldPerformAction(Sci_Line ln, int mode, FOLD_ACTION action) {
 			--lvStop;
 		}
 
+		SciCall_BeginFoldBatch();
 		for (; ln < lnTotal; ++ln) {
 			int lv = SciCall_GetFoldLevel(ln);
 			const BOOL fHeader = (lv & SC_FOLDLEVELHEADERFLAG) != 0;
 			lv &= SC_FOLDLEVELNUMBERMASK;
 
 			if (lv < lvStop || (lv == lvStop && fHeader && ln != lnNode)) {
-				return;
+				break;
 			}
 			if (fHeader && (lv == lvNode || (lv > lvNode && (mode & FOLD_CHILDREN)))) {
 				FoldToggleNode(ln, &action, &fToggled);
 			}
 		}
+		SciCall_EndFoldBatch();
 	} else {
 		FoldToggleNode(ln, &action, &fToggled);
 	}
@@ -97,7 +97,7 @@ enum {
 
 void	Edit_ReleaseResources(void);
 HWND	EditCreate(HWND hwndParent);
-void	EditSetNewText(LPCSTR lpstrText, DWORD cbText, Sci_Line lineCount);
+void	EditSetNewText(LPCSTR lpstrText, SIZE_T cbText, Sci_Line lineCount);
 
 static inline void EditSetEmptyText(void) {
 	EditSetNewText("", 0, 1);
@@ -112,10 +112,23 @@ BOOL	EditCopyAppend(HWND hwnd);
 
 extern const int iLineEndings[3];
 struct EditFileIOStatus;
-void 	EditDetectEOLMode(LPCSTR lpData, DWORD cbData, struct EditFileIOStatus *status);
+void 	EditDetectEOLMode(LPCSTR lpData, SIZE_T cbData, struct EditFileIOStatus *status);
+BOOL	EditLoadFileTail(LPCWSTR pszFile, int iEncoding);
 BOOL	EditLoadFile(LPWSTR pszFile, BOOL bSkipEncodingDetection, struct EditFileIOStatus *status);
 BOOL	EditSaveFile(HWND hwnd, LPCWSTR pszFile, BOOL bSaveCopy, struct EditFileIOStatus *status);
 
+// read-only paged view for file larger than maximum loadable size, or binary file in hex view
+void	EditPagedView_Close(void);
+BOOL	EditPagedView_IsActive(void);
+Sci_Line EditPagedView_GetFirstLine(void);
+Sci_Line EditPagedView_GetLineCount(BOOL *pbComplete);
+void	EditPagedView_OnUpdateUI(HWND hwnd);
+void	EditPagedView_Scroll(void);
+BOOL	EditPagedView_JumpTo(Sci_Line iNewLine, Sci_Position iNewCol);
+Sci_Position EditPagedView_FindText(int searchFlags, struct Sci_TextToFind *ttf, BOOL bBackward);
+BOOL	EditPagedView_IsHexView(void);
+int		EditPagedView_FindHex(LPCSTR szFind, int searchFlags, BOOL bBackward);
+
 void	EditInvertCase(void);
 void	EditTitleCase(void);
 void	EditSentenceCase(void);
@@ -352,8 +365,19 @@ void	Encoding_AddToComboboxEx(HWND hwnd, int idSel, BOOL bRecodeOnly);
 BOOL	Encoding_GetFromComboboxEx(HWND hwnd, int *pidEncoding);
 #endif
 
+#define MAX_ENCODING_CANDIDATES		16
+
+typedef struct EncodingCandidate {
+	int iEncoding;
+	int iConfidence;	// 0 to 100
+} EncodingCandidate;
+
+// ranked candidates, sorted by descending confidence, on a tie iDefaultEncoding comes first
+int 	Encoding_Detect(const char *lpData, SIZE_T cbData, int iDefaultEncoding, EncodingCandidate *candidates, int maxCount);
+// legacy code page for text that isn't Unicode, returns iEncoding when detection isn't confident.
+int 	Encoding_DetectLegacy(const char *lpData, SIZE_T cbData, int iEncoding);
 BOOL	IsUnicode(const char *pBuffer, DWORD cb, LPBOOL lpbBOM, LPBOOL lpbReverse);
-BOOL	IsUTF8(const char *pTest, DWORD nLength);
+BOOL	IsUTF8(const char *pTest, SIZE_T nLength);
 BOOL	IsUTF7(const char *pTest, DWORD nLength);
 //INT		UTF8_mbslen(LPCSTR source, INT byte_length);
 //INT		UTF8_mbslen_bytes(LPCSTR utf8_string);
@@ -388,7 +412,7 @@ typedef struct _filevars {
 
 typedef const FILEVARS * LPCFILEVARS;
 
-BOOL	FileVars_Init(LPCSTR lpData, DWORD cbData, LPFILEVARS lpfv);
+BOOL	FileVars_Init(LPCSTR lpData, SIZE_T cbData, LPFILEVARS lpfv);
 BOOL	FileVars_Apply(LPCFILEVARS lpfv);
 BOOL	FileVars_ParseInt(LPCSTR pszData, LPCSTR pszName, int *piValue);
 BOOL	FileVars_ParseStr(LPCSTR pszData, LPCSTR pszName, char *pszValue, int cchValue);
@@ -0,0 +1,122 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+
+#include <stdint.h>
+#include "EditChunk.h"
+
+size_t UTF8_AlignedLength(const char *lpData, size_t cbData) {
+	size_t pos = cbData;
+	while (pos != 0 && cbData - pos < 3 && ((uint8_t)lpData[pos - 1] & 0xC0) == 0x80) {
+		--pos;
+	}
+	if (pos > 1) {
+		const uint8_t lead = (uint8_t)lpData[pos - 1];
+		const size_t width = (lead >= 0xF0) ? 4 : ((lead >= 0xE0) ? 3 : ((lead >= 0xC0) ? 2 : 1));
+		if (width > cbData - pos + 1) {
+			return pos - 1;
+		}
+	}
+	return cbData;
+}
+
+size_t UTF8_LineAlignedLength(const char *lpData, size_t cbData) {
+	for (size_t pos = cbData; pos != 0; pos--) {
+		if (lpData[pos - 1] == '\n') {
+			return pos;
+		}
+	}
+	return UTF8_AlignedLength(lpData, cbData);
+}
+
+int EditConvert_IsDBCSLeadByte(unsigned codePage, unsigned char ch) {
+	// lead byte ranges from DBCSCharClassify in scintilla/src/CharClassify.cxx
+	switch (codePage) {
+	case 932:
+		return (ch >= 0x81 && ch <= 0x9F) || (ch >= 0xE0 && ch <= 0xFC);
+	case 936:
+	case 949:
+	case 950:
+	case 54936:
+		return ch >= 0x81 && ch <= 0xFE;
+	case 1361:
+		return (ch >= 0x84 && ch <= 0xD3) || (ch >= 0xD8 && ch <= 0xDE) || (ch >= 0xE0 && ch <= 0xF9);
+	default:
+		return 0;
+	}
+}
+
+size_t EditConvert_AlignedLength(unsigned codePage, const char *lpData, size_t cbData) {
+	if (codePage == 65001) {
+		return UTF8_AlignedLength(lpData, cbData);
+	}
+	if (codePage == 65000) {
+		// UTF-7 is stateful, a byte below '+' ends the base64 run and is encoded as itself.
+		for (size_t pos = cbData; pos != 0; pos--) {
+			if ((uint8_t)lpData[pos - 1] < '+') {
+				return pos;
+			}
+		}
+		return cbData;
+	}
+	if (!(codePage == 932 || codePage == 936 || codePage == 949 || codePage == 950 || codePage == 1361 || codePage == 54936)) {
+		return cbData;
+	}
+
+	// DBCS trail byte can be ASCII, split after a byte below 0x30 which is never a trail byte
+	// (GB18030 four byte characters use 0x30 to 0x39), only look at the end to keep the cost
+	// bounded for text without line breaks and spaces.
+	for (size_t pos = cbData; pos != 0 && cbData - pos < 256; pos--) {
+		if ((uint8_t)lpData[pos - 1] < 0x30) {
+			return pos;
+		}
+	}
+
+	// chunk starts at character boundary.
+	size_t pos = 0;
+	while (pos < cbData) {
+		size_t width = 1;
+		if (EditConvert_IsDBCSLeadByte(codePage, (uint8_t)lpData[pos])) {
+			width = 2;
+			if (codePage == 54936 && pos + 1 < cbData && lpData[pos + 1] >= '0' && lpData[pos + 1] <= '9') {
+				width = 4;
+			}
+		}
+		if (pos + width > cbData) {
+			break;
+		}
+		pos += width;
+	}
+	return pos;
+}
+
+int EditChunk_SplitUTF8(size_t length, size_t chunkSize, int bLineBreak, EditChunkReader reader, EditChunkWriter writer, void *context) {
+	size_t position = 0;
+	while (position < length) {
+		size_t cbData = (length - position < chunkSize) ? (length - position) : chunkSize;
+		const char *lpData = reader(context, position, cbData);
+		if (position + cbData < length) {
+			cbData = bLineBreak ? UTF8_LineAlignedLength(lpData, cbData) : UTF8_AlignedLength(lpData, cbData);
+		}
+		if (!writer(context, lpData, cbData)) {
+			return 0;
+		}
+		position += cbData;
+	}
+	return 1;
+}
+
+int EditChunk_Split(unsigned codePage, size_t length, size_t chunkSize, EditChunkReader reader, EditChunkWriter writer, void *context) {
+	size_t position = 0;
+	while (position < length) {
+		size_t cbData = (length - position < chunkSize) ? (length - position) : chunkSize;
+		const char *lpData = reader(context, position, cbData);
+		if (position + cbData < length) {
+			cbData = EditConvert_AlignedLength(codePage, lpData, cbData);
+		}
+		if (!writer(context, lpData, cbData)) {
+			return 0;
+		}
+		position += cbData;
+	}
+	return 1;
+}
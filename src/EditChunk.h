@@ -0,0 +1,44 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//
+// Splitting text into chunks at character boundaries, so each chunk can be converted
+// on its own. Only standard C is used, the functions are tested on other platforms.
+#pragma once
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// returns pointer to cbData bytes at position.
+typedef const char *(*EditChunkReader)(void *context, size_t position, size_t cbData);
+// returns zero to stop splitting.
+typedef int (*EditChunkWriter)(void *context, const char *lpData, size_t cbData);
+
+// length of UTF-8 text without the partial character at end.
+size_t UTF8_AlignedLength(const char *lpData, size_t cbData);
+// length of UTF-8 text up to and including the last line feed,
+// or without the partial character at end when there is no line feed.
+size_t UTF8_LineAlignedLength(const char *lpData, size_t cbData);
+
+// whether ch starts a multi-byte character in DBCS code page 932, 936, 949, 950, 1361 or 54936 (GB18030).
+int EditConvert_IsDBCSLeadByte(unsigned codePage, unsigned char ch);
+// length of text in codePage without the partial character at end, text starts at a character boundary.
+// Single byte code pages are returned whole, UTF-7 (65000) is split after a byte that ends base64 run.
+size_t EditConvert_AlignedLength(unsigned codePage, const char *lpData, size_t cbData);
+
+// split length bytes of UTF-8 text into chunks of at most chunkSize bytes, and pass them to writer in order.
+// chunkSize is at least 4 bytes, the longest UTF-8 character.
+// when bLineBreak is nonzero, chunks end after a line feed where possible: converters for stateful
+// encodings (UTF-7, ISO-2022, HZ) are back in initial state there, so nothing is inserted between chunks.
+// returns zero when writer returns zero.
+int EditChunk_SplitUTF8(size_t length, size_t chunkSize, int bLineBreak, EditChunkReader reader, EditChunkWriter writer, void *context);
+// split length bytes of text in codePage into chunks of at most chunkSize bytes, each ends at
+// EditConvert_AlignedLength(), and pass them to writer in order.
+// chunkSize is at least 4 bytes, the longest GB18030 character. returns zero when writer returns zero.
+int EditChunk_Split(unsigned codePage, size_t length, size_t chunkSize, EditChunkReader reader, EditChunkWriter writer, void *context);
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,544 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+
+#include <stdint.h>
+#include "EditUTF8.h"
+#include "EditDetect.h"
+
+static inline int min_int(int x, int y) {
+	return (x < y) ? x : y;
+}
+
+static inline int max_int(int x, int y) {
+	return (x > y) ? x : y;
+}
+
+// Each candidate is scored by structural validity (invalid sequences are heavily
+// penalized) and by how often its characters fall in frequently used ranges.
+#define ENCODING_SAMPLE_WINDOW_SIZE		(64*1024)
+#define ENCODING_SAMPLE_WINDOW_COUNT	4
+// minimum number of non-ASCII characters for full confidence
+#define ENCODING_DETECT_MIN_EVIDENCE	32
+
+typedef struct EncodingSample {
+	int count;
+	const uint8_t *begin[ENCODING_SAMPLE_WINDOW_COUNT];
+	const uint8_t *end[ENCODING_SAMPLE_WINDOW_COUNT];
+} EncodingSample;
+
+// bResync: move window boundaries to a byte below 0x30, which is never part of
+// a multi-byte sequence in UTF-8 or any of the DBCS encodings (GB18030 uses 0x30-0x39).
+static void Encoding_GetSample(const uint8_t *data, size_t cbData, int bResync, EncodingSample *sample) {
+	const uint8_t * const dataEnd = data + cbData;
+	if (cbData <= ENCODING_SAMPLE_WINDOW_SIZE * ENCODING_SAMPLE_WINDOW_COUNT) {
+		sample->count = 1;
+		sample->begin[0] = data;
+		sample->end[0] = dataEnd - (bResync ? 0 : (cbData & 1));
+		return;
+	}
+
+	sample->count = ENCODING_SAMPLE_WINDOW_COUNT;
+	const size_t step = (cbData - ENCODING_SAMPLE_WINDOW_SIZE) / (ENCODING_SAMPLE_WINDOW_COUNT - 1);
+	for (int i = 0; i < ENCODING_SAMPLE_WINDOW_COUNT; i++) {
+		// keep window aligned to UTF-16 code unit
+		const uint8_t *begin = data + ((step * i) & ~(size_t)1);
+		const uint8_t *end = begin + ENCODING_SAMPLE_WINDOW_SIZE;
+		if (bResync) {
+			if (begin != data) {
+				const uint8_t *pt = begin;
+				while (pt < end && *pt >= 0x30) {
+					++pt;
+				}
+				if (pt < end) {
+					begin = pt + 1;
+				}
+			}
+			if (end != dataEnd) {
+				const uint8_t *pt = end;
+				while (pt > begin && pt[-1] >= 0x30) {
+					--pt;
+				}
+				if (pt > begin) {
+					end = pt;
+				}
+			}
+		}
+		sample->begin[i] = begin;
+		sample->end[i] = end;
+	}
+}
+
+static inline int Encoding_Confidence(unsigned chars, unsigned score, unsigned invalid) {
+	// score is weighted 0 to 2 per character, invalid sequence costs 4 characters.
+	if (chars == 0 || invalid * 32 > chars) {
+		return 0;
+	}
+	int confidence = (int)(score * 50) - (int)(invalid * 200);
+	if (confidence <= 0) {
+		return 0;
+	}
+	confidence /= (int)chars;
+	if (chars < ENCODING_DETECT_MIN_EVIDENCE) {
+		confidence = confidence * (int)chars / ENCODING_DETECT_MIN_EVIDENCE;
+	}
+	return confidence;
+}
+
+// code unit in frequently used blocks: Latin, Greek, Cyrillic, general punctuation,
+// CJK symbols, Kana, CJK ideographs, Hangul syllables and fullwidth forms.
+static inline int IsCommonUTF16(unsigned ch) {
+	return ch < 0x0250
+		|| (ch >= 0x0370 && ch < 0x0530)
+		|| (ch >= 0x2000 && ch < 0x2070)
+		|| (ch >= 0x3000 && ch < 0x3100)
+		|| (ch >= 0x4E00 && ch < 0xA000)
+		|| (ch >= 0xAC00 && ch < 0xD7A4)
+		|| (ch >= 0xFF00 && ch < 0xFFF0);
+}
+
+// score UTF-16 without BOM: Latin text has NUL in high byte of most code units,
+// other scripts have nearly all code units in a few common blocks.
+static int Encoding_DetectUTF16(const EncodingSample *sample, int bReverse) {
+	unsigned units = 0;
+	unsigned zero = 0;
+	// NUL in low byte outside common blocks, frequent in binary data and in UTF-16 read with
+	// wrong byte order, while CJK text has it in common characters (e.g. U+4E00, U+AC00, U+B300).
+	unsigned lowZero = 0;
+	unsigned bad = 0;
+	unsigned common = 0;
+	// both bytes are printable ASCII, usual when 8-bit text is read as UTF-16
+	unsigned asciiPair = 0;
+
+	const unsigned high = bReverse ? 0 : 1;
+	for (int i = 0; i < sample->count; i++) {
+		int surrogate = 0;
+		for (const uint8_t *pt = sample->begin[i]; pt + 1 < sample->end[i]; pt += 2) {
+			const uint8_t hi = pt[high];
+			const uint8_t lo = pt[high ^ 1];
+			const int isCommon = IsCommonUTF16((hi << 8) | lo);
+			++units;
+			common += isCommon;
+			asciiPair += (hi >= 0x20 && hi < 0x7F) && (lo >= 0x20 && lo < 0x7F);
+			zero += hi == 0;
+			lowZero += lo == 0 && !isCommon;
+			if (hi == 0) {
+				// C0 control characters other than whitespace are rare in text
+				if (lo < 0x20 && !(lo >= '\t' && lo <= '\r')) {
+					++bad;
+				}
+			}
+			if (hi >= 0xD8 && hi <= 0xDF) {
+				if (hi < 0xDC) {
+					bad += surrogate;
+					surrogate = 1;
+				} else if (surrogate) {
+					surrogate = 0;
+				} else if (pt != sample->begin[i]) {
+					++bad;
+				}
+			} else {
+				bad += surrogate;
+				surrogate = 0;
+			}
+		}
+	}
+
+	if (units == 0 || bad * 64 > units || lowZero * 32 > units) {
+		return 0;
+	}
+	int confidence = 0;
+	if (zero * 8 >= units) {
+		confidence = min_int(100, 50 + (int)(zero * 100 / units));
+	}
+	// DBCS text also looks like CJK code units, so require at least a NUL in high byte
+	// as evidence, e.g. from line break or space.
+	if (zero != 0 && common * 20 >= units * 19 && asciiPair * 2 < units) {
+		confidence = max_int(confidence, 80);
+	}
+	if (bad != 0) {
+		confidence -= (int)(bad * 64 * 50 / units);
+	}
+	return max_int(confidence, 0);
+}
+
+static int Encoding_DetectUTF8(const EncodingSample *sample) {
+	int multibyte = 0;
+	for (int i = 0; i < sample->count; i++) {
+		const uint8_t * const begin = sample->begin[i];
+		const size_t length = (size_t)(sample->end[i] - begin);
+		if (UTF8_FindInvalid((const char *)begin, length) != length) {
+			return 0;
+		}
+		if (!multibyte) {
+			for (size_t j = 0; j < length; j++) {
+				if (begin[j] & 0x80) {
+					multibyte = 1;
+					break;
+				}
+			}
+		}
+	}
+	// pure ASCII is valid in every candidate
+	return multibyte ? 100 : 50;
+}
+
+// GB18030, also reports whether GBK (936) is enough to decode the text.
+static int Encoding_DetectGB18030(const EncodingSample *sample, unsigned *pCodePage) {
+	unsigned chars = 0;
+	unsigned score = 0;
+	unsigned invalid = 0;
+	unsigned fourByte = 0;
+	unsigned beyondHangul = 0;
+	for (int i = 0; i < sample->count; i++) {
+		const uint8_t *pt = sample->begin[i];
+		const uint8_t * const end = sample->end[i];
+		while (pt < end) {
+			const uint8_t ch = *pt++;
+			if (ch < 0x80) {
+				continue;
+			}
+			if (pt == end) {
+				break;
+			}
+			++chars;
+			const uint8_t trail = *pt;
+			if (ch == 0x80 || ch == 0xFF) {
+				++invalid;
+			} else if (trail >= 0x40 && trail <= 0xFE && trail != 0x7F) {
+				++pt;
+				if (trail >= 0xA1 && ((ch >= 0xA1 && ch <= 0xA3) || (ch >= 0xB0 && ch <= 0xD7))) {
+					score += 2;
+				} else {
+					score += 1;
+				}
+				// EUC-KR Hangul uses lead byte 0xB0 to 0xC8
+				beyondHangul += trail >= 0xA1 && ch >= 0xC9 && ch <= 0xF7;
+			} else if (trail >= 0x30 && trail <= 0x39 && end - pt >= 3
+				&& pt[1] >= 0x81 && pt[1] <= 0xFE && pt[2] >= 0x30 && pt[2] <= 0x39) {
+				pt += 3;
+				++fourByte;
+				score += 1;
+			} else {
+				++invalid;
+			}
+		}
+	}
+
+	int confidence = Encoding_Confidence(chars, score, invalid);
+	if (chars >= ENCODING_DETECT_MIN_EVIDENCE && beyondHangul * 16 < chars) {
+		confidence /= 2;
+	}
+	*pCodePage = fourByte ? 54936 : 936;
+	return confidence;
+}
+
+static int Encoding_DetectShiftJIS(const EncodingSample *sample) {
+	unsigned chars = 0;
+	unsigned score = 0;
+	unsigned invalid = 0;
+	for (int i = 0; i < sample->count; i++) {
+		const uint8_t *pt = sample->begin[i];
+		const uint8_t * const end = sample->end[i];
+		while (pt < end) {
+			const uint8_t ch = *pt++;
+			if (ch < 0x80) {
+				continue;
+			}
+			++chars;
+			if (ch >= 0xA1 && ch <= 0xDF) {
+				// half-width Katakana
+				score += 1;
+			} else if ((ch >= 0x81 && ch <= 0x9F) || (ch >= 0xE0 && ch <= 0xFC)) {
+				if (pt == end) {
+					--chars;
+					break;
+				}
+				const uint8_t trail = *pt;
+				if (trail >= 0x40 && trail <= 0xFC && trail != 0x7F) {
+					++pt;
+					// symbols, Hiragana, Katakana and level 1 Kanji
+					score += (ch <= 0x98) ? 2 : 1;
+				} else {
+					++invalid;
+				}
+			} else {
+				++invalid;
+			}
+		}
+	}
+	return Encoding_Confidence(chars, score, invalid);
+}
+
+// Unified Hangul Code, reports EUC-KR when no extended character is used.
+static int Encoding_DetectKorean(const EncodingSample *sample, unsigned *pCodePage) {
+	unsigned chars = 0;
+	unsigned score = 0;
+	unsigned invalid = 0;
+	unsigned extended = 0;
+	for (int i = 0; i < sample->count; i++) {
+		const uint8_t *pt = sample->begin[i];
+		const uint8_t * const end = sample->end[i];
+		while (pt < end) {
+			const uint8_t ch = *pt++;
+			if (ch < 0x80) {
+				continue;
+			}
+			if (pt == end) {
+				break;
+			}
+			++chars;
+			const uint8_t trail = *pt;
+			if (ch != 0x80 && ch != 0xFF && ((trail >= 0x81 && trail <= 0xFE)
+				|| (trail >= 0x41 && trail <= 0x5A) || (trail >= 0x61 && trail <= 0x7A))) {
+				++pt;
+				if (ch < 0xA1 || trail < 0xA1) {
+					++extended;
+					score += 1;
+				} else {
+					// Hangul syllables
+					score += (ch >= 0xB0 && ch <= 0xC8) ? 2 : 1;
+				}
+			} else {
+				++invalid;
+			}
+		}
+	}
+	*pCodePage = extended ? 949 : 51949;
+	return Encoding_Confidence(chars, score, invalid);
+}
+
+static int Encoding_DetectBig5(const EncodingSample *sample) {
+	unsigned chars = 0;
+	unsigned score = 0;
+	unsigned invalid = 0;
+	unsigned lowTrail = 0;
+	for (int i = 0; i < sample->count; i++) {
+		const uint8_t *pt = sample->begin[i];
+		const uint8_t * const end = sample->end[i];
+		while (pt < end) {
+			const uint8_t ch = *pt++;
+			if (ch < 0x80) {
+				continue;
+			}
+			if (pt == end) {
+				break;
+			}
+			++chars;
+			const uint8_t trail = *pt;
+			if (ch != 0x80 && ch != 0xFF && ((trail >= 0x40 && trail <= 0x7E) || (trail >= 0xA1 && trail <= 0xFE))) {
+				++pt;
+				lowTrail += trail <= 0x7E;
+				// symbols and frequently used Hanzi
+				score += (ch >= 0xA1 && ch <= 0xC6) ? 2 : 1;
+			} else {
+				++invalid;
+			}
+		}
+	}
+
+	int confidence = Encoding_Confidence(chars, score, invalid);
+	// about half of Big5 characters use trail byte below 0x7F, which is unusual in GB2312 and EUC-KR.
+	if (chars >= ENCODING_DETECT_MIN_EVIDENCE && lowTrail * 16 < chars) {
+		confidence /= 2;
+	}
+	return confidence;
+}
+
+// character class for byte 0x80 to 0xFF:
+// U: upper case letter, L: lower case letter, S: symbol, X: undefined
+static const char * const kEncodingWindows1250 =
+	"SXSXSSSSXSUSUUUU" "XSSSSSSSXSLSLLLL" "SSSUSUSSSSUSSSSU" "SSSLSSSSSLLSUSLL"
+	"UUUUUUUUUUUUUUUU" "UUUUUUUSUUUUUUUL" "LLLLLLLLLLLLLLLL" "LLLLLLLSLLLLLLLS";
+static const char * const kEncodingWindows1251 =
+	"UUSLSSSSSSUSUUUU" "LSSSSSSSXSLSLLLL" "SULUSUSSUSUSSSSU" "SSULLSSSLSLSLULL"
+	"UUUUUUUUUUUUUUUU" "UUUUUUUUUUUUUUUU" "LLLLLLLLLLLLLLLL" "LLLLLLLLLLLLLLLL";
+static const char * const kEncodingWindows1252 =
+	"SXSLSSSSSSUSUXUX" "XSSSSSSSSSLSLXLU" "SSSSSSSSSSSSSSSS" "SSSSSSSSSSSSSSSS"
+	"UUUUUUUUUUUUUUUU" "UUUUUUUSUUUUUUUL" "LLLLLLLLLLLLLLLL" "LLLLLLLSLLLLLLLL";
+static const char * const kEncodingWindows1253 =
+	"SXSLSSSSXSXSXXXX" "XSSSSSSSXSXSXXXX" "SSUSSSSSSSXSSSSS" "SSSSSSSSUUUSUSUU"
+	"LUUUUUUUUUUUUUUU" "UUXUUUUUUUUULLLL" "LLLLLLLLLLLLLLLL" "LLLLLLLLLLLLLLLX";
+
+enum {
+	CharClass_Letter = 1,
+	CharClass_Lower = 2,
+	CharClass_High = 4,
+	CharClass_Invalid = 8,
+};
+
+static inline unsigned Encoding_CharClass(const char *table, uint8_t ch) {
+	if (ch < 0x80) {
+		if (ch >= 'a' && ch <= 'z') {
+			return CharClass_Letter | CharClass_Lower;
+		}
+		return (ch >= 'A' && ch <= 'Z') ? CharClass_Letter : 0;
+	}
+	switch (table[ch - 0x80]) {
+	case 'U':
+		return CharClass_High | CharClass_Letter;
+	case 'L':
+		return CharClass_High | CharClass_Letter | CharClass_Lower;
+	case 'S':
+		return CharClass_High;
+	default:
+		return CharClass_High | CharClass_Invalid;
+	}
+}
+
+// Windows-125x: accented letters in Latin script are mixed with ASCII letters,
+// while Cyrillic and Greek words consist of consecutive non-ASCII letters.
+static int Encoding_DetectWindows125x(const EncodingSample *sample, const char *table, int bLatin) {
+	unsigned chars = 0;
+	unsigned score = 0;
+	unsigned invalid = 0;
+	for (int i = 0; i < sample->count; i++) {
+		const uint8_t *pt = sample->begin[i];
+		const uint8_t * const end = sample->end[i];
+		unsigned prev = 0;
+		while (pt < end) {
+			const unsigned cls = Encoding_CharClass(table, *pt++);
+			if (cls & CharClass_Invalid) {
+				++invalid;
+			} else if (cls & CharClass_High) {
+				++chars;
+				if (!(cls & CharClass_Letter)) {
+					score += 1;
+				} else if (!((prev & CharClass_Lower) && !(cls & CharClass_Lower))) {
+					// upper case letter after lower case letter scores nothing
+					const unsigned next = (pt < end) ? Encoding_CharClass(table, *pt) : 0;
+					const unsigned mask = CharClass_Letter | CharClass_High;
+					const int asciiNeighbor = (prev & mask) == CharClass_Letter || (next & mask) == CharClass_Letter;
+					const unsigned highNeighbor = ((prev & mask) == mask) + ((next & mask) == mask);
+					if (bLatin) {
+						score += asciiNeighbor ? 2 : ((highNeighbor == 2) ? 0 : 1);
+					} else {
+						score += asciiNeighbor ? 0 : (highNeighbor ? 2 : 1);
+					}
+				}
+			}
+			prev = cls;
+		}
+	}
+	return Encoding_Confidence(chars, score, invalid);
+}
+
+// code pages scored by Encoding_Rank() other than Unicode.
+static int Encoding_IsScored(unsigned codePage) {
+	switch (codePage) {
+	case 932:
+	case 936:
+	case 949:
+	case 950:
+	case 1250:
+	case 1251:
+	case 1252:
+	case 1253:
+	case 51949:
+	case 54936:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static inline int Encoding_IsUnicode(unsigned codePage) {
+	return codePage == 1200 || codePage == 1201 || codePage == 65001;
+}
+
+int EncodingDetect_IsCompatible(unsigned detectedCodePage, unsigned codePage) {
+	return detectedCodePage == codePage
+		|| (detectedCodePage == 936 && codePage == 54936)
+		|| (detectedCodePage == 51949 && codePage == 949);
+}
+
+// insertion sort, on a tie the default code page wins, then the earlier score.
+static void Encoding_AddScore(EncodingScore *scores, int *count, int maxCount, unsigned defaultCodePage, unsigned codePage, int confidence) {
+	if (confidence <= 0) {
+		return;
+	}
+	const int preferred = EncodingDetect_IsCompatible(codePage, defaultCodePage);
+	int i = *count;
+	if (i == maxCount) {
+		if (scores[i - 1].confidence > confidence || (scores[i - 1].confidence == confidence && !preferred)) {
+			return;
+		}
+		--i;
+	} else {
+		*count = i + 1;
+	}
+	while (i > 0 && (scores[i - 1].confidence < confidence || (scores[i - 1].confidence == confidence && preferred))) {
+		scores[i] = scores[i - 1];
+		--i;
+	}
+	scores[i].codePage = codePage;
+	scores[i].confidence = confidence;
+}
+
+int EncodingDetect_UTF16(const char *lpData, size_t cbData, int bBigEndian) {
+	EncodingSample sample;
+	Encoding_GetSample((const uint8_t *)lpData, cbData, 0, &sample);
+	return Encoding_DetectUTF16(&sample, bBigEndian);
+}
+
+int EncodingDetect_Rank(const char *lpData, size_t cbData, unsigned defaultCodePage, EncodingScore *scores, int maxCount) {
+	if (lpData == NULL || cbData == 0 || maxCount <= 0) {
+		return 0;
+	}
+
+	const uint8_t * const data = (const uint8_t *)lpData;
+	int count = 0;
+	EncodingSample sample;
+	unsigned page;
+
+	if (cbData >= 2 && (cbData & 1) == 0) {
+		Encoding_GetSample(data, cbData, 0, &sample);
+		Encoding_AddScore(scores, &count, maxCount, defaultCodePage, 1200, Encoding_DetectUTF16(&sample, 0));
+		Encoding_AddScore(scores, &count, maxCount, defaultCodePage, 1201, Encoding_DetectUTF16(&sample, 1));
+	}
+
+	Encoding_GetSample(data, cbData, 1, &sample);
+	Encoding_AddScore(scores, &count, maxCount, defaultCodePage, 65001, Encoding_DetectUTF8(&sample));
+
+	Encoding_AddScore(scores, &count, maxCount, defaultCodePage, 1252, Encoding_DetectWindows125x(&sample, kEncodingWindows1252, 1));
+	Encoding_AddScore(scores, &count, maxCount, defaultCodePage, 1250, Encoding_DetectWindows125x(&sample, kEncodingWindows1250, 1));
+	Encoding_AddScore(scores, &count, maxCount, defaultCodePage, 1251, Encoding_DetectWindows125x(&sample, kEncodingWindows1251, 0));
+	Encoding_AddScore(scores, &count, maxCount, defaultCodePage, 1253, Encoding_DetectWindows125x(&sample, kEncodingWindows1253, 0));
+
+	int confidence = Encoding_DetectGB18030(&sample, &page);
+	Encoding_AddScore(scores, &count, maxCount, defaultCodePage, page, confidence);
+	Encoding_AddScore(scores, &count, maxCount, defaultCodePage, 950, Encoding_DetectBig5(&sample));
+	Encoding_AddScore(scores, &count, maxCount, defaultCodePage, 932, Encoding_DetectShiftJIS(&sample));
+	confidence = Encoding_DetectKorean(&sample, &page);
+	Encoding_AddScore(scores, &count, maxCount, defaultCodePage, page, confidence);
+	return count;
+}
+
+unsigned EncodingDetect_Legacy(const char *lpData, size_t cbData, unsigned defaultCodePage) {
+	// a low score only means something for code pages the detector knows,
+	// e.g. Windows-1254 text also scores well as Windows-1252.
+	if (!Encoding_IsScored(defaultCodePage)) {
+		return defaultCodePage;
+	}
+
+	EncodingScore scores[MAX_ENCODING_SCORES];
+	const int count = EncodingDetect_Rank(lpData, cbData, defaultCodePage, scores, MAX_ENCODING_SCORES);
+	int best = -1;
+	for (int i = 0; i < count; i++) {
+		if (Encoding_IsUnicode(scores[i].codePage)) {
+			continue;
+		}
+		if (best < 0) {
+			if (scores[i].confidence < ENCODING_DETECT_THRESHOLD) {
+				break;
+			}
+			best = i;
+		} else if (scores[i].confidence + ENCODING_DETECT_MARGIN < scores[best].confidence) {
+			break;
+		}
+		// keep default code page when it's nearly as likely as the best one.
+		if (EncodingDetect_IsCompatible(scores[i].codePage, defaultCodePage)) {
+			return defaultCodePage;
+		}
+	}
+	return (best < 0) ? defaultCodePage : scores[best].codePage;
+}
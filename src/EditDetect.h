@@ -0,0 +1,37 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//
+// Statistical detection of UTF-16 without BOM, UTF-8 and legacy code pages. Only a few fixed
+// size windows of the text are inspected, so the cost is bounded regardless of file size.
+// Only standard C is used, the functions are tested on other platforms.
+#pragma once
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define ENCODING_DETECT_THRESHOLD	60
+#define ENCODING_DETECT_MARGIN		10
+#define MAX_ENCODING_SCORES			16
+
+typedef struct EncodingScore {
+	unsigned codePage;	// 1200 and 1201 for UTF-16LE and UTF-16BE, 65001 for UTF-8
+	int confidence;		// 1 to 100
+} EncodingScore;
+
+// ranked code pages with non-zero confidence, sorted by descending confidence. On a tie
+// defaultCodePage (or the code page compatible with it) comes first. Returns number of scores.
+int EncodingDetect_Rank(const char *lpData, size_t cbData, unsigned defaultCodePage, EncodingScore *scores, int maxCount);
+// confidence the text is UTF-16 without BOM in little or big endian.
+int EncodingDetect_UTF16(const char *lpData, size_t cbData, int bBigEndian);
+// legacy code page for text that isn't Unicode. Returns defaultCodePage when it can't be
+// scored, or when it's nearly as likely as the best candidate.
+unsigned EncodingDetect_Legacy(const char *lpData, size_t cbData, unsigned defaultCodePage);
+// whether text detected as detectedCodePage can be decoded with codePage.
+int EncodingDetect_IsCompatible(unsigned detectedCodePage, unsigned codePage);
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,228 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+
+#include <stdlib.h>
+#include <string.h>
+#include "EditDiff.h"
+
+static inline uint32_t min_u32(uint32_t x, uint32_t y) {
+	return (x < y) ? x : y;
+}
+
+typedef struct EditDiffLine {
+	uint32_t offset;
+	uint32_t length;
+	uint32_t hash;
+} EditDiffLine;
+
+static inline int EditDiff_IsLineBoundary(const char *lpData, uint32_t pos, uint32_t cbData) {
+	// not between CR and LF
+	return pos == 0 || lpData[pos - 1] == '\n' || (lpData[pos - 1] == '\r' && (pos == cbData || lpData[pos] != '\n'));
+}
+
+// split text into lines including line endings, return line count when it's at most maxLines.
+static uint32_t EditDiff_SplitLines(const char *lpData, uint32_t cbData, EditDiffLine *lines, uint32_t maxLines) {
+	uint32_t count = 0;
+	uint32_t start = 0;
+	uint32_t hash = 2166136261U;
+	for (uint32_t pos = 0; pos < cbData; pos++) {
+		const uint8_t ch = (uint8_t)lpData[pos];
+		hash = (hash ^ ch) * 16777619U;
+		if (ch == '\n' || (ch == '\r' && (pos + 1 == cbData || lpData[pos + 1] != '\n'))) {
+			if (count == maxLines) {
+				return maxLines + 1;
+			}
+			if (lines != NULL) {
+				lines[count].offset = start;
+				lines[count].length = pos + 1 - start;
+				lines[count].hash = hash;
+			}
+			++count;
+			start = pos + 1;
+			hash = 2166136261U;
+		}
+	}
+	if (start < cbData) {
+		if (count == maxLines) {
+			return maxLines + 1;
+		}
+		if (lines != NULL) {
+			lines[count].offset = start;
+			lines[count].length = cbData - start;
+			lines[count].hash = hash;
+		}
+		++count;
+	}
+	return count;
+}
+
+static inline int EditDiff_LineEqual(const char *oldText, const EditDiffLine *oldLine, const char *newText, const EditDiffLine *newLine) {
+	return oldLine->hash == newLine->hash && oldLine->length == newLine->length
+		&& memcmp(oldText + oldLine->offset, newText + newLine->offset, oldLine->length) == 0;
+}
+
+// Myers' O(ND) diff, mark lines in longest common subsequence.
+// return 0 when there are more than EDIT_DIFF_MAX_EDITS inserted and deleted lines.
+static int EditDiff_Compare(const char *oldText, const EditDiffLine *oldLines, uint32_t n,
+	const char *newText, const EditDiffLine *newLines, uint32_t m, uint8_t *oldKeep, uint8_t *newKeep) {
+	const int maxEdits = (int)min_u32(n + m, EDIT_DIFF_MAX_EDITS);
+	// V for each d stored at d*d, indexed by k + d.
+	int *trace = (int *)malloc(sizeof(int) * (maxEdits + 1) * (maxEdits + 1));
+	if (trace == NULL) {
+		return 0;
+	}
+	int edits = -1;
+	for (int d = 0; d <= maxEdits && edits < 0; d++) {
+		int * const V = trace + d * d + d;
+		const int * const prev = trace + (d - 1) * (d - 1) + (d - 1);
+		for (int k = -d; k <= d; k += 2) {
+			int x;
+			if (d == 0) {
+				x = 0;
+			} else if (k == -d || (k != d && prev[k - 1] < prev[k + 1])) {
+				x = prev[k + 1];
+			} else {
+				x = prev[k - 1] + 1;
+			}
+			int y = x - k;
+			while (x < (int)n && y < (int)m && EditDiff_LineEqual(oldText, &oldLines[x], newText, &newLines[y])) {
+				++x;
+				++y;
+			}
+			V[k] = x;
+			if (x >= (int)n && y >= (int)m) {
+				edits = d;
+				break;
+			}
+		}
+	}
+
+	if (edits >= 0) {
+		int x = (int)n;
+		int y = (int)m;
+		for (int d = edits; d > 0; d--) {
+			const int * const prev = trace + (d - 1) * (d - 1) + (d - 1);
+			const int k = x - y;
+			const int prevK = (k == -d || (k != d && prev[k - 1] < prev[k + 1])) ? k + 1 : k - 1;
+			const int prevX = prev[prevK];
+			const int prevY = prevX - prevK;
+			// snake after the edit
+			while (x > prevX + (prevK == k - 1) && y > prevY + (prevK == k + 1)) {
+				--x;
+				--y;
+				oldKeep[x] = newKeep[y] = 1;
+			}
+			x = prevX;
+			y = prevY;
+		}
+		while (x > 0 && y > 0) {
+			--x;
+			--y;
+			oldKeep[x] = newKeep[y] = 1;
+		}
+	}
+
+	free(trace);
+	return edits >= 0;
+}
+
+int EditDiff_GetHunks(const char *oldText, uint32_t cbOld, const char *newText, uint32_t cbNew, EditDiffHunk **pHunks) {
+	*pHunks = NULL;
+	// common prefix and suffix
+	const uint32_t cbMin = min_u32(cbOld, cbNew);
+	uint32_t prefix = 0;
+	while (prefix < cbMin && oldText[prefix] == newText[prefix]) {
+		++prefix;
+	}
+	if (prefix == cbOld && prefix == cbNew) {
+		return 0;
+	}
+	while (prefix != 0 && !(EditDiff_IsLineBoundary(oldText, prefix, cbOld) && EditDiff_IsLineBoundary(newText, prefix, cbNew))) {
+		--prefix;
+	}
+	uint32_t suffix = 0;
+	while (suffix < cbMin - prefix && oldText[cbOld - suffix - 1] == newText[cbNew - suffix - 1]) {
+		++suffix;
+	}
+	while (suffix != 0 && !(EditDiff_IsLineBoundary(oldText, cbOld - suffix, cbOld) && EditDiff_IsLineBoundary(newText, cbNew - suffix, cbNew))) {
+		--suffix;
+	}
+
+	const char * const oldMiddle = oldText + prefix;
+	const char * const newMiddle = newText + prefix;
+	const uint32_t cbOldMiddle = cbOld - prefix - suffix;
+	const uint32_t cbNewMiddle = cbNew - prefix - suffix;
+	const uint32_t n = EditDiff_SplitLines(oldMiddle, cbOldMiddle, NULL, EDIT_DIFF_MAX_LINES);
+	const uint32_t m = EditDiff_SplitLines(newMiddle, cbNewMiddle, NULL, EDIT_DIFF_MAX_LINES);
+
+	int count = 0;
+	EditDiffHunk *hunks = NULL;
+	if (n != 0 && m != 0 && n + m <= EDIT_DIFF_MAX_LINES) {
+		EditDiffLine *oldLines = (EditDiffLine *)malloc((n + 1) * sizeof(EditDiffLine));
+		EditDiffLine *newLines = (EditDiffLine *)malloc((m + 1) * sizeof(EditDiffLine));
+		uint8_t *oldKeep = (uint8_t *)calloc(n + m + 2, 1);
+		uint8_t *newKeep = oldKeep + n + 1;
+		if (oldLines != NULL && newLines != NULL && oldKeep != NULL) {
+			EditDiff_SplitLines(oldMiddle, cbOldMiddle, oldLines, n);
+			EditDiff_SplitLines(newMiddle, cbNewMiddle, newLines, m);
+			oldLines[n].offset = cbOldMiddle;
+			newLines[m].offset = cbNewMiddle;
+			if (EditDiff_Compare(oldMiddle, oldLines, n, newMiddle, newLines, m, oldKeep, newKeep)) {
+				hunks = (EditDiffHunk *)malloc((min_u32(n, m) + 1) * sizeof(EditDiffHunk));
+			}
+		}
+		if (hunks != NULL) {
+			uint32_t i = 0;
+			uint32_t j = 0;
+			while (i < n || j < m) {
+				if (i < n && j < m && oldKeep[i] && newKeep[j]) {
+					++i;
+					++j;
+					continue;
+				}
+				const uint32_t oldStart = i;
+				const uint32_t newStart = j;
+				while (i < n && !oldKeep[i]) {
+					++i;
+				}
+				while (j < m && !newKeep[j]) {
+					++j;
+				}
+				hunks[count].oldStart = prefix + oldLines[oldStart].offset;
+				hunks[count].oldEnd = prefix + oldLines[i].offset;
+				hunks[count].newStart = prefix + newLines[newStart].offset;
+				hunks[count].newEnd = prefix + newLines[j].offset;
+				++count;
+			}
+		}
+		free(oldLines);
+		free(newLines);
+		free(oldKeep);
+	}
+
+	if (hunks == NULL) {
+		// replace all changed lines
+		hunks = (EditDiffHunk *)malloc(sizeof(EditDiffHunk));
+		if (hunks == NULL) {
+			return -1;
+		}
+		hunks[0].oldStart = prefix;
+		hunks[0].oldEnd = cbOld - suffix;
+		hunks[0].newStart = prefix;
+		hunks[0].newEnd = cbNew - suffix;
+		count = 1;
+	}
+	*pHunks = hunks;
+	return count;
+}
+
+void EditDiff_TrimHunk(const char *oldText, const char *newText, EditDiffHunk *hunk) {
+	while (hunk->oldStart < hunk->oldEnd && hunk->newStart < hunk->newEnd && oldText[hunk->oldStart] == newText[hunk->newStart]) {
+		++hunk->oldStart;
+		++hunk->newStart;
+	}
+	while (hunk->oldStart < hunk->oldEnd && hunk->newStart < hunk->newEnd && oldText[hunk->oldEnd - 1] == newText[hunk->newEnd - 1]) {
+		--hunk->oldEnd;
+		--hunk->newEnd;
+	}
+}
@@ -0,0 +1,35 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//
+// Line diff between the document and reloaded text, so reloading replaces only changed lines.
+// Only standard C is used, the functions are tested on other platforms.
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define EDIT_DIFF_MAX_LINES		(64*1024)	// above which changed lines are replaced as a whole
+#define EDIT_DIFF_MAX_EDITS		1024		// inserted and deleted lines
+
+// old text in [oldStart, oldEnd) is replaced with new text in [newStart, newEnd).
+typedef struct EditDiffHunk {
+	uint32_t oldStart;
+	uint32_t oldEnd;
+	uint32_t newStart;
+	uint32_t newEnd;
+} EditDiffHunk;
+
+// find changed ranges between old and new text, both start and end at line boundary.
+// returns number of hunks in ascending order, *pHunks is freed by caller with free().
+// returns -1 when out of memory.
+int EditDiff_GetHunks(const char *oldText, uint32_t cbOld, const char *newText, uint32_t cbNew, EditDiffHunk **pHunks);
+// shrink hunk to bytes that differ, a changed line is replaced without its line ending,
+// so line count, fold level and visibility of the line are unchanged.
+void EditDiff_TrimHunk(const char *oldText, const char *newText, EditDiffHunk *hunk);
+
+#if defined(__cplusplus)
+}
+#endif
@@ -9,6 +9,8 @@
 #include "Helpers.h"
 #include "Notepad2.h"
 #include "Edit.h"
+#include "EditUTF8.h"
+#include "EditDetect.h"
 #include "Styles.h"
 #include "Dialogs.h"
 #include "resource.h"
@@ -479,14 +481,13 @@ BOOL EditSetNewEncoding(int iCurrentEncoding, int iNewEncoding, BOOL bNoUI, BOOL
 			const BOOL bIsEmptyUndoHistory = !(SciCall_CanUndo() || SciCall_CanRedo());
 
 			if (bNoUI || bIsEmptyUndoHistory || InfoBox(MBYESNO, L"MsgConv2", IDS_ASK_ENCODING2) == IDYES) {
-				EditConvertText(cpSrc, cpDest, bSetSavePoint);
-				return TRUE;
+				return EditConvertText(cpSrc, cpDest, bSetSavePoint);
 			}
 		} else if (bNoUI || InfoBox(MBYESNO, L"MsgConv1", IDS_ASK_ENCODING) == IDYES) {
 			BeginWaitCursor();
-			EditConvertText(cpSrc, cpDest, FALSE);
+			const BOOL bSuccess = EditConvertText(cpSrc, cpDest, FALSE);
 			EndWaitCursor();
-			return TRUE;
+			return bSuccess;
 		}
 	}
 
@@ -993,38 +994,124 @@ BOOL Encoding_GetFromComboboxEx(HWND hwnd, int *pidEncoding) {
 #endif
 
 
+//=============================================================================
+//
+// Encoding detection
+//
+// Code pages are scored by the portable detector in EditDetect.c, candidates
+// are the encodings in mEncoding for the scored code pages.
+//
+static UINT Encoding_GetCodePage(int iEncoding) {
+	const UINT uFlags = mEncoding[iEncoding].uFlags;
+	if (uFlags & NCP_DEFAULT) {
+		return GetACP();
+	}
+	if (uFlags & NCP_UTF8) {
+		return CP_UTF8;
+	}
+	if (uFlags & NCP_UNICODE) {
+		return (uFlags & NCP_UNICODE_REVERSE) ? 1201 : 1200;
+	}
+	return mEncoding[iEncoding].uCodePage;
+}
+
+static void Encoding_AddCandidate(EncodingCandidate *candidates, int *count, int maxCount, int iEncoding, int iConfidence) {
+	if (iConfidence <= 0 || iEncoding < 0 || !IsValidEncoding(iEncoding) || *count == maxCount) {
+		return;
+	}
+	candidates[*count].iEncoding = iEncoding;
+	candidates[*count].iConfidence = iConfidence;
+	*count += 1;
+}
+
+int Encoding_Detect(const char *lpData, SIZE_T cbData, int iDefaultEncoding, EncodingCandidate *candidates, int maxCount) {
+	if (lpData == NULL || cbData == 0 || maxCount <= 0) {
+		return 0;
+	}
+
+	BOOL bUTF16BOM = FALSE;
+	BOOL bUTF8BOM = FALSE;
+	int count = 0;
+	if (cbData >= 2 && lpData[0] == '\xFF' && lpData[1] == '\xFE') {
+		bUTF16BOM = TRUE;
+		Encoding_AddCandidate(candidates, &count, maxCount, CPI_UNICODEBOM, 100);
+	} else if (cbData >= 2 && lpData[0] == '\xFE' && lpData[1] == '\xFF') {
+		bUTF16BOM = TRUE;
+		Encoding_AddCandidate(candidates, &count, maxCount, CPI_UNICODEBEBOM, 100);
+	} else if (cbData >= 3 && IsUTF8Signature(lpData)) {
+		bUTF8BOM = TRUE;
+		Encoding_AddCandidate(candidates, &count, maxCount, CPI_UTF8SIGN, 100);
+	}
+
+	// scores are already sorted, with ties resolved in favor of the default code page.
+	EncodingScore scores[MAX_ENCODING_SCORES];
+	const int scoreCount = EncodingDetect_Rank(lpData, cbData, Encoding_GetCodePage(iDefaultEncoding), scores, COUNTOF(scores));
+	for (int i = 0; i < scoreCount; i++) {
+		const UINT page = scores[i].codePage;
+		int iEncoding;
+		switch (page) {
+		case 1200:
+		case 1201:
+			if (bUTF16BOM) {
+				continue;
+			}
+			iEncoding = (page == 1200) ? CPI_UNICODE : CPI_UNICODEBE;
+			break;
+		case CP_UTF8:
+			if (bUTF8BOM) {
+				continue;
+			}
+			iEncoding = CPI_UTF8;
+			break;
+		default:
+			iEncoding = Encoding_GetIndex(page);
+			break;
+		}
+		Encoding_AddCandidate(candidates, &count, maxCount, iEncoding, scores[i].confidence);
+	}
+	return count;
+}
+
+int Encoding_DetectLegacy(const char *lpData, SIZE_T cbData, int iEncoding) {
+	const UINT uCodePage = Encoding_GetCodePage(iEncoding);
+	const UINT uDetected = EncodingDetect_Legacy(lpData, cbData, uCodePage);
+	if (uDetected == uCodePage) {
+		return iEncoding;
+	}
+	const int index = Encoding_GetIndex(uDetected);
+	return (index >= 0 && IsValidEncoding(index)) ? index : iEncoding;
+}
+
 BOOL IsUnicode(const char *pBuffer, DWORD cb, LPBOOL lpbBOM, LPBOOL lpbReverse) {
 	if (pBuffer == NULL || cb < 2 || (cb & 1) != 0) {
 		// reject odd bytes
 		return FALSE;
 	}
 
-	int i = 0xFFFF;
-	const BOOL bIsTextUnicode = bSkipUnicodeDetection ? FALSE : IsTextUnicode(pBuffer, cb, &i);
 	const BOOL bHasBOM = (pBuffer[0] == '\xFF' && pBuffer[1] == '\xFE');
 	const BOOL bHasRBOM = (pBuffer[0] == '\xFE' && pBuffer[1] == '\xFF');
+	BOOL bReverse = bHasRBOM;
 
-	if (i == 0xFFFF) { // i doesn't seem to have been modified ...
-		i = 0;
-	}
-
-	if (bIsTextUnicode || bHasBOM || bHasRBOM ||
-			((i & (IS_TEXT_UNICODE_UNICODE_MASK | IS_TEXT_UNICODE_REVERSE_MASK)) &&
-			 !((i & IS_TEXT_UNICODE_UNICODE_MASK) && (i & IS_TEXT_UNICODE_REVERSE_MASK)) &&
-			 !(i & IS_TEXT_UNICODE_ODD_LENGTH) &&
-			 !(i & IS_TEXT_UNICODE_ILLEGAL_CHARS && !(i & IS_TEXT_UNICODE_REVERSE_SIGNATURE)) &&
-			 !((i & IS_TEXT_UNICODE_REVERSE_MASK) == IS_TEXT_UNICODE_REVERSE_STATISTICS))) {
-		if (lpbBOM) {
-			*lpbBOM = bHasBOM || bHasRBOM ||
-					   (i & (IS_TEXT_UNICODE_SIGNATURE | IS_TEXT_UNICODE_REVERSE_SIGNATURE));
+	if (!(bHasBOM || bHasRBOM)) {
+		if (bSkipUnicodeDetection) {
+			return FALSE;
 		}
-		if (lpbReverse) {
-			*lpbReverse = bHasRBOM || (i & IS_TEXT_UNICODE_REVERSE_MASK);
+
+		const int confidence = EncodingDetect_UTF16(pBuffer, cb, FALSE);
+		const int confidenceBE = EncodingDetect_UTF16(pBuffer, cb, TRUE);
+		if (max_i(confidence, confidenceBE) < ENCODING_DETECT_THRESHOLD - ENCODING_DETECT_MARGIN) {
+			return FALSE;
 		}
-		return TRUE;
+		bReverse = confidenceBE > confidence;
 	}
 
-	return FALSE;
+	if (lpbBOM) {
+		*lpbBOM = bHasBOM || bHasRBOM;
+	}
+	if (lpbReverse) {
+		*lpbReverse = bReverse;
+	}
+	return TRUE;
 }
 
 #if 0
@@ -1091,200 +1178,8 @@ BOOL IsUTF8(const char *pTest, DWORD nLength) {
 }
 #endif
 
-// Copyright (c) 2008-2010 Bjoern Hoehrmann <bjoern@hoehrmann.de>
-// See https://bjoern.hoehrmann.de/utf-8/decoder/dfa/ for details.
-
-BOOL IsUTF8(const char *pTest, DWORD nLength) {
-	enum {
-		UTF8_ACCEPT = 0,
-		UTF8_REJECT = 12,
-	};
-
-#if 0
-	StopWatch watch;
-	StopWatch_Start(watch);
-#endif
-
-	static const uint8_t utf8_dfa[] = {
-		// The first part of the table maps bytes to character classes that
-		// to reduce the size of the transition table and create bitmasks.
-		 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-		 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-		 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-		 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
-		 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,  9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
-		 7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,  7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
-		 8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2,  2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
-		10,3,3,3,3,3,3,3,3,3,3,3,3,4,3,3, 11,6,6,6,5,8,8,8,8,8,8,8,8,8,8,8,
-
-		// The second part is a transition table that maps a combination
-		// of a state of the automaton and a character class to a state.
-		 0,12,24,36,60,96,84,12,12,12,48,72, 12,12,12,12,12,12,12,12,12,12,12,12,
-		12, 0,12,12,12,12,12, 0,12, 0,12,12, 12,24,12,12,12,12,12,24,12,24,12,12,
-		12,12,12,12,12,12,12,24,12,12,12,12, 12,24,12,12,12,12,12,12,12,24,12,12,
-		12,12,12,12,12,12,12,36,12,36,12,12, 12,36,12,12,12,12,12,36,12,36,12,12,
-		12,36,12,12,12,12,12,12,12,12,12,12,
-	};
-
-	const uint8_t *pt = (const uint8_t *)pTest;
-	const uint8_t * const end = pt + nLength;
-
-	UINT state = UTF8_ACCEPT;
-
-	{
-#if NP2_USE_AVX2
-#define ALIGNMENT	sizeof(__m256i)
-#elif NP2_USE_SSE2
-#define ALIGNMENT	sizeof(__m128i)
-#elif defined(_WIN64)
-#define ALIGNMENT	sizeof(uint64_t)
-#else
-#define ALIGNMENT	sizeof(uint32_t)
-#endif
-		const uint8_t * const ptr = (const uint8_t *)align_ptr_ex(pt, ALIGNMENT);
-		while (pt < ptr) {
-			state = utf8_dfa[256 + state + utf8_dfa[*pt++]];
-		}
-		if (state == UTF8_REJECT) {
-			return FALSE;
-		}
-#undef ALIGNMENT
-	}
-
-	{
-#if NP2_USE_AVX2
-		while (pt + sizeof(__m256i) <= end) {
-			const __m256i chunk = _mm256_load_si256((__m256i *)pt);
-			const uint32_t mask = _mm256_movemask_epi8(chunk);
-			if (mask) {
-				// skip leading and trailing ASCII
-#if defined(__clang__) || defined(__GNUC__)
-				const int trailing = __builtin_ctz(mask);
-#elif defined(_MSC_VER)
-				const DWORD trailing = _tzcnt_u32(mask);
-#else
-				DWORD trailing;
-				_BitScanForward(&trailing, mask);
-#endif
-				DWORD leading;
-				_BitScanReverse(&leading, mask);
-
-				const uint8_t *temp = pt + trailing;
-				const uint8_t * const endPtr = pt + leading + 1;
-				do {
-					state = utf8_dfa[256 + state + utf8_dfa[*temp++]];
-				} while (temp < endPtr);
-				if (state == UTF8_REJECT) {
-					return FALSE;
-				}
-			}
-			pt += sizeof(__m256i);
-		}
-		// end NP2_USE_AVX2
-#elif NP2_USE_SSE2
-		while (pt + sizeof(__m128i) <= end) {
-			const __m128i chunk = _mm_load_si128((__m128i *)pt);
-			const uint32_t mask = _mm_movemask_epi8(chunk);
-			if (mask) {
-				// skip leading and trailing ASCII
-#if defined(__clang__) || defined(__GNUC__)
-				const int trailing = __builtin_ctz(mask);
-#elif defined(_MSC_VER)
-				const DWORD trailing = _tzcnt_u32(mask);
-#else
-				DWORD trailing;
-				_BitScanForward(&trailing, mask);
-#endif
-				DWORD leading;
-				_BitScanReverse(&leading, mask);
-
-				const uint8_t *temp = pt + trailing;
-				const uint8_t * const endPtr = pt + leading + 1;
-				do {
-					state = utf8_dfa[256 + state + utf8_dfa[*temp++]];
-				} while (temp < endPtr);
-				if (state == UTF8_REJECT) {
-					return FALSE;
-				}
-			}
-			pt += sizeof(__m128i);
-		}
-		// end NP2_USE_SSE2
-#elif defined(_WIN64)
-		const uint64_t *temp = (const uint64_t *)pt;
-		const uint64_t * const temp_end = (const uint64_t *)end;
-		while (temp < temp_end) {
-			const uint64_t val = *temp;
-			if (val & UINT64_C(0x8080808080808080)) {
-#if 0
-				pt = (const uint8_t *)temp
-				state = utf8_dfa[256 + state + utf8_dfa[pt[0]]];
-				state = utf8_dfa[256 + state + utf8_dfa[pt[1]]];
-				state = utf8_dfa[256 + state + utf8_dfa[pt[2]]];
-				state = utf8_dfa[256 + state + utf8_dfa[pt[3]]];
-				state = utf8_dfa[256 + state + utf8_dfa[pt[4]]];
-				state = utf8_dfa[256 + state + utf8_dfa[pt[5]]];
-				state = utf8_dfa[256 + state + utf8_dfa[pt[6]]];
-				state = utf8_dfa[256 + state + utf8_dfa[pt[7]]];
-#else
-				// same as above
-				state = utf8_dfa[256 + state + utf8_dfa[val & 255]];
-				state = utf8_dfa[256 + state + utf8_dfa[(val >> 8) & 255]];
-				state = utf8_dfa[256 + state + utf8_dfa[(val >> 16) & 255]];
-				state = utf8_dfa[256 + state + utf8_dfa[(val >> 24) & 255]];
-				state = utf8_dfa[256 + state + utf8_dfa[(val >> 32) & 255]];
-				state = utf8_dfa[256 + state + utf8_dfa[(val >> 40) & 255]];
-				state = utf8_dfa[256 + state + utf8_dfa[(val >> 48) & 255]];
-				state = utf8_dfa[256 + state + utf8_dfa[val >> 56]];
-#endif
-				if (state == UTF8_REJECT) {
-					return FALSE;
-				}
-			}
-			++temp;
-		}
-		pt = (const uint8_t *)temp;
-		// end _WIN64
-#else
-		const uint32_t *temp = (const uint32_t *)pt;
-		const uint32_t * const temp_end = (const uint32_t *)end;
-		while (temp < temp_end) {
-			const uint32_t val = *temp;
-			if (val & 0x80808080U) {
-#if 0
-				pt = (const uint8_t *)temp
-				state = utf8_dfa[256 + state + utf8_dfa[pt[0]]];
-				state = utf8_dfa[256 + state + utf8_dfa[pt[1]]];
-				state = utf8_dfa[256 + state + utf8_dfa[pt[2]]];
-				state = utf8_dfa[256 + state + utf8_dfa[pt[3]]];
-#else
-				// same as above
-				state = utf8_dfa[256 + state + utf8_dfa[val & 255]];
-				state = utf8_dfa[256 + state + utf8_dfa[(val >> 8) & 255]];
-				state = utf8_dfa[256 + state + utf8_dfa[(val >> 16) & 255]];
-				state = utf8_dfa[256 + state + utf8_dfa[val >> 24]];
-#endif
-				if (state == UTF8_REJECT) {
-					return FALSE;
-				}
-			}
-			++temp;
-		}
-		pt = (const uint8_t *)temp;
-		// end _WIN32
-#endif
-	}
-
-	while (pt < end) {
-		state = utf8_dfa[256 + state + utf8_dfa[*pt++]];
-	}
-
-#if 0
-	StopWatch_Stop(watch);
-	StopWatch_ShowLog(&watch, "UTF8 time");
-#endif
-
-	return state == UTF8_ACCEPT;
+BOOL IsUTF8(const char *pTest, SIZE_T nLength) {
+	return UTF8_FindInvalid(pTest, nLength) == nLength;
 }
 
 BOOL IsUTF7(const char *pTest, DWORD nLength) {
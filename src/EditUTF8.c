@@ -0,0 +1,310 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+
+#include <stdint.h>
+#include "VectorISA.h"
+#include "EditUTF8.h"
+
+// Copyright (c) 2008-2010 Bjoern Hoehrmann <bjoern@hoehrmann.de>
+// See https://bjoern.hoehrmann.de/utf-8/decoder/dfa/ for details.
+
+enum {
+	UTF8_ACCEPT = 0,
+	UTF8_REJECT = 12,
+};
+
+static const uint8_t utf8_dfa[] = {
+	// The first part of the table maps bytes to character classes that
+	// to reduce the size of the transition table and create bitmasks.
+	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+	 1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,  9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+	 7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,  7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+	 8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2,  2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+	10,3,3,3,3,3,3,3,3,3,3,3,3,4,3,3, 11,6,6,6,5,8,8,8,8,8,8,8,8,8,8,8,
+
+	// The second part is a transition table that maps a combination
+	// of a state of the automaton and a character class to a state.
+	 0,12,24,36,60,96,84,12,12,12,48,72, 12,12,12,12,12,12,12,12,12,12,12,12,
+	12, 0,12,12,12,12,12, 0,12, 0,12,12, 12,24,12,12,12,12,12,24,12,24,12,12,
+	12,12,12,12,12,12,12,24,12,12,12,12, 12,24,12,12,12,12,12,12,12,24,12,12,
+	12,12,12,12,12,12,12,36,12,36,12,12, 12,36,12,12,12,12,12,36,12,36,12,12,
+	12,36,12,12,12,12,12,12,12,12,12,12,
+};
+
+// validate [pt, end) byte by byte, pt must be start of a character.
+// returns offset of the first invalid or incomplete sequence, or length of the text.
+static size_t UTF8_FindInvalidDFA(const uint8_t *begin, const uint8_t *pt, const uint8_t * const end) {
+	const uint8_t *sequence = pt;
+	unsigned state = UTF8_ACCEPT;
+	while (pt < end) {
+		state = utf8_dfa[256 + state + utf8_dfa[*pt++]];
+		if (state == UTF8_ACCEPT) {
+			sequence = pt;
+		} else if (state == UTF8_REJECT) {
+			break;
+		}
+	}
+	return (size_t)((state == UTF8_ACCEPT ? end : sequence) - begin);
+}
+
+// text before pt is valid except the last character may be incomplete,
+// locate the invalid sequence by validating again from start of that character.
+static size_t UTF8_FindInvalidAfter(const uint8_t *begin, const uint8_t *pt, const uint8_t * const end) {
+	unsigned count = 0;
+	while (pt > begin && count < 3 && (pt[-1] & 0xC0) == 0x80) {
+		--pt;
+		++count;
+	}
+	if (pt > begin && pt[-1] >= 0xC0) {
+		--pt;
+	}
+	return UTF8_FindInvalidDFA(begin, pt, end);
+}
+
+#if NP2_USE_SSE2
+// Validating UTF-8 In Less Than One Instruction Per Byte, John Keiser and Daniel Lemire.
+// https://arxiv.org/abs/2010.03090
+// Each pair of adjacent bytes is classified with three nibble lookups, the AND of
+// them is non-zero when the pair forms an invalid sequence.
+#define UTF8_TOO_SHORT		(1 << 0)
+#define UTF8_TOO_LONG		(1 << 1)
+#define UTF8_OVERLONG_3		(1 << 2)
+#define UTF8_TOO_LARGE		(1 << 3)
+#define UTF8_SURROGATE		(1 << 4)
+#define UTF8_OVERLONG_2		(1 << 5)
+#define UTF8_TOO_LARGE_1000	(1 << 6)
+#define UTF8_OVERLONG_4		(1 << 6)
+#define UTF8_TWO_CONTS		(1 << 7)
+#define UTF8_CARRY			(UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#define mm256_setr_table(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15) \
+	_mm256_setr_epi8(a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, \
+					a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15)
+
+// bytes of input shifted right by count bytes, shifting in the last bytes of previous.
+#define mm256_prev_bytes(input, previous, count) \
+	_mm256_alignr_epi8((input), _mm256_permute2x128_si256((previous), (input), 0x21), 16 - (count))
+
+static inline NP2_TARGET_AVX2 __m256i UTF8_CheckBlock(__m256i input, __m256i previous) {
+	const __m256i byte_1_high_table = mm256_setr_table(
+		// 0_______ ________ <ASCII in byte 1>
+		UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+		UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+		// 10______ ________ <continuation in byte 1>
+		UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+		// 1100____ ________ <two byte lead in byte 1>
+		UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+		// 1101____ ________ <two byte lead in byte 1>
+		UTF8_TOO_SHORT,
+		// 1110____ ________ <three byte lead in byte 1>
+		UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+		// 1111____ ________ <four+ byte lead in byte 1>
+		UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+	const __m256i byte_1_low_table = mm256_setr_table(
+		// ____0000 ________
+		UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+		// ____0001 ________
+		UTF8_CARRY | UTF8_OVERLONG_2,
+		// ____001_ ________
+		UTF8_CARRY,
+		UTF8_CARRY,
+		// ____0100 ________
+		UTF8_CARRY | UTF8_TOO_LARGE,
+		// ____0101 ________
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+		// ____011_ ________
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+		// ____1___ ________
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+		// ____1101 ________
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+		UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000);
+	const __m256i byte_2_high_table = mm256_setr_table(
+		// ________ 0_______ <ASCII in byte 2>
+		UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+		UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+		// ________ 1000____
+		UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+		// ________ 1001____
+		UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+		// ________ 101_____
+		UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+		UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+		// ________ 11______
+		UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+	const __m256i prev1 = mm256_prev_bytes(input, previous, 1);
+	const __m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+	const __m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, nibble));
+	const __m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+	const __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+	// third and fourth bytes of 3 and 4 byte sequences must be continuation bytes.
+	const __m256i prev2 = mm256_prev_bytes(input, previous, 2);
+	const __m256i prev3 = mm256_prev_bytes(input, previous, 3);
+	const __m256i third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80));
+	const __m256i fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80));
+	const __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(third_byte, fourth_byte), _mm256_set1_epi8((char)0x80));
+	return _mm256_xor_si256(must_be_continuation, special);
+}
+
+// non-zero when the block ends inside a multi-byte sequence.
+static inline NP2_TARGET_AVX2 __m256i UTF8_IncompleteBlock(__m256i input) {
+	const __m256i max_value = _mm256_setr_epi8(
+		(char)255, (char)255, (char)255, (char)255, (char)255, (char)255, (char)255, (char)255,
+		(char)255, (char)255, (char)255, (char)255, (char)255, (char)255, (char)255, (char)255,
+		(char)255, (char)255, (char)255, (char)255, (char)255, (char)255, (char)255, (char)255,
+		(char)255, (char)255, (char)255, (char)255, (char)255, (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+	return _mm256_subs_epu8(input, max_value);
+}
+
+static NP2_TARGET_AVX2 size_t UTF8_FindInvalidAVX2(const uint8_t * const begin, const uint8_t * const end) {
+	const uint8_t *pt = begin;
+	__m256i previous = _mm256_setzero_si256();
+	__m256i incomplete = _mm256_setzero_si256();
+	while (pt + sizeof(__m256i) <= end) {
+		const __m256i input = _mm256_loadu_si256((const __m256i *)pt);
+		__m256i error;
+		if (_mm256_movemask_epi8(input) == 0) {
+			// ASCII block, only the previous block could be incomplete.
+			error = incomplete;
+			incomplete = _mm256_setzero_si256();
+		} else {
+			error = UTF8_CheckBlock(input, previous);
+			incomplete = UTF8_IncompleteBlock(input);
+		}
+		if (!_mm256_testz_si256(error, error)) {
+			return UTF8_FindInvalidAfter(begin, pt, end);
+		}
+		previous = input;
+		pt += sizeof(__m256i);
+	}
+	// the last block may be incomplete, validate from start of its last character.
+	return UTF8_FindInvalidAfter(begin, pt, end);
+}
+
+// SSE2 has no byte shuffle for the lookups, ASCII is skipped and the rest validated with the DFA.
+static size_t UTF8_FindInvalidSSE2(const uint8_t * const begin, const uint8_t * const end) {
+	const uint8_t *pt = begin;
+	unsigned state = UTF8_ACCEPT;
+	const uint8_t * const ptr = (const uint8_t *)(((uintptr_t)pt + sizeof(__m128i) - 1) & ~(uintptr_t)(sizeof(__m128i) - 1));
+	if (ptr >= end) {
+		return UTF8_FindInvalidDFA(begin, pt, end);
+	}
+	while (pt < ptr) {
+		state = utf8_dfa[256 + state + utf8_dfa[*pt++]];
+	}
+	if (state == UTF8_REJECT) {
+		return UTF8_FindInvalidDFA(begin, begin, end);
+	}
+
+	while (pt + sizeof(__m128i) <= end) {
+		const __m128i chunk = _mm_load_si128((const __m128i *)pt);
+		const uint32_t mask = _mm_movemask_epi8(chunk);
+		if (mask) {
+			// skip leading and trailing ASCII
+			const uint32_t trailing = np2_ctz(mask);
+#if defined(__clang__) || defined(__GNUC__)
+			const uint32_t leading = 31 - __builtin_clz(mask);
+#else
+			unsigned long leading;
+			_BitScanReverse(&leading, mask);
+#endif
+
+			// leading ASCII can't continue a character from previous block
+			const uint8_t *temp = (state == UTF8_ACCEPT) ? pt + trailing : pt;
+			const uint8_t * const endPtr = pt + leading + 1;
+			do {
+				state = utf8_dfa[256 + state + utf8_dfa[*temp++]];
+			} while (temp < endPtr);
+			if (state == UTF8_REJECT || (state != UTF8_ACCEPT && leading != sizeof(__m128i) - 1)) {
+				return UTF8_FindInvalidAfter(begin, pt, end);
+			}
+		} else if (state != UTF8_ACCEPT) {
+			return UTF8_FindInvalidAfter(begin, pt, end);
+		}
+		pt += sizeof(__m128i);
+	}
+	// the text before pt is valid when state is UTF8_ACCEPT,
+	// otherwise its last character continues after pt.
+	return UTF8_FindInvalidAfter(begin, pt, end);
+}
+#endif
+
+// ASCII is skipped a word at a time.
+static size_t UTF8_FindInvalidScalar(const uint8_t * const begin, const uint8_t * const end) {
+	const uint8_t *pt = begin;
+	unsigned state = UTF8_ACCEPT;
+	const uint8_t * const ptr = (const uint8_t *)(((uintptr_t)pt + sizeof(size_t) - 1) & ~(uintptr_t)(sizeof(size_t) - 1));
+	if (ptr >= end) {
+		return UTF8_FindInvalidDFA(begin, pt, end);
+	}
+	while (pt < ptr) {
+		state = utf8_dfa[256 + state + utf8_dfa[*pt++]];
+	}
+	if (state == UTF8_REJECT) {
+		return UTF8_FindInvalidDFA(begin, begin, end);
+	}
+
+	const size_t highBits = ((size_t)-1 / 0xff) * 0x80;
+	while (pt + sizeof(size_t) <= end) {
+		const size_t val = *(const size_t *)pt;
+		if (val & highBits) {
+			for (unsigned i = 0; i < sizeof(size_t); i++) {
+				state = utf8_dfa[256 + state + utf8_dfa[pt[i]]];
+			}
+			if (state == UTF8_REJECT) {
+				return UTF8_FindInvalidAfter(begin, pt, end);
+			}
+		} else if (state != UTF8_ACCEPT) {
+			return UTF8_FindInvalidAfter(begin, pt, end);
+		}
+		pt += sizeof(size_t);
+	}
+	return UTF8_FindInvalidAfter(begin, pt, end);
+}
+
+int UTF8_GetValidator(void) {
+#if NP2_USE_SSE2
+	return np2_cpu_has_avx2() ? UTF8Validator_AVX2 : UTF8Validator_SSE2;
+#else
+	return UTF8Validator_Scalar;
+#endif
+}
+
+size_t UTF8_FindInvalidWith(int validator, const char *pTest, size_t nLength) {
+	const uint8_t * const begin = (const uint8_t *)pTest;
+	const uint8_t * const end = begin + nLength;
+	switch (validator) {
+#if NP2_USE_SSE2
+	case UTF8Validator_AVX2:
+		return UTF8_FindInvalidAVX2(begin, end);
+	case UTF8Validator_SSE2:
+		return UTF8_FindInvalidSSE2(begin, end);
+#endif
+	default:
+		return UTF8_FindInvalidScalar(begin, end);
+	}
+}
+
+size_t UTF8_FindInvalid(const char *pTest, size_t nLength) {
+#if NP2_USE_AVX2
+	return UTF8_FindInvalidWith(UTF8Validator_AVX2, pTest, nLength);
+#else
+	static int validator = -1;
+	if (validator < 0) {
+		validator = UTF8_GetValidator();
+	}
+	return UTF8_FindInvalidWith(validator, pTest, nLength);
+#endif
+}
@@ -0,0 +1,30 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//
+// UTF-8 validation with scalar, SSE2 and AVX2 variants, the fastest one supported
+// by the processor is chosen at runtime. Only standard C and compiler intrinsics
+// are used, the functions are tested on other platforms.
+#pragma once
+
+#include <stddef.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+enum {
+	UTF8Validator_Scalar = 0,
+	UTF8Validator_SSE2 = 1,
+	UTF8Validator_AVX2 = 2,
+};
+
+// the fastest validator supported by the build and the processor.
+int UTF8_GetValidator(void);
+// offset of the first invalid or incomplete sequence, or nLength when the text is valid UTF-8.
+// validator must not be above UTF8_GetValidator().
+size_t UTF8_FindInvalidWith(int validator, const char *pTest, size_t nLength);
+size_t UTF8_FindInvalid(const char *pTest, size_t nLength);
+
+#if defined(__cplusplus)
+}
+#endif
@@ -165,6 +165,8 @@ BOOL	bLoadNFOasOEM;
 BOOL	bNoEncodingTags;
 int		iSrcEncoding = -1;
 int		iWeakSrcEncoding = -1;
+BOOL	bHexViewBinaryFile;
+int		iSrcHexView = -1;
 #if defined(_WIN64)
 BOOL	bLargeFileMode = FALSE;
 #endif
@@ -1303,6 +1305,10 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 		}
 		return DefWindowProc(hwnd, umsg, wParam, lParam);
 
+	case APPM_PAGEDVIEW_MOVE:
+		EditPagedView_Scroll();
+		break;
+
 	case APPM_CHANGENOTIFY:
 		if (iFileWatchingMode == 1 || IsDocumentModified()) {
 			SetForegroundWindow(hwnd);
@@ -1319,8 +1325,16 @@ LRESULT CALLBACK MainWndProc(HWND hwnd, UINT umsg, WPARAM wParam, LPARAM lParam)
 #endif
 				const BOOL bIsTail = bFileWatchingKeepAtEnd || ((iCurPos == iAnchorPos) && (SciCall_LineFromPosition(iCurPos) + 1 == SciCall_GetLineCount()));
 
-				iWeakSrcEncoding = iEncoding;
-				if (FileLoad(TRUE, FALSE, TRUE, FALSE, szCurFile)) {
+				// only read new data at end when the file grew, e.g. log file
+				BOOL bLoaded = !IsDocumentModified() && EditLoadFileTail(szCurFile, iEncoding);
+				if (bLoaded) {
+					UpdateLineNumberWidth();
+					UpdateStatusbar();
+				} else {
+					iWeakSrcEncoding = iEncoding;
+					bLoaded = FileLoad(TRUE, FALSE, TRUE, FALSE, szCurFile);
+				}
+				if (bLoaded) {
 					if (bIsTail && iFileWatchingMode == 2) {
 						SciCall_DocumentEnd();
 						EditEnsureSelectionVisible();
@@ -2208,7 +2222,10 @@ void MsgInitMenu(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	EnableCmd(hmenu, IDM_FILE_OPEN_CONTAINING_FOLDER, i);
 	EnableCmd(hmenu, IDM_FILE_READONLY, i);
 	CheckCmd(hmenu, IDM_FILE_READONLY, bReadOnly);
+	EnableCmd(hmenu, IDM_FILE_LOCK_EDITING, !EditPagedView_IsActive());
 	CheckCmd(hmenu, IDM_FILE_LOCK_EDITING, bLockedForEditing);
+	EnableCmd(hmenu, IDM_FILE_HEX_VIEW, i);
+	CheckCmd(hmenu, IDM_FILE_HEX_VIEW, EditPagedView_IsHexView());
 
 	//EnableCmd(hmenu, IDM_ENCODING_UNICODEREV, !bReadOnly);
 	//EnableCmd(hmenu, IDM_ENCODING_UNICODE, !bReadOnly);
@@ -2602,11 +2619,23 @@ LRESULT MsgCommand(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 		break;
 
 	case IDM_FILE_LOCK_EDITING:
+		// only a window of the file is loaded, it's always locked for editing
+		if (EditPagedView_IsActive()) {
+			break;
+		}
 		bLockedForEditing = !bLockedForEditing;
 		SciCall_SetReadOnly(bLockedForEditing);
 		UpdateWindowTitle();
 		break;
 
+	case IDM_FILE_HEX_VIEW:
+		if (StrNotEmpty(szCurFile)) {
+			iSrcHexView = !EditPagedView_IsHexView();
+			FileLoad(FALSE, FALSE, TRUE, FALSE, szCurFile);
+			iSrcHexView = -1;
+		}
+		break;
+
 	case IDM_FILE_BROWSE:
 		TryBrowseFile(hwnd, szCurFile, TRUE);
 		break;
@@ -4715,6 +4744,9 @@ LRESULT MsgNotify(HWND hwnd, WPARAM wParam, LPARAM lParam) {
 	case IDC_EDIT:
 		switch (pnmh->code) {
 		case SCN_UPDATEUI:
+			if (scn->updated & (SC_UPDATE_V_SCROLL | SC_UPDATE_SELECTION)) {
+				EditPagedView_OnUpdateUI(hwnd);
+			}
 			if (scn->updated & ~(SC_UPDATE_V_SCROLL | SC_UPDATE_H_SCROLL)) {
 				UpdateToolbar();
 
@@ -5210,6 +5242,7 @@ void LoadSettings(void) {
 	bSkipUnicodeDetection = IniSectionGetBool(pIniSection, L"SkipUnicodeDetection", 1);
 	bLoadANSIasUTF8 = IniSectionGetBool(pIniSection, L"LoadANSIasUTF8", 0);
 	bLoadNFOasOEM = IniSectionGetBool(pIniSection, L"LoadNFOasOEM", 1);
+	bHexViewBinaryFile = IniSectionGetBool(pIniSection, L"HexViewBinaryFile", 0);
 	bNoEncodingTags = IniSectionGetBool(pIniSection, L"NoEncodingTags", 0);
 
 	iValue = IniSectionGetInt(pIniSection, L"DefaultEOLMode", 0);
@@ -5526,6 +5559,7 @@ void SaveSettings(BOOL bSaveSettingsNow) {
 	IniSectionSetBoolEx(pIniSection, L"SkipUnicodeDetection", bSkipUnicodeDetection, 1);
 	IniSectionSetBoolEx(pIniSection, L"LoadANSIasUTF8", bLoadANSIasUTF8, 0);
 	IniSectionSetBoolEx(pIniSection, L"LoadNFOasOEM", bLoadNFOasOEM, 1);
+	IniSectionSetBoolEx(pIniSection, L"HexViewBinaryFile", bHexViewBinaryFile, 0);
 	IniSectionSetBoolEx(pIniSection, L"NoEncodingTags", bNoEncodingTags, 0);
 	IniSectionSetIntEx(pIniSection, L"DefaultEOLMode", iDefaultEOLMode, 0);
 	IniSectionSetIntEx(pIniSection, L"WarnLineEndings", bWarnLineEndings, 1);
@@ -6664,12 +6698,34 @@ void UpdateStatusbar(void) {
 	const Sci_Position iPos =  SciCall_GetCurrentPos();
 
 	const Sci_Line iLn = SciCall_LineFromPosition(iPos) + 1;
-	PosToStrW(iLn, tchLn);
-	FormatNumberStr(tchLn);
+	Sci_Line iFileLn = iLn;
+	Sci_Line iLines = SciCall_GetLineCount();
+	BOOL bLinesComplete = TRUE;
+	BOOL bLineKnown = TRUE;
+	if (EditPagedView_IsActive()) {
+		// line number in whole file, line count grows while the file is being indexed
+		const Sci_Line iFirstLine = EditPagedView_GetFirstLine();
+		iLines = EditPagedView_GetLineCount(&bLinesComplete);
+		if (iFirstLine >= 0) {
+			iFileLn += iFirstLine;
+			iLines = max_pos(iLines, iFileLn);
+		} else {
+			// window is after indexed part of the file
+			bLineKnown = FALSE;
+		}
+	}
+	if (bLineKnown) {
+		PosToStrW(iFileLn, tchLn);
+		FormatNumberStr(tchLn);
+	} else {
+		lstrcpy(tchLn, L"?");
+	}
 
-	const Sci_Line iLines = SciCall_GetLineCount();
 	PosToStrW(iLines, tchLines);
 	FormatNumberStr(tchLines);
+	if (!bLinesComplete) {
+		lstrcat(tchLines, L"+");
+	}
 
 	Sci_Position iCol = SciCall_GetColumn(iPos) + 1;
 	PosToStrW(iCol, tchCol);
@@ -6918,6 +6974,7 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 		if (!keepTitleExcerpt) {
 			lstrcpy(szTitleExcerpt, L"");
 		}
+		EditPagedView_Close();
 		FileVars_Init(NULL, 0, &fvCurFile);
 		EditSetEmptyText();
 		bModified = FALSE;
@@ -7007,6 +7064,7 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 			return FALSE;
 		}
 	} else {
+		status.bReload = bReload;
 		fSuccess = FileIO(TRUE, szFileName, bNoEncDetect, &status);
 		if (fSuccess) {
 			iEncoding = status.iEncoding;
@@ -7027,7 +7085,9 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 		UpdateStatusBarCache(STATUS_CODEPAGE);
 		UpdateStatusBarCache(STATUS_EOLMODE);
 		BOOL bUnknownFile = FALSE;
-		if (!lexerSpecified) { // flagLexerSpecified will be cleared
+		// lexer is kept when only changed lines are replaced, setting it again clears
+		// styles and fold levels of whole document, which expands contracted folds.
+		if (!lexerSpecified && !status.bDiffApplied) { // flagLexerSpecified will be cleared
 			np2LexLangIndex = 0;
 			bUnknownFile = !Style_SetLexerFromFile(szCurFile);
 		} else {
@@ -7044,6 +7104,21 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 		}
 		InstallFileWatching(szCurFile);
 
+		// only a window of the file is loaded, it's always locked for editing
+		if (status.bPagedView) {
+			if (!bInitDone) {
+				bInitDone = TRUE;
+				UpdateStatusBarWidth();
+			}
+			if (EditPagedView_IsHexView()) {
+				Style_SetLexerByLangIndex(IDM_LANG_TEXTFILE);
+			}
+			UpdateStatusbar();
+			UpdateDocumentModificationStatus();
+			ShowNotificationMessage(SC_NOTIFICATIONPOSITION_BOTTOMRIGHT, EditPagedView_IsHexView() ? IDS_HEX_VIEW_LOCKED : IDS_PAGED_VIEW_LOCKED);
+			return fSuccess;
+		}
+
 		// check for binary file (file with unknown encoding: ANSI)
 		const BOOL binary = (iEncoding == CPI_DEFAULT) && Style_MaybeBinaryFile(szCurFile);
 		// lock binary file for editing
@@ -7051,7 +7126,8 @@ BOOL FileLoad(BOOL bDontSave, BOOL bNew, BOOL bReload, BOOL bNoEncDetect, LPCWST
 			bLockedForEditing = TRUE;
 			SciCall_SetReadOnly(TRUE);
 		} else {
-			if (line > 1 || col > 1) {
+			// caret is kept when only changed lines are replaced
+			if (!status.bDiffApplied && (line > 1 || col > 1)) {
 				EditJumpTo(line, col);
 				EditEnsureSelectionVisible();
 			}
@@ -7131,6 +7207,12 @@ BOOL FileSave(BOOL bSaveAlways, BOOL bAsk, BOOL bSaveAs, BOOL bSaveCopy) {
 		return TRUE;
 	}
 
+	// saving would truncate the file to the loaded window
+	if (EditPagedView_IsActive()) {
+		ShowNotificationMessage(SC_NOTIFICATIONPOSITION_BOTTOMRIGHT, IDS_PAGED_VIEW_LOCKED);
+		return FALSE;
+	}
+
 	if (bAsk) {
 		// File or "Untitled" ...
 		WCHAR tch[MAX_PATH];
@@ -88,6 +88,9 @@ typedef struct np2params {
 //==== Callback Message from System Tray ======================================
 #define APPM_TRAYMESSAGE			(WM_APP + 4)
 
+//==== Move Window of Paged View ==============================================
+#define APPM_PAGEDVIEW_MOVE			(WM_APP + 5)
+
 //==== Paste Board Timer ======================================================
 #define ID_PASTEBOARDTIMER			0xA001
 
@@ -183,6 +186,9 @@ typedef struct EditFileIOStatus {
 
 	BOOL bFileTooBig;	// load output
 	BOOL bUnicodeErr;	// load output
+	BOOL bReload;		// load input, apply changes as edits instead of replacing the document
+	BOOL bDiffApplied;	// load output
+	BOOL bPagedView;	// load output, file is opened in read-only paged view
 
 	// inconsistent line endings
 	BOOL bLineEndingsDefaultNo; // set default button to "No"
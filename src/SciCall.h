@@ -130,6 +130,16 @@ NP2_inline int SciCall_GetCharacterAt(Sci_Position position) {
 	return (int)SciCall(SCI_GETCHARACTERANDWIDTH, position, 0);
 }
 
+// Error handling
+
+NP2_inline void SciCall_SetStatus(int status) {
+	SciCall(SCI_SETSTATUS, status, 0);
+}
+
+NP2_inline int SciCall_GetStatus(void) {
+	return (int)SciCall(SCI_GETSTATUS, 0, 0);
+}
+
 // Searching and replacing
 
 NP2_inline Sci_Position SciCall_GetTargetStart(void) {
@@ -268,6 +278,10 @@ NP2_inline void SciCall_GotoPos(Sci_Position caret) {
 	SciCall(SCI_GOTOPOS, caret, 0);
 }
 
+NP2_inline void SciCall_SetEmptySelection(Sci_Position caret) {
+	SciCall(SCI_SETEMPTYSELECTION, caret, 0);
+}
+
 NP2_inline void SciCall_GotoLine(Sci_Line line) {
 	SciCall(SCI_GOTOLINE, line, 0);
 }
@@ -460,6 +474,14 @@ NP2_inline Sci_Line SciCall_GetFirstVisibleLine(void) {
 	return SciCall(SCI_GETFIRSTVISIBLELINE, 0, 0);
 }
 
+NP2_inline void SciCall_SetFirstVisibleLine(Sci_Line displayLine) {
+	SciCall(SCI_SETFIRSTVISIBLELINE, displayLine, 0);
+}
+
+NP2_inline Sci_Line SciCall_LinesOnScreen(void) {
+	return SciCall(SCI_LINESONSCREEN, 0, 0);
+}
+
 NP2_inline void SciCall_SetXOffset(int xOffset) {
 	SciCall(SCI_SETXOFFSET, xOffset, 0);
 }
@@ -1133,12 +1155,20 @@ NP2_inline void SciCall_SetPrintColourMode(int mode) {
 
 // Direct access
 
+NP2_inline const char* SciCall_GetCharacterPointer(void) {
+	return (const char *)SciCall(SCI_GETCHARACTERPOINTER, 0, 0);
+}
+
 NP2_inline const char* SciCall_GetRangePointer(Sci_Position start, Sci_Position lengthRange) {
 	return (const char *)SciCall(SCI_GETRANGEPOINTER, start, lengthRange);
 }
 
 // Multiple views
 
+NP2_inline HANDLE SciCall_GetDocPointer(void) {
+	return (HANDLE)SciCall(SCI_GETDOCPOINTER, 0, 0);
+}
+
 NP2_inline void SciCall_SetDocPointer(HANDLE doc) {
 	SciCall(SCI_SETDOCPOINTER, 0, (LPARAM)doc);
 }
@@ -1147,6 +1177,10 @@ NP2_inline HANDLE SciCall_CreateDocument(Sci_Position bytes, int documentOptions
 	return (HANDLE)SciCall(SCI_CREATEDOCUMENT, bytes, documentOptions);
 }
 
+NP2_inline void SciCall_AddRefDocument(HANDLE doc) {
+	SciCall(SCI_ADDREFDOCUMENT, 0, (LPARAM)doc);
+}
+
 NP2_inline void SciCall_ReleaseDocument(HANDLE doc) {
 	SciCall(SCI_RELEASEDOCUMENT, 0, (LPARAM)doc);
 }
@@ -1157,6 +1191,10 @@ NP2_inline int SciCall_GetDocumentOptions(void) {
 
 // Folding
 
+NP2_inline Sci_Line SciCall_VisibleFromDocLine(Sci_Line docLine) {
+	return SciCall(SCI_VISIBLEFROMDOCLINE, docLine, 0);
+}
+
 NP2_inline Sci_Line SciCall_DocLineFromVisible(Sci_Line displayLine) {
 	return SciCall(SCI_DOCLINEFROMVISIBLE, displayLine, 0);
 }
@@ -1189,6 +1227,14 @@ NP2_inline void SciCall_ToggleFold(Sci_Line line) {
 	SciCall(SCI_TOGGLEFOLD, line, 0);
 }
 
+NP2_inline void SciCall_BeginFoldBatch(void) {
+	SciCall(SCI_BEGINFOLDBATCH, 0, 0);
+}
+
+NP2_inline void SciCall_EndFoldBatch(void) {
+	SciCall(SCI_ENDFOLDBATCH, 0, 0);
+}
+
 NP2_inline void SciCall_ToggleFoldShowText(Sci_Line line, const char *text) {
 	SciCall(SCI_TOGGLEFOLDSHOWTEXT, line, (LPARAM)text);
 }
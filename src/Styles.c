@@ -2619,9 +2619,7 @@ BOOL Style_CanOpenFile(LPCWSTR lpszFile) {
 	return pLexNew != NULL || StrIsEmpty(lpszExt) || bDotFile || StrCaseEqual(lpszExt, L"cgi") || StrCaseEqual(lpszExt, L"fcgi");
 }
 
-BOOL Style_MaybeBinaryFile(LPCWSTR lpszFile) {
-#if 1
-	UNREFERENCED_PARAMETER(lpszFile);
+BOOL Style_MaybeBinaryData(const char *lpData, SIZE_T cbData) {
 	/* Test C0 Control Character
 	These character is not reused in most text encoding, and doesn't appears in normal text file.
 	Most binary file has reserved fields (most are NULL) or small values in it's header.
@@ -2630,12 +2628,12 @@ BOOL Style_MaybeBinaryFile(LPCWSTR lpszFile) {
 
 	// see tools/GenerateTable.py for this mask.
 	const UINT C0Mask = 0x0FFFC1FFU;
-	const Sci_Position headerLen = min_pos(1023, SciCall_GetLength() - 1);
-	const uint8_t *ptr = (const uint8_t *)SciCall_GetRangePointer(0, headerLen + 1);
-	if (ptr == NULL || headerLen <= 0) {
+	if (lpData == NULL || cbData <= 1) {
 		return FALSE; // empty file
 	}
 
+	const SIZE_T headerLen = (cbData > 1024) ? 1023 : (cbData - 1);
+	const uint8_t *ptr = (const uint8_t *)lpData;
 	const uint8_t * const end  = ptr + headerLen;
 	UINT count = 0;
 	while (ptr < end) {
@@ -2648,6 +2646,16 @@ BOOL Style_MaybeBinaryFile(LPCWSTR lpszFile) {
 			}
 		}
 	}
+	return FALSE;
+}
+
+BOOL Style_MaybeBinaryFile(LPCWSTR lpszFile) {
+#if 1
+	UNREFERENCED_PARAMETER(lpszFile);
+	const Sci_Position length = min_pos(1024, SciCall_GetLength());
+	if (Style_MaybeBinaryData(SciCall_GetRangePointer(0, length), length)) {
+		return TRUE;
+	}
 #else
 	uint8_t buf[5] = {0}; // file magic
 	SciCall_GetText(COUNTOF(buf), buf);
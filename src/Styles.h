@@ -60,6 +60,7 @@ void	Style_InitDefaultColor(void);
 void	Style_SetLexer(PEDITLEXER pLexNew, BOOL bLexerChanged);
 BOOL	Style_SetLexerFromFile(LPCWSTR lpszFile);
 void	Style_SetLexerFromName(LPCWSTR lpszFile, LPCWSTR lpszName);
+BOOL	Style_MaybeBinaryData(const char *lpData, SIZE_T cbData);
 BOOL	Style_MaybeBinaryFile(LPCWSTR lpszFile);
 BOOL	Style_CanOpenFile(LPCWSTR lpszFile);
 void	Style_SetLexerFromID(int id);
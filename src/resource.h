@@ -385,6 +385,7 @@
 #define IDM_FILE_LOCK_EDITING			40024
 #define IDM_FILE_LARGE_FILE_MODE		40025
 #define IDM_FILE_LARGE_FILE_MODE_RELOAD	40026
+#define IDM_FILE_HEX_VIEW				40027
 #define IDM_ENCODING_ANSI				40100
 #define IDM_ENCODING_UNICODE			40101
 #define IDM_ENCODING_UNICODEREV			40102
@@ -783,6 +784,9 @@
 #define IDS_EXPORT_FAIL					50040
 #define IDS_LOCKED						50041
 #define IDS_BINARY_FILE_LOCKED			50042
+#define IDS_PAGED_VIEW_LOCKED			50043
+#define IDS_HEX_VIEW_LOCKED				50044
+#define IDS_HEX_VIEW_FIND				50045
 #define IDS_CMDLINEHELP					60000
 #define IDS_EOLMODENAME_CRLF			62000
 #define IDS_EOLMODENAME_LF				62001
@@ -0,0 +1,308 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//
+// Chunks written while saving must join to the document, end at UTF-8 character boundaries,
+// and end after line breaks for stateful encodings, so a converter that resets its state at
+// end of each chunk writes the same bytes as converting the whole document at once.
+// Chunks converted while loading must end at character boundaries of the DBCS code page,
+// including text without a byte below 0x30 near the end, and join to the text.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "EditChunk.h"
+
+static int failures;
+
+static void Fail(const char *what, size_t chunkSize, int bLineBreak, size_t position) {
+	if (failures < 20) {
+		printf("%s: chunk size %zu, line break %d, position %zu\n", what, chunkSize, bLineBreak, position);
+	}
+	failures++;
+}
+
+static const char *const fragments[] = {
+	"word", "x", "\t", " ", "\n", "\r\n", "\xC3\xA9", "\xE4\xB8\xAD\xE6\x96\x87", "\xF0\x9F\x98\x80",
+	"\xE2\x80\x8B", "12345", "+", "-",
+};
+
+// deterministic UTF-8 text, some with long runs without line breaks.
+static size_t MakeText(char *text, size_t size, unsigned int seed, int lineBreaks) {
+	size_t length = 0;
+	for (;;) {
+		seed = seed * 1103515245 + 12345;
+		const char *fragment = fragments[(seed >> 16) % (sizeof(fragments)/sizeof(fragments[0]))];
+		if (!lineBreaks && (fragment[0] == '\n' || fragment[0] == '\r')) {
+			continue;
+		}
+		const size_t len = strlen(fragment);
+		if (length + len > size) {
+			return length;
+		}
+		memcpy(text + length, fragment, len);
+		length += len;
+	}
+}
+
+static int IsTrailByte(char ch) {
+	return ((uint8_t)ch & 0xC0) == 0x80;
+}
+
+// a toy stateful encoder: non-ASCII bytes are written between SO and SI, and the state is reset
+// at end of each conversion, as converters for ISO-2022 do.
+static size_t Encode(char *output, const char *lpData, size_t cbData) {
+	size_t length = 0;
+	int shifted = 0;
+	for (size_t i = 0; i < cbData; i++) {
+		const int ascii = (uint8_t)lpData[i] < 0x80;
+		if (ascii == shifted) {
+			output[length++] = shifted ? '\x0F' : '\x0E';
+			shifted = !shifted;
+		}
+		output[length++] = lpData[i];
+	}
+	if (shifted) {
+		output[length++] = '\x0F';
+	}
+	return length;
+}
+
+typedef struct ChunkTest {
+	const char *text;
+	size_t length;
+	size_t chunkSize;
+	int bLineBreak;
+	size_t position;	// read position
+	size_t written;		// bytes written
+	size_t chunks;
+	size_t stopAfter;	// chunks written before stopping
+	char *encoded;
+	size_t cbEncoded;
+} ChunkTest;
+
+static const char *ChunkTest_Read(void *context, size_t position, size_t cbData) {
+	ChunkTest *test = (ChunkTest *)context;
+	if (position != test->written || cbData > test->chunkSize || position + cbData > test->length) {
+		Fail("read outside of text", test->chunkSize, test->bLineBreak, position);
+	}
+	test->position = position;
+	return test->text + position;
+}
+
+static int ChunkTest_Write(void *context, const char *lpData, size_t cbData) {
+	ChunkTest *test = (ChunkTest *)context;
+	const size_t position = test->written;
+	if (lpData != test->text + position || cbData == 0) {
+		Fail("chunk not at read position", test->chunkSize, test->bLineBreak, position);
+		return 0;
+	}
+	const size_t end = position + cbData;
+	if (end < test->length && IsTrailByte(test->text[end])) {
+		Fail("chunk ends inside a character", test->chunkSize, test->bLineBreak, end);
+	}
+	if (test->bLineBreak && end < test->length && test->text[end - 1] != '\n' && memchr(lpData, '\n', cbData) != NULL) {
+		Fail("chunk not ended after line break", test->chunkSize, test->bLineBreak, end);
+	}
+	test->cbEncoded += Encode(test->encoded + test->cbEncoded, lpData, cbData);
+	test->written = end;
+	test->chunks++;
+	return test->chunks != test->stopAfter;
+}
+
+static void TestSplit(const char *text, size_t length, size_t chunkSize, int bLineBreak, char *encoded, const char *expected, size_t cbExpected) {
+	ChunkTest test;
+	memset(&test, 0, sizeof(test));
+	test.text = text;
+	test.length = length;
+	test.chunkSize = chunkSize;
+	test.bLineBreak = bLineBreak;
+	test.encoded = encoded;
+	if (!EditChunk_SplitUTF8(length, chunkSize, bLineBreak, ChunkTest_Read, ChunkTest_Write, &test)) {
+		Fail("split stopped", chunkSize, bLineBreak, test.written);
+	}
+	if (test.written != length) {
+		Fail("chunks shorter than text", chunkSize, bLineBreak, test.written);
+	}
+	if (expected != NULL && (test.cbEncoded != cbExpected || memcmp(encoded, expected, cbExpected) != 0)) {
+		Fail("encoded chunks differ from encoded text", chunkSize, bLineBreak, test.cbEncoded);
+	}
+
+	// writer returning zero stops splitting
+	if (test.chunks > 1) {
+		const size_t chunks = test.chunks;
+		memset(&test, 0, sizeof(test));
+		test.text = text;
+		test.length = length;
+		test.chunkSize = chunkSize;
+		test.bLineBreak = bLineBreak;
+		test.encoded = encoded;
+		test.stopAfter = chunks / 2;
+		if (EditChunk_SplitUTF8(length, chunkSize, bLineBreak, ChunkTest_Read, ChunkTest_Write, &test) || test.chunks != chunks / 2) {
+			Fail("split not stopped by writer", chunkSize, bLineBreak, test.written);
+		}
+	}
+}
+
+static void TestAlignedLength(const char *text, size_t length) {
+	for (size_t cut = 4; cut < length; cut++) {
+		const size_t aligned = UTF8_AlignedLength(text, cut);
+		if (aligned > cut || cut - aligned > 3 || IsTrailByte(text[aligned]) || (!IsTrailByte(text[cut]) && aligned != cut)) {
+			Fail("aligned length", cut, 0, aligned);
+		}
+		const size_t lineAligned = UTF8_LineAlignedLength(text, cut);
+		const char *lf = NULL;
+		for (size_t pos = cut; pos != 0; pos--) {
+			if (text[pos - 1] == '\n') {
+				lf = text + pos;
+				break;
+			}
+		}
+		if (lineAligned != (lf ? (size_t)(lf - text) : aligned)) {
+			Fail("line aligned length", cut, 1, lineAligned);
+		}
+	}
+}
+
+typedef struct DBCSCodePage {
+	unsigned codePage;
+	uint8_t leadRanges[6];	// pairs of first and last byte
+	uint8_t trailRanges[6];
+} DBCSCodePage;
+
+static const DBCSCodePage dbcsCodePages[] = {
+	{ 932, { 0x81, 0x9F, 0xE0, 0xFC }, { 0x40, 0x7E, 0x80, 0xFC } },
+	{ 936, { 0x81, 0xFE }, { 0x40, 0x7E, 0x80, 0xFE } },
+	{ 949, { 0x81, 0xFE }, { 0x41, 0x5A, 0x61, 0x7A, 0x81, 0xFE } },
+	{ 950, { 0x81, 0xFE }, { 0x40, 0x7E, 0xA1, 0xFE } },
+	{ 1361, { 0x84, 0xD3, 0xD8, 0xDE, 0xE0, 0xF9 }, { 0x31, 0x7E, 0x81, 0xFE } },
+	{ 54936, { 0x81, 0xFE }, { 0x40, 0x7E, 0x80, 0xFE } },
+};
+
+static uint8_t RandomInRanges(const uint8_t *ranges, unsigned int *seed) {
+	unsigned count = 0;
+	while (count < 3 && ranges[count * 2] != 0) {
+		count++;
+	}
+	*seed = *seed * 1103515245 + 12345;
+	const uint8_t *range = ranges + 2 * ((*seed >> 16) % count);
+	*seed = *seed * 1103515245 + 12345;
+	return (uint8_t)(range[0] + (*seed >> 16) % (range[1] - range[0] + 1));
+}
+
+// DBCS text with ASCII trail bytes, boundary[i] is set when a character starts at i.
+static size_t MakeDBCSText(const DBCSCodePage *page, char *text, char *boundary, size_t size, unsigned int seed, int spaces) {
+	size_t length = 0;
+	while (length + 4 <= size) {
+		boundary[length] = 1;
+		seed = seed * 1103515245 + 12345;
+		const unsigned kind = (seed >> 16) % 8;
+		if (kind == 0) {
+			text[length++] = spaces ? ' ' : 'a';
+		} else if (kind == 1) {
+			text[length++] = (char)('0' + (seed >> 20) % 10);
+		} else if (kind == 2 && page->codePage == 54936) {
+			text[length++] = (char)RandomInRanges(page->leadRanges, &seed);
+			text[length++] = (char)('0' + (seed >> 20) % 10);
+			text[length++] = (char)RandomInRanges(page->leadRanges, &seed);
+			text[length++] = (char)('0' + (seed >> 24) % 10);
+		} else {
+			text[length++] = (char)RandomInRanges(page->leadRanges, &seed);
+			text[length++] = (char)RandomInRanges(page->trailRanges, &seed);
+		}
+	}
+	boundary[length] = 1;
+	return length;
+}
+
+typedef struct DBCSSplit {
+	size_t chunkSize;
+	const char *text;
+	const char *boundary;
+	size_t written;
+} DBCSSplit;
+
+static const char *DBCSSplit_Read(void *context, size_t position, size_t cbData) {
+	(void)cbData;
+	const DBCSSplit *split = (const DBCSSplit *)context;
+	return split->text + position;
+}
+
+static int DBCSSplit_Write(void *context, const char *lpData, size_t cbData) {
+	DBCSSplit *split = (DBCSSplit *)context;
+	if (lpData != split->text + split->written || cbData == 0 || !split->boundary[split->written + cbData]) {
+		Fail("DBCS chunk not at character boundary", split->chunkSize, 0, split->written);
+		return 0;
+	}
+	split->written += cbData;
+	return 1;
+}
+
+static void TestDBCSAlignedLength(char *text, char *boundary, size_t size) {
+	for (size_t i = 0; i < sizeof(dbcsCodePages)/sizeof(dbcsCodePages[0]); i++) {
+		const DBCSCodePage *page = &dbcsCodePages[i];
+		for (int spaces = 0; spaces <= 1; spaces++) {
+			memset(boundary, 0, size + 1);
+			const size_t length = MakeDBCSText(page, text, boundary, size, page->codePage + spaces, spaces);
+			for (size_t cut = 4; cut < length; cut++) {
+				const size_t aligned = EditConvert_AlignedLength(page->codePage, text, cut);
+				if (aligned > cut || cut - aligned > 256 || aligned == 0 || !boundary[aligned]) {
+					Fail("DBCS aligned length", cut, spaces, aligned);
+				}
+			}
+			const size_t chunkSizes[] = { 4, 5, 7, 100, 300 };
+			for (size_t j = 0; j < sizeof(chunkSizes)/sizeof(chunkSizes[0]); j++) {
+				DBCSSplit split = { chunkSizes[j], text, boundary, 0 };
+				if (!EditChunk_Split(page->codePage, length, chunkSizes[j], DBCSSplit_Read, DBCSSplit_Write, &split) || split.written != length) {
+					Fail("DBCS chunks shorter than text", chunkSizes[j], spaces, split.written);
+				}
+			}
+		}
+	}
+
+	// single byte code pages are not split, UTF-7 is split before a base64 run
+	const char *utf7 = "A +ZeVnLIqe- text +ZeVnLIqe-";
+	const size_t length = strlen(utf7);
+	if (EditConvert_AlignedLength(1252, utf7, length - 3) != length - 3) {
+		Fail("single byte aligned length", length - 3, 0, EditConvert_AlignedLength(1252, utf7, length - 3));
+	}
+	if (EditConvert_AlignedLength(65000, utf7, length - 3) != 18) {
+		Fail("UTF-7 aligned length", length - 3, 0, EditConvert_AlignedLength(65000, utf7, length - 3));
+	}
+}
+
+int main(void) {
+	enum { textSize = 200000 };
+	char *text = (char *)malloc(textSize);
+	char *encoded = (char *)malloc(textSize * 3);
+	char *expected = (char *)malloc(textSize * 3);
+	const size_t chunkSizes[] = { 4, 5, 7, 16, 100, 4096, 65536, textSize };
+	int runs = 0;
+
+	TestDBCSAlignedLength(text, encoded, 4000);
+
+	for (int lineBreaks = 0; lineBreaks <= 1; lineBreaks++) {
+		const size_t length = MakeText(text, textSize, 1 + lineBreaks, lineBreaks);
+		TestAlignedLength(text, 2000);
+		for (size_t cut = 4; cut < 2000; cut++) {
+			if (EditConvert_AlignedLength(65001, text, cut) != UTF8_AlignedLength(text, cut)) {
+				Fail("UTF-8 aligned length", cut, 0, EditConvert_AlignedLength(65001, text, cut));
+			}
+		}
+		const size_t cbExpected = Encode(expected, text, length);
+		for (size_t i = 0; i < sizeof(chunkSizes)/sizeof(chunkSizes[0]); i++) {
+			const size_t chunkSize = chunkSizes[i];
+			TestSplit(text, length, chunkSize, 0, encoded, NULL, 0);
+			// lines are shorter than the chunk, so the converter is in initial state at each chunk end
+			TestSplit(text, length, chunkSize, 1, encoded, (lineBreaks && chunkSize >= 4096) ? expected : NULL, cbExpected);
+			runs += 2;
+		}
+	}
+
+	free(text);
+	free(encoded);
+	free(expected);
+	printf("Split text in %d runs, %d failed.\n", runs, failures);
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,253 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//
+// Text in the corpus directory, named <language>.<code page>.txt, must be detected as its code
+// page: UTF-16 without BOM in either byte order (including CJK text with NUL in low byte), UTF-8,
+// and legacy code pages, where the default code page wins ties and is kept when it can't be
+// scored. TestEditDetect --bench prints the time to rank encodings of large buffers instead.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "EditDetect.h"
+
+static int failures;
+
+static void Fail(const char *what, const char *name, unsigned codePage, unsigned detected) {
+	if (failures < 20) {
+		printf("%s: %s, code page %u, detected %u\n", what, name, codePage, detected);
+	}
+	failures++;
+}
+
+typedef struct CorpusFile {
+	const char *name;
+	unsigned codePage;
+} CorpusFile;
+
+static const CorpusFile corpus[] = {
+	{ "cs.1250.txt", 1250 },
+	{ "de.1252.txt", 1252 },
+	{ "el.1253.txt", 1253 },
+	{ "en.1200.txt", 1200 },
+	{ "en.1201.txt", 1201 },
+	{ "fr.1252.txt", 1252 },
+	{ "ja.1200.txt", 1200 },
+	{ "ja.65001.txt", 65001 },
+	{ "ja.932.txt", 932 },
+	{ "ko.1200.txt", 1200 },
+	{ "ko.1201.txt", 1201 },
+	{ "ko.949.txt", 949 },
+	{ "pl.1250.txt", 1250 },
+	{ "ru.1200.txt", 1200 },
+	{ "ru.1201.txt", 1201 },
+	{ "ru.1251.txt", 1251 },
+	{ "ru.65001.txt", 65001 },
+	{ "zh-TW.950.txt", 950 },
+	{ "zh.1200.txt", 1200 },
+	{ "zh.1201.txt", 1201 },
+	{ "zh.65001.txt", 65001 },
+	{ "zh.936.txt", 936 },
+};
+
+// scored legacy code pages, used as default code page.
+static const unsigned legacyCodePages[] = { 1250, 1251, 1252, 1253, 932, 936, 949, 950 };
+
+static char *ReadCorpus(const char *directory, const char *name, size_t *length) {
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s", directory, name);
+	FILE *fp = fopen(path, "rb");
+	if (fp == NULL) {
+		Fail("can't open file", path, 0, 0);
+		return NULL;
+	}
+	fseek(fp, 0, SEEK_END);
+	const long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	char *text = (char *)malloc(size + 1);
+	*length = fread(text, 1, size, fp);
+	fclose(fp);
+	return text;
+}
+
+// single byte code pages with letters at the same bytes can't be told apart by structure,
+// so the default code page is kept within ENCODING_DETECT_MARGIN.
+static int IsAlike(unsigned codePage, unsigned other) {
+	const int latin = codePage == 1250 || codePage == 1252;
+	const int otherLatin = other == 1250 || other == 1252;
+	const int script = codePage == 1251 || codePage == 1253;
+	const int otherScript = other == 1251 || other == 1253;
+	return (latin && otherLatin) || (script && otherScript);
+}
+
+static void TestCorpusFile(const char *name, unsigned codePage, const char *text, size_t length) {
+	EncodingScore scores[MAX_ENCODING_SCORES];
+	const int count = EncodingDetect_Rank(text, length, 0, scores, MAX_ENCODING_SCORES);
+	if (count == 0 || !EncodingDetect_IsCompatible(scores[0].codePage, codePage)) {
+		Fail("not ranked first", name, codePage, (count == 0) ? 0 : scores[0].codePage);
+	}
+	for (int i = 1; i < count; i++) {
+		if (scores[i].confidence > scores[i - 1].confidence) {
+			Fail("scores not sorted", name, codePage, scores[i].codePage);
+		}
+	}
+
+	// same rule as IsUnicode() for text without BOM
+	const int confidence = EncodingDetect_UTF16(text, length, 0);
+	const int confidenceBE = EncodingDetect_UTF16(text, length, 1);
+	const int isUTF16 = (confidence > confidenceBE ? confidence : confidenceBE) >= ENCODING_DETECT_THRESHOLD - ENCODING_DETECT_MARGIN;
+	if (codePage == 1200 || codePage == 1201) {
+		if (!isUTF16) {
+			Fail("UTF-16 rejected", name, codePage, 0);
+		} else if ((confidenceBE > confidence) != (codePage == 1201)) {
+			Fail("wrong UTF-16 byte order", name, codePage, (confidenceBE > confidence) ? 1201 : 1200);
+		}
+		return;
+	}
+	if (isUTF16) {
+		Fail("text detected as UTF-16", name, codePage, (confidenceBE > confidence) ? 1201 : 1200);
+	}
+	if (codePage == 65001) {
+		return;
+	}
+
+	// default code page is kept when it's the detected one
+	unsigned detected = EncodingDetect_Legacy(text, length, codePage);
+	if (detected != codePage) {
+		Fail("default code page not kept", name, codePage, detected);
+	}
+	// other default code pages are replaced
+	for (size_t i = 0; i < sizeof(legacyCodePages)/sizeof(legacyCodePages[0]); i++) {
+		const unsigned defaultCodePage = legacyCodePages[i];
+		if (IsAlike(codePage, defaultCodePage)) {
+			continue;
+		}
+		detected = EncodingDetect_Legacy(text, length, defaultCodePage);
+		if (!EncodingDetect_IsCompatible(detected, codePage)) {
+			Fail("legacy code page", name, defaultCodePage, detected);
+		}
+	}
+	// detector doesn't know Windows-1254, so it's kept
+	detected = EncodingDetect_Legacy(text, length, 1254);
+	if (detected != 1254) {
+		Fail("unscored default code page replaced", name, 1254, detected);
+	}
+}
+
+static void TestTie(void) {
+	// same letters in Windows-1250 and Windows-1252
+	char text[1024];
+	size_t length = 0;
+	while (length + 8 < sizeof(text)) {
+		memcpy(text + length, "caf\xE9 d\xE9j\xE0 ", 9);
+		length += 9;
+	}
+	text[length - 1] = '\n';
+	const unsigned defaults[] = { 1250, 1252 };
+	for (int i = 0; i < 2; i++) {
+		EncodingScore scores[MAX_ENCODING_SCORES];
+		const int count = EncodingDetect_Rank(text, length, defaults[i], scores, MAX_ENCODING_SCORES);
+		if (count < 2 || scores[0].confidence != scores[1].confidence) {
+			Fail("Latin text without tie", "tie", defaults[i], (count == 0) ? 0 : scores[0].codePage);
+		} else if (scores[0].codePage != defaults[i]) {
+			Fail("tie not won by default code page", "tie", defaults[i], scores[0].codePage);
+		}
+		const unsigned detected = EncodingDetect_Legacy(text, length, defaults[i]);
+		if (detected != defaults[i]) {
+			Fail("tie not won by default code page", "legacy", defaults[i], detected);
+		}
+	}
+}
+
+static void TestBinary(void) {
+	enum { size = 64 * 1024 };
+	char *data = (char *)malloc(size);
+	uint32_t seed = 1;
+	for (int pass = 0; pass < 2; pass++) {
+		for (size_t i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			const uint8_t value = (uint8_t)(seed >> 16);
+			// second pass: mostly zero, as in executable and object files
+			data[i] = (pass == 0 || (value & 3) == 0) ? (char)value : '\0';
+		}
+		const int confidence = EncodingDetect_UTF16(data, size, 0);
+		const int confidenceBE = EncodingDetect_UTF16(data, size, 1);
+		if (confidence >= ENCODING_DETECT_THRESHOLD - ENCODING_DETECT_MARGIN || confidenceBE >= ENCODING_DETECT_THRESHOLD - ENCODING_DETECT_MARGIN) {
+			Fail("binary detected as UTF-16", "binary", pass, (unsigned)(confidence > confidenceBE ? confidence : confidenceBE));
+		}
+		const unsigned detected = EncodingDetect_Legacy(data, size, 1252);
+		if (detected != 1252) {
+			Fail("binary detected as legacy code page", "binary", pass, detected);
+		}
+	}
+	free(data);
+}
+
+static int Test(const char *directory) {
+	int runs = 0;
+	for (size_t i = 0; i < sizeof(corpus)/sizeof(corpus[0]); i++) {
+		size_t length = 0;
+		char *text = ReadCorpus(directory, corpus[i].name, &length);
+		if (text != NULL) {
+			TestCorpusFile(corpus[i].name, corpus[i].codePage, text, length);
+			free(text);
+			runs++;
+		}
+	}
+	TestTie();
+	TestBinary();
+	printf("Detected %d corpus files, %d failed.\n", runs, failures);
+	return (failures == 0) ? 0 : 1;
+}
+
+// corpus files repeated into large buffers: the detector only reads a few windows,
+// so the time per buffer should not grow with its size.
+static int Bench(const char *directory) {
+	enum { repeat = 100 };
+	const size_t sizes[] = { 64 * 1024, 1024 * 1024, 64 * 1024 * 1024 };
+	char *buffer = (char *)malloc(sizes[2]);
+
+	printf("microseconds to rank encodings\n%-16s", "file");
+	for (size_t j = 0; j < sizeof(sizes)/sizeof(sizes[0]); j++) {
+		printf("%8zuK", sizes[j] / 1024);
+	}
+	printf("\n");
+	for (size_t i = 0; i < sizeof(corpus)/sizeof(corpus[0]); i++) {
+		size_t length = 0;
+		char *text = ReadCorpus(directory, corpus[i].name, &length);
+		if (text == NULL) {
+			continue;
+		}
+		printf("%-16s", corpus[i].name);
+		for (size_t j = 0; j < sizeof(sizes)/sizeof(sizes[0]); j++) {
+			// whole copies of the text keep UTF-16 units aligned
+			const size_t size = sizes[j] - sizes[j] % length;
+			for (size_t offset = 0; offset < size; offset += length) {
+				memcpy(buffer + offset, text, length);
+			}
+			EncodingScore scores[MAX_ENCODING_SCORES];
+			const clock_t start = clock();
+			for (int k = 0; k < repeat; k++) {
+				if (EncodingDetect_Rank(buffer, size, 0, scores, MAX_ENCODING_SCORES) == 0 || !EncodingDetect_IsCompatible(scores[0].codePage, corpus[i].codePage)) {
+					Fail("not ranked first", corpus[i].name, corpus[i].codePage, scores[0].codePage);
+				}
+			}
+			const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+			printf("%9.0f", seconds * 1e6 / repeat);
+		}
+		printf("\n");
+		free(text);
+	}
+	free(buffer);
+	return (failures == 0) ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+		return Bench((argc > 2) ? argv[2] : "corpus");
+	}
+	return Test((argc > 1) ? argv[1] : "corpus");
+}
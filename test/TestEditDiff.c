@@ -0,0 +1,164 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//
+// Hunks found between old and new text must turn old text into new text when applied from
+// end, start and end at line boundaries, and cover only changed lines, e.g. a reload with one
+// changed line replaces that line only, so folds and styles of other lines are kept.
+// Trimmed hunks must still turn old text into new text.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "EditDiff.h"
+
+static int failures;
+
+static void Fail(const char *what, int round, uint32_t position) {
+	if (failures < 20) {
+		printf("%s: round %d, position %u\n", what, round, position);
+	}
+	failures++;
+}
+
+static uint32_t Random(uint32_t *seed, uint32_t range) {
+	*seed = *seed * 1103515245 + 12345;
+	return (*seed >> 8) % range;
+}
+
+static const char *const eols[] = { "\r\n", "\n", "\r" };
+
+// text of count lines, each is "line <number>" with random line ending.
+static uint32_t MakeLines(char *text, uint32_t *lineStarts, uint32_t count, uint32_t *seed) {
+	uint32_t length = 0;
+	for (uint32_t line = 0; line < count; line++) {
+		lineStarts[line] = length;
+		length += sprintf(text + length, "line %u%s", Random(seed, 100), eols[Random(seed, 4) % 3]);
+	}
+	lineStarts[count] = length;
+	return length;
+}
+
+static int IsLineBoundary(const char *text, uint32_t pos, uint32_t length) {
+	return pos == 0 || pos == length || text[pos - 1] == '\n' || (text[pos - 1] == '\r' && text[pos] != '\n');
+}
+
+// apply hunks from end to old text, check the result is new text.
+static void CheckHunks(int round, const char *oldText, uint32_t cbOld, const char *newText, uint32_t cbNew, const EditDiffHunk *hunks, int count, char *buffer, int lineBoundary) {
+	uint32_t length = cbOld;
+	memcpy(buffer, oldText, cbOld);
+	for (int i = count; i != 0; i--) {
+		const EditDiffHunk *hunk = &hunks[i - 1];
+		if (hunk->oldStart > hunk->oldEnd || hunk->oldEnd > cbOld || hunk->newStart > hunk->newEnd || hunk->newEnd > cbNew
+			|| (i != count && hunk->oldEnd > hunks[i].oldStart)) {
+			Fail("hunk out of range", round, hunk->oldStart);
+			return;
+		}
+		if (lineBoundary && (!IsLineBoundary(oldText, hunk->oldStart, cbOld) || !IsLineBoundary(oldText, hunk->oldEnd, cbOld)
+			|| !IsLineBoundary(newText, hunk->newStart, cbNew) || !IsLineBoundary(newText, hunk->newEnd, cbNew))) {
+			Fail("hunk not at line boundary", round, hunk->oldStart);
+		}
+		const uint32_t cbInsert = hunk->newEnd - hunk->newStart;
+		memmove(buffer + hunk->oldStart + cbInsert, buffer + hunk->oldEnd, length - hunk->oldEnd);
+		memcpy(buffer + hunk->oldStart, newText + hunk->newStart, cbInsert);
+		length = length - (hunk->oldEnd - hunk->oldStart) + cbInsert;
+	}
+	if (length != cbNew || memcmp(buffer, newText, cbNew) != 0) {
+		Fail("hunks don't make new text", round, length);
+	}
+}
+
+int main(void) {
+	enum { maxLines = 2000, textSize = maxLines * 64 };
+	char *oldText = (char *)malloc(textSize);
+	char *newText = (char *)malloc(textSize);
+	char *buffer = (char *)malloc(textSize);
+	uint32_t *lineStarts = (uint32_t *)malloc((maxLines + 1) * sizeof(uint32_t));
+	uint32_t seed = 1;
+	int rounds = 0;
+
+	for (int round = 0; round < 500; round++) {
+		const uint32_t lineCount = 1 + Random(&seed, (round < 400) ? 100 : maxLines);
+		const uint32_t cbOld = MakeLines(oldText, lineStarts, lineCount, &seed);
+
+		// one changed line with same line ending, only that line is replaced.
+		const uint32_t line = Random(&seed, lineCount);
+		const uint32_t start = lineStarts[line];
+		const uint32_t end = lineStarts[line + 1];
+		uint32_t eol = start;
+		while (oldText[eol] != '\r' && oldText[eol] != '\n') {
+			eol++;
+		}
+		uint32_t cbNew = start;
+		memcpy(newText, oldText, start);
+		cbNew += sprintf(newText + cbNew, "changed %u", line);
+		memcpy(newText + cbNew, oldText + eol, cbOld - eol);
+		cbNew += cbOld - eol;
+		EditDiffHunk *hunks = NULL;
+		int count = EditDiff_GetHunks(oldText, cbOld, newText, cbNew, &hunks);
+		if (count != 1 || hunks[0].oldStart != start || hunks[0].oldEnd != end || hunks[0].newStart != start) {
+			Fail("one changed line", round, start);
+		} else {
+			CheckHunks(round, oldText, cbOld, newText, cbNew, hunks, count, buffer, 1);
+			// only "line" and the number are replaced, line ending is kept.
+			EditDiff_TrimHunk(oldText, newText, &hunks[0]);
+			if (memchr(oldText + hunks[0].oldStart, '\n', hunks[0].oldEnd - hunks[0].oldStart) != NULL
+				|| memchr(oldText + hunks[0].oldStart, '\r', hunks[0].oldEnd - hunks[0].oldStart) != NULL) {
+				Fail("trimmed line ending", round, start);
+			}
+			CheckHunks(round, oldText, cbOld, newText, cbNew, hunks, count, buffer, 0);
+		}
+		free(hunks);
+
+		// random inserted, deleted and changed lines.
+		cbNew = 0;
+		for (uint32_t i = 0; i < lineCount; i++) {
+			const uint32_t action = Random(&seed, 40);
+			if (action == 0) {
+				cbNew += sprintf(newText + cbNew, "inserted %u%s", i, eols[Random(&seed, 3)]);
+			}
+			if (action == 1) {
+				continue;
+			}
+			if (action == 2) {
+				cbNew += sprintf(newText + cbNew, "changed %u%s", i, eols[Random(&seed, 3)]);
+				continue;
+			}
+			memcpy(newText + cbNew, oldText + lineStarts[i], lineStarts[i + 1] - lineStarts[i]);
+			cbNew += lineStarts[i + 1] - lineStarts[i];
+		}
+		hunks = NULL;
+		count = EditDiff_GetHunks(oldText, cbOld, newText, cbNew, &hunks);
+		if (count < 0) {
+			Fail("out of memory", round, 0);
+		} else {
+			CheckHunks(round, oldText, cbOld, newText, cbNew, hunks, count, buffer, 1);
+			for (int i = 0; i < count; i++) {
+				EditDiff_TrimHunk(oldText, newText, &hunks[i]);
+			}
+			CheckHunks(round, oldText, cbOld, newText, cbNew, hunks, count, buffer, 0);
+		}
+		free(hunks);
+		rounds++;
+	}
+
+	// CR and LF of a line ending are not split.
+	const char *oldCRLF = "one\r\ntwo\r\nthree\r\n";
+	const char *newCRLF = "one\r\ntwo\r\n\nthree\r\n";
+	EditDiffHunk *hunks = NULL;
+	const int count = EditDiff_GetHunks(oldCRLF, (uint32_t)strlen(oldCRLF), newCRLF, (uint32_t)strlen(newCRLF), &hunks);
+	if (count != 1) {
+		Fail("line ending", 0, 0);
+	} else {
+		CheckHunks(0, oldCRLF, (uint32_t)strlen(oldCRLF), newCRLF, (uint32_t)strlen(newCRLF), hunks, count, buffer, 1);
+	}
+	free(hunks);
+
+	free(oldText);
+	free(newText);
+	free(buffer);
+	free(lineStarts);
+	printf("Compared text in %d rounds, %d failed.\n", rounds, failures);
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//
+// Chunks of a sparse file larger than 4 GiB must be read at 64-bit positions and end at
+// character boundaries, including characters across 2 GiB and 4 GiB, where 32-bit int and
+// DWORD lengths wrap. Needs a file system with sparse files, it's skipped otherwise.
+
+#define _FILE_OFFSET_BITS	64
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "EditChunk.h"
+
+#define GiB		((uint64_t)1 << 30)
+#define CHUNK_SIZE	(64*1024*1024)
+
+static int failures;
+
+static void Fail(const char *what, unsigned codePage, uint64_t position) {
+	if (failures < 20) {
+		printf("%s: code page %u, position %llu\n", what, codePage, (unsigned long long)position);
+	}
+	failures++;
+}
+
+typedef struct Marker {
+	uint64_t position;
+	const char *text;
+} Marker;
+
+// characters across chunk boundaries at 2 GiB, 4 GiB and the chunk after 4 GiB.
+static const Marker utf8Markers[] = {
+	{ 2*GiB - 1, "\xE4\xB8\xAD" },
+	{ 4*GiB - 2, "\xF0\x9F\x98\x80" },
+	{ 4*GiB + CHUNK_SIZE - 1, "\xC3\xA9" },
+};
+
+// GB18030 two and four byte characters with ASCII trail bytes.
+static const Marker gb18030Markers[] = {
+	{ 2*GiB - 1, "\xD6\x40" },
+	{ 4*GiB - 2, "\x81\x30\x81\x30" },
+	{ 4*GiB + CHUNK_SIZE - 1, "\xD6\xD0" },
+};
+
+typedef struct LargeFile {
+	int fd;
+	unsigned codePage;
+	const Marker *markers;
+	size_t markerCount;
+	uint64_t written;
+	char *buffer;
+} LargeFile;
+
+static const char *LargeFile_Read(void *context, size_t position, size_t cbData) {
+	LargeFile *file = (LargeFile *)context;
+	if (position != file->written || cbData > CHUNK_SIZE) {
+		Fail("read outside of chunk", file->codePage, position);
+	}
+	size_t cbRead = 0;
+	while (cbRead < cbData) {
+		const ssize_t result = pread(file->fd, file->buffer + cbRead, cbData - cbRead, (off_t)(position + cbRead));
+		if (result <= 0) {
+			Fail("can't read file", file->codePage, position + cbRead);
+			break;
+		}
+		cbRead += (size_t)result;
+	}
+	return file->buffer;
+}
+
+static int LargeFile_Write(void *context, const char *lpData, size_t cbData) {
+	LargeFile *file = (LargeFile *)context;
+	const uint64_t start = file->written;
+	const uint64_t end = start + cbData;
+	if (lpData != file->buffer || cbData == 0) {
+		Fail("chunk not at read position", file->codePage, start);
+		return 0;
+	}
+	for (size_t i = 0; i < file->markerCount; i++) {
+		const Marker *marker = &file->markers[i];
+		const uint64_t markerEnd = marker->position + strlen(marker->text);
+		if (end > marker->position && end < markerEnd) {
+			Fail("chunk ends inside a character", file->codePage, end);
+		}
+		for (uint64_t pos = marker->position; pos < markerEnd; pos++) {
+			if (pos >= start && pos < end && lpData[pos - start] != marker->text[pos - marker->position]) {
+				Fail("chunk read at wrong position", file->codePage, pos);
+			}
+		}
+	}
+	file->written = end;
+	return 1;
+}
+
+static void WriteMarkers(int fd, const Marker *markers, size_t count, int clear) {
+	for (size_t i = 0; i < count; i++) {
+		const size_t length = strlen(markers[i].text);
+		const char zeros[8] = "";
+		if (pwrite(fd, clear ? zeros : markers[i].text, length, (off_t)markers[i].position) != (ssize_t)length) {
+			Fail("can't write marker", 0, markers[i].position);
+		}
+	}
+}
+
+static void TestSplit(int fd, uint64_t size, unsigned codePage, int utf8Split, const Marker *markers, size_t count, char *buffer) {
+	LargeFile file;
+	memset(&file, 0, sizeof(file));
+	file.fd = fd;
+	file.codePage = codePage;
+	file.markers = markers;
+	file.markerCount = count;
+	file.buffer = buffer;
+	WriteMarkers(fd, markers, count, 0);
+	const int result = utf8Split ? EditChunk_SplitUTF8((size_t)size, CHUNK_SIZE, 0, LargeFile_Read, LargeFile_Write, &file)
+		: EditChunk_Split(codePage, (size_t)size, CHUNK_SIZE, LargeFile_Read, LargeFile_Write, &file);
+	if (!result || file.written != size) {
+		Fail("chunks shorter than file", codePage, file.written);
+	}
+	WriteMarkers(fd, markers, count, 1);
+}
+
+int main(void) {
+	if (sizeof(size_t) < sizeof(uint64_t)) {
+		printf("Skipped large file test for 32-bit build.\n");
+		return 0;
+	}
+
+	const char *directory = getenv("TMPDIR");
+	char path[512];
+	snprintf(path, sizeof(path), "%s/TestEditLargeFileXXXXXX", (directory != NULL) ? directory : "/tmp");
+	const int fd = mkstemp(path);
+	const uint64_t size = 4*GiB + 2*CHUNK_SIZE + 123;
+	if (fd < 0 || ftruncate(fd, (off_t)size) != 0) {
+		printf("Skipped large file test, can't create sparse file %s.\n", path);
+		if (fd >= 0) {
+			close(fd);
+			unlink(path);
+		}
+		return 0;
+	}
+
+	char *buffer = (char *)malloc(CHUNK_SIZE);
+	TestSplit(fd, size, 65001, 1, utf8Markers, sizeof(utf8Markers)/sizeof(utf8Markers[0]), buffer);
+	TestSplit(fd, size, 65001, 0, utf8Markers, sizeof(utf8Markers)/sizeof(utf8Markers[0]), buffer);
+	TestSplit(fd, size, 54936, 0, gb18030Markers, sizeof(gb18030Markers)/sizeof(gb18030Markers[0]), buffer);
+
+	free(buffer);
+	close(fd);
+	unlink(path);
+	printf("Split %llu bytes sparse file, %d failed.\n", (unsigned long long)size, failures);
+	return (failures == 0) ? 0 : 1;
+}
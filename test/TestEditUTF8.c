@@ -0,0 +1,253 @@
+// This file is part of Notepad2.
+// See License.txt for details about distribution and modification.
+//
+// Each UTF-8 validator supported by the processor must report the same offset as a strict
+// reference validator, for text with all kinds of invalid sequences at any position and
+// alignment. TestEditUTF8 --bench prints the speed of each validator instead.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "EditUTF8.h"
+
+static const char *const validatorNames[] = { "scalar", "SSE2", "AVX2" };
+
+static int failures;
+
+static void Fail(const char *what, int validator, size_t length, size_t offset) {
+	if (failures < 20) {
+		printf("%s: %s validator, length %zu, offset %zu\n", what, validatorNames[validator], length, offset);
+	}
+	failures++;
+}
+
+// offset of the first byte that doesn't start a well-formed sequence, per Table 3-7 of the Unicode Standard.
+static size_t ReferenceFindInvalid(const uint8_t *text, size_t length) {
+	size_t i = 0;
+	while (i < length) {
+		const uint8_t lead = text[i];
+		if (lead < 0x80) {
+			i++;
+			continue;
+		}
+		size_t width;
+		if (lead >= 0xC2 && lead <= 0xDF) {
+			width = 2;
+		} else if (lead >= 0xE0 && lead <= 0xEF) {
+			width = 3;
+		} else if (lead >= 0xF0 && lead <= 0xF4) {
+			width = 4;
+		} else {
+			return i;
+		}
+		if (i + width > length) {
+			return i;
+		}
+		uint32_t ch = lead & (0x7F >> width);
+		for (size_t j = 1; j < width; j++) {
+			if ((text[i + j] & 0xC0) != 0x80) {
+				return i;
+			}
+			ch = (ch << 6) | (text[i + j] & 0x3F);
+		}
+		if ((width == 3 && ch < 0x800) || (width == 4 && (ch < 0x10000 || ch > 0x10FFFF)) || (ch >= 0xD800 && ch <= 0xDFFF)) {
+			return i;
+		}
+		i += width;
+	}
+	return length;
+}
+
+static uint32_t seed = 1;
+
+static uint32_t Random(uint32_t range) {
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 8) % range;
+}
+
+static size_t AppendUTF8(uint8_t *text, uint32_t ch) {
+	if (ch < 0x80) {
+		text[0] = (uint8_t)ch;
+		return 1;
+	}
+	if (ch < 0x800) {
+		text[0] = (uint8_t)(0xC0 | (ch >> 6));
+		text[1] = (uint8_t)(0x80 | (ch & 0x3F));
+		return 2;
+	}
+	if (ch < 0x10000) {
+		text[0] = (uint8_t)(0xE0 | (ch >> 12));
+		text[1] = (uint8_t)(0x80 | ((ch >> 6) & 0x3F));
+		text[2] = (uint8_t)(0x80 | (ch & 0x3F));
+		return 3;
+	}
+	text[0] = (uint8_t)(0xF0 | (ch >> 18));
+	text[1] = (uint8_t)(0x80 | ((ch >> 12) & 0x3F));
+	text[2] = (uint8_t)(0x80 | ((ch >> 6) & 0x3F));
+	text[3] = (uint8_t)(0x80 | (ch & 0x3F));
+	return 4;
+}
+
+enum {
+	ScriptASCII,
+	ScriptLatin,
+	ScriptCJK,
+	ScriptEmoji,
+	ScriptMixed,
+	ScriptCount,
+};
+
+static const char *const scriptNames[] = { "ascii", "latin", "cjk", "emoji", "mixed" };
+
+static uint32_t RandomCharacter(int script) {
+	switch (script) {
+	case ScriptASCII:
+		return Random(8) ? ('a' + Random(26)) : ' ';
+	case ScriptLatin:
+		// mostly ASCII with accented letters
+		return Random(5) ? ('a' + Random(26)) : (0xC0 + Random(0x180 - 0xC0));
+	case ScriptCJK:
+		return Random(8) ? (0x4E00 + Random(0x9FFF - 0x4E00)) : 0x3002;
+	case ScriptEmoji:
+		return Random(3) ? (0x1F600 + Random(0x50)) : ' ';
+	default:
+		switch (Random(6)) {
+		case 0:
+			return 0x80 + Random(0x800 - 0x80);
+		case 1:
+			return 0x800 + Random(0xD800 - 0x800);
+		case 2:
+			return 0xE000 + Random(0x10000 - 0xE000);
+		case 3:
+			return 0x10000 + Random(0x110000 - 0x10000);
+		default:
+			return Random(0x80);
+		}
+	}
+}
+
+static size_t MakeText(uint8_t *text, size_t size, int script) {
+	size_t length = 0;
+	while (length + 4 <= size) {
+		length += AppendUTF8(text + length, RandomCharacter(script));
+	}
+	return length;
+}
+
+static const uint8_t *const mistakes[] = {
+	(const uint8_t *)"\x80", (const uint8_t *)"\xBF", (const uint8_t *)"\xC0\x80", (const uint8_t *)"\xC1\xBF",
+	(const uint8_t *)"\xE0\x80\x80", (const uint8_t *)"\xE0\x9F\xBF", (const uint8_t *)"\xED\xA0\x80", (const uint8_t *)"\xED\xBF\xBF",
+	(const uint8_t *)"\xF0\x80\x80\x80", (const uint8_t *)"\xF0\x8F\xBF\xBF", (const uint8_t *)"\xF4\x90\x80\x80", (const uint8_t *)"\xF5\x80\x80\x80",
+	(const uint8_t *)"\xFE", (const uint8_t *)"\xFF", (const uint8_t *)"\xC3", (const uint8_t *)"\xE4\xB8", (const uint8_t *)"\xF0\x9F\x98",
+	(const uint8_t *)"\xC3\xC3", (const uint8_t *)"\xE4\x41\x80",
+};
+
+// overwrite bytes at position with one of the mistakes.
+static void AddMistake(uint8_t *text, size_t length, size_t position) {
+	const uint8_t *mistake = mistakes[Random(sizeof(mistakes)/sizeof(mistakes[0]))];
+	const size_t len = strlen((const char *)mistake);
+	for (size_t j = 0; j < len && position + j < length; j++) {
+		text[position + j] = mistake[j];
+	}
+}
+
+static void Compare(const uint8_t *text, size_t length, int maxValidator) {
+	const size_t expected = ReferenceFindInvalid(text, length);
+	for (int validator = UTF8Validator_Scalar; validator <= maxValidator; validator++) {
+		const size_t actual = UTF8_FindInvalidWith(validator, (const char *)text, length);
+		if (actual != expected) {
+			Fail("offset differs", validator, length, actual);
+		}
+	}
+}
+
+static int Test(void) {
+	enum { bufferSize = 4096 + 64 };
+	uint8_t *buffer = (uint8_t *)malloc(bufferSize);
+	uint8_t *text = (uint8_t *)malloc(bufferSize);
+	const int maxValidator = UTF8_GetValidator();
+	int runs = 0;
+
+	for (int round = 0; round < 20000; round++) {
+		const int script = Random(ScriptCount);
+		const size_t size = Random(4) ? Random(200) : Random(4096);
+		const size_t length = MakeText(text, size, script);
+		const uint32_t count = Random(4);
+		for (uint32_t j = 0; j < count && length != 0; j++) {
+			AddMistake(text, length, Random((uint32_t)length));
+		}
+		// validators align their reads, so check every start offset within a block
+		const size_t offset = Random(64);
+		memcpy(buffer + offset, text, length);
+		Compare(buffer + offset, length, maxValidator);
+		// truncated text ends inside a character
+		if (length != 0) {
+			Compare(buffer + offset, length - 1 - Random((uint32_t)(length < 4 ? length : 4)), maxValidator);
+		}
+		runs++;
+	}
+
+	// each mistake at each position around block boundaries
+	for (int script = 0; script < ScriptCount; script++) {
+		const size_t length = MakeText(text, 160, script);
+		for (size_t position = 0; position < length; position++) {
+			for (size_t k = 0; k < sizeof(mistakes)/sizeof(mistakes[0]); k++) {
+				memcpy(buffer, text, length);
+				const size_t len = strlen((const char *)mistakes[k]);
+				for (size_t j = 0; j < len && position + j < length; j++) {
+					buffer[position + j] = mistakes[k][j];
+				}
+				Compare(buffer, length, maxValidator);
+				runs++;
+			}
+		}
+	}
+
+	free(buffer);
+	free(text);
+	printf("Validated %d texts with", runs);
+	for (int validator = UTF8Validator_Scalar; validator <= maxValidator; validator++) {
+		printf(" %s", validatorNames[validator]);
+	}
+	printf(", %d failed.\n", failures);
+	return (failures == 0) ? 0 : 1;
+}
+
+static int Bench(void) {
+	enum { textSize = 16 * 1024 * 1024, repeat = 10 };
+	uint8_t *text = (uint8_t *)malloc(textSize);
+	const int maxValidator = UTF8_GetValidator();
+
+	printf("MB/s of valid UTF-8\n%-8s", "script");
+	for (int validator = UTF8Validator_Scalar; validator <= maxValidator; validator++) {
+		printf("%10s", validatorNames[validator]);
+	}
+	printf("\n");
+	for (int script = 0; script < ScriptCount; script++) {
+		const size_t length = MakeText(text, textSize, script);
+		printf("%-8s", scriptNames[script]);
+		for (int validator = UTF8Validator_Scalar; validator <= maxValidator; validator++) {
+			const clock_t start = clock();
+			for (int i = 0; i < repeat; i++) {
+				if (UTF8_FindInvalidWith(validator, (const char *)text, length) != length) {
+					Fail("valid text rejected", validator, length, 0);
+				}
+			}
+			const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+			printf("%10.0f", (double)length * repeat / seconds / (1024 * 1024));
+		}
+		printf("\n");
+	}
+	free(text);
+	return (failures == 0) ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+		return Bench();
+	}
+	return Test();
+}